@@ -0,0 +1,65 @@
+# Mapper sources shared by the GUI application and the auxiliary targets
+# (tests/benchmarks). Everything except src/main.cpp lives here: the
+# widget-free part in pandora_map.pri, the windows and the renderer below.
+
+QT += widgets opengl openglwidgets
+
+include(pandora_map.pri)
+
+FORMS += $$PWD/src/Ui/configedit.ui \
+    $$PWD/src/Ui/finddialog.ui \
+    $$PWD/src/Ui/groupmanagersettings.ui \
+    $$PWD/src/Ui/logdialog.ui \
+    $$PWD/src/Ui/movementdialog.ui \
+    $$PWD/src/Ui/roomedit.ui \
+    $$PWD/src/Ui/spellsdialog.ui
+
+	
+################################################ 	GroupManager		######################################################
+HEADERS += $$PWD/src/GroupManager/CGroup.h \
+    $$PWD/src/GroupManager/CGroupChar.h \
+    $$PWD/src/GroupManager/CGroupClient.h \
+    $$PWD/src/GroupManager/CGroupCommunicator.h \
+    $$PWD/src/GroupManager/CGroupServer.h
+
+SOURCES += $$PWD/src/GroupManager/CGroup.cpp \
+    $$PWD/src/GroupManager/CGroupChar.cpp \
+    $$PWD/src/GroupManager/CGroupClient.cpp \
+    $$PWD/src/GroupManager/CGroupCommunicator.cpp \
+    $$PWD/src/GroupManager/CGroupServer.cpp
+
+	
+################################################ 	Gui		######################################################
+HEADERS += $$PWD/src/Gui/CActionManager.h \
+    $$PWD/src/Gui/CLogDialog.h \
+    $$PWD/src/Gui/CMovementDialog.h \
+    $$PWD/src/Gui/ConfigWidget.h \
+    $$PWD/src/Gui/finddialog.h \
+    $$PWD/src/Gui/mainwindow.h \
+    $$PWD/src/Gui/RoomEditDialog.h \
+    $$PWD/src/Gui/SpellsDialog.h \
+    $$PWD/src/Gui/CGroupSettingsDialog.h
+
+SOURCES += $$PWD/src/Gui/CActionManager.cpp \
+    $$PWD/src/Gui/CLogDialog.cpp \
+    $$PWD/src/Gui/CMovementDialog.cpp \
+    $$PWD/src/Gui/ConfigWidget.cpp \
+    $$PWD/src/Gui/finddialog.cpp \
+    $$PWD/src/Gui/mainwindow.cpp \
+    $$PWD/src/Gui/RoomEditDialog.cpp \
+    $$PWD/src/Gui/SpellsDialog.cpp \
+    $$PWD/src/Gui/CGroupSettingsDialog.cpp
+
+	
+################################################ 	Renderer	######################################################
+HEADERS += $$PWD/src/Renderer/CFrustum.h \
+    $$PWD/src/Renderer/GLPrimitives.h \
+    $$PWD/src/Renderer/renderer.h
+
+
+SOURCES += $$PWD/src/Renderer/CFrustum.cpp \
+    $$PWD/src/Renderer/CTextures.cpp \
+    $$PWD/src/Renderer/GLPrimitives.cpp \
+    $$PWD/src/Renderer/renderer.cpp 
+
+RESOURCES += $$PWD/resources/pandora.qrc
@@ -0,0 +1,122 @@
+# Widget-free mapper sources: the map, engine, proxy and utils. The GUI
+# application and the tests get them through pandora_core.pri, headless
+# targets (tools/maptool) include this file alone and get the no-op GUI
+# hooks of src/Utils/headless.cpp.
+
+INCLUDEPATH += $$PWD/src $$PWD/src/Utils
+
+# QtGui for QImage and QColor only, no widgets or OpenGL
+QT += core gui xml network
+
+# MapTools and CMapChecker split their work over the thread pool
+QT += concurrent
+
+HEADERS += $$PWD/src/defines.h \
+    $$PWD/src/AppContext.h
+SOURCES += $$PWD/src/AppContext.cpp
+
+	
+################################################ 	Engine		######################################################
+HEADERS += $$PWD/src/Engine/CEngine.h \
+    $$PWD/src/Engine/CCommandQueue.h \
+    $$PWD/src/Engine/CEvent.h \
+    $$PWD/src/Engine/CSession.h \
+    $$PWD/src/Engine/CStacksManager.h 
+
+SOURCES += $$PWD/src/Engine/CEngine.cpp \
+    $$PWD/src/Engine/CCommandQueue.cpp \
+    $$PWD/src/Engine/CSession.cpp \
+    $$PWD/src/Engine/CStacksManager.cpp 
+	
+	
+################################################ 	GroupManager		######################################################
+HEADERS += $$PWD/src/GroupManager/CGroupCharState.h
+
+	
+################################################ 	Gui		######################################################
+HEADERS += $$PWD/src/Gui/CSelectionManager.h
+
+SOURCES += $$PWD/src/Gui/CSelectionManager.cpp
+
+	
+################################################ 	Map		######################################################
+HEADERS += $$PWD/src/Map/CRoom.h \
+    $$PWD/src/Map/CDescSketch.h \
+    $$PWD/src/Map/CRoomManager.h \
+    $$PWD/src/Map/CTree.h \
+    $$PWD/src/Map/CRegion.h \
+    $$PWD/src/Map/CMapChecker.h \
+    $$PWD/src/Map/CMapGraph.h \
+    $$PWD/src/Map/CMapLayout.h \
+    $$PWD/src/Map/CMapPath.h \
+    $$PWD/src/Map/CRoomBitmap.h \
+    $$PWD/src/Map/CRoomIndex.h \
+    $$PWD/src/Map/CRegionPager.h \
+    $$PWD/src/Map/CMapEpoch.h \
+    $$PWD/src/Map/CMapTransaction.h
+
+
+SOURCES += $$PWD/src/Map/CRoom.cpp \
+    $$PWD/src/Map/CDescSketch.cpp \
+    $$PWD/src/Map/CRoomManager.cpp \
+    $$PWD/src/Map/CTree.cpp \
+    $$PWD/src/Map/CRegion.cpp \
+    $$PWD/src/Map/CMapChecker.cpp \
+    $$PWD/src/Map/CMapGraph.cpp \
+    $$PWD/src/Map/CMapLayout.cpp \
+    $$PWD/src/Map/CMapPath.cpp \
+    $$PWD/src/Map/CRoomBitmap.cpp \
+    $$PWD/src/Map/CRoomIndex.cpp \
+    $$PWD/src/Map/CRegionPager.cpp \
+    $$PWD/src/Map/CMapEpoch.cpp \
+    $$PWD/src/Map/CMapTransaction.cpp
+
+	
+################################################ 	Proxy		######################################################
+HEADERS += $$PWD/src/Proxy/CDispatcher.h \
+    $$PWD/src/Proxy/CDispatcherSink.h \
+	$$PWD/src/Proxy/patterns.h \
+    $$PWD/src/Proxy/proxy.h \
+    $$PWD/src/Proxy/userfunc.h 
+	
+
+SOURCES += $$PWD/src/Proxy/CDispatcher.cpp \
+	$$PWD/src/Proxy/patterns.cpp \
+    $$PWD/src/Proxy/proxy.cpp \
+    $$PWD/src/Proxy/userfunc.cpp 
+
+	
+################################################ 	Renderer	######################################################
+HEADERS += $$PWD/src/Renderer/CSquare.h
+
+SOURCES += $$PWD/src/Renderer/CSquare.cpp
+
+	
+################################################ 	Utils		######################################################
+HEADERS += $$PWD/src/Utils/CTimers.h \
+    $$PWD/src/Utils/CConfigurator.h \
+    $$PWD/src/Utils/utils.h \
+    $$PWD/src/Utils/xml2.h \
+    $$PWD/src/Utils/MMapperImport.h \
+    $$PWD/src/Utils/MapGenerator.h \
+    $$PWD/src/Utils/MapDocument.h \
+    $$PWD/src/Utils/MapTools.h \
+    $$PWD/src/Utils/LogIngest.h \
+    $$PWD/src/Utils/CMemoryStats.h \
+    $$PWD/src/Utils/CProgress.h \
+    $$PWD/src/Utils/parallel.h
+
+SOURCES += $$PWD/src/Utils/CTimers.cpp \
+    $$PWD/src/Utils/CConfigurator.cpp \
+    $$PWD/src/Utils/utils.cpp \
+    $$PWD/src/Utils/xml2.cpp \
+    $$PWD/src/Utils/MMapperImport.cpp \
+    $$PWD/src/Utils/MapGenerator.cpp \
+    $$PWD/src/Utils/MapDocument.cpp \
+    $$PWD/src/Utils/MapTools.cpp \
+    $$PWD/src/Utils/LogIngest.cpp \
+    $$PWD/src/Utils/CMemoryStats.cpp
+
+# the GUI hooks, pandora_core.pri adds widgets and Gui/mainwindow.cpp with
+# the real ones before it includes this file
+!contains(QT, widgets): SOURCES += $$PWD/src/Utils/headless.cpp
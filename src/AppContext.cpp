@@ -26,7 +26,6 @@
 #include "Engine/CStacksManager.h"
 #include "Map/CTree.h"
 #include "Utils/CConfigurator.h"
-#include "Gui/mainwindow.h"
 #include "Proxy/userfunc.h"
 
 AppContext &AppContext::instance()
@@ -0,0 +1,175 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QHash>
+
+#include "Engine/CCommandQueue.h"
+#include "Map/CRoomManager.h"
+
+CPredictedRoom CCommandQueue::predictedRoom(CRoom *r)
+{
+    return CPredictedRoom{r->id, qHash(r->getName()), r->getDescSketch().key()};
+}
+
+bool CCommandQueue::predictionFits(unsigned int id) const
+{
+    return predicted && chain.first().id == id && predictedVersion == Map.getVersion() &&
+           predictedRevision == Map.getGraphRevision();
+}
+
+/* moves r along dir, returns false if the exit is not known */
+bool CCommandQueue::predictStep(CRoom *&r, int dir)
+{
+    if (r->isConnected(dir))
+        r = r->exits[dir];
+    else if (r->isExitUndefined(dir))
+        return false;
+    /* no exit at all - the move fails and we stay */
+    chain.append(predictedRoom(r));
+    return true;
+}
+
+void CCommandQueue::predictFrom(CRoom *r)
+{
+    chain.clear();
+    chain.append(predictedRoom(r));
+    complete = true;
+    walked = 0;
+    extendPrediction(r);
+
+    predicted = true;
+    predictedVersion = Map.getVersion();
+    predictedRevision = Map.getGraphRevision();
+}
+
+/* walks the commands queued since the last walk, r is the end of the chain */
+void CCommandQueue::extendPrediction(CRoom *r)
+{
+    for (; walked < pipe.size() && complete; walked++)
+        if (pipe.at(walked).type == CCommand::MOVEMENT)
+            complete = predictStep(r, pipe.at(walked).dir);
+}
+
+void CCommandQueue::updatePrediction(CRoom *r)
+{
+    if (!predictionFits(r->id)) {
+        predictFrom(r);
+        return;
+    }
+    if (!complete || walked == pipe.size())
+        return;
+
+    CRoom *last = Map.getRoom(chain.last().id);
+    if (last == nullptr)
+        predictFrom(r);
+    else
+        extendPrediction(last);
+}
+
+void CCommandQueue::shiftPrediction(const CCommand &head)
+{
+    if (!predicted)
+        return;
+    /* the head was not walked yet, the next update makes a new prediction */
+    if (walked == 0) {
+        predicted = false;
+        return;
+    }
+    walked--;
+    if (head.type != CCommand::MOVEMENT)
+        return;
+    /* the head was not resolved, nothing is known about where we go */
+    if (chain.size() < 2) {
+        predicted = false;
+        return;
+    }
+    chain.removeFirst();
+}
+
+std::unique_ptr<QVector<unsigned int>> CCommandQueue::getPrespam(unsigned int id)
+{
+    auto list = std::make_unique<QVector<unsigned int>>();
+    CEpochGuard guard(Map.epoch);
+    QMutexLocker locker(&pipeMutex);
+
+    CRoom *r = Map.getRoom(id);
+    if (r == nullptr)
+        return list;
+    updatePrediction(r);
+
+    /* failed moves repeat the room, the line skips them */
+    for (const CPredictedRoom &step : chain)
+        if (list->isEmpty() || list->last() != step.id)
+            list->append(step.id);
+    return list;
+}
+
+std::unique_ptr<QVector<unsigned int>> CCommandQueue::peekPrespam(unsigned int id)
+{
+    auto list = std::make_unique<QVector<unsigned int>>();
+    CEpochGuard guard(Map.epoch);
+    QMutexLocker locker(&pipeMutex);
+
+    CRoom *r = Map.getRoom(id);
+    if (r == nullptr)
+        return list;
+
+    int from = 0;
+    CRoom *last = predictionFits(id) ? Map.getRoom(chain.last().id) : nullptr;
+    if (last != nullptr) {
+        for (const CPredictedRoom &step : chain)
+            if (list->isEmpty() || list->last() != step.id)
+                list->append(step.id);
+        if (!complete)
+            return list;
+        from = walked;
+        r = last;
+    } else {
+        list->append(id);
+    }
+
+    /* only exit pointers from here on, as the plain prespam walk did */
+    for (int i = from; i < pipe.size(); i++) {
+        const CCommand &cmd = pipe.at(i);
+        if (cmd.type != CCommand::MOVEMENT)
+            continue;
+        if (r->isConnected(cmd.dir)) {
+            r = r->exits[cmd.dir];
+            list->append(r->id);
+        } else if (r->isExitUndefined(cmd.dir)) {
+            break;
+        }
+    }
+    return list;
+}
+
+bool CCommandQueue::expectedRoom(CRoom *r, int dir, CPredictedRoom &expected)
+{
+    QMutexLocker locker(&pipeMutex);
+
+    if (pipe.isEmpty() || pipe.head().type != CCommand::MOVEMENT || pipe.head().dir != dir)
+        return false;
+    updatePrediction(r);
+    if (chain.size() < 2)
+        return false;
+    expected = chain[1];
+    return true;
+}
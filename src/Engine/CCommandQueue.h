@@ -18,6 +18,7 @@
 #include <QVector>
 
 #include "utils.h"
+#include "CMemoryStats.h"
 
 #include "Map/CRoom.h"
 
@@ -63,11 +64,43 @@ class CCommand
     }
 };
 
+/* one step of the prespam prediction: the room a movement should lead */
+/* into and fingerprints of its texts, taken when the step was predicted */
+struct CPredictedRoom
+{
+    unsigned int id;
+    size_t nameKey; /* qHash() of the name */
+    size_t descKey; /* CDescSketch::key() of the desc */
+};
+
 class CCommandQueue
 {
     mutable QMutex pipeMutex;
     QQueue<CCommand> pipe;
 
+    /* Rooms the queued movements are expected to lead through. chain[0]   */
+    /* is the room the movements start from, chain[i] the room after the   */
+    /* i-th movement. The chain is cut at the first movement into an       */
+    /* unknown exit. Commands are queued on the proxy thread, so the chain */
+    /* is only walked when the engine thread asks for it (getPrespam,      */
+    /* expectedRoom) - it reads room texts the engine thread writes.       */
+    /* Everything under pipeMutex; a prediction made on another map        */
+    /* (version or graph revision) or from another room is made again.     */
+    QVector<CPredictedRoom> chain;
+    bool predicted = false;
+    bool complete = false; /* no unknown exit so far, so the chain may grow */
+    int walked = 0;        /* queued commands the chain went through */
+    quint64 predictedVersion = 0;
+    quint64 predictedRevision = 0;
+
+    void predictFrom(CRoom *r);
+    bool predictionFits(unsigned int id) const;
+    bool predictStep(CRoom *&r, int dir);
+    void extendPrediction(CRoom *r);
+    void updatePrediction(CRoom *r);
+    void shiftPrediction(const CCommand &head);
+    static CPredictedRoom predictedRoom(CRoom *r);
+
   public:
     void addCommand(int type, int dir)
     {
@@ -78,18 +111,22 @@ class CCommandQueue
 
         QMutexLocker locker(&pipeMutex);
         pipe.enqueue(command);
+        MemoryStats.add(CMemoryStats::MEM_EVENTS, sizeof(CCommand), 1);
     }
 
     void addCommand(CCommand e)
     {
         QMutexLocker locker(&pipeMutex);
         pipe.enqueue(e);
+        MemoryStats.add(CMemoryStats::MEM_EVENTS, sizeof(CCommand), 1);
     }
 
     void clear()
     {
         QMutexLocker locker(&pipeMutex);
+        MemoryStats.add(CMemoryStats::MEM_EVENTS, -qint64(pipe.size() * sizeof(CCommand)), -pipe.size());
         pipe.clear();
+        predicted = false;
     }
 
     bool isEmpty() const
@@ -109,11 +146,21 @@ class CCommandQueue
     CCommand dequeue()
     {
         QMutexLocker locker(&pipeMutex);
-        if (!pipe.empty())
+        if (!pipe.empty()) {
+            MemoryStats.add(CMemoryStats::MEM_EVENTS, -qint64(sizeof(CCommand)), -1);
+            shiftPrediction(pipe.head());
             return pipe.dequeue();
+        }
         return CCommand();
     }
 
+    /* drops the prediction, e.g. when a move was cancelled */
+    void invalidatePrediction()
+    {
+        QMutexLocker locker(&pipeMutex);
+        predicted = false;
+    }
+
     void print()
     {
         QMutexLocker locker(&pipeMutex);
@@ -126,24 +173,17 @@ class CCommandQueue
         printf("\r\n");
     }
 
-    std::unique_ptr<QVector<unsigned int>> getPrespam(CRoom *r)
-    {
-        auto list = std::make_unique<QVector<unsigned int>>();
-        QMutexLocker locker(&pipeMutex);
-
-        list->append(r->id);
-        for (int i = 0; i < pipe.size(); i++) {
-            CCommand cmd = pipe.at(i);
-            if (cmd.type == CCommand::MOVEMENT) {
-                if (r->isConnected(cmd.dir)) {
-                    list->append(r->exits[cmd.dir]->id);
-                    r = r->exits[cmd.dir];
-                } else if (r->isExitUndefined(cmd.dir))
-                    break;
-            }
-        }
-        return list;
-    }
+    /* ids of room id and the rooms the queued movements lead to. Engine */
+    /* thread only, brings the prediction up to date                     */
+    std::unique_ptr<QVector<unsigned int>> getPrespam(unsigned int id);
+    /* the same for other threads: the ids of a fitting prediction, then  */
+    /* the exits for the commands it did not walk yet. Reads no room text */
+    std::unique_ptr<QVector<unsigned int>> peekPrespam(unsigned int id);
+
+    /* the room the head command should lead to from r, if the head is a */
+    /* movement in dir and the prediction knows where it goes. Engine    */
+    /* thread only                                                       */
+    bool expectedRoom(CRoom *r, int dir, CPredictedRoom &expected);
 };
 
 #endif /* CCOMMANDQUEUE_H_ */
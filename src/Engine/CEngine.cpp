@@ -21,11 +21,14 @@
 #include <QMutex>
 #include <QElapsedTimer>
 #include <QTimer>
+#include <QThread>
 
 #include "defines.h"
 #include "CConfigurator.h"
 #include "utils.h"
+#include "parallel.h"
 
+#include "Engine/CSession.h"
 #include "Engine/CStacksManager.h"
 
 #include "Proxy/CDispatcher.h"
@@ -34,12 +37,13 @@
 #include "Engine/CEngine.h"
 #include "Engine/CEvent.h"
 
+#include "Map/CMapTransaction.h"
 #include "Map/CRoomManager.h"
 #include "Map/CTree.h"
 
 #include "Proxy/userfunc.h"
 
-class CEngine *engine;
+thread_local class CEngine *engine = nullptr;
 
 /*---------------- * MAPPING OFF ---------------------------- */
 void CEngine::mappingOff()
@@ -55,10 +59,14 @@ void CEngine::mappingOff()
 void CEngine::swap()
 {
     print_debug(DEBUG_ANALYZER, "in swap");
-    stacker.swap();
+    stacker->swap();
 
-    if (mapping && stacker.amount() != 1)
+    if (mapping && stacker->amount() != 1)
         mappingOff();
+
+    /* load the regions around us before the next room needs them */
+    if (stacker->amount() == 1)
+        Map.pager.touchAround(stacker->first());
 }
 /*---------------- * SWAP  ------------------------- */
 
@@ -67,33 +75,90 @@ void CEngine::resync()
 {
     int j;
     TTree *n;
+    int exits[6];
+    bool check = conf->getExitsCheck() && last_exits != "";
 
     mappingOff();
 
+    if (check)
+        parse_exits(last_exits.constData(), exits);
+
     print_debug(DEBUG_ANALYZER, "FULL RESYNC");
     n = NameMap.findByName(last_name);
     if (n != nullptr)
         for (j = 0; j < n->ids.size(); j++) {
-            if (last_name == Map.getName(n->ids[j])) {
+            CRoom *room = Map.getRoom(n->ids[j]);
+            if (room && last_name == room->getName() && (!check || exitsFit(room, exits))) {
                 //        print_debug(DEBUG_ANALYZER, "Adding matches");
-                stacker.put(n->ids[j]);
+                stacker->put(room);
             }
         }
 
-    stacker.swap();
+    stacker->swap();
+}
+
+/* only reads the event and the room, so it may run on any thread */
+CEngine::CandidateTest CEngine::testRoom(CRoom *room) const
+{
+    CandidateTest test = {false, false, false, 0, 0};
+
+    if (event.blind) {
+        test.match = true;
+        return test;
+    }
+    /* the cheapest test first - a few bit operations per room */
+    if (checkExits && !exitsFit(room, eventExits))
+        return test;
+    test.nameTested = true;
+    if ((test.nameMatch = room->roomnameCmp(event.name)) >= 0) {
+        if (event.desc == "") {
+            test.match = true;
+        } else {
+            test.descTested = true;
+            test.match = (test.descMatch = room->descCmp(event.desc, eventSketch)) >= 0;
+        }
+    }
+    return test;
+}
+
+QVector<CEngine::CandidateTest> CEngine::testRooms(const QVector<CRoom *> &candidates) const
+{
+    auto testRange = [this, &candidates](int from, int to) {
+        QVector<CandidateTest> result;
+        result.reserve(to - from);
+        for (int i = from; i < to; i++)
+            result.append(testRoom(candidates[i]));
+        return result;
+    };
+
+    if (candidates.size() < PARALLEL_CANDIDATES)
+        return testRange(0, candidates.size());
+
+    /* paging in is not made for many threads, bring the texts first */
+    for (CRoom *room : candidates)
+        room->ensureResident();
+
+    QVector<QVector<CandidateTest>> chunks =
+        runChunked<QVector<CandidateTest>>(candidates.size(), testRange, PARALLEL_CANDIDATES / 4);
+    QVector<CandidateTest> result;
+    result.reserve(candidates.size());
+    for (const QVector<CandidateTest> &chunk : chunks)
+        result += chunk;
+    return result;
 }
 
-bool CEngine::testRoom(CRoom *room)
+void CEngine::takeMatches(const QVector<CRoom *> &candidates)
 {
-    if (event.blind)
-        return true;
-    if ((nameMatch = room->roomnameCmp(event.name)) >= 0) {
-        if (event.desc == "")
-            return true;
-        else if ((descMatch = room->descCmp(event.desc)) >= 0)
-            return true;
+    QVector<CandidateTest> tests = testRooms(candidates);
+
+    for (int i = 0; i < candidates.size(); i++) {
+        if (tests[i].nameTested)
+            nameMatch = tests[i].nameMatch;
+        if (tests[i].descTested)
+            descMatch = tests[i].descMatch;
+        if (tests[i].match)
+            stacker->put(candidates[i]);
     }
-    return false;
 }
 
 void CEngine::tryDir()
@@ -101,7 +166,6 @@ void CEngine::tryDir()
     int dir;
     unsigned int i;
     CRoom *room;
-    CRoom *candidate;
 
     nameMatch = 0;
     descMatch = 0;
@@ -114,53 +178,65 @@ void CEngine::tryDir()
     }
 
     CCommand cmd = commandQueue.peek();
+    CPredictedRoom expected;
+    bool predicted = false;
     if (cmd.timer.elapsed() > conf->getPrespamTTL()) {
         print_debug(DEBUG_ANALYZER, "The command queue has head entry with lifetime over limit. Resetting");
         commandQueue.clear();
         toggle_renderer_reaction();
     } else if (cmd.dir == dir && !event.fleeing) {
         // we moved in awaited direction
+        predicted = stacker->amount() == 1 && commandQueue.expectedRoom(stacker->first(), dir, expected);
         commandQueue.dequeue();
     }
 
-    if (stacker.amount() == 0) {
+    if (stacker->amount() == 0) {
         print_debug(DEBUG_ANALYZER, "leaving. No candidates in stack to check. This results in FULL RESYNC.");
         return;
     }
 
-    for (i = 0; i < stacker.amount(); i++) {
-        room = stacker.get(i);
-        if (room->isConnected(dir)) {
-            candidate = room->exits[dir];
-            if (testRoom(candidate)) {
-                stacker.put(candidate);
-            }
+    room = stacker->first();
+    if (stacker->amount() == 1 && mapping && !room->isConnected(dir)) {
+        print_debug(DEBUG_ANALYZER, "Going to add new room...");
+        mapCurrentRoom(room, dir);
+        return;
+    }
 
-        } else {
-            if (stacker.amount() == 1 && mapping) {
-                print_debug(DEBUG_ANALYZER, "Going to add new room...");
-                mapCurrentRoom(room, dir);
-                return;
-            }
-        }
+    if (predicted && matchesPrediction(expected)) {
+        print_debug(DEBUG_ANALYZER, "The event is the predicted room %u", expected.id);
+        stacker->put(expected.id);
+        return;
     }
 
+    QVector<CRoom *> candidates;
+    candidates.reserve(stacker->amount());
+    for (i = 0; i < stacker->amount(); i++) {
+        room = stacker->get(i);
+        if (room->isConnected(dir))
+            candidates.append(room->exits[dir]);
+    }
+    takeMatches(candidates);
+
+    /* the one room we should have entered does not match - maybe it got a new description */
+    if (reidentify && stacker->next() == 0 && candidates.size() == 1)
+        queueReidentCheck(candidates[0]);
+
     /* roomname update */
-    if (stacker.next() == 1) {
+    if (stacker->next() == 1) {
         /* this means we have exactly one match */
         //        printf("nameMatch %i, descMatch %i\r\n", nameMatch, descMatch);
         if (nameMatch > 0) {
             /* Autorefresh only if case has been changed. */
-            if (conf->getAutorefresh() && event.name.toLower() == stacker.nextFirst()->getName().toLower()) {
+            if (conf->getAutorefresh() && event.name.toLower() == stacker->nextFirst()->getName().toLower()) {
                 send_to_user("--[ (AutoRefreshed) not exact room name match: %i errors.\r\n", nameMatch);
-                stacker.nextFirst()->setName(event.name);
+                stacker->nextFirst()->setName(event.name);
             } else {
                 send_to_user("--[ not exact room name match: %i errors. Use 'mrefresh' to fix it!\r\n", nameMatch);
             }
         }
         if (conf->getAutorefresh() && descMatch > 0) {
             send_to_user("--[ (AutoRefreshed) not exact room desc match: %i errors.\r\n", descMatch);
-            stacker.nextFirst()->setDesc(event.desc);
+            stacker->nextFirst()->setDesc(event.desc);
         } else if (!conf->getAutorefresh() && descMatch > 0) {
             send_to_user("--[ not exact room desc match: %i errors.\r\n", descMatch);
         }
@@ -169,6 +245,21 @@ void CEngine::tryDir()
     print_debug(DEBUG_ANALYZER, "leaving tryDir");
 }
 
+bool CEngine::matchesPrediction(const CPredictedRoom &expected) const
+{
+    if (event.blind || eventNameKey != expected.nameKey)
+        return false;
+    if (event.desc != "" && eventSketch.key() != expected.descKey)
+        return false;
+
+    /* the texts may have changed since the prediction */
+    CRoom *room = Map.getRoom(expected.id);
+    if (room == nullptr || qHash(room->getName()) != expected.nameKey ||
+        room->getDescSketch().key() != expected.descKey)
+        return false;
+    return !checkExits || exitsFit(room, eventExits);
+}
+
 /* now try all dirs, only removes other rooms, if there is a full 100% fit for new data */
 /* resyncs only if the stacks are empty */
 void CEngine::tryAllDirs()
@@ -176,26 +267,23 @@ void CEngine::tryAllDirs()
     int dir;
     unsigned int i;
     CRoom *room;
-    CRoom *candidate;
 
     mappingOff();
 
     print_debug(DEBUG_ANALYZER, "in try_dir_all_dirs");
-    if (stacker.amount() == 0) {
+    if (stacker->amount() == 0) {
         print_debug(DEBUG_ANALYZER, "leaving. No candidates in stack to check. This results in FULL RESYNC.");
         return;
     }
 
-    for (i = 0; i < stacker.amount(); i++) {
-        room = stacker.get(i);
-        for (dir = 0; dir <= 5; dir++) {
-            if (room->isConnected(dir)) {
-                candidate = room->exits[dir];
-                if (testRoom(candidate))
-                    stacker.put(candidate);
-            }
-        }
+    QVector<CRoom *> candidates;
+    for (i = 0; i < stacker->amount(); i++) {
+        room = stacker->get(i);
+        for (dir = 0; dir <= 5; dir++)
+            if (room->isConnected(dir))
+                candidates.append(room->exits[dir]);
     }
+    takeMatches(candidates);
 
     print_debug(DEBUG_ANALYZER, "leaving try_dir_all_dirs");
 }
@@ -207,20 +295,22 @@ void CEngine::tryLook()
 
     print_debug(DEBUG_ANALYZER, "in tryLook");
 
-    if (stacker.amount() == 0) {
+    if (stacker->amount() == 0) {
         print_debug(DEBUG_ANALYZER, "leaving. No candidates in stack to check. This results in FULL RESYNC.");
         return;
     }
 
-    for (i = 0; i < stacker.amount(); i++) {
-        room = stacker.get(i);
-        if (testRoom(room))
-            stacker.put(room);
-    }
+    QVector<CRoom *> candidates;
+    candidates.reserve(stacker->amount());
+    for (i = 0; i < stacker->amount(); i++)
+        candidates.append(stacker->get(i));
+    takeMatches(candidates);
 }
 
 void CEngine::slotRunEngine()
 {
+    CSessionScope scope(session);
+
     print_debug(DEBUG_ANALYZER, "In slotRunEngine");
 
     if (Map.isBlocked()) {
@@ -242,6 +332,111 @@ void CEngine::slotRunEngine()
     print_debug(DEBUG_ANALYZER, "leaving slotRunEngine");
 }
 
+/*---------------- * RE-IDENTIFICATION * ------------------------- */
+void CEngine::setReidentify(bool b)
+{
+    reidentify = b;
+    if (!reidentify)
+        reidentChecks.clear();
+}
+
+void CEngine::queueReidentCheck(CRoom *room)
+{
+    if (event.name == "" || event.desc == "" || reidentChecks.size() >= REIDENT_PENDING)
+        return;
+
+    CReidentCheck check;
+    check.id = room->id;
+    check.name = event.name;
+    check.desc = event.desc;
+    check.checkExits = checkExits;
+    for (int dir = 0; dir <= 5; dir++)
+        check.exits[dir] = eventExits[dir];
+    reidentChecks.append(check);
+
+    print_debug(DEBUG_ANALYZER, "Room %u did not match, queued for re-identification", room->id);
+    scheduleReident(0);
+}
+
+void CEngine::scheduleReident(int delay)
+{
+    if (reidentScheduled)
+        return;
+    reidentScheduled = true;
+    QTimer::singleShot(delay, this, SLOT(slotReidentify()));
+}
+
+/* name and exits as usual, the description within the wider quote */
+void CEngine::checkReident(const CReidentCheck &check)
+{
+    CRoom *room = Map.getRoom(check.id);
+
+    if (room == nullptr || room->roomnameCmp(check.name) < 0)
+        return;
+    if (check.checkExits && !exitsFit(room, check.exits))
+        return;
+
+    QByteArray desc = room->getDesc();
+    int errors = comparator.compare_with_quote(check.desc, desc, conf->getReidentQuote());
+    if (errors <= 0)
+        return; /* too different, or it matches by now */
+
+    CReidentProposal proposal = {check.id, desc, check.desc, errors};
+    for (CReidentProposal &known : reidentProposals)
+        if (known.id == check.id) {
+            known = proposal;
+            return;
+        }
+    reidentProposals.append(proposal);
+}
+
+int CEngine::applyReidentProposals()
+{
+    CMapTransaction transaction(&Map);
+    int applied = 0;
+
+    for (const CReidentProposal &proposal : reidentProposals) {
+        CRoom *r = Map.getRoom(proposal.id);
+        /* edited since, the proposal is stale */
+        if (r == nullptr || r->getDesc() != proposal.oldDesc)
+            continue;
+        transaction.edit(r)->setDesc(proposal.desc);
+        applied++;
+    }
+    transaction.commit();
+    reidentProposals.clear();
+    return applied;
+}
+
+/* runs the queued checks in the time the tracking leaves over */
+void CEngine::slotReidentify()
+{
+    CSessionScope scope(session);
+    QElapsedTimer budget;
+    int proposals = reidentProposals.size();
+
+    reidentScheduled = false;
+    if (reidentChecks.isEmpty())
+        return;
+    if (!eventPipe.isEmpty() || Map.isBlocked()) {
+        scheduleReident(REIDENT_DELAY);
+        return;
+    }
+
+    budget.start();
+    while (!reidentChecks.isEmpty() && budget.elapsed() < REIDENT_BUDGET)
+        checkReident(reidentChecks.takeFirst());
+    if (!reidentChecks.isEmpty())
+        scheduleReident(0);
+
+    if (reidentProposals.size() > proposals) {
+        send_to_user("--[ Room descriptions seem to be changed, %d updates proposed. See mreident list.\r\n",
+                     static_cast<int>(reidentProposals.size()));
+        send_prompt();
+    }
+}
+/*---------------- * RE-IDENTIFICATION * ------------------------- */
+
 void CEngine::parseEvent()
 {
     print_debug(DEBUG_ANALYZER, "in parseEvent()");
@@ -249,6 +444,7 @@ void CEngine::parseEvent()
     if (event.movementBlocker) {
         // notify renderer to remove all the unnecessary line drawn
         commandQueue.dequeue();
+        commandQueue.invalidatePrediction();
         toggle_renderer_reaction();
         return;
     }
@@ -264,8 +460,12 @@ void CEngine::parseEvent()
         latinToAscii(event.desc);
         last_desc = event.desc;
     }
+    eventSketch.set(event.desc);
+    eventNameKey = qHash(event.name);
+    checkExits = conf->getExitsCheck() && event.exits != "";
     if (event.exits != "") {
         last_exits = event.exits;
+        parse_exits(event.exits.constData(), eventExits);
     }
     if (event.terrain != -1) {
         last_terrain = event.terrain;
@@ -321,14 +521,14 @@ void CEngine::parseEvent()
 
     swap();
 
-    if (stacker.amount() == 0)
+    if (stacker->amount() == 0)
         resync();
 
     print_debug(DEBUG_ANALYZER, "Done. Sending an event to the Renderer");
     toggle_renderer_reaction();
 }
 
-CEngine::CEngine() : QObject()
+CEngine::CEngine() : QObject(), session(nullptr), reidentify(false), reidentScheduled(false)
 {
     /* setting defaults */
 
@@ -371,8 +571,8 @@ void CEngine::updateRegions()
     print_debug(DEBUG_ANALYZER, "in updateRegions");
 
     // update Regions info only if we are in full sync
-    if (stacker.amount() == 1) {
-        r = stacker.first();
+    if (stacker->amount() == 1) {
+        r = stacker->first();
 
         last_region = r->getRegion();
         // If this room was JUST added, it has no region set.
@@ -468,12 +668,12 @@ void CEngine::mapCurrentRoom(CRoom *room, int dir)
     addedroom->simpleSetZ(z);
 
     Map.addRoom(addedroom);
-    stacker.put(addedroom);
+    stacker->put(addedroom);
 
     if (Map.isDuplicate(addedroom) == true) {
         resetAddedRoomVar();
         send_to_user("--[Pandora: Twin rooms merged!\n");
-        proxy->send_line_to_user((const char *)last_prompt);
+        send_prompt();
         print_debug(DEBUG_ANALYZER, "Twins merged");
     } else {
         angryLinker(addedroom);
@@ -645,13 +845,14 @@ void CEngine::printStacks()
                        .arg(ON_OFF(conf->getDuallinker()));
 
     send_to_user(qPrintable(line));
-    stacker.printStacks();
+    stacker->printStacks();
 }
 
 void CEngine::clear()
 {
     eventPipe.clear();
     commandQueue.clear();
+    reidentChecks.clear();
 
     print_debug(DEBUG_ANALYZER, "Engine INIT.\r\n");
     mapping = 0;
@@ -660,6 +861,9 @@ void CEngine::clear()
     last_name.clear();
     last_desc.clear();
     last_exits.clear();
+    eventSketch.clear();
+    eventNameKey = 0;
+    checkExits = false;
     last_terrain = 0;
     last_prompt.clear();
     last_prompt = "-->";
@@ -699,13 +903,22 @@ CRegion *CEngine::get_last_region()
     return last_region;
 }
 
+void CEngine::addMovementCommand(int dir)
+{
+    /* proxy thread - the prediction is walked on demand, not here */
+    commandQueue.addCommand(CCommand::MOVEMENT, dir);
+}
+
 // this method ensures that we are in sync!
 std::unique_ptr<QVector<unsigned int>> CEngine::getPrespammedDirs()
 {
-    if (commandQueue.isEmpty() || stacker.amount() != 1)
+    if (commandQueue.isEmpty() || stacker->amount() != 1)
         return nullptr;  // return an empty list
 
-    return commandQueue.getPrespam(stacker.get(0));
+    /* maction asks from the proxy thread, it must not touch the prediction */
+    if (QThread::currentThread() != thread())
+        return commandQueue.peekPrespam(stacker->getId(0));
+    return commandQueue.getPrespam(stacker->getId(0));
 }
 
 void CEngine::do_exits(const char *exits_line)
@@ -746,64 +959,29 @@ void CEngine::do_exits(const char *exits_line)
             r->setExitUndefined(i);
     }
 
-    stacker.put(engine->addedroom);
+    stacker->put(engine->addedroom);
 
     return;
 }
 
-int CEngine::compare_exits(CRoom *p, int exits[])
+/* Secret exits may stay unseen behind a closed door, portals match */
+/* anything. Every other difference counts against the tolerance     */
+bool CEngine::exitsFit(CRoom *room, const int exits[]) const
 {
-    int counter;
-    int i;
-    CRoom *localExit;
-    QByteArray localDoor;
-
-    counter = 0;
-    /* for each door there are following situations : */
-    /* 0) closed door and secret exit in base -> skip this one */
-    /* 1) open exit and normal exit in base -> skip! */
-    /* a) normal exit there and exit in base (secret or not doesnt matter) */
-    /* b) no exit and secret exit in base -> fine */
-
-    print_debug(DEBUG_ANALYZER, "compare_exits called.");
-    for (i = 0; i <= 5; i++) {
-        localExit = p->exits[i];
-        localDoor = p->getDoor(i);
-        if ((exits[i] == 3) && (localExit != nullptr) && (localDoor != ""))
-            if (localDoor != "exit")
-                break; /* situation 0) */
-
-        if (exits[i] == 4) {
-            counter++; /* portal - we ignore this exit and count as possible */
-            continue;
-        }
-
-        if ((exits[i] == 2) && (localExit != nullptr) && (localDoor != ""))
-            break; /* situation 1) */
+    int differences = 0;
 
-        if ((exits[i] > 0) && (localExit != nullptr)) {
-            counter++;
+    for (int dir = 0; dir <= 5; dir++) {
+        int known = room->getExitSignature(dir);
+        if (exits[dir] == E_PORTAL)
             continue;
+        if (exits[dir] == E_NOEXIT) {
+            if (known == CRoom::SIGNATURE_OPEN || known == CRoom::SIGNATURE_DOOR)
+                differences++;
+        } else if (known == CRoom::SIGNATURE_NONE) {
+            differences++;
         }
-
-        if ((exits[i] == 0) && (localExit != nullptr) && (localDoor != ""))
-            if (localDoor != "exit") {
-                counter++;
-                continue;
-            }
-
-        if ((exits[i] == 0) && (localExit != nullptr)) {
-            counter++;
-            continue;
-        }
-    }
-
-    if (counter == 6) { /* only if all 6 exits are the same we can say it probably the same room */
-        print_debug(DEBUG_ANALYZER, "Compare exits result - positive.");
-        return 1;
     }
-    print_debug(DEBUG_ANALYZER, "Compare exits result - negative.");
-    return 0;
+    return differences <= conf->getExitsTolerance();
 }
 
 void CEngine::parse_exits(const char *p, int exits[])
@@ -23,12 +23,35 @@
 
 #include <memory>
 #include <QObject>
+#include <QVector>
 
 #include "Map/CRoom.h"
 
 #include "Engine/CEvent.h"
 #include "Engine/CCommandQueue.h"
 
+class CSession;
+
+/* a description update the engine proposes for a room, see mreident */
+struct CReidentProposal
+{
+    unsigned int id;
+    QByteArray oldDesc; /* applied only if the room still has it */
+    QByteArray desc;
+    int errors;
+};
+
+/* re-identification: the room we should have entered did not match the
+ * event, its description is compared with a wider quote in spare time */
+struct CReidentCheck
+{
+    unsigned int id;
+    QByteArray name;
+    QByteArray desc;
+    bool checkExits;
+    int exits[6]; /* as CEngine::parse_exits() gives them */
+};
+
 class CEngine : public QObject
 {
     Q_OBJECT
@@ -56,6 +79,10 @@ class CEngine : public QObject
 
     QByteArray last_name;
     QByteArray last_desc;
+    CDescSketch eventSketch; /* of event.desc, made once per event for testRoom() */
+    size_t eventNameKey;     /* qHash() of event.name, for the prespam prediction */
+    bool checkExits;         /* exits check on and the event has an exits line */
+    int eventExits[6];       /* the parsed exits line of the event */
     QByteArray last_exits;
     QByteArray last_prompt;
     char last_terrain;
@@ -66,6 +93,20 @@ class CEngine : public QObject
 
     CCommandQueue commandQueue;
 
+    /* not worth more than a walk through a patched area */
+    static const int REIDENT_PENDING = 64;
+    /* per run in spare time, in ms, and how long to wait while events are coming */
+    static const int REIDENT_BUDGET = 5;
+    static const int REIDENT_DELAY = 50;
+    bool reidentify;
+    bool reidentScheduled;
+    QVector<CReidentCheck> reidentChecks;
+    QVector<CReidentProposal> reidentProposals;
+    void queueReidentCheck(CRoom *room);
+    void scheduleReident(int delay);
+
+    CSession *session; /* the engine runs with this session bound, see CSession */
+
     void parseEvent();
     void tryAllDirs();
     void tryDir();
@@ -74,7 +115,26 @@ class CEngine : public QObject
     void resync();
     void mappingOff();
 
-    bool testRoom(CRoom *room);
+    /* result of testing one candidate against the event */
+    struct CandidateTest
+    {
+        bool match;
+        bool nameTested; /* nameMatch/descMatch are only valid if tested */
+        bool descTested;
+        int nameMatch;
+        int descMatch;
+    };
+    /* stacks of at least this size are tested on the thread pool */
+    static const int PARALLEL_CANDIDATES = 64;
+
+    CandidateTest testRoom(CRoom *room) const;
+    /* tests all candidates, results in the order of the candidates */
+    QVector<CandidateTest> testRooms(const QVector<CRoom *> &candidates) const;
+    /* puts the matches into the next stack, the same way a serial loop would */
+    void takeMatches(const QVector<CRoom *> &candidates);
+
+    /* the event is exactly the room the prespam prediction expects */
+    bool matchesPrediction(const CPredictedRoom &expected) const;
 
     void mapCurrentRoom(CRoom *room, int dir);
 
@@ -86,11 +146,13 @@ class CEngine : public QObject
 
     void addEvent(Event e) { eventPipe.addEvent(e); }
 
-    void addMovementCommand(int dir) { commandQueue.addCommand(CCommand::MOVEMENT, dir); }
+    void addMovementCommand(int dir);
     std::unique_ptr<QVector<unsigned int>> getPrespammedDirs();
 
     void exec();
 
+    void setSession(CSession *s) { session = s; }
+
     void angryLinker(CRoom *r);
     void printStacks();
 
@@ -106,7 +168,8 @@ class CEngine : public QObject
     void setExits(QByteArray s) { last_exits = s; }
     void setTerrain(char c) { last_terrain = c; }
 
-    int compare_exits(CRoom *p, int exits[]);
+    /* the room against a parsed exits line, within the exits tolerance */
+    bool exitsFit(CRoom *room, const int exits[]) const;
     void parse_exits(const char *exits_line, int exits[]);
     void do_exits(const char *exits_line);
 
@@ -126,11 +189,24 @@ class CEngine : public QObject
     void updateRegions();
 
     void resetAddedRoomVar() { addedroom = nullptr; }
+
+    bool isReidentify() { return reidentify; }
+    void setReidentify(bool b);
+    const QVector<CReidentProposal> &getReidentProposals() { return reidentProposals; }
+    void clearReidentProposals() { reidentProposals.clear(); }
+    /* proposes an update if check fits its room within reidentQuote */
+    void checkReident(const CReidentCheck &check);
+    /* applies the proposals that are not stale and drops all of them, */
+    /* returns how many were applied                                   */
+    int applyReidentProposals();
+
   public slots:
     void slotRunEngine();
+    void slotReidentify();
     void setPrompt(QByteArray s) { last_prompt = s; }
 };
 
-extern class CEngine *engine;
+/* engine of the session of the calling thread, see CSession */
+extern thread_local class CEngine *engine;
 
 #endif
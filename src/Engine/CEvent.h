@@ -25,6 +25,8 @@
 #include <QMutex>
 #include <QMutexLocker>
 
+#include "CMemoryStats.h"
+
 class Event
 {
   public:
@@ -77,6 +79,11 @@ class Event
         movementBlocker = false;
     }
 
+    qint64 memoryUsed() const
+    {
+        return sizeof(Event) + dir.size() + name.size() + desc.size() + exits.size() + prompt.size();
+    }
+
     QByteArray dir;
     QByteArray name;
     QByteArray desc;
@@ -94,17 +101,22 @@ class PipeManager
 {
     mutable QMutex pipeMutex;
     QQueue<Event> Pipe;
+    qint64 queuedBytes = 0;
 
   public:
     void addEvent(const Event &e)
     {
         QMutexLocker locker(&pipeMutex);
         Pipe.enqueue(e);
+        queuedBytes += e.memoryUsed();
+        MemoryStats.add(CMemoryStats::MEM_EVENTS, e.memoryUsed(), 1);
     }
 
     void clear()
     {
         QMutexLocker locker(&pipeMutex);
+        MemoryStats.add(CMemoryStats::MEM_EVENTS, -queuedBytes, -Pipe.size());
+        queuedBytes = 0;
         Pipe.clear();
     }
 
@@ -117,7 +129,10 @@ class PipeManager
     Event getEvent()
     {
         QMutexLocker locker(&pipeMutex);
-        return Pipe.dequeue();
+        Event e = Pipe.dequeue();
+        queuedBytes -= e.memoryUsed();
+        MemoryStats.add(CMemoryStats::MEM_EVENTS, -e.memoryUsed(), -1);
+        return e;
     }
 };
 
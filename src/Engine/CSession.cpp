@@ -0,0 +1,118 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "Engine/CEngine.h"
+#include "Engine/CSession.h"
+#include "Engine/CStacksManager.h"
+
+#include "Proxy/proxy.h"
+#include "Proxy/userfunc.h"
+
+QList<CSession *> CSession::sessions;
+
+static thread_local CSession *boundSession = nullptr;
+
+CSession::CSession(int index, int localPort) : index(index), localPort(localPort)
+{
+    engine = new CEngine();
+    proxy = new Proxy();
+    userland = new Userland();
+    /* the first session takes the stacks threads start with */
+    stacks = index == 0 ? stacker : new CStacksManager();
+
+    engine->setSession(this);
+    proxy->setSession(this);
+}
+
+CSession *CSession::create(int localPort)
+{
+    CSession *session = new CSession(sessions.size(), localPort);
+    sessions.append(session);
+    return session;
+}
+
+CSession *CSession::current()
+{
+    return boundSession;
+}
+
+void CSession::bind()
+{
+    boundSession = this;
+    ::engine = engine;
+    ::proxy = proxy;
+    ::stacker = stacks;
+    ::userland_parser = userland;
+}
+
+void CSession::forgetRoom(CRoom *room)
+{
+    if (sessions.isEmpty()) {
+        /* headless tools work with the globals alone */
+        stacker->removeRoom(room->id);
+        if (engine != nullptr && engine->addedroom == room)
+            engine->resetAddedRoomVar();
+        return;
+    }
+
+    for (CSession *session : sessions) {
+        session->stacks->removeRoom(room->id);
+        if (session->engine->addedroom == room)
+            session->engine->resetAddedRoomVar();
+    }
+}
+
+void CSession::forgetAllRooms()
+{
+    if (sessions.isEmpty()) {
+        stacker->reset();
+        if (engine != nullptr)
+            engine->resetAddedRoomVar();
+        return;
+    }
+
+    for (CSession *session : sessions) {
+        session->stacks->reset();
+        session->engine->resetAddedRoomVar();
+    }
+}
+
+CSessionScope::CSessionScope(CSession *session) : previous(CSession::current()), active(session != nullptr)
+{
+    if (active)
+        session->bind();
+}
+
+CSessionScope::~CSessionScope()
+{
+    if (!active)
+        return;
+    if (previous != nullptr) {
+        previous->bind();
+    } else {
+        /* the thread was not bound before, back to its defaults */
+        boundSession = nullptr;
+        engine = nullptr;
+        proxy = nullptr;
+        stacker = sessions.first()->stacks;
+        userland_parser = nullptr;
+    }
+}
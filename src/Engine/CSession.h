@@ -0,0 +1,97 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CSESSION_H
+#define CSESSION_H
+
+#include <QList>
+
+class CEngine;
+class CRoom;
+class CStacksManager;
+class Proxy;
+class Userland;
+
+// One play session: a proxy listener (with its dispatcher), an engine with
+// its command queue, the stacks of the current position and a userland
+// command queue. All sessions share the one map (Map), so N characters
+// cost one copy of it.
+//
+// The globals engine, proxy, stacker and userland_parser are thread local.
+// A proxy thread binds its session for good. The GUI thread stays bound to
+// the first session, except while the engine of another session runs -
+// CEngine::slotRunEngine() binds its session for that time. Engines of all
+// sessions run on the GUI thread, so map changes stay serialized as with a
+// single session; other threads read the map through its epoch. Sessions
+// live as long as the program, like the single engine and proxy did.
+
+class CSession
+{
+    static QList<CSession *> sessions;
+
+    int index;
+    int localPort;
+
+    CEngine *engine;
+    Proxy *proxy;
+    CStacksManager *stacks;
+    Userland *userland;
+
+    CSession(int index, int localPort);
+
+  public:
+    // A new session listening on localPort. The first one keeps the stacks
+    // every thread starts with, the others get their own
+    static CSession *create(int localPort);
+    static const QList<CSession *> &all() { return sessions; }
+    // the session the calling thread is bound to, nullptr without sessions
+    static CSession *current();
+
+    // Drops a deleted room from the stacks and engines of all sessions
+    static void forgetRoom(CRoom *room);
+    // Same for all rooms, before the map is cleared
+    static void forgetAllRooms();
+
+    int getIndex() const { return index; }
+    int getLocalPort() const { return localPort; }
+    CEngine *getEngine() const { return engine; }
+    Proxy *getProxy() const { return proxy; }
+    CStacksManager *getStacks() const { return stacks; }
+    Userland *getUserland() const { return userland; }
+
+    void bind(); /* points the globals of the calling thread to this session */
+};
+
+// Binds a session for the lifetime of the scope, a nullptr session is ignored
+class CSessionScope
+{
+    CSession *previous;
+    bool active;
+
+  public:
+    explicit CSessionScope(CSession *session);
+    ~CSessionScope();
+
+    CSessionScope(const CSessionScope &) = delete;
+    CSessionScope &operator=(const CSessionScope &) = delete;
+};
+
+#endif
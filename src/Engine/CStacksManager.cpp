@@ -20,31 +20,30 @@
 
 #include "defines.h"
 #include "utils.h"
+#include "CMemoryStats.h"
 #include "CStacksManager.h"
 
-#include "Renderer/renderer.h"
-
-#include "Gui/mainwindow.h"
-
 #include "Proxy/CDispatcher.h"
 #include "Proxy/proxy.h"
 
 #include "Map/CRoomManager.h"
 
-class CStacksManager stacker;
+/* stacks of the first session, every thread starts with them (see CSession) */
+static class CStacksManager primaryStacks;
+thread_local class CStacksManager *stacker = &primaryStacks;
 
 CRoom *CStacksManager::first()
 {
     if (sa->size() == 0)
         return nullptr;
-    return (*sa)[0];
+    return Map.getRoom((*sa)[0]);
 }
 
 CRoom *CStacksManager::nextFirst()
 {
     if (sb->size() == 0)
         return nullptr;
-    return (*sb)[0];
+    return Map.getRoom((*sb)[0]);
 }
 
 QString CStacksManager::getCurrent() const
@@ -57,78 +56,124 @@ QString CStacksManager::getCurrent() const
         return QStringLiteral(" MULT ");
     }
 
-    return QString::number((*sa)[0]->id);
+    return QString::number((*sa)[0]);
 }
 
 void CStacksManager::printStacks()
 {
-    unsigned int i;
+    int i;
 
     send_to_user(" Possible positions : \n");
     if (sa->size() == 0)
         send_to_user(" Current position is unknown!\n");
     for (i = 0; i < sa->size(); i++) {
-        send_to_user(" %i\n", (*sa)[i]->id);
+        send_to_user(" %i\n", (*sa)[i]);
     }
 }
 
 void CStacksManager::removeRoom(unsigned int id)
 {
-    unsigned int i;
+    sa->removeAll(id);
+    if (sb->removeAll(id) > 0)
+        marks[id] = 0;
+}
+
+int CStacksManager::holds(unsigned int id)
+{
+    int stacks = 0;
+    if (sa->contains(id))
+        stacks |= CURRENT_STACK;
+    if (sb->contains(id))
+        stacks |= NEXT_STACK;
+    return stacks;
+}
+
+void CStacksManager::restoreRoom(unsigned int id, int stacks)
+{
+    if ((stacks & CURRENT_STACK) && !sa->contains(id))
+        sa->append(id);
+    if (stacks & NEXT_STACK)
+        put(id);
+}
+
+/* at least up to the ids the map hands out, doubling past them */
+void CStacksManager::grow(unsigned int id)
+{
+    unsigned int size = qMax(id, Map.next_free) + 1;
+    size = qMax(size, qMin(2 * static_cast<unsigned int>(marks.size()), static_cast<unsigned int>(MAX_ROOMS)));
+    marks.resize(size);
+}
 
-    for (i = 0; i < sa->size(); i++)
-        if (stacker.get(i)->id != id)
-            stacker.put(stacker.get(i));
-    stacker.swap();
+bool CStacksManager::marked(unsigned int id)
+{
+    if (id >= static_cast<unsigned int>(marks.size()))
+        grow(id);
+    if (marks[id] == generation)
+        return true;
+    marks[id] = generation;
+    return false;
 }
 
 void CStacksManager::put(CRoom *r)
 {
-    if (mark[r->id] == turn)
-        return;
-    sb->push_back(r);
-    mark[r->id] = turn;
+    put(r->id);
 }
 
 void CStacksManager::put(unsigned int id)
 {
-    put(Map.getRoom(id));
+    if (marked(id))
+        return;
+    sb->append(id);
 }
 
 CRoom *CStacksManager::get(unsigned int i)
 {
-    return (*sa)[i];
+    return Map.getRoom((*sa)[i]);
 }
 
 CRoom *CStacksManager::getNext(unsigned int i)
 {
-    return (*sb)[i];
+    return Map.getRoom((*sb)[i]);
 }
 
-CStacksManager::CStacksManager()
+CStacksManager::CStacksManager() : accountedBytes(0), accountedCandidates(0)
 {
     reset();
 }
 
+CStacksManager::~CStacksManager()
+{
+    MemoryStats.add(CMemoryStats::MEM_STACKS, -accountedBytes, -accountedCandidates);
+}
+
+void CStacksManager::account()
+{
+    qint64 bytes = (marks.capacity() + stacka.capacity() + stackb.capacity()) * sizeof(unsigned int);
+    int candidates = sa->size();
+    MemoryStats.add(CMemoryStats::MEM_STACKS, bytes - accountedBytes, candidates - accountedCandidates);
+    accountedBytes = bytes;
+    accountedCandidates = candidates;
+}
+
 void CStacksManager::reset()
 {
     sa = &stacka;
     sb = &stackb;
     sa->clear();
     sb->clear();
-    memset(mark, 0, MAX_ROOMS * sizeof(mark[0]));
-    turn = 1;
+    marks.clear();
+    generation = 1;
     swap();
 }
 
 void CStacksManager::swap()
 {
-    vector<CRoom *> *t;
+    Stack *t;
 
-    turn++;
-    if (turn == 0) {
-        memset(mark, 0, MAX_ROOMS * sizeof(mark[0]));
-        turn = 1;
+    generation++;
+    if (generation == 0) {
+        marks.fill(0);
+        generation = 1;
     }
 
     t = sa;
@@ -136,6 +181,7 @@ void CStacksManager::swap()
     sb = t;
     sb->clear();
 
-    if (renderer_window)
-        renderer_window->update_status_bar();
+    account();
+
+    refresh_status_bar();
 }
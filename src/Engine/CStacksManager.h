@@ -21,22 +21,40 @@
 #ifndef STACKSMANAGER_H
 #define STACKSMANAGER_H
 
-#include <vector>
 #include <QString>
+#include <QVarLengthArray>
+#include <QVector>
 #include "Map/CRoom.h"
 #include "Map/CRoomManager.h"
 
+// The candidates are kept by room id, so a deleted room can not leave a
+// dangling pointer behind - CRoomManager drops it through removeRoom().
 class CStacksManager
 {
   private:
-    std::vector<CRoom *> stacka;
-    std::vector<CRoom *> stackb;
+    /* up to this many candidates - the usual case - stay inline */
+    static const int SMALL_STACK = 8;
+    typedef QVarLengthArray<unsigned int, SMALL_STACK> Stack;
 
-    std::vector<CRoom *> *sa;
-    std::vector<CRoom *> *sb;
+    Stack stacka;
+    Stack stackb;
 
-    unsigned int mark[MAX_ROOMS];
-    unsigned int turn;
+    Stack *sa;
+    Stack *sb;
+
+    /* marks[id] == generation if the id is in the next stack. swap() starts
+     * a new generation, so a turn begins with no marks without touching
+     * them. Grown on demand to the ids of the map */
+    QVector<unsigned int> marks;
+    unsigned int generation;
+
+    bool marked(unsigned int id); /* true if id is in the next stack, marks it otherwise */
+    void grow(unsigned int id);
+
+    /* what this instance added to MEM_STACKS, every session has its own */
+    qint64 accountedBytes;
+    int accountedCandidates;
+    void account();
 
   public:
     unsigned int amount() { return sa->size(); }
@@ -47,15 +65,25 @@ class CStacksManager
 
     void swap();
     CStacksManager();
+    ~CStacksManager();
     void reset();
 
     CRoom *get(unsigned int i);
+    unsigned int getId(unsigned int i) { return (*sa)[i]; }
 
     CRoom *getNext(unsigned int i);
 
     void put(unsigned int id);
     void put(CRoom *r);
-    void removeRoom(unsigned int id); /* swaps */
+    void removeRoom(unsigned int id); /* from both stacks */
+
+    enum
+    {
+        CURRENT_STACK = 1,
+        NEXT_STACK = 2
+    };
+    int holds(unsigned int id);                    /* the stacks with the id, CURRENT_STACK | NEXT_STACK */
+    void restoreRoom(unsigned int id, int stacks); /* back after removeRoom(), see CMapTransaction */
 
     /* DEBUG */
     void printStacks();
@@ -63,6 +91,7 @@ class CStacksManager
     QString getCurrent() const;
 };
 
-extern class CStacksManager stacker;
+/* stacks of the session of the calling thread, see CSession */
+extern thread_local class CStacksManager *stacker;
 
 #endif
@@ -30,7 +30,9 @@
 #include <QTreeWidgetItem>
 #include <QElapsedTimer>
 
-class CGroupChar
+#include "GroupManager/CGroupCharState.h"
+
+class CGroupChar : public CGroupCharState
 {
     CGroup *parent;
 
@@ -75,16 +77,6 @@ class CGroupChar
     QString calculateTimeElapsed(QElapsedTimer &timer, int delay);
 
   public:
-    enum States
-    {
-        STANDING = 0,
-        ENGAGED,
-        BASHED,
-        SLEEPING,
-        RESTING,
-        DEAD,
-        INCAP
-    };
     CGroupChar(CGroup *parent, QTreeWidget *);
     virtual ~CGroupChar();
 
@@ -0,0 +1,40 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CGROUPCHARSTATE_H_
+#define CGROUPCHARSTATE_H_
+
+// The states of a group member. Split from CGroupChar so the dispatcher,
+// which spots them in the game text, does not need the group widgets
+struct CGroupCharState
+{
+    enum States
+    {
+        STANDING = 0,
+        ENGAGED,
+        BASHED,
+        SLEEPING,
+        RESTING,
+        DEAD,
+        INCAP
+    };
+};
+
+#endif /*CGROUPCHARSTATE_H_*/
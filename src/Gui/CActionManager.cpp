@@ -20,7 +20,11 @@
 
 #include <QActionGroup>
 #include <QFileDialog>
+#include <QFutureWatcher>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QtConcurrent>
+#include <memory>
 
 #include "defines.h"
 
@@ -40,12 +44,15 @@
 #include "Engine/CStacksManager.h"
 #include "Engine/CEngine.h"
 
+#include "Map/CMapTransaction.h"
 #include "Map/CRoomManager.h"
 
 #include "Proxy/userfunc.h"
 #include "Proxy/proxy.h"
 
 #include "Utils/MMapperImport.h"
+#include "Utils/MapDocument.h"
+#include "Utils/MapTools.h"
 
 CActionManager::CActionManager(CMainWindow *parentWindow)
 {
@@ -80,8 +87,8 @@ CActionManager::CActionManager(CMainWindow *parentWindow)
     saveAsAct->setStatusTip(tr("Save the map As"));
     connect(saveAsAct, SIGNAL(triggered()), this, SLOT(saveAs()));
 
-    publishAct = new QAction(tr("Remove Secrets"), this);
-    publishAct->setStatusTip(tr("Removes all secret exits and rooms behind them from the map"));
+    publishAct = new QAction(tr("Export Public Map..."), this);
+    publishAct->setStatusTip(tr("Saves the map without secret exits and the rooms behind them to a new file"));
     connect(publishAct, SIGNAL(triggered()), this, SLOT(publish_map()));
 
     quitAct = new QAction(tr("&Exit..."), this);
@@ -348,8 +355,9 @@ void CActionManager::bindRooms()
         return;
     }
 
-    one = Map.getRoom(Map.selections.get(0));
-    two = Map.getRoom(Map.selections.get(1));
+    CMapTransaction transaction(&Map);
+    one = transaction.edit(Map.selections.get(0));
+    two = transaction.edit(Map.selections.get(1));
 
     // roll over all dirs
     for (dir = 0; dir <= 5; dir++)
@@ -368,6 +376,7 @@ void CActionManager::bindRooms()
                 one->setExit(dir, two);
                 if (conf->getDuallinker() == true)
                     two->setExit(reversenum(dir), one);
+                transaction.commit();
                 return;
             }
         }
@@ -384,11 +393,11 @@ void CActionManager::edit_current_room()
     if (Map.selections.isEmpty() == false) {
         id = Map.selections.getFirst();
     } else {
-        if (stacker.amount() != 1) {
+        if (stacker->amount() != 1) {
             QMessageBox::critical(parent, "Room Info Edit", QString("You are not in sync!"));
             return;
         }
-        id = stacker.first()->id;
+        id = stacker->first()->id;
     }
 
     parent->editRoomDialog(id);
@@ -496,7 +505,7 @@ void CActionManager::newFile()
     }
 
     Map.reinit();    /* this one reinits Ctree structure also */
-    stacker.reset(); /* resetting stacks */
+    stacker->reset(); /* resetting stacks */
     engine->clear();
     engine->setMapping(false);
     toggle_renderer_reaction();
@@ -594,32 +603,48 @@ void CActionManager::importMMapper()
         return;
     }
 
-    // Clear current map
-    Map.reinit();
-    stacker.reset();
-    engine->clear();
-    engine->setMapping(false);
+    // Decode on a worker thread, the current map stays usable until the commit
+    QProgressDialog *progress = new QProgressDialog("Importing MMapper database...", "Abort", 0, 0, parent);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+
+    MMapperImportThread *importer = new MMapperImportThread(s, this);
+    connect(importer, &MMapperImportThread::progress, progress, [progress](int done, int total) {
+        progress->setMaximum(total);
+        progress->setValue(done);
+    });
+    connect(progress, &QProgressDialog::canceled, importer, &MMapperImportThread::cancel, Qt::DirectConnection);
+    connect(importer, &QThread::finished, this, [this, importer, progress]() {
+        progress->reset();
+        progress->deleteLater();
+        importer->deleteLater();
+        importMMapperAct->setEnabled(true);
+
+        if (!importer->succeeded()) {
+            // Aborted from the progress dialog, the current map is untouched
+            if (importer->wasCanceled())
+                QMessageBox::information(parent, "Import Aborted", "The import was aborted, the map is unchanged.");
+            else
+                QMessageBox::critical(parent, "Import Error", importer->errorString());
+            return;
+        }
 
-    // Import the file
-    if (MMapperImport::importFile(s, &Map, parent)) {
-        QMessageBox::information(parent, "Import Complete",
-                                 QString("Successfully imported %1 rooms from MMapper file.").arg(Map.size()));
+        // Replace the current map in one go
+        engine->clear();
+        engine->setMapping(false);
+        MMapperImport::commit(importer->document(), &Map);
         conf->setDatabaseModified(true);
-        if (Map.size() > 0 && renderer_window && renderer_window->renderer) {
-            CRoom *firstRoom = Map.getRoom(1);
-            if (firstRoom != nullptr) {
-                stacker.reset();
-                stacker.put(firstRoom);
-                stacker.swap();
-                renderer_window->renderer->setUserX(0, true);
-                renderer_window->renderer->setUserY(0, true);
-                engine->setMgoto(true);
-                toggle_renderer_reaction();
-            }
+        if (Map.size() > 0) {
+            engine->setMgoto(true);
+            toggle_renderer_reaction();
         }
-    } else {
-        QMessageBox::critical(parent, "Import Error", MMapperImport::lastError());
-    }
+        QMessageBox::information(parent, "Import Complete",
+                                 QString("Successfully imported %1 rooms from MMapper file.").arg(Map.size()));
+    });
+
+    importMMapperAct->setEnabled(false);
+    progress->show();
+    importer->start();
 }
 
 void CActionManager::reload()
@@ -660,11 +685,11 @@ void CActionManager::refreshRoom()
     CRoom *r;
 
     if (Map.selections.isEmpty() == true) {
-        if (stacker.amount() != 1) {
+        if (stacker->amount() != 1) {
             QMessageBox::critical(parent, "Pandora", QString("You have to be in sync or select just one room!"));
             return;
         }
-        r = stacker.first();
+        r = stacker->first();
     } else {
         if (Map.selections.size() != 1) {
             QMessageBox::critical(parent, "Pandora", QString("You have to select just one room!"));
@@ -751,8 +776,8 @@ void CActionManager::emulation_mode()
         }
         proxy->setMudEmulation(true);
         engine->setPrompt("-->");
-        stacker.put(1);
-        stacker.swap();
+        stacker->put(1);
+        stacker->swap();
     } else {
         proxy->setMudEmulation(false);
     }
@@ -760,16 +785,52 @@ void CActionManager::emulation_mode()
 
 void CActionManager::publish_map()
 {
-    if (mappingAct->isChecked()) {
-        emulationAct->setChecked(false);
-        QMessageBox::critical(parent, "Pandora", QString("You have to disconnect from the game first!"));
+    QString s = QFileDialog::getSaveFileName(parent, "Choose a filename for the public map", "database/",
+                                             "XML database files (*.xml);;Pandora binary maps (*.pmb)");
+    if (s.isEmpty())
+        return;
+
+    if (Map.getRoom(1) == nullptr) {
+        QMessageBox::critical(parent, "Pandora", QString("The map has no base room (id 1) to start from."));
         return;
     }
 
-    Map.clearAllSecrets();
+    // the only work on the live map is this copy, the rest runs on a worker thread
+    std::shared_ptr<MapDocument> doc = std::make_shared<MapDocument>();
+    std::shared_ptr<int> exported = std::make_shared<int>(0);
+    QString copyError;
+    if (!MapDocumentIO::fromRoomManager(&Map, *doc, &copyError)) {
+        QMessageBox::critical(parent, "Export Error", copyError);
+        return;
+    }
+
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, exported, s]() {
+        QString error = watcher->result();
+        watcher->deleteLater();
+        publishAct->setEnabled(true);
 
-    print_debug(DEBUG_INTERFACE | DEBUG_ROOMS, "Finished removing secrets from the map!\r\n");
-    //    QMessageBox::information(parent, "Removing secrets...", "Done!\n", QMessageBox::Ok);
+        if (!error.isEmpty()) {
+            QMessageBox::critical(parent, "Export Error", error);
+            return;
+        }
+        print_debug(DEBUG_INTERFACE | DEBUG_ROOMS, "Exported %d public rooms to %s", *exported, qPrintable(s));
+        QMessageBox::information(parent, "Pandora",
+                                 QString("Exported %1 rooms without secrets to:\n%2").arg(*exported).arg(s));
+    });
+
+    publishAct->setEnabled(false);
+    watcher->setFuture(QtConcurrent::run([doc, exported, s]() -> QString {
+        MapDocument publicMap;
+        QString error;
+
+        if (!MapTools::publicSubset(*doc, 1, publicMap))
+            return QString("The map has no base room (id 1) to start from.");
+        if (!MapDocumentIO::writeFile(s, publicMap, &error))
+            return error;
+        *exported = publicMap.rooms.size();
+        return QString();
+    }));
 }
 
 void CActionManager::gotoAction()
@@ -20,12 +20,14 @@
 
 #include <QFile>
 #include <QMessageBox>
+#include <QTextDocument>
 #include <QTextStream>
 #include <QUrl>
 
 #include "utils.h"
 #include "defines.h"
 #include "CConfigurator.h"
+#include "CMemoryStats.h"
 
 #include "Map/CRoomManager.h"
 
@@ -66,6 +68,9 @@ void CLogDialog::run()
     }
 
     textBrowser->setReadOnly(true);
+
+    QTextDocument *document = textBrowser->document();
+    MemoryStats.set(CMemoryStats::MEM_LOG, document->characterCount() * qint64(sizeof(QChar)), document->blockCount());
 }
 
 void CLogDialog::accept()
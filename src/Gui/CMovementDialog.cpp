@@ -26,6 +26,7 @@
 
 #include "Gui/CMovementDialog.h"
 
+#include "Map/CMapTransaction.h"
 #include "Map/CRoomManager.h"
 #include "Engine/CStacksManager.h"
 
@@ -63,22 +64,26 @@ void CMovementDialog::accept()
         if (Map.selections.isEmpty() == false) {
             ids = Map.selections.getList();
         } else {
-            if (stacker.amount() != 1) {
+            if (stacker->amount() != 1) {
                 QMessageBox::critical(this, "Movement Dialog", QString("You are not in sync!"));
                 done(Accepted);
                 return;
             }
-            ids.append(stacker.first()->id);
+            ids.append(stacker->first()->id);
         }
 
+        /* the rooms are placed into the squares once, at the commit */
+        CMapTransaction transaction(&Map);
         for (int i = 0; i < ids.size(); ++i) {
-            r = Map.getRoom(ids.at(i));
+            r = transaction.edit(ids.at(i));
+            if (r == nullptr)
+                continue;
             r->setX(r->getX() + x);
             r->setY(r->getY() + y);
             if (z != 0)
                 r->setZ(r->getZ() + z);
         }
-        toggle_renderer_reaction();
+        transaction.commit();
     }
 
     done(Accepted);
@@ -20,13 +20,12 @@
 
 #include <QSet>
 
+#include "defines.h"
 #include "CSelectionManager.h"
 #include "utils.h"
 
 #include "Map/CRoomManager.h"
 
-#include "Gui/mainwindow.h"
-
 #include "Proxy/proxy.h"
 
 void CSelectionManager::select(unsigned int id)
@@ -38,21 +37,21 @@ void CSelectionManager::select(unsigned int id)
     }
 
     toggle_renderer_reaction();
-    renderer_window->update_status_bar();
+    refresh_status_bar();
 }
 
 void CSelectionManager::unselect(unsigned int id)
 {
     selection.remove(id);
     toggle_renderer_reaction();
-    renderer_window->update_status_bar();
+    refresh_status_bar();
 }
 
 void CSelectionManager::resetSelection()
 {
     selection.clear();
     toggle_renderer_reaction();
-    renderer_window->update_status_bar();
+    refresh_status_bar();
 }
 
 CSelectionManager::CSelectionManager()
@@ -75,6 +74,18 @@ void CSelectionManager::exclusiveSelection(unsigned int id)
     }
 }
 
+void CSelectionManager::selectList(const QVector<unsigned int> &ids)
+{
+    selection.clear();
+    selection.reserve(ids.size());
+    for (unsigned int id : ids)
+        selection.insert(id);
+    print_debug(DEBUG_INTERFACE, "selecting %i rooms", static_cast<int>(ids.size()));
+
+    toggle_renderer_reaction();
+    refresh_status_bar();
+}
+
 // ########################### CMouseState ########################
 
 CMouseState::CMouseState()
@@ -23,6 +23,7 @@
 
 #include <QObject>
 #include <QSet>
+#include <QVector>
 #include <QPoint>
 
 class CSelectionManager : public QObject
@@ -45,6 +46,8 @@ class CSelectionManager : public QObject
 
     int size() { return selection.size(); }
     void exclusiveSelection(unsigned int id);
+    // replaces the selection with the given rooms, refreshing the views once
+    void selectList(const QVector<unsigned int> &ids);
 
     QList<int> getList() { return selection.values(); }
     bool isEmpty() { return selection.empty(); }
@@ -23,8 +23,11 @@
 #include "Gui/finddialog.h"
 #include "Gui/mainwindow.h"
 
+#include "Map/CRoomIndex.h"
 #include "Map/CRoomManager.h"
 
+#include "Engine/CStacksManager.h"
+
 #include "Renderer/renderer.h"
 
 FindDialog::FindDialog(QWidget *parent) : QDialog(parent)
@@ -62,6 +65,40 @@ void FindDialog::findClicked()
         results = Map.searchNotes(text, cs);
     else if (exitsRadioButton->isChecked())
         results = Map.searchExits(text, cs);
+    else if (flagsRadioButton->isChecked()) {
+        CRoomBitmap found;
+        QString error;
+
+        if (!FlagIndex.query(text.toUtf8(), found, &error)) {
+            roomsFoundLabel->setText(error);
+            return;
+        }
+        for (unsigned int id : found.toList())
+            results.append(id);
+    }
+
+    if (nearestCheckBox->isChecked()) {
+        if (stacker->amount() != 1) {
+            roomsFoundLabel->setText(tr("Current position is unknown"));
+            return;
+        }
+
+        QVector<unsigned int> targets;
+        for (int id : results)
+            targets.append(id);
+        paths.refresh(&Map);
+        paths.nearest(stacker->first()->id, targets, targets.size(), CMapPath::AVOID_ALL, hits);
+
+        for (const CMapPath::Hit &hit : hits) {
+            item = new QTreeWidgetItem(resultTable);
+            item->setText(0, QString::number(hit.id));
+            item->setText(1, QString(Map.getName(hit.id)));
+            item->setText(2, QString::number(hit.moves));
+        }
+
+        roomsFoundLabel->setText(tr("%1 room(s) found, %2 reachable").arg(results.size()).arg(hits.size()));
+        return;
+    }
 
     for (int i = 0; i < results.size(); i++) {
         QString id = QString(tr("%1").arg(results.at(i)));
@@ -95,8 +132,8 @@ void FindDialog::enableFindButton(const QString &text)
 
 void FindDialog::adjustResultTable()
 {
-    resultTable->setColumnCount(2);
-    resultTable->setHeaderLabels(QStringList() << tr("Room ID") << tr("Room Name"));
+    resultTable->setColumnCount(3);
+    resultTable->setHeaderLabels(QStringList() << tr("Room ID") << tr("Room Name") << tr("Moves"));
     //    resultTable->header()->setResizeMode(0, QHeaderView::Stretch);
     //    resultTable->header()->setResizeMode(QHeaderView::Stretch);
     resultTable->setRootIsDecorated(false);
@@ -23,6 +23,8 @@
 #include <QDialog>
 #include "ui_finddialog.h"
 
+#include "Map/CMapPath.h"
+
 class FindDialog : public QDialog, public Ui::FindDialog
 {
     Q_OBJECT
@@ -31,6 +33,9 @@ class FindDialog : public QDialog, public Ui::FindDialog
     FindDialog(QWidget *parent = 0);
 
   private:
+    CMapPath paths;               /* for nearest first, kept while the map does not change */
+    QVector<CMapPath::Hit> hits;
+
     void adjustResultTable();
 
   private slots:
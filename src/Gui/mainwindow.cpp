@@ -25,6 +25,7 @@
 #include <QtWidgets>
 
 #include "utils.h"
+#include "CProgress.h"
 
 #include "Gui/mainwindow.h"
 #include "Gui/CActionManager.h"
@@ -59,6 +60,10 @@ QSize DockWidget::sizeHint() const
 
 void toggle_renderer_reaction()
 {
+    // headless runs (tests, benchmarks, tools) have neither window nor proxy
+    if (renderer_window == nullptr || proxy == nullptr)
+        return;
+
     if (renderer_window->renderer->redraw == false) {
         renderer_window->renderer->redraw = true;
         proxy->startRendererCall();
@@ -67,7 +72,72 @@ void toggle_renderer_reaction()
 
 void notify_analyzer()
 {
-    proxy->startEngineCall();
+    if (proxy)
+        proxy->startEngineCall();
+}
+
+void refresh_status_bar()
+{
+    if (renderer_window)
+        renderer_window->update_status_bar();
+}
+
+void notify_room_deleted(unsigned int id)
+{
+    if (renderer_window)
+        renderer_window->renderer->deletedRoom = id;
+}
+
+void recenter_renderer()
+{
+    if (renderer_window == nullptr || renderer_window->renderer == nullptr)
+        return;
+
+    renderer_window->renderer->setUserX(0, true);
+    renderer_window->renderer->setUserY(0, true);
+}
+
+QRect main_window_rect()
+{
+    return renderer_window ? renderer_window->geometry() : conf->getWindowRect();
+}
+
+QRect group_manager_rect()
+{
+    return renderer_window ? renderer_window->getGroupManagerRect() : conf->getGroupManagerRect();
+}
+
+void show_warning(const QString &title, const QString &text)
+{
+    if (renderer_window)
+        QMessageBox::warning(renderer_window, title, text);
+}
+
+namespace
+{
+class CProgressDialog : public CProgress
+{
+  public:
+    CProgressDialog(const QString &label, const QString &cancelText, int maximum, Qt::WindowModality modality)
+        : dialog(label, cancelText, 0, maximum, renderer_window)
+    {
+        dialog.setWindowModality(modality);
+        dialog.show();
+    }
+
+    void setLabelText(const QString &text) override { dialog.setLabelText(text); }
+    void setMaximum(int maximum) override { dialog.setMaximum(maximum); }
+    void setValue(int value) override { dialog.setValue(value); }
+    bool wasCanceled() const override { return dialog.wasCanceled(); }
+
+  private:
+    QProgressDialog dialog;
+};
+}  // namespace
+
+CProgress *create_progress(const QString &label, const QString &cancelText, int maximum, Qt::WindowModality modality)
+{
+    return new CProgressDialog(label, cancelText, maximum, modality);
 }
 
 /*  globals end */
@@ -82,7 +152,7 @@ CMainWindow::CMainWindow(QWidget *parent) : QMainWindow(parent)
     findDialog = nullptr;
     groupDialog = nullptr;
 
-    userland_parser = new Userland();
+    /* userland_parser comes with the session, see CSession */
     actionManager = new CActionManager(this);
 
     print_debug(DEBUG_INTERFACE, "in mainwindow constructor");
@@ -267,7 +337,7 @@ void CMainWindow::moveRoomDialog()
     print_debug(DEBUG_INTERFACE, "move room dialog action called");
 
     // check if there is an objective for this operation
-    if (Map.selections.size() == 0 && stacker.amount() != 1) {
+    if (Map.selections.size() == 0 && stacker->amount() != 1) {
         QMessageBox::critical(this, "Movement Dialog", QString("You have to either get in sync or select some rooms!"));
         return;
     }
@@ -344,7 +414,7 @@ void CMainWindow::update_status_bar()
 
     emit newModLabel(modLabel + firstPart);
 
-    emit newLocationLabel(stacker.getCurrent());
+    emit newLocationLabel(stacker->getCurrent());
     print_debug(DEBUG_INTERFACE, "Done updating interface!\r\n");
 }
 
@@ -0,0 +1,71 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstring>
+
+#include <QHash>
+
+#include "Map/CDescSketch.h"
+
+void CDescSketch::clear()
+{
+    memset(counts, 0, sizeof(counts));
+    size = 0;
+    textKey = qHash(QByteArray());
+}
+
+void CDescSketch::set(const QByteArray &text)
+{
+    clear();
+    size = text.length();
+    textKey = qHash(text);
+
+    const char *p = text.constData();
+    for (int i = 0; i < size; i++) {
+        quint16 &count = counts[static_cast<unsigned char>(p[i]) % BUCKETS];
+        if (count != 0xffff)
+            count++;
+    }
+}
+
+int CDescSketch::minDistance(const CDescSketch &other) const
+{
+    int more = 0, less = 0;
+
+    /* a substitution fixes one surplus and one shortage at once, */
+    /* an insertion or a deletion only one of them                */
+    for (int i = 0; i < BUCKETS; i++) {
+        int d = int(counts[i]) - int(other.counts[i]);
+        if (d > 0)
+            more += d;
+        else
+            less -= d;
+    }
+    return qMax(more, less);
+}
+
+bool CDescSketch::cannotMatch(const CDescSketch &pattern, const CDescSketch &text, int quote)
+{
+    /* the same limit as compare_with_quote() */
+    int allowed_errors = (int)((double)quote / 100.0 * (double)pattern.size);
+
+    return pattern.minDistance(text) > allowed_errors;
+}
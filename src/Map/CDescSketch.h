@@ -0,0 +1,68 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CDESCSKETCH_H
+#define CDESCSKETCH_H
+
+#include <QByteArray>
+
+// Character histogram of a description, folded into BUCKETS counters.
+// Every edit step changes the histogram by at most one count up and one
+// count down, so the histograms of two texts give a lower bound of their
+// Levenshtein distance. Folding only merges counts and keeps the bound.
+// Unlike SimHash or MinHash the bound never rejects a real match, so
+// candidates can be dropped before the full comparison runs.
+//
+// key() is a hash of the whole text, for checks that want the exact text
+// (the prespam prediction of CCommandQueue).
+
+class CDescSketch
+{
+  public:
+    enum
+    {
+        BUCKETS = 32
+    };
+
+    CDescSketch() { clear(); }
+    explicit CDescSketch(const QByteArray &text) { set(text); }
+
+    void set(const QByteArray &text);
+    void clear();
+
+    int length() const { return size; }
+    size_t key() const { return textKey; }
+    bool isEmpty() const { return size == 0; }
+
+    // never more than the Levenshtein distance of the two texts
+    int minDistance(const CDescSketch &other) const;
+
+    // true if Strings_Comparator::compare_with_quote(pattern, text, quote)
+    // surely returns -1, without looking at the texts
+    static bool cannotMatch(const CDescSketch &pattern, const CDescSketch &text, int quote);
+
+  private:
+    quint16 counts[BUCKETS]; /* saturated, a clipped count only lowers the bound */
+    int size;
+    size_t textKey;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QSet>
+
+#include "defines.h"
+#include "parallel.h"
+#include "utils.h"
+
+#include "Map/CMapChecker.h"
+#include "Map/CRoom.h"
+#include "Map/CRegion.h"
+#include "Map/CRoomManager.h"
+
+typedef QVector<CMapViolation> Violations;
+
+/* per room checks, only reads the rooms. Exit pointers are never */
+/* dereferenced before they are found in the live set             */
+static Violations checkRooms(CRoomManager *roomManager, const QVector<CRoom *> &rooms,
+                             const QSet<const CRoom *> &live, int from, int to)
+{
+    Violations result;
+
+    for (int i = from; i < to; i++) {
+        CRoom *room = rooms[i];
+
+        if (roomManager->getRoom(room->id) != room)
+            result.append({CMapChecker::ID_MISMATCH, room, nullptr, -1, room->id});
+        if (room->getRegion() == nullptr)
+            result.append({CMapChecker::BAD_REGION, room, nullptr, -1, 0});
+
+        for (int dir = 0; dir <= 5; dir++) {
+            CRoom *target = room->exits[dir];
+
+            if (target == nullptr) {
+                if (!room->isExitPresent(dir) && !room->getDoor(dir).isEmpty())
+                    result.append({CMapChecker::DOOR_WITHOUT_EXIT, room, nullptr, dir, 0});
+                continue;
+            }
+
+            if (!live.contains(target)) {
+                result.append({CMapChecker::DANGLING_EXIT, room, nullptr, dir, 0});
+                continue;
+            }
+
+            if (room->isExitUndefined(dir) || room->isExitDeath(dir))
+                result.append({CMapChecker::EXIT_FLAG_MISMATCH, room, nullptr, dir, target->id});
+
+            int back = reversenum(dir);
+            if (target->exits[back] == nullptr && target->isExitUndefined(back))
+                result.append({CMapChecker::MISSING_BACKLINK, room, nullptr, dir, target->id});
+        }
+    }
+    return result;
+}
+
+QVector<CMapViolation> CMapChecker::check(CRoomManager *roomManager)
+{
+    CEpochGuard guard(roomManager->epoch);
+    std::shared_ptr<const CMapSnapshot> snap = roomManager->snapshot();
+    const QVector<CRoom *> &rooms = snap->rooms;
+    QSet<const CRoom *> live;
+    Violations violations;
+
+    live.reserve(rooms.size());
+    for (CRoom *room : rooms)
+        live.insert(room);
+
+    QVector<Violations> parts =
+        runChunked<Violations>(rooms.size(), [roomManager, &rooms, &live](int from, int to) {
+            return checkRooms(roomManager, rooms, live, from, to);
+        });
+    for (const Violations &part : parts)
+        violations += part;
+
+    /* a handful of regions, no need for threads */
+    QList<CRegion *> regions = roomManager->getAllRegions();
+    for (CRegion *region : regions) {
+        int space = region->getLocalSpaceId();
+        if (space > 0 && roomManager->getLocalSpace(space) == nullptr)
+            violations.append({BAD_LOCALSPACE, nullptr, region, -1, static_cast<unsigned int>(space)});
+    }
+
+    return violations;
+}
+
+int CMapChecker::fix(CRoomManager *roomManager, const QVector<CMapViolation> &violations)
+{
+    CRegion *defaultRegion = roomManager->getRegionByName("default");
+    int fixed = 0;
+
+    for (const CMapViolation &v : violations) {
+        CRoom *room = v.room;
+
+        if (!isFixable(v.kind))
+            continue;
+
+        switch (v.kind) {
+        case DANGLING_EXIT:
+        case DOOR_WITHOUT_EXIT:
+            room->setExitUndefined(v.dir);
+            break;
+        case EXIT_FLAG_MISMATCH:
+            /* the link itself is valid, trust it over the flag */
+            room->setExit(v.dir, room->exits[v.dir]);
+            break;
+        case MISSING_BACKLINK: {
+            CRoom *target = roomManager->getRoom(v.other);
+            int back = reversenum(v.dir);
+            /* an earlier fix may have linked it already */
+            if (target == nullptr || target->exits[back] != nullptr || !target->isExitUndefined(back))
+                continue;
+            target->setExit(back, room);
+            target->setModified(true);
+            break;
+        }
+        case BAD_REGION:
+            if (defaultRegion == nullptr)
+                continue;
+            room->setRegion(defaultRegion);
+            break;
+        case BAD_LOCALSPACE:
+            v.region->setLocalSpaceId(0);
+            fixed++;
+            continue;
+        default:
+            continue;
+        }
+
+        room->setModified(true);
+        fixed++;
+    }
+
+    if (fixed > 0)
+        roomManager->updateLocalSpaceBounds();
+
+    return fixed;
+}
+
+const char *CMapChecker::kindName(int kind)
+{
+    static const char *names[] = {"dangling exits",   "exit/flag mismatches", "doors without exits",
+                                  "missing backlinks", "id mismatches",        "rooms without region",
+                                  "unknown local spaces"};
+    if (kind < 0 || kind >= KIND_COUNT)
+        return "unknown";
+    return names[kind];
+}
+
+bool CMapChecker::isFixable(int kind)
+{
+    return kind != ID_MISMATCH && kind >= 0 && kind < KIND_COUNT;
+}
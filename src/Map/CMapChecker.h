@@ -0,0 +1,69 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CMAPCHECKER_H
+#define CMAPCHECKER_H
+
+#include <QVector>
+
+class CRoom;
+class CRegion;
+class CRoomManager;
+
+struct CMapViolation
+{
+    int kind;
+    CRoom *room;        /* nullptr for region wide problems */
+    CRegion *region;    /* set for BAD_LOCALSPACE only */
+    int dir;            /* -1 if not exit related */
+    unsigned int other; /* the other room involved, if any */
+};
+
+// Integrity checks of the live map. The check reads the published room
+// list inside the map epoch and is split over room ranges on the thread
+// pool; fixing runs on the calling thread afterwards. Keep the map
+// blocked in between.
+
+class CMapChecker
+{
+  public:
+    enum Kinds
+    {
+        DANGLING_EXIT = 0,  /* exit pointer to a room that is not in the map */
+        EXIT_FLAG_MISMATCH, /* exit pointer set while the flags say undefined/death */
+        DOOR_WITHOUT_EXIT,  /* door in a direction without any exit */
+        MISSING_BACKLINK,   /* A leads to B, B's way back is an unlinked undefined exit */
+        ID_MISMATCH,        /* room not registered under its own id */
+        BAD_REGION,         /* room without region */
+        BAD_LOCALSPACE,     /* region assigned to a local space that does not exist */
+        KIND_COUNT
+    };
+
+    static QVector<CMapViolation> check(CRoomManager *roomManager);
+
+    // Applies the safe fix of every violation that has one, returns the amount fixed
+    static int fix(CRoomManager *roomManager, const QVector<CMapViolation> &violations);
+
+    static const char *kindName(int kind);
+    static bool isFixable(int kind); /* false if fix() leaves this kind alone */
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "Map/CMapEpoch.h"
+
+/* slot value of a reader that has claimed its slot but not yet read the */
+/* epoch. It is lower than any real epoch and so holds back every free   */
+static const quint64 EPOCH_CLAIMING = 1;
+static const quint64 EPOCH_FIRST = 2;
+
+CMapEpoch::CMapEpoch() : epoch(EPOCH_FIRST)
+{
+    for (int i = 0; i < MAX_READERS; i++)
+        readers[i].storeRelaxed(0);
+}
+
+CMapEpoch::~CMapEpoch()
+{
+    for (const Retired &r : retired)
+        r.free();
+}
+
+int CMapEpoch::enter()
+{
+    int slot = -1;
+
+    while (slot == -1) {
+        for (int i = 0; i < MAX_READERS; i++)
+            if (readers[i].testAndSetOrdered(0, EPOCH_CLAIMING)) {
+                slot = i;
+                break;
+            }
+        if (slot == -1)
+            QThread::yieldCurrentThread(); /* more readers than slots, wait for one to leave */
+    }
+
+    /* announce the epoch and make sure no retire() slipped in between */
+    for (;;) {
+        quint64 e = epoch.loadAcquire();
+        readers[slot].fetchAndStoreOrdered(e);
+        if (epoch.loadAcquire() == e)
+            break;
+    }
+    return slot;
+}
+
+void CMapEpoch::leave(int slot)
+{
+    readers[slot].storeRelease(0);
+}
+
+void CMapEpoch::retire(std::function<void()> free)
+{
+    QMutexLocker locker(&lock);
+
+    /* the object was unlinked before this point, readers entering after */
+    /* the increment can not reach it any more                           */
+    quint64 e = epoch.fetchAndAddOrdered(1);
+    retired.append({e, std::move(free)});
+}
+
+int CMapEpoch::collect()
+{
+    QVector<Retired> ready;
+
+    /* read before the scan: a reader entering after the scan announces at  */
+    /* least this epoch, but may still reach objects retired from now on    */
+    quint64 limit = epoch.loadAcquire();
+    for (int i = 0; i < MAX_READERS; i++) {
+        quint64 e = readers[i].loadAcquire();
+        if (e != 0 && e < limit)
+            limit = e;
+    }
+
+    {
+        QMutexLocker locker(&lock);
+        int kept = 0;
+        for (int i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch < limit)
+                ready.append(retired[i]);
+            else
+                retired[kept++] = retired[i];
+        }
+        retired.resize(kept);
+    }
+
+    /* run the deleters outside of the lock, they may retire again */
+    for (const Retired &r : ready)
+        r.free();
+
+    return ready.size();
+}
+
+int CMapEpoch::pending()
+{
+    QMutexLocker locker(&lock);
+    return retired.size();
+}
+
+int CMapEpoch::activeReaders() const
+{
+    int amount = 0;
+    for (int i = 0; i < MAX_READERS; i++)
+        if (readers[i].loadAcquire() != 0)
+            amount++;
+    return amount;
+}
@@ -0,0 +1,94 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CMAPEPOCH_H
+#define CMAPEPOCH_H
+
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QVector>
+#include <functional>
+
+// Epoch based reclamation for map objects.
+//
+// Readers wrap their work in enter()/leave() (or a CEpochGuard). Writers
+// first unlink an object (ids[], rooms, published snapshot) and then
+// retire() it instead of deleting it. collect() frees the retired objects
+// once every reader that might still hold a pointer has left.
+//
+// Entering and leaving is lock free; retire() and collect() take a mutex
+// and are meant for the writer side.
+
+class CMapEpoch
+{
+  public:
+    enum
+    {
+        MAX_READERS = 64
+    };
+
+    CMapEpoch();
+    ~CMapEpoch(); /* frees everything still retired */
+
+    int enter();          /* returns the reader slot for leave() */
+    void leave(int slot);
+
+    template <typename T>
+    void retire(T *object)
+    {
+        retire([object]() { delete object; });
+    }
+    void retire(std::function<void()> free);
+
+    int collect(); /* returns the amount of freed objects */
+
+    int pending();
+    int activeReaders() const;
+    quint64 current() const { return epoch.loadAcquire(); }
+
+  private:
+    struct Retired
+    {
+        quint64 epoch;
+        std::function<void()> free;
+    };
+
+    QAtomicInteger<quint64> epoch;
+    QAtomicInteger<quint64> readers[MAX_READERS]; /* 0 - free slot, otherwise the epoch seen by the reader */
+
+    QMutex lock;
+    QVector<Retired> retired;
+};
+
+class CEpochGuard
+{
+    CMapEpoch &epoch;
+    int slot;
+
+  public:
+    explicit CEpochGuard(CMapEpoch &e) : epoch(e), slot(e.enter()) {}
+    ~CEpochGuard() { epoch.leave(slot); }
+
+    CEpochGuard(const CEpochGuard &) = delete;
+    CEpochGuard &operator=(const CEpochGuard &) = delete;
+};
+
+#endif
@@ -0,0 +1,329 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QBitArray>
+#include <QHash>
+#include <algorithm>
+
+#include "Map/CMapGraph.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+
+typedef QVector<QVector<unsigned int>> IdGroups;
+
+static void sortGroups(IdGroups &groups)
+{
+    for (QVector<unsigned int> &group : groups)
+        std::sort(group.begin(), group.end());
+    std::stable_sort(groups.begin(), groups.end(), [](const QVector<unsigned int> &a, const QVector<unsigned int> &b) {
+        if (a.size() != b.size())
+            return a.size() > b.size();
+        return a.first() < b.first();
+    });
+}
+
+CMapGraph::CMapGraph(const QVector<unsigned int> &roomIds, const QVector<QPair<unsigned int, unsigned int>> &links)
+{
+    unsigned int maxId = 0;
+    for (unsigned int id : roomIds)
+        maxId = qMax(maxId, id);
+
+    indexes.fill(-1, roomIds.isEmpty() ? 0 : maxId + 1);
+    for (unsigned int id : roomIds) {
+        if (indexes[id] != -1)
+            continue;
+        indexes[id] = ids.size();
+        ids.append(id);
+    }
+
+    QVector<QPair<int, int>> indexLinks;
+    indexLinks.reserve(links.size());
+    for (const QPair<unsigned int, unsigned int> &link : links)
+        if (contains(link.first) && contains(link.second))
+            indexLinks.append(qMakePair(indexes[link.first], indexes[link.second]));
+    build(indexLinks);
+}
+
+CMapGraph CMapGraph::fromRoomManager(CRoomManager *roomManager)
+{
+    CMapGraph graph;
+    CEpochGuard guard(roomManager->epoch);
+    std::shared_ptr<const CMapSnapshot> snap = roomManager->snapshot();
+    const QVector<CRoom *> &rooms = snap->rooms;
+
+    /* exit pointers are only looked up here, never dereferenced, */
+    /* so exits into deleted rooms cannot do any harm             */
+    QHash<const CRoom *, int> byPointer;
+    byPointer.reserve(rooms.size());
+
+    unsigned int maxId = 0;
+    for (const CRoom *room : rooms)
+        maxId = qMax(maxId, room->id);
+    graph.indexes.fill(-1, rooms.isEmpty() ? 0 : maxId + 1);
+
+    for (const CRoom *room : rooms) {
+        if (graph.indexes[room->id] != -1)
+            continue;
+        graph.indexes[room->id] = graph.ids.size();
+        byPointer.insert(room, graph.ids.size());
+        graph.ids.append(room->id);
+    }
+
+    QVector<QPair<int, int>> links;
+    links.reserve(rooms.size() * 3);
+    for (const CRoom *room : rooms) {
+        int from = byPointer.value(room, -1);
+        if (from == -1)
+            continue;
+        for (int dir = 0; dir <= 5; dir++) {
+            int to = room->exits[dir] ? byPointer.value(room->exits[dir], -1) : -1;
+            if (to != -1)
+                links.append(qMakePair(from, to));
+        }
+    }
+    graph.build(links);
+    return graph;
+}
+
+void CMapGraph::build(const QVector<QPair<int, int>> &links)
+{
+    int n = ids.size();
+
+    /* counting sort of the links into both CSR arrays */
+    outStart.fill(0, n + 1);
+    undStart.fill(0, n + 1);
+    for (const QPair<int, int> &link : links) {
+        outStart[link.first + 1]++;
+        if (link.first == link.second)
+            continue;
+        undStart[link.first + 1]++;
+        undStart[link.second + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+        outStart[i + 1] += outStart[i];
+        undStart[i + 1] += undStart[i];
+    }
+
+    outTo.resize(outStart[n]);
+    undTo.resize(undStart[n]);
+    QVector<int> outPos(outStart.constBegin(), outStart.constEnd() - 1);
+    QVector<int> undPos(undStart.constBegin(), undStart.constEnd() - 1);
+    for (const QPair<int, int> &link : links) {
+        outTo[outPos[link.first]++] = link.second;
+        if (link.first == link.second)
+            continue;
+        undTo[undPos[link.first]++] = link.second;
+        undTo[undPos[link.second]++] = link.first;
+    }
+}
+
+QVector<unsigned int> CMapGraph::toIds(const QVector<int> &list) const
+{
+    QVector<unsigned int> result;
+    result.reserve(list.size());
+    for (int i : list)
+        result.append(ids[i]);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+QVector<QVector<unsigned int>> CMapGraph::components() const
+{
+    int n = ids.size();
+    IdGroups groups;
+    QBitArray seen(n);
+    QVector<int> queue;
+    queue.reserve(n);
+
+    for (int start = 0; start < n; start++) {
+        if (seen.testBit(start))
+            continue;
+
+        queue.clear();
+        queue.append(start);
+        seen.setBit(start);
+        for (int head = 0; head < queue.size(); head++) {
+            int v = queue[head];
+            for (int e = undStart[v]; e < undStart[v + 1]; e++) {
+                int w = undTo[e];
+                if (!seen.testBit(w)) {
+                    seen.setBit(w);
+                    queue.append(w);
+                }
+            }
+        }
+        groups.append(toIds(queue));
+    }
+    sortGroups(groups);
+    return groups;
+}
+
+QVector<QVector<unsigned int>> CMapGraph::strongComponents() const
+{
+    int n = ids.size();
+    IdGroups groups;
+    QVector<int> order(n, -1); /* discovery order, -1 if not visited yet */
+    QVector<int> low(n, 0);
+    QVector<int> pos(n, 0); /* next link to look at */
+    QBitArray onStack(n);
+    QVector<int> stack;    /* Tarjan's stack of open rooms */
+    QVector<int> callStack; /* the DFS itself, kept iterative for deep maps */
+    int counter = 0;
+
+    for (int start = 0; start < n; start++) {
+        if (order[start] != -1)
+            continue;
+
+        callStack.append(start);
+        while (!callStack.isEmpty()) {
+            int v = callStack.last();
+
+            if (order[v] == -1) {
+                order[v] = low[v] = counter++;
+                pos[v] = outStart[v];
+                stack.append(v);
+                onStack.setBit(v);
+            }
+
+            if (pos[v] < outStart[v + 1]) {
+                int w = outTo[pos[v]++];
+                if (order[w] == -1)
+                    callStack.append(w);
+                else if (onStack.testBit(w))
+                    low[v] = qMin(low[v], order[w]);
+                continue;
+            }
+
+            callStack.removeLast();
+            if (!callStack.isEmpty()) {
+                int parent = callStack.last();
+                low[parent] = qMin(low[parent], low[v]);
+            }
+
+            if (low[v] == order[v]) {
+                QVector<int> group;
+                int w;
+                do {
+                    w = stack.takeLast();
+                    onStack.clearBit(w);
+                    group.append(w);
+                } while (w != v);
+                groups.append(toIds(group));
+            }
+        }
+    }
+    sortGroups(groups);
+    return groups;
+}
+
+QVector<unsigned int> CMapGraph::unreachableFrom(unsigned int root) const
+{
+    int n = ids.size();
+    QVector<int> result;
+
+    if (!contains(root)) {
+        result.reserve(n);
+        for (int i = 0; i < n; i++)
+            result.append(i);
+        return toIds(result);
+    }
+
+    QBitArray seen(n);
+    QVector<int> queue;
+    queue.reserve(n);
+    queue.append(indexes[root]);
+    seen.setBit(indexes[root]);
+    for (int head = 0; head < queue.size(); head++) {
+        int v = queue[head];
+        for (int e = outStart[v]; e < outStart[v + 1]; e++) {
+            int w = outTo[e];
+            if (!seen.testBit(w)) {
+                seen.setBit(w);
+                queue.append(w);
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+        if (!seen.testBit(i))
+            result.append(i);
+    return toIds(result);
+}
+
+QVector<unsigned int> CMapGraph::articulationPoints() const
+{
+    int n = ids.size();
+    QVector<int> order(n, -1);
+    QVector<int> low(n, 0);
+    QVector<int> parent(n, -1);
+    QVector<int> pos(n, 0);
+    QBitArray cut(n);
+    QVector<int> callStack;
+    int counter = 0;
+
+    for (int start = 0; start < n; start++) {
+        if (order[start] != -1)
+            continue;
+
+        int rootChildren = 0;
+        order[start] = low[start] = counter++;
+        pos[start] = undStart[start];
+        callStack.append(start);
+
+        while (!callStack.isEmpty()) {
+            int v = callStack.last();
+
+            if (pos[v] < undStart[v + 1]) {
+                int w = undTo[pos[v]++];
+                if (order[w] == -1) {
+                    parent[w] = v;
+                    order[w] = low[w] = counter++;
+                    pos[w] = undStart[w];
+                    callStack.append(w);
+                    if (v == start)
+                        rootChildren++;
+                } else if (w != parent[v]) {
+                    /* parallel links to the parent (both ways of a two-way exit) */
+                    /* do not matter here, only rooms are cut, not links         */
+                    low[v] = qMin(low[v], order[w]);
+                }
+                continue;
+            }
+
+            callStack.removeLast();
+            int p = parent[v];
+            if (p == -1)
+                continue;
+            low[p] = qMin(low[p], low[v]);
+            if (p != start && low[v] >= order[p])
+                cut.setBit(p);
+        }
+
+        if (rootChildren > 1)
+            cut.setBit(start);
+    }
+
+    QVector<int> result;
+    for (int i = 0; i < n; i++)
+        if (cut.testBit(i))
+            result.append(i);
+    return toIds(result);
+}
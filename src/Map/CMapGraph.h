@@ -0,0 +1,76 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CMAPGRAPH_H
+#define CMAPGRAPH_H
+
+#include <QPair>
+#include <QVector>
+
+class CRoomManager;
+
+// Read-only copy of the exit graph in compact arrays (rooms are dense
+// indexes, links are kept in CSR form), so the analyses below never chase
+// CRoom pointers. Build it once, then run as many queries as needed - the
+// graph does not follow later changes of the map.
+
+class CMapGraph
+{
+    QVector<unsigned int> ids; /* index -> room id */
+    QVector<int> indexes;      /* room id -> index, -1 if there is no such room */
+
+    /* directed links: targets of room i are outTo[outStart[i] .. outStart[i + 1]) */
+    QVector<int> outStart;
+    QVector<int> outTo;
+    /* the same links without direction, for components and cut rooms */
+    QVector<int> undStart;
+    QVector<int> undTo;
+
+    void build(const QVector<QPair<int, int>> &links);
+    QVector<unsigned int> toIds(const QVector<int> &list) const;
+
+  public:
+    CMapGraph() {}
+    // ids of all rooms and the links between them (from, to) by room id;
+    // links to ids not in the list are dropped
+    CMapGraph(const QVector<unsigned int> &roomIds, const QVector<QPair<unsigned int, unsigned int>> &links);
+
+    // Takes the published room list inside the map epoch, exits into rooms
+    // that are no longer in the map are skipped
+    static CMapGraph fromRoomManager(CRoomManager *roomManager);
+
+    int size() const { return ids.size(); }
+    int linkCount() const { return outTo.size(); }
+    bool contains(unsigned int id) const { return id < (unsigned int)indexes.size() && indexes[id] != -1; }
+
+    // Rooms connected when exits are walked both ways. Largest first,
+    // ids sorted within each component
+    QVector<QVector<unsigned int>> components() const;
+    // Rooms that can all reach each other following exit directions
+    // (Tarjan). Largest first, ids sorted
+    QVector<QVector<unsigned int>> strongComponents() const;
+    // Rooms that cannot be reached from root following exit directions
+    QVector<unsigned int> unreachableFrom(unsigned int root) const;
+    // Rooms whose removal disconnects their component (exits taken both ways)
+    QVector<unsigned int> articulationPoints() const;
+};
+
+#endif
@@ -0,0 +1,398 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+#include "defines.h"
+#include "parallel.h"
+
+#include "Map/CMapLayout.h"
+#include "Map/CMapTransaction.h"
+#include "Map/CRegion.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+
+typedef QHash<quint64, QVector<int>> LayoutGrid;
+
+static const double PULL = 0.2;                          /* share of an exit pull applied per step */
+static const int SEARCH_RADIUS = 4 * CMapLayout::SPACING; /* how far a room may be snapped away */
+
+static quint64 cellKey(int space, int z, int cx, int cy)
+{
+    /* wrapped values only give extra candidates, they are checked exactly */
+    return (quint64(quint16(space)) << 48) | (quint64(quint16(z)) << 32) | (quint64(quint16(cx)) << 16) |
+           quint64(quint16(cy));
+}
+
+static int cellOf(double v)
+{
+    return static_cast<int>(std::floor(v / CMapLayout::SPACING));
+}
+
+/* step of an exit direction on the plane, up and down have none */
+static bool dirStep(int dir, int &dx, int &dy)
+{
+    dx = dy = 0;
+    switch (dir) {
+    case NORTH:
+        dy = 1;
+        break;
+    case SOUTH:
+        dy = -1;
+        break;
+    case EAST:
+        dx = 1;
+        break;
+    case WEST:
+        dx = -1;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/* (ox, oy) is the offset of the exit target from its source */
+static bool wrongWay(int dx, int dy, double ox, double oy)
+{
+    return (dx > 0 && ox <= 0) || (dx < 0 && ox >= 0) || (dy > 0 && oy <= 0) || (dy < 0 && oy >= 0);
+}
+
+void CMapLayout::addRoom(unsigned int id, int x, int y, int z, int space, bool movable)
+{
+    if (byId.contains(id))
+        return;
+    byId.insert(id, nodes.size());
+    nodes.append(Node{id, x, y, z, space, movable});
+}
+
+void CMapLayout::addLink(unsigned int from, unsigned int to, int dir)
+{
+    links.append(Link{from, to, dir});
+}
+
+CMapLayout CMapLayout::fromRoomManager(CRoomManager *roomManager, const QVector<unsigned int> &movable)
+{
+    CMapLayout layout;
+    QSet<unsigned int> movableIds(movable.begin(), movable.end());
+    CEpochGuard guard(roomManager->epoch);
+    std::shared_ptr<const CMapSnapshot> snap = roomManager->snapshot();
+
+    /* exit pointers are only looked up, never dereferenced */
+    QHash<const CRoom *, unsigned int> byPointer;
+    byPointer.reserve(snap->rooms.size());
+
+    for (CRoom *room : snap->rooms) {
+        CRegion *region = room->getRegion();
+        layout.addRoom(room->id, room->getX(), room->getY(), room->getZ(), region ? region->getLocalSpaceId() : 0,
+                       movableIds.contains(room->id));
+        byPointer.insert(room, room->id);
+    }
+
+    for (const CRoom *room : snap->rooms)
+        for (int dir = 0; dir <= 5; dir++) {
+            if (room->exits[dir] == nullptr)
+                continue;
+            unsigned int to = byPointer.value(room->exits[dir], 0);
+            if (to != 0 && (movableIds.contains(room->id) || movableIds.contains(to)))
+                layout.addLink(room->id, to, dir);
+        }
+
+    return layout;
+}
+
+QVector<unsigned int> CMapLayout::overlapping() const
+{
+    LayoutGrid grid;
+    QVector<unsigned int> result;
+
+    for (int i = 0; i < nodes.size(); i++)
+        grid[cellKey(nodes[i].space, nodes[i].z, cellOf(nodes[i].x), cellOf(nodes[i].y))].append(i);
+
+    for (int i = 0; i < nodes.size(); i++) {
+        const Node &node = nodes[i];
+        int cx = cellOf(node.x), cy = cellOf(node.y);
+        bool hit = false;
+
+        for (int gx = cx - 1; gx <= cx + 1 && !hit; gx++)
+            for (int gy = cy - 1; gy <= cy + 1 && !hit; gy++) {
+                LayoutGrid::const_iterator cell = grid.constFind(cellKey(node.space, node.z, gx, gy));
+                if (cell == grid.constEnd())
+                    continue;
+                for (int j : *cell)
+                    if (j != i && samePlane(i, j) && std::abs(node.x - nodes[j].x) < SPACING &&
+                        std::abs(node.y - nodes[j].y) < SPACING) {
+                        hit = true;
+                        break;
+                    }
+            }
+        if (hit)
+            result.append(node.id);
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+int CMapLayout::badLinks() const
+{
+    int bad = 0;
+    int dx, dy;
+
+    for (const Link &link : links) {
+        int a = byId.value(link.from, -1);
+        int b = byId.value(link.to, -1);
+        if (a == -1 || b == -1 || !dirStep(link.dir, dx, dy) || !samePlane(a, b))
+            continue;
+        if (wrongWay(dx, dy, nodes[b].x - nodes[a].x, nodes[b].y - nodes[a].y))
+            bad++;
+    }
+    return bad;
+}
+
+QVector<CMapLayout::Move> CMapLayout::solve(int iterations)
+{
+    struct Pull
+    {
+        int other;
+        int dx, dy; /* the room wants to be at other + (dx, dy) */
+    };
+    struct Step
+    {
+        double x, y;
+        bool awake;
+    };
+
+    const int n = nodes.size();
+    QVector<Move> moves;
+
+    /* only the planes with movable rooms take part */
+    QSet<quint64> planes;
+    for (const Node &node : nodes)
+        if (node.movable)
+            planes.insert(cellKey(node.space, node.z, 0, 0));
+
+    QVector<int> active, movable;
+    for (int i = 0; i < n; i++)
+        if (planes.contains(cellKey(nodes[i].space, nodes[i].z, 0, 0))) {
+            active.append(i);
+            if (nodes[i].movable)
+                movable.append(i);
+        }
+
+    /* rooms start to move once they are pushed, the rest stays where it is */
+    QVector<char> awake(n, 0);
+    bool anyAwake = false;
+    for (unsigned int id : overlapping()) {
+        int i = byId.value(id);
+        if (nodes[i].movable)
+            awake[i] = anyAwake = true;
+    }
+    if (!anyAwake)
+        return moves;
+
+    QVector<QVector<Pull>> pulls(n);
+    for (const Link &link : links) {
+        int a = byId.value(link.from, -1);
+        int b = byId.value(link.to, -1);
+        int dx, dy;
+        if (a == -1 || b == -1 || a == b || !dirStep(link.dir, dx, dy) || !samePlane(a, b))
+            continue;
+        if (nodes[a].movable)
+            pulls[a].append(Pull{b, -dx * SPACING, -dy * SPACING});
+        if (nodes[b].movable)
+            pulls[b].append(Pull{a, dx * SPACING, dy * SPACING});
+    }
+
+    QVector<double> px(n), py(n);
+    for (int i = 0; i < n; i++) {
+        px[i] = nodes[i].x;
+        py[i] = nodes[i].y;
+    }
+
+    /* Jacobi steps - every room reads the positions of the last step only, */
+    /* so the chunks run in parallel and the result does not depend on them  */
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        LayoutGrid grid;
+        for (int i : active)
+            grid[cellKey(nodes[i].space, nodes[i].z, cellOf(px[i]), cellOf(py[i]))].append(i);
+
+        QVector<QVector<Step>> chunks = runChunked<QVector<Step>>(movable.size(), [&](int from, int to) {
+            QVector<Step> result;
+            result.reserve(to - from);
+            for (int m = from; m < to; m++) {
+                int i = movable[m];
+                int cx = cellOf(px[i]), cy = cellOf(py[i]);
+                double fx = 0, fy = 0;
+
+                for (int gx = cx - 1; gx <= cx + 1; gx++)
+                    for (int gy = cy - 1; gy <= cy + 1; gy++) {
+                        LayoutGrid::const_iterator cell =
+                            grid.constFind(cellKey(nodes[i].space, nodes[i].z, gx, gy));
+                        if (cell == grid.constEnd())
+                            continue;
+                        for (int j : *cell) {
+                            if (j == i || !samePlane(i, j))
+                                continue;
+                            double dx = px[i] - px[j], dy = py[i] - py[j];
+                            double ox = SPACING - std::fabs(dx), oy = SPACING - std::fabs(dy);
+                            if (ox <= 0 || oy <= 0)
+                                continue;
+
+                            /* fixed rooms do not give way; rooms on one spot part by id */
+                            double share = nodes[j].movable ? 0.5 : 1.0;
+                            double sx = dx != 0 ? (dx > 0 ? 1 : -1) : (nodes[i].id < nodes[j].id ? -1 : 1);
+                            double sy = dy != 0 ? (dy > 0 ? 1 : -1) : (nodes[i].id < nodes[j].id ? -1 : 1);
+                            if (ox < oy)
+                                fx += sx * ox * share;
+                            else
+                                fy += sy * oy * share;
+                        }
+                    }
+
+                bool isAwake = awake[i] || fx != 0 || fy != 0;
+                if (isAwake)
+                    for (const Pull &pull : pulls[i]) {
+                        fx += (px[pull.other] + pull.dx - px[i]) * PULL;
+                        fy += (py[pull.other] + pull.dy - py[i]) * PULL;
+                    }
+                result.append(Step{px[i] + fx, py[i] + fy, isAwake});
+            }
+            return result;
+        });
+
+        double shift = 0;
+        int m = 0;
+        for (const QVector<Step> &chunk : chunks)
+            for (const Step &step : chunk) {
+                int i = movable[m++];
+                shift = qMax(shift, qMax(std::fabs(step.x - px[i]), std::fabs(step.y - py[i])));
+                px[i] = step.x;
+                py[i] = step.y;
+                awake[i] = step.awake;
+            }
+        if (shift < 0.01)
+            break;
+    }
+
+    /* snap to whole coordinates - in id order every moved room takes the free */
+    /* spot nearby with the fewest exits pointing the wrong way               */
+    QVector<int> fx(n), fy(n);
+    QVector<int> order;
+    LayoutGrid taken;
+    for (int i = 0; i < n; i++) {
+        fx[i] = nodes[i].x;
+        fy[i] = nodes[i].y;
+    }
+    for (int i : active) {
+        if (awake[i]) {
+            fx[i] = static_cast<int>(std::lround(px[i]));
+            fy[i] = static_cast<int>(std::lround(py[i]));
+            order.append(i);
+        } else {
+            taken[cellKey(nodes[i].space, nodes[i].z, cellOf(fx[i]), cellOf(fy[i]))].append(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) { return nodes[a].id < nodes[b].id; });
+
+    auto isFree = [&](int i, int x, int y) {
+        for (int gx = cellOf(x) - 1; gx <= cellOf(x) + 1; gx++)
+            for (int gy = cellOf(y) - 1; gy <= cellOf(y) + 1; gy++) {
+                LayoutGrid::const_iterator cell = taken.constFind(cellKey(nodes[i].space, nodes[i].z, gx, gy));
+                if (cell == taken.constEnd())
+                    continue;
+                for (int j : *cell)
+                    if (samePlane(i, j) && std::abs(x - fx[j]) < SPACING && std::abs(y - fy[j]) < SPACING)
+                        return false;
+            }
+        return true;
+    };
+    auto wrongLinks = [&](int i, int x, int y) {
+        int bad = 0;
+        for (const Pull &pull : pulls[i])
+            if (wrongWay(pull.dx, pull.dy, x - fx[pull.other], y - fy[pull.other]))
+                bad++;
+        return bad;
+    };
+
+    for (int i : order) {
+        int bestX = nodes[i].x, bestY = nodes[i].y;
+        int bestBad = 0, bestDistance = 0;
+        bool found = false;
+
+        for (int dx = -SEARCH_RADIUS; dx <= SEARCH_RADIUS; dx++)
+            for (int dy = -SEARCH_RADIUS; dy <= SEARCH_RADIUS; dy++) {
+                int x = fx[i] + dx, y = fy[i] + dy;
+                if (!isFree(i, x, y))
+                    continue;
+                int bad = wrongLinks(i, x, y);
+                int distance = dx * dx + dy * dy;
+                if (!found || bad < bestBad || (bad == bestBad && distance < bestDistance)) {
+                    bestX = x;
+                    bestY = y;
+                    bestBad = bad;
+                    bestDistance = distance;
+                    found = true;
+                }
+            }
+
+        fx[i] = bestX;
+        fy[i] = bestY;
+        taken[cellKey(nodes[i].space, nodes[i].z, cellOf(bestX), cellOf(bestY))].append(i);
+    }
+
+    for (int i : order) {
+        if (fx[i] == nodes[i].x && fy[i] == nodes[i].y)
+            continue;
+        moves.append(Move{nodes[i].id, nodes[i].x, nodes[i].y, fx[i], fy[i]});
+        nodes[i].x = fx[i];
+        nodes[i].y = fy[i];
+    }
+    return moves;
+}
+
+void CMapLayout::apply(CRoomManager *roomManager, const QVector<Move> &moves)
+{
+    CMapTransaction transaction(roomManager);
+    for (const Move &move : moves) {
+        CRoom *room = transaction.edit(move.id);
+        if (room == nullptr)
+            continue;
+        room->setX(move.toX);
+        room->setY(move.toY);
+    }
+    transaction.commit();
+}
+
+void CMapLayout::revert(CRoomManager *roomManager, const QVector<Move> &moves)
+{
+    CMapTransaction transaction(roomManager);
+    for (const Move &move : moves) {
+        CRoom *room = transaction.edit(move.id);
+        if (room == nullptr)
+            continue;
+        room->setX(move.fromX);
+        room->setY(move.fromY);
+    }
+    transaction.commit();
+}
@@ -0,0 +1,98 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CMAPLAYOUT_H
+#define CMAPLAYOUT_H
+
+#include <QHash>
+#include <QVector>
+
+class CRoomManager;
+
+// Removes overlapping rooms. Like CMapGraph it works on a copy of the
+// coordinates, so the solver runs on worker threads and never touches the
+// map. The result is a list of moves; apply() performs them as one
+// CMapTransaction and revert() takes them back.
+//
+// A room is a SPACING x SPACING square on its plane (local space and z).
+// Two rooms overlap when they are closer than SPACING on both axes. Rooms
+// overlapping others push each other apart, and fixed rooms do not give
+// way. Exits pull their rooms to SPACING in the exit direction, so north
+// stays north. Rooms that are never pushed keep their place.
+
+class CMapLayout
+{
+  public:
+    enum
+    {
+        SPACING = 2,
+        DEFAULT_ITERATIONS = 100
+    };
+
+    struct Move
+    {
+        unsigned int id;
+        int fromX, fromY;
+        int toX, toY;
+    };
+
+    CMapLayout() {}
+
+    void addRoom(unsigned int id, int x, int y, int z, int space, bool movable);
+    // an exit from one room into another, rooms that are not added are ignored
+    void addLink(unsigned int from, unsigned int to, int dir);
+
+    // All rooms of the published list, the given ones movable
+    static CMapLayout fromRoomManager(CRoomManager *roomManager, const QVector<unsigned int> &movable);
+
+    int size() const { return nodes.size(); }
+    QVector<unsigned int> overlapping() const; /* sorted ids */
+    int badLinks() const;                      /* north/east/south/west exits pointing the wrong way */
+
+    // Relaxes the movable rooms, snaps them to whole coordinates and
+    // returns the moves. The copy keeps the new coordinates
+    QVector<Move> solve(int iterations = DEFAULT_ITERATIONS);
+
+    static void apply(CRoomManager *roomManager, const QVector<Move> &moves);
+    static void revert(CRoomManager *roomManager, const QVector<Move> &moves);
+
+  private:
+    struct Node
+    {
+        unsigned int id;
+        int x, y, z;
+        int space;
+        bool movable;
+    };
+    struct Link
+    {
+        unsigned int from, to;
+        int dir;
+    };
+
+    QVector<Node> nodes;
+    QVector<Link> links;
+    QHash<unsigned int, int> byId;
+
+    bool samePlane(int a, int b) const { return nodes[a].space == nodes[b].space && nodes[a].z == nodes[b].z; }
+};
+
+#endif
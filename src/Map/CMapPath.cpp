@@ -0,0 +1,314 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+
+#include "Map/CMapPath.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+
+void CMapPath::addRoom(unsigned int id, int x, int y, int z, int cost, bool deathtrap)
+{
+    if (byId.contains(id))
+        return;
+    byId.insert(id, nodes.size());
+    nodes.append(Node{id, x, y, z, qMax(1, cost), deathtrap});
+}
+
+void CMapPath::addLink(unsigned int from, unsigned int to, int dir, const QByteArray &door, bool secret)
+{
+    int a = byId.value(from, -1);
+    int b = byId.value(to, -1);
+    if (a == -1 || b == -1)
+        return;
+
+    int doorIndex = -1;
+    if (!door.isEmpty()) {
+        doorIndex = doorIndexes.value(door, -1);
+        if (doorIndex == -1) {
+            doorIndex = doorNames.size();
+            doorIndexes.insert(door, doorIndex);
+            doorNames.append(door);
+        }
+    }
+    pending.append(Link{a, b, dir, doorIndex, secret});
+}
+
+void CMapPath::build()
+{
+    int n = nodes.size();
+
+    /* counting sort of the links by their source room */
+    linkStart.fill(0, n + 1);
+    for (const Link &link : pending)
+        linkStart[link.from + 1]++;
+    for (int i = 0; i < n; i++)
+        linkStart[i + 1] += linkStart[i];
+
+    linkTo.resize(pending.size());
+    linkDir.resize(pending.size());
+    linkDoor.resize(pending.size());
+    linkSecret.resize(pending.size());
+
+    QVector<int> fill = linkStart;
+    scale = -1;
+    for (const Link &link : pending) {
+        int at = fill[link.from]++;
+        linkTo[at] = link.to;
+        linkDir[at] = link.dir;
+        linkDoor[at] = link.door;
+        linkSecret[at] = link.secret;
+
+        /* the heuristic must never promise more than a link costs */
+        int length = distance(link.from, link.to);
+        if (length > 0) {
+            double perUnit = double(nodes[link.to].cost) / length;
+            if (scale < 0 || perUnit < scale)
+                scale = perUnit;
+        }
+    }
+    if (scale < 0)
+        scale = 0;
+    pending.clear();
+}
+
+CMapPath CMapPath::fromRoomManager(CRoomManager *roomManager)
+{
+    CMapPath path;
+    CEpochGuard guard(roomManager->epoch);
+    std::shared_ptr<const CMapSnapshot> snap = roomManager->snapshot();
+
+    /* exit pointers are only looked up, never dereferenced */
+    QHash<const CRoom *, unsigned int> byPointer;
+    byPointer.reserve(snap->rooms.size());
+
+    for (CRoom *room : snap->rooms) {
+        unsigned int sector = (unsigned char)room->getTerrain();
+        int cost = sector < conf->sectors.size() ? conf->sectors[sector].moveCost : 1;
+        path.addRoom(room->id, room->getX(), room->getY(), room->getZ(), cost,
+                     room->getLoadFlags() & MM_LOAD_DEATHTRAP);
+        byPointer.insert(room, room->id);
+    }
+
+    for (CRoom *room : snap->rooms)
+        for (int dir = 0; dir <= 5; dir++) {
+            if (room->exits[dir] == nullptr)
+                continue;
+            unsigned int to = byPointer.value(room->exits[dir], 0);
+            if (to == 0)
+                continue;
+
+            int signature = room->getExitSignature(dir);
+            QByteArray door;
+            if (signature == CRoom::SIGNATURE_DOOR || signature == CRoom::SIGNATURE_SECRET) {
+                door = room->getDoor(dir);
+                if (door.isEmpty())
+                    door = "exit"; /* door known from MMapper flags only */
+            }
+            path.addLink(room->id, to, dir, door, signature == CRoom::SIGNATURE_SECRET);
+        }
+
+    path.build();
+    return path;
+}
+
+bool CMapPath::refresh(CRoomManager *roomManager)
+{
+    if (copied && copiedVersion == roomManager->getVersion() && copiedRevision == roomManager->getGraphRevision())
+        return false;
+
+    /* read the counters first, changes made while copying trigger the next refresh */
+    quint64 version = roomManager->getVersion();
+    quint64 revision = roomManager->getGraphRevision();
+    *this = fromRoomManager(roomManager);
+    copied = true;
+    copiedVersion = version;
+    copiedRevision = revision;
+    return true;
+}
+
+int CMapPath::distance(int a, int b) const
+{
+    const Node &p = nodes[a];
+    const Node &q = nodes[b];
+    return qAbs(p.x - q.x) + qAbs(p.y - q.y) + qAbs(p.z - q.z);
+}
+
+bool CMapPath::allowed(int link, int options) const
+{
+    if (linkSecret[link] && !(options & USE_SECRET))
+        return false;
+    return !nodes[linkTo[link]].deathtrap || (options & USE_DEATHTRAPS);
+}
+
+void CMapPath::startQuery() const
+{
+    if (stamp.size() != nodes.size()) {
+        stamp.fill(0, nodes.size());
+        targetStamp.fill(0, nodes.size());
+        spent.resize(nodes.size());
+        via.resize(nodes.size());
+        prev.resize(nodes.size());
+        generation = 0;
+    }
+    /* on wrap around old stamps could look valid again */
+    if (++generation == 0) {
+        stamp.fill(0);
+        targetStamp.fill(0);
+        generation = 1;
+    }
+    heap.clear();
+    queue.clear();
+}
+
+QVector<CMapPath::Step> CMapPath::find(unsigned int from, unsigned int to, int options, int *cost) const
+{
+    typedef QPair<double, int> Entry; /* estimated total, node */
+
+    QVector<Step> route;
+    int start = byId.value(from, -1);
+    int goal = byId.value(to, -1);
+    if (cost)
+        *cost = 0;
+    if (start == -1 || goal == -1 || start == goal || linkStart.size() != nodes.size() + 1)
+        return route;
+    if (nodes[goal].deathtrap && !(options & USE_DEATHTRAPS))
+        return route;
+
+    startQuery();
+    stamp[start] = generation;
+    spent[start] = 0;
+    heap.append(Entry(scale * distance(start, goal), start));
+    while (!heap.isEmpty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.takeLast();
+        int node = top.second;
+        if (node == goal)
+            break;
+        /* stale entry, the node was reached cheaper meanwhile */
+        if (top.first > spent[node] + scale * distance(node, goal))
+            continue;
+
+        for (int l = linkStart[node]; l < linkStart[node + 1]; l++) {
+            if (!allowed(l, options))
+                continue;
+            int next = linkTo[l];
+            int total = spent[node] + nodes[next].cost;
+            if (stamp[next] == generation && total >= spent[next])
+                continue;
+            stamp[next] = generation;
+            spent[next] = total;
+            via[next] = l;
+            prev[next] = node;
+            heap.append(Entry(total + scale * distance(next, goal), next));
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        }
+    }
+
+    if (stamp[goal] != generation)
+        return route;
+    if (cost)
+        *cost = spent[goal];
+
+    /* walk the links back from the goal */
+    for (int node = goal; node != start; node = prev[node]) {
+        int l = via[node];
+        route.append(Step{nodes[node].id, linkDir[l], linkDoor[l] == -1 ? QByteArray() : doorNames[linkDoor[l]],
+                          linkSecret[l]});
+    }
+    std::reverse(route.begin(), route.end());
+    return route;
+}
+
+void CMapPath::nearest(unsigned int from, const QVector<unsigned int> &targets, int k, int options,
+                       QVector<Hit> &result) const
+{
+    result.clear();
+    int start = byId.value(from, -1);
+    if (start == -1 || k <= 0 || linkStart.size() != nodes.size() + 1)
+        return;
+
+    startQuery();
+    int left = 0;
+    for (unsigned int id : targets) {
+        int index = byId.value(id, -1);
+        if (index != -1 && targetStamp[index] != generation) {
+            targetStamp[index] = generation;
+            left++;
+        }
+    }
+
+    /* level by level, so hits of one distance can be ordered by id */
+    stamp[start] = generation;
+    spent[start] = 0;
+    queue.append(start);
+    for (int head = 0; head < queue.size() && left > 0 && result.size() < k;) {
+        int level = spent[queue[head]];
+        int levelStart = result.size();
+        for (; head < queue.size() && spent[queue[head]] == level; head++) {
+            int node = queue[head];
+            if (targetStamp[node] == generation) {
+                result.append(Hit{nodes[node].id, level});
+                left--;
+            }
+            for (int l = linkStart[node]; l < linkStart[node + 1]; l++) {
+                int next = linkTo[l];
+                if (stamp[next] == generation || !allowed(l, options))
+                    continue;
+                stamp[next] = generation;
+                spent[next] = level + 1;
+                queue.append(next);
+            }
+        }
+        std::sort(result.begin() + levelStart, result.end(),
+                  [](const Hit &a, const Hit &b) { return a.id < b.id; });
+    }
+    if (result.size() > k)
+        result.resize(k);
+}
+
+QByteArray CMapPath::speedwalk(const QVector<Step> &route)
+{
+    QList<QByteArray> parts;
+
+    for (int i = 0; i < route.size();) {
+        const Step &step = route[i];
+        if (!step.door.isEmpty()) {
+            parts << "open " + step.door + " " + dirbynum(step.dir);
+            parts << QByteArray(1, dirbynum(step.dir));
+            i++;
+            continue;
+        }
+
+        int run = 1;
+        while (i + run < route.size() && route[i + run].dir == step.dir && route[i + run].door.isEmpty())
+            run++;
+        QByteArray part = QByteArray(1, dirbynum(step.dir));
+        parts << (run > 1 ? QByteArray::number(run) + part : part);
+        i += run;
+    }
+    return parts.join(", ");
+}
@@ -0,0 +1,150 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CMAPPATH_H
+#define CMAPPATH_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+class CRoomManager;
+
+// Route finder for speedwalks. Like CMapGraph it keeps its own copy of the
+// exits in CSR form (with direction, door and terrain cost per link), so a
+// query over the whole map is a plain A* over arrays and the copy can be
+// kept between queries until the map changes (see refresh()).
+//
+// Queries reuse scratch arrays of the instance, tagged with a generation
+// instead of cleared, so repeated queries do not allocate. An instance is
+// meant for one thread.
+//
+// Entering a room costs the move cost of its terrain. The heuristic is the
+// coordinate distance to the target, scaled down so that no link of the
+// copy walks further than it costs - routes stay the cheapest ones even on
+// maps with odd coordinates, only the search gets wider there.
+
+class CMapPath
+{
+  public:
+    enum Options
+    {
+        AVOID_ALL = 0,
+        USE_SECRET = 1 << 0,    /* walk through secret doors */
+        USE_DEATHTRAPS = 1 << 1 /* enter deathtrap rooms */
+    };
+
+    struct Step
+    {
+        unsigned int id; /* room entered by this step */
+        int dir;
+        QByteArray door; /* door to open first, empty if there is none */
+        bool secret;
+    };
+
+    struct Hit
+    {
+        unsigned int id;
+        int moves;
+    };
+
+    CMapPath() {}
+
+    void addRoom(unsigned int id, int x, int y, int z, int cost, bool deathtrap);
+    // a link from one room into another, rooms that are not added are ignored
+    void addLink(unsigned int from, unsigned int to, int dir, const QByteArray &door = QByteArray(),
+                 bool secret = false);
+    // packs the added links, must be called before find()
+    void build();
+
+    // All rooms of the published list with their terrain costs from conf->sectors
+    static CMapPath fromRoomManager(CRoomManager *roomManager);
+    // Takes a new copy if the map changed since the last refresh (room list
+    // version or graph revision), returns true if it did
+    bool refresh(CRoomManager *roomManager);
+
+    int size() const { return nodes.size(); }
+    int linkCount() const { return linkTo.size(); }
+    bool contains(unsigned int id) const { return byId.contains(id); }
+
+    // Cheapest route from one room to the other, empty if there is none
+    // (or from == to). The total cost is stored in *cost if given
+    QVector<Step> find(unsigned int from, unsigned int to, int options = AVOID_ALL, int *cost = nullptr) const;
+
+    // Compact speedwalk: runs of one direction are counted ("3n, 2e") and
+    // doors get an "open <door> <dir>" before the move
+    static QByteArray speedwalk(const QVector<Step> &route);
+
+    // Up to k targets closest to from by the amount of moves, nearest first
+    // (ties by id). One breadth first search that stops at the k-th target
+    void nearest(unsigned int from, const QVector<unsigned int> &targets, int k, int options, QVector<Hit> &result) const;
+
+  private:
+    struct Node
+    {
+        unsigned int id;
+        int x, y, z;
+        int cost;
+        bool deathtrap;
+    };
+    struct Link
+    {
+        int from, to;
+        int dir;
+        int door; /* index into doorNames, -1 if none */
+        bool secret;
+    };
+
+    QVector<Node> nodes;
+    QHash<unsigned int, int> byId;
+    QVector<Link> pending;
+    QVector<QByteArray> doorNames;
+    QHash<QByteArray, int> doorIndexes;
+
+    /* links of node i are linkTo[linkStart[i] .. linkStart[i + 1]) and so on */
+    QVector<int> linkStart;
+    QVector<int> linkTo;
+    QVector<qint8> linkDir;
+    QVector<int> linkDoor;
+    QVector<bool> linkSecret;
+    double scale = 0; /* heuristic cost per coordinate unit */
+
+    bool copied = false; /* refresh() state */
+    quint64 copiedVersion = 0;
+    quint64 copiedRevision = 0;
+
+    /* per query scratch, a slot is valid while its stamp equals generation */
+    mutable QVector<quint32> stamp;
+    mutable QVector<int> spent;
+    mutable QVector<int> via;  /* link the node was reached by */
+    mutable QVector<int> prev; /* and the room it came from */
+    mutable QVector<quint32> targetStamp;
+    mutable QVector<int> queue;
+    mutable QVector<QPair<double, int>> heap;
+    mutable quint32 generation = 0;
+
+    int distance(int a, int b) const;
+    bool allowed(int link, int options) const;
+    void startQuery() const;
+};
+
+#endif
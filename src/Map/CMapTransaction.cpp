@@ -0,0 +1,308 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+
+#include "Map/CMapTransaction.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+#include "Map/CTree.h"
+
+#include "Engine/CSession.h"
+#include "Engine/CStacksManager.h"
+
+CMapTransaction::CMapTransaction(CRoomManager *_map)
+    : map(_map), outer(_map->transaction), open(true), modified(false), wasBlocked(false)
+{
+    if (outer == nullptr) {
+        wasBlocked = map->isBlocked();
+        map->setBlocked(true);
+        map->transaction = this;
+    }
+}
+
+CMapTransaction::~CMapTransaction()
+{
+    if (open)
+        rollback();
+}
+
+bool CMapTransaction::onMap(CRoom *room)
+{
+    return room != nullptr && map->getRoom(room->id) == room;
+}
+
+int CMapTransaction::savedRooms() const
+{
+    return outer ? outer->savedRooms() : saved.size();
+}
+
+CRoom *CMapTransaction::edit(unsigned int id)
+{
+    return edit(map->getRoom(id));
+}
+
+CRoom *CMapTransaction::edit(CRoom *room)
+{
+    if (room == nullptr || !open)
+        return room;
+    if (outer)
+        return outer->edit(room);
+    if (saved.contains(room))
+        return room;
+
+    SavedRoom s;
+    room->ensureResident();
+    s.name = room->name;
+    s.desc = room->desc;
+    s.note = room->note;
+    s.noteColor = room->noteColor;
+    s.contents = room->contents;
+    s.sector = room->sector;
+    s.region = room->region;
+    s.x = room->x;
+    s.y = room->y;
+    s.z = room->z;
+    for (int i = 0; i <= 5; i++) {
+        s.exits[i] = room->exits[i];
+        s.exitFlags[i] = room->exitFlags[i];
+        s.doors[i] = room->doors[i];
+        s.mmExitFlags[i] = room->mmExitFlags[i];
+        s.mmDoorFlags[i] = room->mmDoorFlags[i];
+    }
+    s.lightType = room->lightType;
+    s.alignType = room->alignType;
+    s.portableType = room->portableType;
+    s.ridableType = room->ridableType;
+    s.sundeathType = room->sundeathType;
+    s.mobFlags = room->mobFlags;
+    s.loadFlags = room->loadFlags;
+    s.flags = room->flags;
+
+    saved.insert(room, s);
+    return room;
+}
+
+/* the room is out of the indexes already, fields are written directly */
+void CMapTransaction::restore(CRoom *room, const SavedRoom &s)
+{
+    room->ensureResident();
+    room->name = s.name;
+    room->desc = s.desc;
+    room->descSketch.set(s.desc);
+    room->note = s.note;
+    room->noteColor = s.noteColor;
+    room->contents = s.contents;
+    room->sector = s.sector;
+    if (room->region != s.region) {
+        bool listed = room->listed;
+        room->unlistFromRegion();
+        room->region = s.region;
+        if (listed)
+            room->listInRegion();
+    }
+    room->x = s.x;
+    room->y = s.y;
+    room->z = s.z;
+    for (int i = 0; i <= 5; i++) {
+        room->exits[i] = s.exits[i];
+        room->exitFlags[i] = s.exitFlags[i];
+        room->doors[i] = s.doors[i];
+        room->mmExitFlags[i] = s.mmExitFlags[i];
+        room->mmDoorFlags[i] = s.mmDoorFlags[i];
+    }
+    room->updateExitSignature();
+    room->lightType = s.lightType;
+    room->alignType = s.alignType;
+    room->portableType = s.portableType;
+    room->ridableType = s.ridableType;
+    room->sundeathType = s.sundeathType;
+    room->mobFlags = s.mobFlags;
+    room->loadFlags = s.loadFlags;
+    room->flags = s.flags;
+    room->accountText();
+}
+
+bool CMapTransaction::deferName(CRoom *room)
+{
+    if (!onMap(room))
+        return false;
+    if (!names.contains(room)) {
+        room->unindexName(true);
+        names.insert(room);
+    }
+    return true;
+}
+
+bool CMapTransaction::deferFlags(CRoom *room)
+{
+    if (!onMap(room))
+        return false;
+    if (!flags.contains(room)) {
+        room->unindexFlags(true);
+        flags.insert(room);
+    }
+    return true;
+}
+
+bool CMapTransaction::deferPlacement(CRoom *room)
+{
+    if (!onMap(room))
+        return false;
+    if (!placement.contains(room)) {
+        map->removeFromPlane(room);
+        placement.insert(room);
+    }
+    return true;
+}
+
+void CMapTransaction::deferDeletion(CRoom *room)
+{
+    deleted.append(room);
+}
+
+void CMapTransaction::saveMembership(CRoom *room)
+{
+    Membership m;
+    m.id = room->id;
+    m.selected = map->selections.isSelected(room->id);
+
+    /* headless tools work with the globals alone, see CSession::forgetRoom() */
+    QList<CStacksManager *> all;
+    if (CSession::all().isEmpty())
+        all.append(stacker);
+    for (CSession *session : CSession::all())
+        all.append(session->getStacks());
+    for (CStacksManager *stacks : all) {
+        int held = stacks->holds(room->id);
+        if (held)
+            m.stacks.append(qMakePair(stacks, held));
+    }
+
+    if (m.selected || !m.stacks.isEmpty())
+        memberships.append(m);
+}
+
+void CMapTransaction::commit()
+{
+    if (!open)
+        return;
+    if (outer) {
+        open = false;
+        return;
+    }
+    finish();
+}
+
+void CMapTransaction::rollback()
+{
+    if (!open)
+        return;
+    if (outer) {
+        open = false;
+        outer->rollback();
+        return;
+    }
+
+    print_debug(DEBUG_ROOMS, "map transaction: rolling back %i rooms", static_cast<int>(saved.size()));
+
+    /* deleted rooms return first, the restored exits may lead to them */
+    for (int i = deleted.size() - 1; i >= 0; i--) {
+        CRoom *room = deleted[i];
+        map->rooms.append(room);
+        map->ids[room->id] = room;
+        room->listInRegion();
+        names.insert(room);
+        flags.insert(room);
+        placement.insert(room);
+    }
+    if (!deleted.isEmpty())
+        map->touch();
+    deleted.clear();
+
+    for (int i = memberships.size() - 1; i >= 0; i--) {
+        const Membership &m = memberships[i];
+        if (map->getRoom(m.id) == nullptr)
+            continue;
+        for (const auto &held : m.stacks)
+            held.first->restoreRoom(m.id, held.second);
+        if (m.selected)
+            map->selections.select(m.id);
+    }
+    memberships.clear();
+
+    for (auto it = saved.constBegin(); it != saved.constEnd(); ++it) {
+        if (!onMap(it.key()))
+            continue;
+        deferName(it.key());
+        deferFlags(it.key());
+        deferPlacement(it.key());
+        restore(it.key(), it.value());
+    }
+
+    finish();
+}
+
+void CMapTransaction::finish()
+{
+    bool changed = modified || !names.isEmpty() || !flags.isEmpty() || !placement.isEmpty() || !deleted.isEmpty();
+
+    /* from here on the setters work directly again */
+    map->transaction = nullptr;
+    open = false;
+
+    for (CRoom *room : names)
+        if (onMap(room)) {
+            NameMap.addName(room->name, room->id);
+            room->nameIndexed = true;
+        }
+    for (CRoom *room : flags)
+        if (onMap(room))
+            room->indexFlags();
+    for (CRoom *room : placement)
+        if (onMap(room))
+            map->addToPlane(room);
+
+    if (!deleted.isEmpty()) {
+        /* readers may still hold them - unpublish first, free after they leave */
+        map->touch(true);
+        for (CRoom *room : deleted)
+            map->epoch.retire(room);
+        map->epoch.collect();
+        map->fixFreeRooms();
+    }
+
+    if (modified)
+        conf->setDatabaseModified(true);
+    map->setBlocked(wasBlocked);
+
+    saved.clear();
+    names.clear();
+    flags.clear();
+    placement.clear();
+    deleted.clear();
+    memberships.clear();
+
+    if (changed)
+        toggle_renderer_reaction();
+}
@@ -0,0 +1,122 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CMAPTRANSACTION_H
+#define CMAPTRANSACTION_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QVector>
+#include <cstdint>
+
+class CRoom;
+class CRegion;
+class CRoomManager;
+class CStacksManager;
+
+// Scope for bulk map edits.
+//
+// While a transaction is open the map is blocked and the room setters
+// leave the expensive follow-ups to it: a renamed room drops out of
+// NameMap, a room with changed flags drops out of FlagIndex and a moved
+// room drops out of its plane, all once, on the first change. Deleted
+// rooms are unlinked but not freed. commit() indexes and places every
+// touched room once, publishes one snapshot and asks for one redraw.
+//
+// Rooms passed through edit() are saved first, rollback() (or leaving
+// the scope without commit()) restores them and brings deleted rooms
+// back. Rooms created inside the transaction are kept. A deleted room
+// also returns to the candidate stacks of every session and to the
+// selection it was dropped from.
+//
+// A transaction opened while another one is open joins the outer one.
+// Like every map change it has to run on the thread that owns the map.
+
+class CMapTransaction
+{
+  public:
+    explicit CMapTransaction(CRoomManager *map);
+    ~CMapTransaction(); /* rolls back unless committed */
+
+    /* save the room before changing it, returns the room (nullptr for an unknown id) */
+    CRoom *edit(unsigned int id);
+    CRoom *edit(CRoom *room);
+
+    void commit();
+    void rollback();
+
+    bool isOpen() const { return open; }
+    int savedRooms() const;
+
+    /* hooks of the CRoom setters and CRoomManager, false if the room is not */
+    /* on the map and the caller has to do the update itself                 */
+    bool deferName(CRoom *room);
+    bool deferFlags(CRoom *room);
+    bool deferPlacement(CRoom *room);
+    void deferDeletion(CRoom *room);
+    void saveMembership(CRoom *room); /* stacks and selection, before the room is dropped from them */
+    void markModified() { modified = true; }
+
+  private:
+    struct SavedRoom
+    {
+        QByteArray name, desc, note, noteColor, contents;
+        char sector;
+        CRegion *region;
+        int x, y, z;
+        CRoom *exits[6];
+        unsigned char exitFlags[6];
+        QByteArray doors[6];
+        uint16_t mmExitFlags[6];
+        uint16_t mmDoorFlags[6];
+        uint8_t lightType, alignType, portableType, ridableType, sundeathType;
+        uint32_t mobFlags, loadFlags;
+        unsigned int flags;
+    };
+
+    CRoomManager *map;
+    CMapTransaction *outer; /* set if this one joined an open transaction */
+    bool open;
+    bool modified;
+    bool wasBlocked;
+
+    QHash<CRoom *, SavedRoom> saved;
+    QSet<CRoom *> names;
+    QSet<CRoom *> flags;
+    QSet<CRoom *> placement;
+    QVector<CRoom *> deleted;
+
+    struct Membership
+    {
+        unsigned int id;
+        bool selected;
+        QVector<QPair<CStacksManager *, int>> stacks; /* see CStacksManager::holds() */
+    };
+    QVector<Membership> memberships;
+
+    bool onMap(CRoom *room);
+    void restore(CRoom *room, const SavedRoom &s);
+    void finish();
+};
+
+#endif
@@ -32,6 +32,7 @@
 #include "utils.h"
 
 #include "Map/CRegion.h"
+#include "Map/CRoom.h"
 #include "Map/CRoomManager.h"
 
 CRegion::CRegion()
@@ -39,6 +40,8 @@ CRegion::CRegion()
     name.clear();
     doors.clear();
     localSpaceId = 0;
+    members = nullptr;
+    memberCount = 0;
 }
 
 CRegion::~CRegion()
@@ -57,12 +60,53 @@ QByteArray CRegion::getName()
     return name;
 }
 
+void CRegion::addMember(CRoom *room)
+{
+    room->regionPrev = nullptr;
+    room->regionNext = members;
+    if (members)
+        members->regionPrev = room;
+    members = room;
+    memberCount++;
+}
+
+void CRegion::removeMember(CRoom *room)
+{
+    if (room->regionPrev)
+        room->regionPrev->regionNext = room->regionNext;
+    else
+        members = room->regionNext;
+    if (room->regionNext)
+        room->regionNext->regionPrev = room->regionPrev;
+    room->regionPrev = room->regionNext = nullptr;
+    memberCount--;
+}
+
 void CRegion::addDoor(QByteArray alias, QByteArray name)
 {
-    doors.insert(alias.trimmed(), name.simplified());
+    alias = alias.trimmed();
+    name = name.simplified();
+    bool replaced = doors.contains(alias);
+    doors.insert(alias, name);
+    if (replaced)
+        rebuildAliases();
+    else if (!aliases.contains(name) || alias < aliases.value(name))
+        aliases.insert(name, alias);
     Map.rebuildRegion(this);
 }
 
+/* doors change rarely, the renderer asks for aliases all the time */
+void CRegion::rebuildAliases()
+{
+    aliases.clear();
+    QMapIterator<QByteArray, QByteArray> i(doors);
+    while (i.hasNext()) {
+        i.next();
+        if (!aliases.contains(i.value()))
+            aliases.insert(i.value(), i.key());
+    }
+}
+
 QByteArray CRegion::getDoor(QByteArray alias)
 {
     if (doors.contains(alias) == true)
@@ -73,6 +117,7 @@ QByteArray CRegion::getDoor(QByteArray alias)
 bool CRegion::removeDoor(QByteArray alias)
 {
     bool b = doors.remove(alias);
+    rebuildAliases();
     Map.rebuildRegion(this);
     return b;
 }
@@ -101,12 +146,10 @@ QByteArray CRegion::getAliasByDoor(QByteArray door, int dir)
     fulldoor = door + " ";
     fulldoor.append(dirbynum(dir));
 
-    QMapIterator<QByteArray, QByteArray> i(doors);
-    while (i.hasNext()) {
-        i.next();
-        print_debug(DEBUG_USERFUNC, "Checking ...%s...\r\n", (const char *)i.value());
-        if (i.value() == door || i.value() == fulldoor)
-            return i.key();
-    }
-    return "";
+    /* the first alias in order that names either of them */
+    QByteArray alias = aliases.value(door);
+    QByteArray fullAlias = aliases.value(fulldoor);
+    if (alias.isEmpty() || (!fullAlias.isEmpty() && fullAlias < alias))
+        return fullAlias;
+    return alias;
 }
@@ -21,16 +21,25 @@
 #ifndef REGIONS_H
 #define REGIONS_H
 
+#include <QHash>
 #include <QMap>
 #include <QByteArray>
 
+class CRoom;
+
 class CRegion
 {
     QByteArray name;
     QMap<QByteArray, QByteArray> doors;
+    QHash<QByteArray, QByteArray> aliases; /* door -> its first alias, for getAliasByDoor() */
     int localSpaceId;
     QByteArray localSpaceName;
 
+    CRoom *members; /* intrusive list through CRoom::nextInRegion() */
+    int memberCount;
+
+    void rebuildAliases();
+
   public:
     CRegion();
     ~CRegion();
@@ -52,6 +61,13 @@ class CRegion
     int getLocalSpaceId() const { return localSpaceId; }
     void setLocalSpaceName(const QByteArray &name) { localSpaceName = name; }
     QByteArray getLocalSpaceName() const { return localSpaceName; }
+
+    /* rooms of the map in this region, kept by CRoom::setRegion() and the */
+    /* room manager. Walk with firstMember() and CRoom::nextInRegion()      */
+    void addMember(CRoom *room);
+    void removeMember(CRoom *room);
+    CRoom *firstMember() const { return members; }
+    int memberAmount() const { return memberCount; }
 };
 
 #endif
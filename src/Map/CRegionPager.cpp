@@ -0,0 +1,285 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+
+#include "Map/CRegion.h"
+#include "Map/CRegionPager.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+
+static const quint32 PAGE_MAGIC = 0x50525047u; /* "PRPG" */
+static const quint32 PAGE_VERSION = 1;
+
+bool CRegionPager::isEnabled() const
+{
+    return conf && conf->getPagingEnabled();
+}
+
+QString CRegionPager::pageFile(CRegion *region) const
+{
+    QString dir = QFileInfo(QString::fromUtf8(conf->getBaseFile())).absolutePath() + "/pages";
+    QString name = QString::fromUtf8(region->getName());
+
+    /* the readable part may clash ("a b" and "a_b", or by case on some */
+    /* file systems), the hash of the full name keeps the files apart   */
+    for (QChar &c : name)
+        if (!c.isLetterOrNumber() && c != '-')
+            c = '_';
+    QByteArray hash = QCryptographicHash::hash(region->getName(), QCryptographicHash::Sha1).toHex().left(16);
+    return dir + "/" + name + "-" + QString::fromLatin1(hash) + ".page";
+}
+
+bool CRegionPager::isPinned(CRegion *region) const
+{
+    return conf->getPagingPinnedRegions().contains(region->getName());
+}
+
+/* the texts are dropped only after the page file has been written and */
+/* read back, anything short of that keeps the region as it is          */
+bool CRegionPager::writePage(CRegion *region)
+{
+    QVector<CRoom *> rooms;
+    rooms.reserve(region->memberAmount());
+    for (CRoom *room = region->firstMember(); room != nullptr; room = room->nextInRegion()) {
+        /* the texts of a broken page are only in that file, never overwrite it */
+        if (room->isPaged())
+            return false;
+        rooms.append(room);
+    }
+    if (rooms.isEmpty())
+        return false;
+
+    QByteArray buffer;
+    QDataStream out(&buffer, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << PAGE_MAGIC << PAGE_VERSION << quint32(rooms.size());
+    for (CRoom *room : rooms)
+        room->writeText(out);
+
+    QString filename = pageFile(region);
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(buffer) != buffer.size() || !file.commit()) {
+        print_debug(DEBUG_ROOMS, "Failed to write the region page %s, keeping the region", qPrintable(filename));
+        return false;
+    }
+
+    QFile check(filename);
+    if (!check.open(QIODevice::ReadOnly) || check.readAll() != buffer) {
+        print_debug(DEBUG_ROOMS, "The region page %s does not read back, keeping the region", qPrintable(filename));
+        return false;
+    }
+
+    for (CRoom *room : rooms)
+        room->pageOut();
+    return true;
+}
+
+bool CRegionPager::readPage(CRegion *region)
+{
+    QString filename = pageFile(region);
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        print_debug(DEBUG_ROOMS, "Cannot open the region page %s", qPrintable(filename));
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != PAGE_MAGIC || version != PAGE_VERSION) {
+        print_debug(DEBUG_ROOMS, "%s is not a region page", qPrintable(filename));
+        return false;
+    }
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        quint32 id;
+        QByteArray desc, contents;
+        in >> id >> desc >> contents;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        CRoom *room = Map.getRoom(id);
+        if (room && room->isPaged())
+            room->pageIn(desc, contents);
+    }
+    if (in.status() != QDataStream::Ok) {
+        print_debug(DEBUG_ROOMS, "The region page %s is truncated", qPrintable(filename));
+        return false;
+    }
+
+    /* every room of the region must have come back */
+    for (CRoom *room = region->firstMember(); room != nullptr; room = room->nextInRegion())
+        if (room->isPaged()) {
+            print_debug(DEBUG_ROOMS, "The region page %s misses room %u", qPrintable(filename), room->id);
+            return false;
+        }
+    return true;
+}
+
+/* rooms the page restored keep their texts even if it failed, the rest */
+/* stay paged without them, which is reported once                      */
+void CRegionPager::loadLocked(CRegion *region, Page &page)
+{
+    if (page.resident || page.broken)
+        return;
+
+    if (readPage(region)) {
+        page.resident = true;
+        pageIns++;
+        return;
+    }
+
+    page.broken = true;
+    readFailures++;
+    send_to_user("--[Pandora: Error, cannot read the region page of %s (%s). Its rooms have lost their "
+                 "descriptions, saving the map is refused until the map is reloaded.\r\n",
+                 region->getName().constData(), qPrintable(pageFile(region)));
+}
+
+void CRegionPager::pageIn(CRegion *region)
+{
+    if (region == nullptr)
+        return;
+
+    QMutexLocker locker(&lock);
+    Page &page = pages[region];
+    page.lastUse = ++clock;
+    loadLocked(region, page);
+}
+
+bool CRegionPager::pageOut(CRegion *region)
+{
+    QMutexLocker locker(&lock);
+    Page &page = pages[region];
+    if (!page.resident || !writePage(region))
+        return false;
+
+    page.resident = false;
+    pageOuts++;
+    return true;
+}
+
+void CRegionPager::touch(const QList<CRegion *> &regions)
+{
+    if (!isEnabled())
+        return;
+
+    QMutexLocker locker(&lock);
+    clock++;
+    for (CRegion *region : regions) {
+        Page &page = pages[region];
+        page.lastUse = clock;
+        loadLocked(region, page);
+    }
+    balanceLocked();
+}
+
+void CRegionPager::touchAround(CRoom *room)
+{
+    if (room == nullptr || !isEnabled())
+        return;
+
+    QSet<CRegion *> near;
+    near.insert(room->getRegion());
+    for (int dir = 0; dir <= 5; dir++)
+        if (room->exits[dir])
+            near.insert(room->exits[dir]->getRegion());
+    near.remove(nullptr);
+
+    touch(near.values());
+}
+
+/* regions never touched count as resident and least recently used */
+void CRegionPager::balanceLocked()
+{
+    QList<CRegion *> regions = Map.getAllRegions();
+    int limit = conf->getPagingResidentRegions();
+    int resident = 0;
+
+    for (CRegion *region : regions)
+        if (pages.value(region).resident)
+            resident++;
+
+    while (resident > limit) {
+        CRegion *victim = nullptr;
+        quint64 oldest = clock;
+
+        for (CRegion *region : regions) {
+            Page page = pages.value(region);
+            if (page.resident && page.lastUse < oldest && !isPinned(region)) {
+                victim = region;
+                oldest = page.lastUse;
+            }
+        }
+        if (victim == nullptr)
+            break;
+
+        /* empty regions and failed writes stay, but are not picked again */
+        Page &page = pages[victim];
+        if (writePage(victim)) {
+            page.resident = false;
+            pageOuts++;
+        } else {
+            page.lastUse = clock;
+        }
+        resident--;
+    }
+}
+
+void CRegionPager::clear()
+{
+    QMutexLocker locker(&lock);
+    pages.clear();
+}
+
+int CRegionPager::residentCount()
+{
+    QMutexLocker locker(&lock);
+    int result = 0;
+    for (CRegion *region : Map.getAllRegions())
+        if (pages.value(region).resident)
+            result++;
+    return result;
+}
+
+int CRegionPager::pagedCount()
+{
+    QMutexLocker locker(&lock);
+    int result = 0;
+    for (CRegion *region : Map.getAllRegions())
+        if (!pages.value(region).resident)
+            result++;
+    return result;
+}
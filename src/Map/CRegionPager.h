@@ -0,0 +1,92 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CREGIONPAGER_H
+#define CREGIONPAGER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+class CRoom;
+class CRegion;
+
+// Paged storage of the room texts. With paging on in mume.ini ([Paging]
+// enabled) every region is a page: the descriptions and contents of its
+// rooms can be written to a region file and dropped from memory. Room
+// objects, ids, coordinates, flags and exits always stay, so cross region
+// exits and everything id based keep working; a paged room reloads its
+// region the first time its text is needed.
+//
+// The engine touches the region of the current room and of its neighbours,
+// the renderer the regions in view. Past residentRegions the least recently
+// touched region that is not in pinnedRegions is paged out.
+//
+// Texts are only dropped once their page file reads back byte for byte.
+// A page that cannot be read later leaves its rooms paged without texts:
+// they match no description, and saving the map is refused while they
+// exist, so the map file on disk keeps the texts.
+
+class CRegionPager
+{
+    struct Page
+    {
+        bool resident = true;
+        bool broken = false; /* the page file could not be read, not tried again */
+        quint64 lastUse = 0;
+    };
+
+    QMutex lock;
+    QHash<CRegion *, Page> pages;
+    quint64 clock = 0;
+    int pageOuts = 0;
+    int pageIns = 0;
+    int readFailures = 0;
+
+    QString pageFile(CRegion *region) const;
+    bool isPinned(CRegion *region) const;
+    bool writePage(CRegion *region);
+    bool readPage(CRegion *region);
+    void loadLocked(CRegion *region, Page &page);
+    void balanceLocked();
+
+  public:
+    bool isEnabled() const;
+
+    // marks the regions as used now and loads them, then evicts past the limit
+    void touch(const QList<CRegion *> &regions);
+    void touchAround(CRoom *room);
+
+    void pageIn(CRegion *region);
+    bool pageOut(CRegion *region);
+
+    // forgets all pages, for CRoomManager::reinit
+    void clear();
+
+    int residentCount();
+    int pagedCount();
+    int pageInCount() const { return pageIns; }
+    int pageOutCount() const { return pageOuts; }
+    int readFailureCount() const { return readFailures; }
+};
+
+#endif
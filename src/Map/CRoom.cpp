@@ -30,12 +30,17 @@
 //
 //
 #include <QByteArray>
+#include <QDataStream>
 #include <QString>
+#include <QVector>
 
 #include "CConfigurator.h"
+#include "CMemoryStats.h"
 #include "utils.h"
 
+#include "Map/CMapTransaction.h"
 #include "Map/CRoom.h"
+#include "Map/CRoomIndex.h"
 #include "Map/CRoomManager.h"
 #include "Map/CTree.h"
 
@@ -55,6 +60,9 @@ CRoom::CRoom()
 
     id = 0;
     name = nullptr;
+    nameIndexed = false;
+    flagsIndexed = false;
+    paged = false;
     note = nullptr;
     desc = nullptr;
     x = 0;
@@ -62,6 +70,9 @@ CRoom::CRoom()
     z = 0;
     sector = 0;
     region = nullptr;
+    listed = false;
+    regionPrev = nullptr;
+    regionNext = nullptr;
     flags = 0;
 
     // Initialize MMapper properties
@@ -81,35 +92,79 @@ CRoom::CRoom()
         mmExitFlags[i] = 0;
         mmDoorFlags[i] = 0;
     }
+    exitSignature = 0;
     square = nullptr;
+
+    textBytes = 0;
+    MemoryStats.add(CMemoryStats::MEM_ROOMS, sizeof(CRoom), 1);
 }
 
 CRoom::~CRoom()
 {
     int i;
 
-    NameMap.deleteItem(name, id);
+    if (nameIndexed)
+        NameMap.deleteItem(name, id);
+    unlistFromRegion();
 
     for (i = 0; i <= 5; i++) {
         doors[i].clear();
     }
+
+    MemoryStats.add(CMemoryStats::MEM_ROOMS, -qint64(sizeof(CRoom)), -1);
+    MemoryStats.add(CMemoryStats::MEM_ROOM_TEXT, -textBytes);
+}
+
+void CRoom::accountText()
+{
+    qint64 bytes = name.size() + desc.size() + note.size() + noteColor.size() + contents.size();
+    for (int i = 0; i <= 5; i++)
+        bytes += doors[i].size();
+
+    MemoryStats.add(CMemoryStats::MEM_ROOM_TEXT, bytes - textBytes);
+    textBytes = bytes;
 }
 
 void CRoom::setModified(bool b)
 {
     if (b) {
-        conf->setDatabaseModified(true);
+        if (Map.transaction)
+            Map.transaction->markModified();
+        else
+            conf->setDatabaseModified(true);
     }
 }
 
+/* inside a map transaction the room leaves FlagIndex on its first change */
+/* and is indexed again when the transaction ends                         */
+void CRoom::deferIndexUpdate()
+{
+    if (flagsIndexed && Map.transaction)
+        Map.transaction->deferFlags(this);
+}
+
 int CRoom::descCmp(QByteArray d)
 {
+    ensureResident();
+    /* the region page could not be read, the text is unknown */
+    if (paged)
+        return -1;
     if (desc.isEmpty() != true)
         return comparator.strcmp_desc(d, desc);
     else
         return 0;
 }
 
+int CRoom::descCmp(const QByteArray &d, const CDescSketch &sketch)
+{
+    /* an empty description matches everything, as above */
+    if (descSketch.isEmpty())
+        return 0;
+    if (CDescSketch::cannotMatch(sketch, descSketch, conf->getDescQuote()))
+        return -1;
+    return descCmp(d);
+}
+
 int CRoom::roomnameCmp(QByteArray n)
 {
     if (name.isEmpty() != true)
@@ -139,6 +194,26 @@ bool CRoom::isExitPresent(int dir)
     return false;
 }
 
+/* secret doors may be closed and missing from the exits line, */
+/* MMapper door flags count as much as our own door names       */
+void CRoom::updateExitSignature()
+{
+    exitSignature = 0;
+    for (int dir = 0; dir <= 5; dir++) {
+        int signature;
+        if (!isExitPresent(dir))
+            signature = SIGNATURE_NONE;
+        else if (isDoorSecret(dir) || (mmDoorFlags[dir] & MM_DOOR_HIDDEN))
+            signature = SIGNATURE_SECRET;
+        else if (isDoorSet(dir) || (mmExitFlags[dir] & MM_EXIT_DOOR))
+            signature = SIGNATURE_DOOR;
+        else
+            signature = SIGNATURE_OPEN;
+        exitSignature |= signature << (dir * SIGNATURE_BITS);
+    }
+    Map.graphChanged();
+}
+
 bool CRoom::isExitLeadingTo(int dir, CRoom *room)
 {
     if (exits[dir] == nullptr)
@@ -159,6 +234,8 @@ int CRoom::setDoor(int dir, QByteArray d)
     }
 
     doors[dir] = d;
+    accountText();
+    updateExitSignature();
 
     rebuildDisplayList();
     setModified(true);
@@ -169,6 +246,8 @@ int CRoom::setDoor(int dir, QByteArray d)
 void CRoom::removeDoor(int dir)
 {
     doors[dir].clear();
+    accountText();
+    updateExitSignature();
     rebuildDisplayList();
     setModified(true);
 }
@@ -214,6 +293,8 @@ char CRoom::dirbynum(int dir)
 
 void CRoom::setX(int nx)
 {
+    if (Map.transaction)
+        Map.transaction->deferPlacement(this);
     x = nx;
     setModified(true);
     rebuildDisplayList();
@@ -221,6 +302,8 @@ void CRoom::setX(int nx)
 
 void CRoom::setY(int ny)
 {
+    if (Map.transaction)
+        Map.transaction->deferPlacement(this);
     y = ny;
     setModified(true);
     rebuildDisplayList();
@@ -228,6 +311,13 @@ void CRoom::setY(int ny)
 
 void CRoom::setZ(int nz)
 {
+    /* a map transaction places the room once, when it ends */
+    if (Map.transaction && Map.transaction->deferPlacement(this)) {
+        z = nz;
+        setModified(true);
+        return;
+    }
+
     Map.removeFromPlane(this);
     z = nz;
 
@@ -251,6 +341,7 @@ QByteArray CRoom::getName()
 
 QByteArray CRoom::getDesc()
 {
+    ensureResident();
     return desc;
 }
 
@@ -267,6 +358,7 @@ QByteArray CRoom::getNote()
 void CRoom::setNoteColor(QByteArray color)
 {
     noteColor = color;
+    accountText();
     rebuildDisplayList();
 }
 QByteArray CRoom::getNoteColor()
@@ -276,7 +368,10 @@ QByteArray CRoom::getNoteColor()
 
 void CRoom::setDesc(QByteArray newdesc)
 {
+    ensureResident();
     desc = newdesc;
+    descSketch.set(desc);
+    accountText();
     setModified(true);
 }
 
@@ -302,28 +397,92 @@ QByteArray CRoom::getSecretsInfo()
 
 void CRoom::setName(QByteArray newname)
 {
-    NameMap.deleteItem(name, id);
+    /* a map transaction puts the new name into NameMap when it ends */
+    bool deferred = Map.transaction && Map.transaction->deferName(this);
+
+    if (!deferred)
+        NameMap.deleteItem(name, id);
     name = newname;
-    NameMap.addName(newname, id);
+    accountText();
+    if (!deferred) {
+        NameMap.addName(newname, id);
+        nameIndexed = true;
+    }
     setModified(true);
 }
 
+void CRoom::unindexName(bool removeFromTree)
+{
+    if (removeFromTree)
+        NameMap.deleteItem(name, id);
+    nameIndexed = false;
+}
+
+void CRoom::indexFlags()
+{
+    FlagIndex.addRoom(this);
+    flagsIndexed = true;
+}
+
+void CRoom::unindexFlags(bool removeFromIndex)
+{
+    if (removeFromIndex && flagsIndexed)
+        FlagIndex.removeRoom(this);
+    flagsIndexed = false;
+}
+
+void CRoom::faultIn()
+{
+    Map.pager.pageIn(region);
+}
+
+void CRoom::writeText(QDataStream &out)
+{
+    out << quint32(id) << desc << contents;
+}
+
+void CRoom::pageOut()
+{
+    desc.clear();
+    contents.clear();
+    paged = true;
+    accountText();
+}
+
+void CRoom::pageIn(const QByteArray &pagedDesc, const QByteArray &pagedContents)
+{
+    desc = pagedDesc;
+    contents = pagedContents;
+    paged = false;
+    accountText();
+}
+
 void CRoom::setTerrain(char terrain)
 {
-    sector = conf->getSectorByPattern(terrain);
+    char val = conf->getSectorByPattern(terrain);
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeSector(id, sector, val);
+    sector = val;
+    Map.graphChanged();
     setModified(true);
     rebuildDisplayList();
 }
 
 void CRoom::setSector(char val)
 {
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeSector(id, sector, val);
     sector = val;
+    Map.graphChanged();
     rebuildDisplayList();
 }
 
 void CRoom::setNote(QByteArray newnote)
 {
     note = newnote;
+    accountText();
     rebuildDisplayList();
 }
 
@@ -342,6 +501,7 @@ void CRoom::setExit(int dir, CRoom *room)
 {
     exits[dir] = room;
     exitFlags[dir] = EXIT_NONE;
+    updateExitSignature();
     rebuildDisplayList();
 }
 
@@ -349,6 +509,7 @@ void CRoom::setExit(int dir, unsigned int value)
 {
     exits[dir] = Map.getRoom(value);
     exitFlags[dir] = EXIT_NONE;
+    updateExitSignature();
     rebuildDisplayList();
 }
 
@@ -371,6 +532,7 @@ void CRoom::setExitUndefined(int dir)
 {
     exits[dir] = nullptr;
     exitFlags[dir] = EXIT_UNDEFINED;
+    updateExitSignature();
     rebuildDisplayList();
 }
 
@@ -393,6 +555,7 @@ bool CRoom::isExitNormal(int dir)
 void CRoom::setExitFlags(int dir, unsigned char flag)
 {
     exitFlags[dir] = flag;
+    updateExitSignature();
 
     rebuildDisplayList();
     setModified(true);
@@ -402,6 +565,7 @@ void CRoom::setExitDeath(int dir)
 {
     exitFlags[dir] = EXIT_DEATH;
     exits[dir] = nullptr;
+    updateExitSignature();
     rebuildDisplayList();
     setModified(true);
 }
@@ -419,6 +583,7 @@ bool CRoom::anyUndefinedExits()
 
 bool CRoom::isEqualNameAndDesc(CRoom *room)
 {
+    ensureResident();
     if ((desc == room->getDesc()) && (name == room->getName()))
         return true;
     return false;
@@ -426,6 +591,7 @@ bool CRoom::isEqualNameAndDesc(CRoom *room)
 
 bool CRoom::isDescSet()
 {
+    ensureResident();
     if (desc.isEmpty() == true)
         return false;
     return true;
@@ -461,12 +627,40 @@ void CRoom::setRegion(QByteArray name)
 
 void CRoom::setRegion(CRegion *reg)
 {
-    if (reg != nullptr)
+    if (reg != nullptr) {
+        /* the texts belong to the page of the old region */
+        ensureResident();
+        deferIndexUpdate();
+        if (flagsIndexed)
+            FlagIndex.changeRegion(id, region, reg);
+        if (listed && region)
+            region->removeMember(this);
         region = reg;
+        if (listed)
+            region->addMember(this);
+    }
 
     rebuildDisplayList();
 }
 
+void CRoom::listInRegion()
+{
+    if (listed)
+        return;
+    listed = true;
+    if (region)
+        region->addMember(this);
+}
+
+void CRoom::unlistFromRegion()
+{
+    if (!listed)
+        return;
+    listed = false;
+    if (region)
+        region->removeMember(this);
+}
+
 CRegion *CRoom::getRegion()
 {
     return region;
@@ -476,6 +670,7 @@ void CRoom::disconnectExit(int dir)
 {
     exitFlags[dir] = EXIT_NONE;
     exits[dir] = nullptr;
+    updateExitSignature();
     rebuildDisplayList();
 }
 
@@ -484,6 +679,8 @@ void CRoom::removeExit(int dir)
     exitFlags[dir] = EXIT_NONE;
     exits[dir] = nullptr;
     doors[dir].clear();
+    accountText();
+    updateExitSignature();
     rebuildDisplayList();
 }
 
@@ -510,6 +707,7 @@ QString CRoom::toolTip()
 /* ------------------------------ prints the given room --------------------*/
 void CRoom::sendRoom()
 {
+    ensureResident();
     send_to_user(" Id: %i, Flags: %s, Region: %s, Coord: %i,%i,%i\r\n", id, conf->sectors[sector].desc.constData(),
                  region->getName().constData(), x, y, z);
     send_to_user(" \x1b[32m%s\x1b[0m\r\n", name.constData());
@@ -646,6 +844,63 @@ void CRoom::sendRoom()
     }
 }
 
+void CRoom::setLightType(uint8_t type)
+{
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeType(CRoomIndex::LIGHT, id, lightType, type);
+    lightType = type;
+}
+
+void CRoom::setAlignType(uint8_t type)
+{
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeType(CRoomIndex::ALIGN, id, alignType, type);
+    alignType = type;
+}
+
+void CRoom::setPortableType(uint8_t type)
+{
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeType(CRoomIndex::PORTABLE, id, portableType, type);
+    portableType = type;
+}
+
+void CRoom::setRidableType(uint8_t type)
+{
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeType(CRoomIndex::RIDABLE, id, ridableType, type);
+    ridableType = type;
+}
+
+void CRoom::setSundeathType(uint8_t type)
+{
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeType(CRoomIndex::SUNDEATH, id, sundeathType, type);
+    sundeathType = type;
+}
+
+void CRoom::setMobFlags(uint32_t flags)
+{
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeMobFlags(id, mobFlags, flags);
+    mobFlags = flags;
+}
+
+void CRoom::setLoadFlags(uint32_t flags)
+{
+    deferIndexUpdate();
+    if (flagsIndexed)
+        FlagIndex.changeLoadFlags(id, loadFlags, flags);
+    loadFlags = flags;
+    Map.graphChanged();
+}
+
 const char *CRoom::lightTypeToString(uint8_t type)
 {
     switch (type) {
@@ -708,19 +963,40 @@ const char *CRoom::sundeathTypeToString(uint8_t type)
     }
 }
 
+static const char *mobFlagNames[CRoom::MOB_FLAG_COUNT] = {
+    "RENT",        "SHOP",         "WEAPON_SHOP",   "ARMOUR_SHOP",
+    "FOOD_SHOP",   "PET_SHOP",     "GUILD",         "SCOUT_GUILD",
+    "MAGE_GUILD",  "CLERIC_GUILD", "WARRIOR_GUILD", "RANGER_GUILD",
+    "AGGRESSIVE",  "QUEST_MOB",    "PASSIVE_MOB",   "ELITE_MOB",
+    "SUPER_MOB",   "MILKABLE",     "RATTLESNAKE"};
+
+static const char *loadFlagNames[CRoom::LOAD_FLAG_COUNT] = {
+    "TREASURE",  "ARMOUR",     "WEAPON",        "WATER",
+    "FOOD",      "HERB",       "KEY",           "MULE",
+    "HORSE",     "PACK_HORSE", "TRAINED_HORSE", "ROHIRRIM",
+    "WARG",      "BOAT",       "ATTENTION",     "TOWER",
+    "CLOCK",     "MAIL",       "STABLE",        "WHITE_WORD",
+    "DARK_WORD", "EQUIPMENT",  "COACH",         "FERRY",
+    "DEATHTRAP"};
+
+const char *CRoom::mobFlagName(int bit)
+{
+    return (bit >= 0 && bit < MOB_FLAG_COUNT) ? mobFlagNames[bit] : "";
+}
+
+const char *CRoom::loadFlagName(int bit)
+{
+    return (bit >= 0 && bit < LOAD_FLAG_COUNT) ? loadFlagNames[bit] : "";
+}
+
 QByteArray CRoom::mobFlagsToString(uint32_t flags)
 {
-    static const char *names[] = {"RENT",         "SHOP",       "WEAPON_SHOP", "ARMOUR_SHOP",
-                                  "FOOD_SHOP",    "PET_SHOP",   "GUILD",       "SCOUT_GUILD",
-                                  "MAGE_GUILD",   "CLERIC_GUILD", "WARRIOR_GUILD", "RANGER_GUILD",
-                                  "AGGRESSIVE",   "QUEST_MOB",  "PASSIVE_MOB", "ELITE_MOB",
-                                  "SUPER_MOB",    "MILKABLE",   "RATTLESNAKE"};
     QByteArray result;
-    for (int i = 0; i < 19; i++) {
+    for (int i = 0; i < MOB_FLAG_COUNT; i++) {
         if (flags & (1 << i)) {
             if (!result.isEmpty())
                 result += "|";
-            result += names[i];
+            result += mobFlagNames[i];
         }
     }
     return result.isEmpty() ? QByteArray("none") : result;
@@ -728,19 +1004,12 @@ QByteArray CRoom::mobFlagsToString(uint32_t flags)
 
 QByteArray CRoom::loadFlagsToString(uint32_t flags)
 {
-    static const char *names[] = {"TREASURE", "ARMOUR",       "WEAPON",     "WATER",
-                                  "FOOD",     "HERB",         "KEY",        "MULE",
-                                  "HORSE",    "PACK_HORSE",   "TRAINED_HORSE", "ROHIRRIM",
-                                  "WARG",     "BOAT",         "ATTENTION",  "TOWER",
-                                  "CLOCK",    "MAIL",         "STABLE",     "WHITE_WORD",
-                                  "DARK_WORD", "EQUIPMENT",   "COACH",      "FERRY",
-                                  "DEATHTRAP"};
     QByteArray result;
-    for (int i = 0; i < 25; i++) {
+    for (int i = 0; i < LOAD_FLAG_COUNT; i++) {
         if (flags & (1 << i)) {
             if (!result.isEmpty())
                 result += "|";
-            result += names[i];
+            result += loadFlagNames[i];
         }
     }
     return result.isEmpty() ? QByteArray("none") : result;
@@ -782,6 +1051,8 @@ QByteArray CRoom::doorFlagsToString(uint16_t flags)
 /* Returns Levenshtein distance between two strings. */
 int Strings_Comparator::compare(QByteArray pattern, QByteArray text)
 {
+    /* only two rows of the matrix are needed at a time */
+    static thread_local QVector<int> previous, current;
     int n, m, i, j;
     int cost;
 
@@ -795,26 +1066,29 @@ int Strings_Comparator::compare(QByteArray pattern, QByteArray text)
     n = pattern.length();
     m = text.length();
 
-    /* initialization */
-    for (i = 0; i <= n; i++)
-        D[i][0] = i;
+    previous.resize(m + 1);
+    current.resize(m + 1);
 
-    for (i = 0; i <= m; i++)
-        D[0][i] = i;
+    /* initialization */
+    for (j = 0; j <= m; j++)
+        previous[j] = j;
 
     /* recurence */
-    for (i = 1; i <= n; i++)
+    for (i = 1; i <= n; i++) {
+        current[0] = i;
         for (j = 1; j <= m; j++) {
-            cost = D[i - 1][j - 1];
+            cost = previous[j - 1];
             if (s1[i - 1] != s2[j - 1])
                 cost += 1;
 
-            D[i][j] = MIN(cost, MIN(D[i - 1][j] + 1, D[i][j - 1] + 1));
+            current[j] = MIN(cost, MIN(previous[j] + 1, current[j - 1] + 1));
         }
+        previous.swap(current);
+    }
 
-    //  print_debug(DEBUG_ROOMS, "result of comparison : %i", D[n][m]);
+    //  print_debug(DEBUG_ROOMS, "result of comparison : %i", previous[m]);
 
-    return D[n][m];
+    return previous[m];
 }
 
 int Strings_Comparator::compare_with_quote(QByteArray str, QByteArray text, int quote)
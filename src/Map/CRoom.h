@@ -33,9 +33,11 @@
 #define CROOM_H
 
 #include <QByteArray>
+#include <QDataStream>
 
 #include "defines.h"
 
+#include "Map/CDescSketch.h"
 #include "Map/CRegion.h"
 #include "Renderer/CSquare.h"
 
@@ -173,13 +175,10 @@ enum MMDoorFlag : uint16_t
     MM_DOOR_NO_BASH = 1 << 10
 };
 
+/* keeps no state - the scratch rows are per thread, so the engine */
+/* can compare candidates on several threads at once               */
 class Strings_Comparator
 {
-  private:
-    static const int MAX_N = MAX_LINES_DESC * 80;
-    static const int MAX_M = MAX_LINES_DESC * 80;
-    int D[MAX_N][MAX_M];
-
   public:
     int compare(QByteArray pattern, QByteArray text);
     int compare_with_quote(QByteArray str, QByteArray text, int quote);
@@ -191,17 +190,28 @@ extern Strings_Comparator comparator;
 
 class CRoom
 {
+    friend class CMapTransaction; /* saves and restores the fields directly */
+    friend class CRegion;         /* keeps the member list links */
+
     unsigned int flags;
+    bool nameIndexed;     /* name is registered in NameMap under this id */
+    bool flagsIndexed;    /* flags, types, terrain and region are in FlagIndex */
+    bool paged;           /* desc and contents are in the region page file, see CRegionPager */
     QByteArray name;      /* POINTER to the room name */
     QByteArray note;      /* note, if needed, additional info etc */
     QByteArray noteColor; /* note color in this room */
     QByteArray desc;      /* descrition */
+    CDescSketch descSketch; /* of desc, kept while the texts are paged out */
     char sector;          /* terrain marker */
                           /* _no need to free this one_ */
     CRegion *region;      /* region of this room */
+    bool listed;          /* on the map, then also in the member list of the region */
+    CRoom *regionPrev;    /* neighbours in that list */
+    CRoom *regionNext;
 
     QByteArray doors[6]; /* if the door is secret */
     unsigned char exitFlags[6];
+    quint16 exitSignature; /* ExitSignature of every direction, SIGNATURE_BITS each */
 
     CSquare *square; /* which square this room belongs to */
 
@@ -217,6 +227,18 @@ class CRoom
     uint32_t loadFlags;     // MMLoadFlag bitmask
     QByteArray contents;    // Room contents description
 
+    qint64 textBytes; /* what this room has added to MemoryStats room texts */
+    void accountText();
+
+    void deferIndexUpdate();
+
+    void faultIn();
+    inline void ensureResident()
+    {
+        if (paged)
+            faultIn();
+    }
+
     // MMapper exit properties (per direction)
     uint16_t mmExitFlags[6];  // MMExitFlag bitmask per direction
     uint16_t mmDoorFlags[6];  // MMDoorFlag bitmask per direction
@@ -229,6 +251,16 @@ class CRoom
         EXIT_DEATH
     };
 
+    /* what an exits line should show of a direction, see updateExitSignature() */
+    enum ExitSignature
+    {
+        SIGNATURE_NONE = 0,
+        SIGNATURE_OPEN,
+        SIGNATURE_DOOR,
+        SIGNATURE_SECRET
+    };
+    static const int SIGNATURE_BITS = 2;
+
     unsigned int id; /* identifier, public for speed up - its very often used  */
     CRoom *exits[6]; /* very often used in places where performance matters */
 
@@ -245,6 +277,11 @@ class CRoom
 
     void setDesc(QByteArray newdesc);
     void setName(QByteArray newname);
+    /* drop the room from NameMap now, used when the room is retired instead of deleted */
+    void unindexName(bool removeFromTree = true);
+    /* add to/drop from the FlagIndex bitmaps, done by CRoomManager */
+    void indexFlags();
+    void unindexFlags(bool removeFromIndex = true);
     void setTerrain(char terrain);
     void setSector(char val);
     void setNote(QByteArray note);
@@ -300,12 +337,19 @@ class CRoom
     inline int getZ() { return z; }
 
     int descCmp(QByteArray desc);
+    /* the same, but rejects hopeless candidates by their sketches first */
+    int descCmp(const QByteArray &desc, const CDescSketch &sketch);
+    const CDescSketch &getDescSketch() const { return descSketch; }
     int roomnameCmp(QByteArray name);
 
     QByteArray getRegionName();
     CRegion *getRegion();
     void setRegion(QByteArray name);
     void setRegion(CRegion *reg);
+    /* the room manager lists the rooms on the map in their regions */
+    void listInRegion();
+    void unlistFromRegion();
+    CRoom *nextInRegion() const { return regionNext; }
     QByteArray getSecretsInfo();
     QByteArray getDoorAlias(int i);
 
@@ -319,36 +363,70 @@ class CRoom
 
     // MMapper property getters/setters
     uint8_t getLightType() const { return lightType; }
-    void setLightType(uint8_t type) { lightType = type; }
+    void setLightType(uint8_t type);
 
     uint8_t getAlignType() const { return alignType; }
-    void setAlignType(uint8_t type) { alignType = type; }
+    void setAlignType(uint8_t type);
 
     uint8_t getPortableType() const { return portableType; }
-    void setPortableType(uint8_t type) { portableType = type; }
+    void setPortableType(uint8_t type);
 
     uint8_t getRidableType() const { return ridableType; }
-    void setRidableType(uint8_t type) { ridableType = type; }
+    void setRidableType(uint8_t type);
 
     uint8_t getSundeathType() const { return sundeathType; }
-    void setSundeathType(uint8_t type) { sundeathType = type; }
+    void setSundeathType(uint8_t type);
 
     uint32_t getMobFlags() const { return mobFlags; }
-    void setMobFlags(uint32_t flags) { mobFlags = flags; }
+    void setMobFlags(uint32_t flags);
 
     uint32_t getLoadFlags() const { return loadFlags; }
-    void setLoadFlags(uint32_t flags) { loadFlags = flags; }
+    void setLoadFlags(uint32_t flags);
 
-    QByteArray getContents() const { return contents; }
-    void setContents(const QByteArray &c) { contents = c; }
+    QByteArray getContents()
+    {
+        ensureResident();
+        return contents;
+    }
+    void setContents(const QByteArray &c)
+    {
+        ensureResident();
+        contents = c;
+        accountText();
+    }
+
+    /* region paging - only CRegionPager calls these */
+    bool isPaged() const { return paged; }
+    void writeText(QDataStream &out);
+    void pageOut();
+    void pageIn(const QByteArray &pagedDesc, const QByteArray &pagedContents);
 
     uint16_t getMMExitFlags(int dir) const { return (dir >= 0 && dir < 6) ? mmExitFlags[dir] : 0; }
-    void setMMExitFlags(int dir, uint16_t flags) { if (dir >= 0 && dir < 6) mmExitFlags[dir] = flags; }
+    void setMMExitFlags(int dir, uint16_t flags)
+    {
+        if (dir >= 0 && dir < 6)
+            mmExitFlags[dir] = flags;
+        updateExitSignature();
+    }
 
     uint16_t getMMDoorFlags(int dir) const { return (dir >= 0 && dir < 6) ? mmDoorFlags[dir] : 0; }
-    void setMMDoorFlags(int dir, uint16_t flags) { if (dir >= 0 && dir < 6) mmDoorFlags[dir] = flags; }
+    void setMMDoorFlags(int dir, uint16_t flags)
+    {
+        if (dir >= 0 && dir < 6)
+            mmDoorFlags[dir] = flags;
+        updateExitSignature();
+    }
+
+    /* kept by the exit and door setters; whoever writes exits[] */
+    /* directly calls updateExitSignature() afterwards             */
+    int getExitSignature(int dir) const { return (exitSignature >> (dir * SIGNATURE_BITS)) & 3; }
+    void updateExitSignature();
 
     // Helper methods for displaying MMapper properties
+    static const int MOB_FLAG_COUNT = 19;
+    static const int LOAD_FLAG_COUNT = 25;
+    static const char *mobFlagName(int bit);
+    static const char *loadFlagName(int bit);
     static QByteArray mobFlagsToString(uint32_t flags);
     static QByteArray loadFlagsToString(uint32_t flags);
     static QByteArray exitFlagsToString(uint16_t flags);
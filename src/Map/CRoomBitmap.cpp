@@ -0,0 +1,300 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QtAlgorithms>
+#include <algorithm>
+
+#include "Map/CRoomBitmap.h"
+
+bool CRoomBitmap::Container::contains(quint16 low) const
+{
+    if (isBitmap())
+        return (bits[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(array.constBegin(), array.constEnd(), low);
+}
+
+QVector<quint64> CRoomBitmap::Container::toBits() const
+{
+    if (isBitmap())
+        return bits;
+
+    QVector<quint64> result(WORDS, 0);
+    for (quint16 low : array)
+        result[low >> 6] |= quint64(1) << (low & 63);
+    return result;
+}
+
+CRoomBitmap::Container CRoomBitmap::Container::fromBits(quint16 key, const QVector<quint64> &bits)
+{
+    Container c;
+    c.key = key;
+    for (quint64 word : bits)
+        c.cardinality += qPopulationCount(word);
+
+    if (c.cardinality > ARRAY_LIMIT) {
+        c.bits = bits;
+        return c;
+    }
+
+    c.array.reserve(c.cardinality);
+    for (int w = 0; w < WORDS; w++) {
+        quint64 word = bits[w];
+        while (word) {
+            c.array.append(quint16(w * 64 + qCountTrailingZeroBits(word)));
+            word &= word - 1;
+        }
+    }
+    return c;
+}
+
+int CRoomBitmap::find(quint16 key) const
+{
+    int from = 0, to = containers.size();
+    while (from < to) {
+        int middle = (from + to) / 2;
+        if (containers[middle].key < key)
+            from = middle + 1;
+        else
+            to = middle;
+    }
+    return from;
+}
+
+void CRoomBitmap::add(unsigned int id)
+{
+    quint16 key = id >> 16;
+    quint16 low = id & 0xFFFF;
+    int i = find(key);
+
+    if (i == containers.size() || containers[i].key != key) {
+        Container c;
+        c.key = key;
+        containers.insert(i, c);
+    }
+
+    Container &c = containers[i];
+    if (c.isBitmap()) {
+        quint64 &word = c.bits[low >> 6];
+        quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask)) {
+            word |= mask;
+            c.cardinality++;
+        }
+        return;
+    }
+
+    QVector<quint16>::iterator pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos != c.array.end() && *pos == low)
+        return;
+    c.array.insert(pos, low);
+    c.cardinality++;
+    if (c.cardinality > ARRAY_LIMIT) {
+        c.bits = c.toBits();
+        c.array.clear();
+    }
+}
+
+void CRoomBitmap::remove(unsigned int id)
+{
+    quint16 key = id >> 16;
+    quint16 low = id & 0xFFFF;
+    int i = find(key);
+
+    if (i == containers.size() || containers[i].key != key)
+        return;
+
+    Container &c = containers[i];
+    if (c.isBitmap()) {
+        quint64 &word = c.bits[low >> 6];
+        quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask))
+            return;
+        word &= ~mask;
+        if (--c.cardinality <= ARRAY_LIMIT)
+            c = Container::fromBits(key, c.bits);
+        return;
+    }
+
+    QVector<quint16>::iterator pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos == c.array.end() || *pos != low)
+        return;
+    c.array.erase(pos);
+    if (--c.cardinality == 0)
+        containers.remove(i);
+}
+
+bool CRoomBitmap::contains(unsigned int id) const
+{
+    quint16 key = id >> 16;
+    int i = find(key);
+    return i < containers.size() && containers[i].key == key && containers[i].contains(id & 0xFFFF);
+}
+
+int CRoomBitmap::cardinality() const
+{
+    int result = 0;
+    for (const Container &c : containers)
+        result += c.cardinality;
+    return result;
+}
+
+CRoomBitmap CRoomBitmap::operator&(const CRoomBitmap &other) const
+{
+    CRoomBitmap result;
+    int i = 0, j = 0;
+
+    while (i < containers.size() && j < other.containers.size()) {
+        const Container &a = containers[i];
+        const Container &b = other.containers[j];
+        if (a.key < b.key) {
+            i++;
+            continue;
+        }
+        if (b.key < a.key) {
+            j++;
+            continue;
+        }
+
+        Container c;
+        c.key = a.key;
+        if (!a.isBitmap() || !b.isBitmap()) {
+            /* at least one side is sparse - probe the other one */
+            const Container &small = a.isBitmap() ? b : a;
+            const Container &large = a.isBitmap() ? a : b;
+            for (quint16 low : small.array)
+                if (large.contains(low))
+                    c.array.append(low);
+            c.cardinality = c.array.size();
+        } else {
+            QVector<quint64> bits(WORDS);
+            for (int w = 0; w < WORDS; w++)
+                bits[w] = a.bits[w] & b.bits[w];
+            c = Container::fromBits(a.key, bits);
+        }
+        if (c.cardinality > 0)
+            result.containers.append(c);
+        i++;
+        j++;
+    }
+    return result;
+}
+
+CRoomBitmap CRoomBitmap::operator|(const CRoomBitmap &other) const
+{
+    CRoomBitmap result;
+    int i = 0, j = 0;
+
+    while (i < containers.size() || j < other.containers.size()) {
+        if (j == other.containers.size() || (i < containers.size() && containers[i].key < other.containers[j].key)) {
+            result.containers.append(containers[i++]);
+            continue;
+        }
+        if (i == containers.size() || other.containers[j].key < containers[i].key) {
+            result.containers.append(other.containers[j++]);
+            continue;
+        }
+
+        const Container &a = containers[i++];
+        const Container &b = other.containers[j++];
+        Container c;
+        c.key = a.key;
+        if (!a.isBitmap() && !b.isBitmap() && a.cardinality + b.cardinality <= ARRAY_LIMIT) {
+            c.array.resize(a.cardinality + b.cardinality);
+            QVector<quint16>::iterator end = std::set_union(a.array.constBegin(), a.array.constEnd(),
+                                                             b.array.constBegin(), b.array.constEnd(), c.array.begin());
+            c.array.resize(end - c.array.begin());
+            c.cardinality = c.array.size();
+        } else {
+            QVector<quint64> bits = a.toBits();
+            if (b.isBitmap()) {
+                for (int w = 0; w < WORDS; w++)
+                    bits[w] |= b.bits[w];
+            } else {
+                for (quint16 low : b.array)
+                    bits[low >> 6] |= quint64(1) << (low & 63);
+            }
+            c = Container::fromBits(a.key, bits);
+        }
+        result.containers.append(c);
+    }
+    return result;
+}
+
+CRoomBitmap CRoomBitmap::andNot(const CRoomBitmap &other) const
+{
+    CRoomBitmap result;
+    int j = 0;
+
+    for (const Container &a : containers) {
+        while (j < other.containers.size() && other.containers[j].key < a.key)
+            j++;
+        if (j == other.containers.size() || other.containers[j].key != a.key) {
+            result.containers.append(a);
+            continue;
+        }
+
+        const Container &b = other.containers[j];
+        Container c;
+        c.key = a.key;
+        if (!a.isBitmap()) {
+            for (quint16 low : a.array)
+                if (!b.contains(low))
+                    c.array.append(low);
+            c.cardinality = c.array.size();
+        } else {
+            QVector<quint64> bits = a.bits;
+            if (b.isBitmap()) {
+                for (int w = 0; w < WORDS; w++)
+                    bits[w] &= ~b.bits[w];
+            } else {
+                for (quint16 low : b.array)
+                    bits[low >> 6] &= ~(quint64(1) << (low & 63));
+            }
+            c = Container::fromBits(a.key, bits);
+        }
+        if (c.cardinality > 0)
+            result.containers.append(c);
+    }
+    return result;
+}
+
+QVector<unsigned int> CRoomBitmap::toList() const
+{
+    QVector<unsigned int> result;
+    result.reserve(cardinality());
+
+    for (const Container &c : containers) {
+        unsigned int base = unsigned(c.key) << 16;
+        if (!c.isBitmap()) {
+            for (quint16 low : c.array)
+                result.append(base | low);
+            continue;
+        }
+        for (int w = 0; w < WORDS; w++) {
+            quint64 word = c.bits[w];
+            while (word) {
+                result.append(base | unsigned(w * 64 + qCountTrailingZeroBits(word)));
+                word &= word - 1;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CROOMBITMAP_H
+#define CROOMBITMAP_H
+
+#include <QVector>
+
+// Compressed set of room ids in the spirit of roaring bitmaps: ids are split
+// into chunks of 65536 by their upper bits, each chunk keeps either a sorted
+// array of the lower 16 bits (sparse chunks) or a plain 8 KB bitmap (dense
+// chunks, more than ARRAY_LIMIT members). Set operations pick the cheapest
+// way for each pair of chunks.
+
+class CRoomBitmap
+{
+    static const int ARRAY_LIMIT = 4096;
+    static const int WORDS = 65536 / 64;
+
+    struct Container
+    {
+        quint16 key = 0;
+        int cardinality = 0;
+        QVector<quint16> array; /* used while cardinality <= ARRAY_LIMIT */
+        QVector<quint64> bits;  /* WORDS words otherwise */
+
+        bool isBitmap() const { return !bits.isEmpty(); }
+        bool contains(quint16 low) const;
+        QVector<quint64> toBits() const;
+        static Container fromBits(quint16 key, const QVector<quint64> &bits);
+    };
+
+    QVector<Container> containers; /* sorted by key, none of them empty */
+
+    int find(quint16 key) const;
+
+  public:
+    void add(unsigned int id);
+    void remove(unsigned int id);
+    bool contains(unsigned int id) const;
+
+    int cardinality() const;
+    bool isEmpty() const { return containers.isEmpty(); }
+    void clear() { containers.clear(); }
+
+    CRoomBitmap operator&(const CRoomBitmap &other) const;
+    CRoomBitmap operator|(const CRoomBitmap &other) const;
+    CRoomBitmap andNot(const CRoomBitmap &other) const;
+
+    // all members, ascending
+    QVector<unsigned int> toList() const;
+};
+
+#endif
@@ -0,0 +1,367 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include "CConfigurator.h"
+
+#include "Map/CRegion.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomIndex.h"
+
+class CRoomIndex FlagIndex;
+
+void CRoomIndex::changeBits(CRoomBitmap *bitmaps, unsigned int id, uint32_t from, uint32_t to)
+{
+    uint32_t changed = from ^ to;
+    for (int bit = 0; changed; bit++, changed >>= 1) {
+        if (!(changed & 1))
+            continue;
+        if (to & (1u << bit))
+            bitmaps[bit].add(id);
+        else
+            bitmaps[bit].remove(id);
+    }
+}
+
+void CRoomIndex::addRoom(CRoom *room)
+{
+    QWriteLocker locker(&lock);
+    unsigned int id = room->id;
+
+    all.add(id);
+    changeBits(mob, id, 0, room->getMobFlags());
+    changeBits(load, id, 0, room->getLoadFlags());
+    types[LIGHT][room->getLightType() % TYPE_VALUES].add(id);
+    types[ALIGN][room->getAlignType() % TYPE_VALUES].add(id);
+    types[PORTABLE][room->getPortableType() % TYPE_VALUES].add(id);
+    types[RIDABLE][room->getRidableType() % TYPE_VALUES].add(id);
+    types[SUNDEATH][room->getSundeathType() % TYPE_VALUES].add(id);
+    sectors[(unsigned char)room->getTerrain()].add(id);
+    if (room->getRegion())
+        regions[room->getRegion()].add(id);
+}
+
+void CRoomIndex::removeRoom(CRoom *room)
+{
+    QWriteLocker locker(&lock);
+    unsigned int id = room->id;
+
+    all.remove(id);
+    changeBits(mob, id, room->getMobFlags(), 0);
+    changeBits(load, id, room->getLoadFlags(), 0);
+    types[LIGHT][room->getLightType() % TYPE_VALUES].remove(id);
+    types[ALIGN][room->getAlignType() % TYPE_VALUES].remove(id);
+    types[PORTABLE][room->getPortableType() % TYPE_VALUES].remove(id);
+    types[RIDABLE][room->getRidableType() % TYPE_VALUES].remove(id);
+    types[SUNDEATH][room->getSundeathType() % TYPE_VALUES].remove(id);
+    sectors[(unsigned char)room->getTerrain()].remove(id);
+    if (room->getRegion() && regions.contains(room->getRegion())) {
+        CRoomBitmap &members = regions[room->getRegion()];
+        members.remove(id);
+        if (members.isEmpty())
+            regions.remove(room->getRegion());
+    }
+}
+
+void CRoomIndex::clear()
+{
+    QWriteLocker locker(&lock);
+
+    all.clear();
+    for (int i = 0; i < 32; i++) {
+        mob[i].clear();
+        load[i].clear();
+    }
+    for (int kind = 0; kind < TYPE_KINDS; kind++)
+        for (int value = 0; value < TYPE_VALUES; value++)
+            types[kind][value].clear();
+    for (int i = 0; i < SECTORS; i++)
+        sectors[i].clear();
+    regions.clear();
+}
+
+void CRoomIndex::changeMobFlags(unsigned int id, uint32_t from, uint32_t to)
+{
+    QWriteLocker locker(&lock);
+    changeBits(mob, id, from, to);
+}
+
+void CRoomIndex::changeLoadFlags(unsigned int id, uint32_t from, uint32_t to)
+{
+    QWriteLocker locker(&lock);
+    changeBits(load, id, from, to);
+}
+
+void CRoomIndex::changeType(int kind, unsigned int id, uint8_t from, uint8_t to)
+{
+    if (from == to || kind < 0 || kind >= TYPE_KINDS)
+        return;
+    QWriteLocker locker(&lock);
+    types[kind][from % TYPE_VALUES].remove(id);
+    types[kind][to % TYPE_VALUES].add(id);
+}
+
+void CRoomIndex::changeSector(unsigned int id, char from, char to)
+{
+    if (from == to)
+        return;
+    QWriteLocker locker(&lock);
+    sectors[(unsigned char)from].remove(id);
+    sectors[(unsigned char)to].add(id);
+}
+
+void CRoomIndex::changeRegion(unsigned int id, CRegion *from, CRegion *to)
+{
+    if (from == to)
+        return;
+    QWriteLocker locker(&lock);
+    if (from && regions.contains(from)) {
+        CRoomBitmap &members = regions[from];
+        members.remove(id);
+        if (members.isEmpty())
+            regions.remove(from);
+    }
+    if (to)
+        regions[to].add(id);
+}
+
+int CRoomIndex::size() const
+{
+    QReadLocker locker(&lock);
+    return all.cardinality();
+}
+
+QVector<unsigned int> CRoomIndex::regionMembers(CRegion *region) const
+{
+    QReadLocker locker(&lock);
+    QHash<CRegion *, CRoomBitmap>::const_iterator i = regions.constFind(region);
+    if (i == regions.constEnd())
+        return QVector<unsigned int>();
+    return i.value().toList();
+}
+
+/* ------------------------------ query parser ------------------------------ */
+
+/* recursive descent over the tokens, evaluating while parsing:  */
+/*   expr   := term { ("or" | "|") term }                        */
+/*   term   := factor { ["and" | "&"] factor }                   */
+/*   factor := ("not" | "!") factor | "(" expr ")" | atom         */
+class CRoomIndex::Parser
+{
+    const CRoomIndex &index;
+    QVector<QByteArray> tokens;
+    int pos = 0;
+
+  public:
+    QString error;
+
+    Parser(const CRoomIndex &idx, const QByteArray &text) : index(idx)
+    {
+        QByteArray word;
+        for (char c : text) {
+            bool special = (c == '(' || c == ')' || c == '&' || c == '|' || c == '!');
+            if (special || c == ' ' || c == '\t') {
+                if (!word.isEmpty())
+                    tokens.append(word.toLower());
+                word.clear();
+                if (special)
+                    tokens.append(QByteArray(1, c));
+            } else {
+                word += c;
+            }
+        }
+        if (!word.isEmpty())
+            tokens.append(word.toLower());
+    }
+
+    bool atEnd() const { return pos >= tokens.size(); }
+    QByteArray peek() const { return atEnd() ? QByteArray() : tokens[pos]; }
+
+    bool fail(const QString &reason)
+    {
+        if (error.isEmpty())
+            error = reason;
+        return false;
+    }
+
+    bool parse(CRoomBitmap &result)
+    {
+        if (tokens.isEmpty())
+            return fail("Empty query.");
+        if (!expr(result))
+            return false;
+        if (!atEnd())
+            return fail(QString("Unexpected \"%1\".").arg(QString::fromUtf8(peek())));
+        return true;
+    }
+
+    bool expr(CRoomBitmap &result)
+    {
+        if (!term(result))
+            return false;
+        while (peek() == "or" || peek() == "|") {
+            CRoomBitmap right;
+            pos++;
+            if (!term(right))
+                return false;
+            result = result | right;
+        }
+        return true;
+    }
+
+    bool term(CRoomBitmap &result)
+    {
+        if (!factor(result))
+            return false;
+        while (!atEnd() && peek() != "or" && peek() != "|" && peek() != ")") {
+            CRoomBitmap right;
+            if (peek() == "and" || peek() == "&")
+                pos++;
+            if (!factor(right))
+                return false;
+            result = result & right;
+        }
+        return true;
+    }
+
+    bool factor(CRoomBitmap &result)
+    {
+        if (atEnd())
+            return fail("Unexpected end of the query.");
+
+        QByteArray token = tokens[pos++];
+        if (token == "not" || token == "!") {
+            CRoomBitmap inner;
+            if (!factor(inner))
+                return false;
+            result = index.all.andNot(inner);
+            return true;
+        }
+        if (token == "(") {
+            if (!expr(result))
+                return false;
+            if (peek() != ")")
+                return fail("Missing \")\".");
+            pos++;
+            return true;
+        }
+        return atom(token, result);
+    }
+
+    static int findName(const QByteArray &value, const char *(*nameOf)(int), int count)
+    {
+        for (int bit = 0; bit < count; bit++) {
+            QByteArray name = QByteArray(nameOf(bit)).toLower();
+            if (value == name || value == QByteArray(name).replace('_', '-'))
+                return bit;
+        }
+        return -1;
+    }
+
+    static int findType(const QByteArray &value, const char *(*nameOf)(uint8_t))
+    {
+        for (int type = 0; type < TYPE_VALUES; type++)
+            if (value == nameOf(type))
+                return type;
+        return -1;
+    }
+
+    bool atom(const QByteArray &token, CRoomBitmap &result)
+    {
+        int colon = token.indexOf(':');
+        QByteArray kind = colon == -1 ? QByteArray() : token.left(colon);
+        QByteArray value = colon == -1 ? token : token.mid(colon + 1);
+        int bit;
+
+        if (kind.isEmpty() && value == "all") {
+            result = index.all;
+            return true;
+        }
+        if ((kind.isEmpty() || kind == "mob") && (bit = findName(value, CRoom::mobFlagName, CRoom::MOB_FLAG_COUNT)) != -1) {
+            result = index.mob[bit];
+            return true;
+        }
+        if ((kind.isEmpty() || kind == "load") &&
+            (bit = findName(value, CRoom::loadFlagName, CRoom::LOAD_FLAG_COUNT)) != -1) {
+            result = index.load[bit];
+            return true;
+        }
+
+        static const struct
+        {
+            const char *kind;
+            int index;
+            const char *(*nameOf)(uint8_t);
+        } typeKinds[] = {{"light", LIGHT, CRoom::lightTypeToString},
+                         {"align", ALIGN, CRoom::alignTypeToString},
+                         {"portable", PORTABLE, CRoom::portableTypeToString},
+                         {"ridable", RIDABLE, CRoom::ridableTypeToString},
+                         {"sundeath", SUNDEATH, CRoom::sundeathTypeToString}};
+        for (const auto &t : typeKinds) {
+            if (kind != t.kind)
+                continue;
+            int type = findType(value, t.nameOf);
+            if (type == -1)
+                return fail(QString("Unknown %1 type \"%2\".").arg(t.kind, QString::fromUtf8(value)));
+            result = index.types[t.index][type];
+            return true;
+        }
+
+        if (kind == "terrain") {
+            for (unsigned int i = 0; i < conf->sectors.size() && i < SECTORS; i++)
+                if (conf->sectors[i].desc.toLower() == value) {
+                    result = index.sectors[i];
+                    return true;
+                }
+            return fail(QString("Unknown terrain \"%1\".").arg(QString::fromUtf8(value)));
+        }
+
+        if (kind == "region") {
+            result.clear();
+            for (QHash<CRegion *, CRoomBitmap>::const_iterator i = index.regions.constBegin();
+                 i != index.regions.constEnd(); ++i)
+                if (i.key()->getName().toLower() == value)
+                    result = result | i.value();
+            return true;
+        }
+
+        if (kind.isEmpty() || kind == "mob" || kind == "load")
+            return fail(QString("Unknown flag \"%1\".").arg(QString::fromUtf8(value)));
+        return fail(QString("Unknown kind \"%1\".").arg(QString::fromUtf8(kind)));
+    }
+};
+
+bool CRoomIndex::query(const QByteArray &text, CRoomBitmap &result, QString *error) const
+{
+    QReadLocker locker(&lock);
+    Parser parser(*this, text);
+
+    result.clear();
+    if (parser.parse(result))
+        return true;
+
+    result.clear();
+    if (error)
+        *error = parser.error;
+    return false;
+}
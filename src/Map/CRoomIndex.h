@@ -0,0 +1,96 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CROOMINDEX_H
+#define CROOMINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+#include "Map/CRoomBitmap.h"
+
+class CRoom;
+class CRegion;
+
+// Bitmap index over the MMapper flags and types, terrain and region of the
+// rooms in the map. CRoomManager adds and drops rooms, the CRoom setters
+// keep it up to date. Queries may run on any thread.
+//
+// Query language: terms joined with "and"/"&" (or just a space), "or"/"|",
+// "not"/"!" and parentheses. A term is a mob or load flag name (rent, shop,
+// boat, ...) or kind:value - mob:, load:, terrain:, region:, light:,
+// align:, portable:, ridable:, sundeath:. "all" matches every room.
+//   Example: rent and region:bree / terrain:water & (shop | load:boat)
+
+class CRoomIndex
+{
+  public:
+    enum TypeKinds
+    {
+        LIGHT = 0,
+        ALIGN,
+        PORTABLE,
+        RIDABLE,
+        SUNDEATH,
+        TYPE_KINDS
+    };
+
+  private:
+    static const int TYPE_VALUES = 4;
+    static const int SECTORS = 256;
+
+    mutable QReadWriteLock lock;
+    CRoomBitmap all;
+    CRoomBitmap mob[32];
+    CRoomBitmap load[32];
+    CRoomBitmap types[TYPE_KINDS][TYPE_VALUES];
+    CRoomBitmap sectors[SECTORS];
+    QHash<CRegion *, CRoomBitmap> regions;
+
+    static void changeBits(CRoomBitmap *bitmaps, unsigned int id, uint32_t from, uint32_t to);
+
+    class Parser;
+
+  public:
+    void addRoom(CRoom *room);
+    void removeRoom(CRoom *room);
+    void clear();
+
+    void changeMobFlags(unsigned int id, uint32_t from, uint32_t to);
+    void changeLoadFlags(unsigned int id, uint32_t from, uint32_t to);
+    void changeType(int kind, unsigned int id, uint8_t from, uint8_t to);
+    void changeSector(unsigned int id, char from, char to);
+    void changeRegion(unsigned int id, CRegion *from, CRegion *to);
+
+    int size() const;
+    // ids of the rooms currently in the region
+    QVector<unsigned int> regionMembers(CRegion *region) const;
+
+    // Evaluates the query, on a syntax error returns false with the reason in *error
+    bool query(const QByteArray &text, CRoomBitmap &result, QString *error = nullptr) const;
+};
+
+extern class CRoomIndex FlagIndex;
+
+#endif
@@ -24,19 +24,20 @@
 #include <cstring>
 #include <QDateTime>
 #include <vector>
-#include <QProgressDialog>
 // using namespace std;
 
 #include "defines.h"
 #include "CConfigurator.h"
 #include "utils.h"
 
+#include "Map/CMapTransaction.h"
+#include "Map/CRoomIndex.h"
 #include "Map/CRoomManager.h"
 #include "Map/CTree.h"
 
+#include "Engine/CSession.h"
 #include "Engine/CStacksManager.h"
 #include "Proxy/CDispatcher.h"
-#include "Gui/mainwindow.h"
 
 class CRoomManager Map;
 
@@ -47,78 +48,9 @@ void CRoomManager::rebuildRegion(CRegion *reg)
     if (reg == nullptr)
         return;
 
-    QVector<CRoom *> rooms = getRooms();
-    for (unsigned int i = 0; i < size(); i++) {
-        CRoom *r = rooms[i];
-        if (r->getRegion() == reg)
-            // this only sets a flag, so it should not be a problem to "rebuild" squares list multiple times
-            r->rebuildDisplayList();
-    }
-}
-
-void CRoomManager::clearAllSecrets()
-{
-    bool mark[MAX_ROOMS];
-    CRoom *r;
-    unsigned int i;
-    unsigned int z;
-
-    // "wave" over all rooms reacheable over non-secret exits.
-    memset(mark, 0, MAX_ROOMS);
-    stacker.reset();
-    stacker.put(1);
-    stacker.swap();
-
-    Map.setBlocked(true);
-
-    QProgressDialog progress("Removing secret exits...", "Abort", 0, MAX_ROOMS, renderer_window);
-    progress.setWindowModality(Qt::ApplicationModal);
-    progress.show();
-
-    // lockForWrite();
-    while (stacker.amount() != 0) {
-        for (i = 0; i < stacker.amount(); i++) {
-            progress.setValue(i);
-            r = stacker.get(i);
-            mark[r->id] = true;
-            for (z = 0; z <= 5; z++)
-                if (r->isConnected(z) && mark[r->exits[z]->id] != true && r->isDoorSecret(z) != true)
-                    stacker.put(r->exits[z]->id);
-        }
-        stacker.swap();
-    }
-
-    progress.setValue(0);
-    // delete all unreached rooms
-    for (i = 0; i < MAX_ROOMS; i++) {
-        progress.setValue(i);
-        r = getRoom(i);
-        if (r == nullptr)
-            continue;
-        if (r) {
-            if (mark[r->id] == false) {
-                deleteRoom(r, 0);
-                continue;
-            }
-        }
-    }
-
-    QVector<CRoom *> rooms = getRooms();
-    // roll over all still accessible rooms and delete the secret doors if they are still left in the database
-    for (i = 0; i < size(); i++) {
-        r = rooms[i];
-        if (r) {
-            for (z = 0; z <= 5; z++) {
-                if (r->isDoorSecret(z) == true) {
-                    print_debug(DEBUG_ROOMS, "Secret door was still in database...\r\n");
-                    r->removeDoor(z);
-                }
-            }
-        }
-    }
-
-    Map.setBlocked(false);
-    // unlock();
+    for (CRoom *r = reg->firstMember(); r != nullptr; r = r->nextInRegion())
+        // this only sets a flag, so it should not be a problem to "rebuild" squares list multiple times
+        r->rebuildDisplayList();
 }
 
 bool CRoomManager::isDuplicate(CRoom *addedroom)
@@ -140,7 +72,7 @@ bool CRoomManager::isDuplicate(CRoom *addedroom)
 
     if (conf->getAutomerge() == false) {
         print_debug(DEBUG_ANALYZER, "autodesc check if OFF - quiting this routine.\n");
-        stacker.put(addedroom);
+        stacker->put(addedroom);
 
         return false;
     }
@@ -182,7 +114,7 @@ bool CRoomManager::isDuplicate(CRoom *addedroom)
     /* if we are still here, then we didnt manage to merge the room */
     /* so put addedroom->id in stack */
     print_debug(DEBUG_ANALYZER, "------- Returning with return 0\r\n");
-    stacker.put(engine->addedroom);
+    stacker->put(engine->addedroom);
     return false;
 }
 
@@ -227,7 +159,7 @@ int CRoomManager::tryMergeRooms(CRoom *r, CRoom *copy, int j)
 
         smallDeleteRoom(copy);
 
-        stacker.put(r);
+        stacker->put(r);
         return 1;
     }
     if (r->isExitUndefined(j)) {
@@ -239,7 +171,7 @@ int CRoomManager::tryMergeRooms(CRoom *r, CRoom *copy, int j)
 
         smallDeleteRoom(copy);
 
-        stacker.put(r);
+        stacker->put(r);
         return 1;
     }
     return 0;
@@ -276,18 +208,50 @@ void CRoomManager::addRoom(CRoom *room)
     rooms.push_back(room);
     ids[room->id] = room;                       /* add to the first array */
     NameMap.addName(room->getName(), room->id); /* update name-searhing engine */
+    room->indexFlags();                         /* and the flags bitmaps */
+    room->listInRegion();                       /* and the member list of its region */
 
     fixFreeRooms();
     addToPlane(room);
+    touch();
 }
 /* ------------ addroom ENDS ---------- */
 
+/* a change of the rooms list. Published right away unless a bulk change */
+/* is running - publishing on every add would make the next push_back    */
+/* copy the whole vector                                                 */
+void CRoomManager::touch(bool forcePublish)
+{
+    version.fetchAndAddOrdered(1);
+    snapshotDirty = true;
+    if (forcePublish || !blocked)
+        publishSnapshot();
+}
+
+void CRoomManager::publishSnapshot()
+{
+    if (!snapshotDirty && published)
+        return;
+
+    std::shared_ptr<CMapSnapshot> snap = std::make_shared<CMapSnapshot>();
+    snap->version = version.loadAcquire();
+    snap->rooms = rooms;
+    std::atomic_store(&published, std::shared_ptr<const CMapSnapshot>(snap));
+    snapshotDirty = false;
+
+    epoch.collect();
+}
+
 /*------------- Constructor of the room manager ---------------*/
 CRoomManager::CRoomManager()
 {
     // Initialize pointers to safe values before reinit() tries to delete them
     planes = nullptr;
     blocked = false;
+    transaction = nullptr;
+    version.storeRelaxed(0);
+    snapshotDirty = true;
+    graphRevision.storeRelaxed(0);
 
     reinit();
 }
@@ -297,13 +261,7 @@ CRegion *CRoomManager::getRegionByName(QByteArray name)
 {
     // TODO: threadsafety the class regions QMutexLocker locker(mapLock);
 
-    CRegion *region;
-    for (int i = 0; i < regions.size(); i++) {
-        region = regions[i];
-        if (region->getName() == name)
-            return region;
-    }
-    return nullptr;
+    return regionsByName.value(name, nullptr);
 }
 
 bool CRoomManager::addRegion(QByteArray name)
@@ -315,6 +273,7 @@ bool CRoomManager::addRegion(QByteArray name)
         region = new CRegion();
         region->setName(name);
         regions.push_back(region);
+        regionsByName.insert(name, region);
         return true;
     } else {
         return false;
@@ -325,8 +284,10 @@ void CRoomManager::addRegion(CRegion *reg)
 {
     // TODO: threadsafety the class regions QMutexLocker locker(mapLock);
 
-    if (reg != nullptr && getRegionByName(reg->getName()) == nullptr)
+    if (reg != nullptr && getRegionByName(reg->getName()) == nullptr) {
         regions.push_back(reg);
+        regionsByName.insert(reg->getName(), reg);
+    }
 }
 
 void CRoomManager::sendRegionsList()
@@ -473,6 +434,10 @@ void CRoomManager::reinit()
     print_debug(DEBUG_ROOMS, "CRoomManager::reinit() - clearing %d rooms, %d regions\r\n",
                 rooms.size(), regions.size());
 
+    // The stacks of every session keep room ids, the map was empty in the constructor
+    if (!rooms.isEmpty())
+        CSession::forgetAllRooms();
+
     // Reset counters
     next_free = 1;
     nextLocalSpaceId = 1;
@@ -480,14 +445,15 @@ void CRoomManager::reinit()
     // Clear local spaces
     localSpaces.clear();
 
-    // Delete and clear all regions, then create fresh default region
-    for (int i = 0; i < regions.size(); i++) {
-        delete regions[i];
-    }
+    // Unlink regions and rooms now, free them once no reader can see them
+    QList<CRegion *> oldRegions = regions;
+    QVector<CRoom *> oldRooms = rooms;
     regions.clear();
+    regionsByName.clear();
     CRegion *defaultRegion = new CRegion;
     defaultRegion->setName("default");
     regions.push_back(defaultRegion);
+    regionsByName.insert(defaultRegion->getName(), defaultRegion);
 
     // Delete all planes (linked list)
     CPlane *p = planes;
@@ -498,17 +464,26 @@ void CRoomManager::reinit()
     }
     planes = nullptr;
 
-    // Delete all room objects
-    for (int i = 0; i < rooms.size(); i++) {
-        delete rooms[i];
-    }
     rooms.clear();
 
     // Clear the ID lookup array
     memset(ids, 0, MAX_ROOMS * sizeof(CRoom *));
 
-    // Reset the name search tree
+    // Reset the name search tree and flag index, the retired rooms must not touch them any more
     NameMap.reinit();
+    FlagIndex.clear();
+    pager.clear();
+    for (int i = 0; i < oldRooms.size(); i++) {
+        oldRooms[i]->unindexName(false);
+        oldRooms[i]->unindexFlags(false);
+    }
+
+    touch(true);
+    epoch.retire([oldRooms, oldRegions]() {
+        qDeleteAll(oldRooms);
+        qDeleteAll(oldRegions);
+    });
+    epoch.collect();
 
     print_debug(DEBUG_ROOMS, "CRoomManager::reinit() complete\r\n");
 }
@@ -531,6 +506,8 @@ void CRoomManager::deleteRoom(CRoom *r, int mode)
     for (i = 0; i < rooms.size(); i++)
         for (k = 0; k <= 5; k++)
             if (rooms[i]->isExitLeadingTo(k, r) == true) {
+                if (transaction)
+                    transaction->edit(rooms[i]);
                 if (mode == 0) {
                     rooms[i]->removeExit(k);
                 } else if (mode == 1) {
@@ -551,15 +528,21 @@ void CRoomManager::smallDeleteRoom(CRoom *r)
         return;
     }
 
+    if (transaction) {
+        transaction->edit(r);
+        transaction->saveMembership(r);
+    }
+
     removeFromPlane(r);
-    stacker.removeRoom(r->id);
+    CSession::forgetRoom(r);
     selections.unselect(r->id);
-    if (engine->addedroom == r)
-        engine->resetAddedRoomVar();
 
-    renderer_window->renderer->deletedRoom = r->id;
+    notify_room_deleted(r->id);
 
     int i;
+    r->unindexName();
+    r->unindexFlags();
+    r->unlistFromRegion();
     ids[r->id] = nullptr;
 
     for (i = 0; i < rooms.size(); i++)
@@ -569,7 +552,16 @@ void CRoomManager::smallDeleteRoom(CRoom *r)
             break;
         }
 
-    delete r;
+    /* a map transaction frees it on commit or brings it back on rollback */
+    if (transaction) {
+        transaction->deferDeletion(r);
+        return;
+    }
+
+    // readers may still hold it - unpublish first, free after they leave
+    touch(true);
+    epoch.retire(r);
+    epoch.collect();
 
     fixFreeRooms();
     toggle_renderer_reaction();
@@ -589,12 +581,11 @@ void CRoomManager::removeFromPlane(CRoom *room)
         return;
 
     p = planes;
-    while (p->z != room->getZ()) {
-        if (!p) {
-            print_debug(DEBUG_ROOMS, " FATAL ERROR. remove_fromplane() the given has impossible Z coordinate!\r\n");
-            return; /* no idea what happens next ... */
-        }
+    while (p && p->z != room->getZ())
         p = p->next;
+    if (!p) {
+        print_debug(DEBUG_ROOMS, " FATAL ERROR. remove_fromplane() the given has impossible Z coordinate!\r\n");
+        return; /* no idea what happens next ... */
     }
 
     p->squares->remove(room);
@@ -682,7 +673,10 @@ QList<int> CRoomManager::searchNames(QString s, Qt::CaseSensitivity cs)
 {
     QList<int> results;
 
-    //    QReadLocker locker(&mapLock);
+    // a stable list even if the map changes meanwhile
+    CEpochGuard guard(epoch);
+    std::shared_ptr<const CMapSnapshot> snap = snapshot();
+    const QVector<CRoom *> &rooms = snap->rooms;
 
     for (int i = 0; i < rooms.size(); i++) {
         if (QString(rooms[i]->getName()).contains(s, cs)) {
@@ -697,7 +691,10 @@ QList<int> CRoomManager::searchDescs(QString s, Qt::CaseSensitivity cs)
 {
     QList<int> results;
 
-    //    QReadLocker locker(&mapLock);
+    // a stable list even if the map changes meanwhile
+    CEpochGuard guard(epoch);
+    std::shared_ptr<const CMapSnapshot> snap = snapshot();
+    const QVector<CRoom *> &rooms = snap->rooms;
 
     for (int i = 0; i < rooms.size(); i++) {
         if (QString(rooms[i]->getDesc()).contains(s, cs)) {
@@ -712,7 +709,10 @@ QList<int> CRoomManager::searchNotes(QString s, Qt::CaseSensitivity cs)
 {
     QList<int> results;
 
-    //    QReadLocker locker(&mapLock);
+    // a stable list even if the map changes meanwhile
+    CEpochGuard guard(epoch);
+    std::shared_ptr<const CMapSnapshot> snap = snapshot();
+    const QVector<CRoom *> &rooms = snap->rooms;
 
     for (int i = 0; i < rooms.size(); i++) {
         if (QString(rooms[i]->getNote()).contains(s, cs)) {
@@ -727,7 +727,10 @@ QList<int> CRoomManager::searchExits(QString s, Qt::CaseSensitivity cs)
 {
     QList<int> results;
 
-    //    QReadLocker locker(&mapLock);
+    // a stable list even if the map changes meanwhile
+    CEpochGuard guard(epoch);
+    std::shared_ptr<const CMapSnapshot> snap = snapshot();
+    const QVector<CRoom *> &rooms = snap->rooms;
 
     for (int i = 0; i < rooms.size(); i++) {
         for (int j = 0; j <= 5; j++) {
@@ -21,21 +21,27 @@
 #ifndef ROOMSMANAGER_H
 #define ROOMSMANAGER_H
 
+#include <QAtomicInteger>
+#include <QHash>
 #include <QVector>
 #include <QObject>
 #include <QThread>
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
+#include <memory>
 
 #include "defines.h"
 
 #include "Map/CRoom.h"
 #include "Map/CRegion.h"
+#include "Map/CMapEpoch.h"
+#include "Map/CRegionPager.h"
 #include "Gui/CSelectionManager.h"
 
 class CPlane;
 class CSquare;
+class CMapTransaction;
 
 struct LocalSpace
 {
@@ -56,11 +62,22 @@ struct LocalSpace
     float maxZ;
 };
 
+/* published list of rooms, never changed after publishing. Only the list: */
+/* the rooms in it are the live ones                                       */
+struct CMapSnapshot
+{
+    quint64 version;
+    QVector<CRoom *> rooms;
+};
+
 class CRoomManager : public QObject
 {
     Q_OBJECT
 
-    QList<CRegion *> regions;
+    friend class CMapTransaction;
+
+    QList<CRegion *> regions;                    /* in the order they were added */
+    QHash<QByteArray, CRegion *> regionsByName; /* the same, for getRegionByName() */
     QVector<CRoom *> rooms; /* rooms */
     CRoom *ids[MAX_ROOMS];  /* array of pointers */
     QVector<LocalSpace> localSpaces;
@@ -70,6 +87,14 @@ class CRoomManager : public QObject
 
     bool blocked;
 
+    /* RCU style publishing of the rooms list, see snapshot() */
+    std::shared_ptr<const CMapSnapshot> published;
+    QAtomicInteger<quint64> version; /* both read on other threads */
+    bool snapshotDirty;
+    QAtomicInteger<quint64> graphRevision;
+
+    void touch(bool forcePublish = false);
+
   public:
     CRoomManager();
     virtual ~CRoomManager();
@@ -83,7 +108,27 @@ class CRoomManager : public QObject
 
     unsigned int size() { return rooms.size(); }
 
+    /* For readers of the room list on other threads (layout, paths, graph, */
+    /* checker, searches): enter the epoch (CEpochGuard guard(Map.epoch))   */
+    /* and then take a snapshot. Rooms of the snapshot stay allocated until */
+    /* the guard is gone, even if they are deleted from the map meanwhile.  */
+    /* It is not a stable view of the rooms - their fields are written in  */
+    /* place. The renderer and the engine run on the thread that does the  */
+    /* writes, walk the live map and wait out bulk changes (isBlocked()).   */
+    CMapEpoch epoch;
+    std::shared_ptr<const CMapSnapshot> snapshot() const { return std::atomic_load(&published); }
+    quint64 getVersion() const { return version.loadAcquire(); }
+    void publishSnapshot();
+    /* bumped when exits, doors, terrain or load flags of a room change,   */
+    /* copies of the exit graph (CMapPath) check it next to getVersion()   */
+    quint64 getGraphRevision() const { return graphRevision.loadAcquire(); }
+    void graphChanged() { graphRevision.fetchAndAddOrdered(1); }
+
     CSelectionManager selections;
+    CRegionPager pager;
+
+    /* the open bulk edit, nullptr if none. See CMapTransaction */
+    CMapTransaction *transaction;
 
     /* plane support */
     void addToPlane(CRoom *room);
@@ -138,10 +183,16 @@ class CRoomManager : public QObject
     CRoom *findDuplicateRoom(CRoom *orig);
 
     void loadMap(QString filename);
-    void saveMap(QString filename);
-    void clearAllSecrets();
+    bool saveMap(QString filename); /* false if nothing was written */
 
-    void setBlocked(bool b) { blocked = b; }
+    /* bulk changes block the map, the snapshot is published when they end. */
+    /* An open transaction keeps the map blocked until it ends itself.      */
+    void setBlocked(bool b)
+    {
+        blocked = b || transaction != nullptr;
+        if (!blocked)
+            publishSnapshot();
+    }
     bool isBlocked() { return blocked; }
 };
 
@@ -24,6 +24,7 @@
 
 #include "defines.h"
 #include "utils.h"
+#include "CMemoryStats.h"
 #include "Map/CTree.h"
 
 class CTree NameMap;
@@ -33,6 +34,7 @@ void CTree::removeId(unsigned int id, TTree *p)
     for (int i = 0; i < p->ids.size(); ++i)
         if (p->ids[i] == id) {
             p->ids.remove(i);
+            MemoryStats.add(CMemoryStats::MEM_NAME_TREE, -qint64(sizeof(unsigned int)));
             return;
         }
 }
@@ -84,6 +86,8 @@ void CTree::reinit()
     deleteAll(root);
 
     root = new TTree;
+
+    MemoryStats.add(CMemoryStats::MEM_NAME_TREE, sizeof(TTree), 1);
     resetTTree(root);
 }
 
@@ -100,6 +104,7 @@ void CTree::deleteAll(TTree *t)
             deleteAll(t->leads[i]);
         }
 
+    MemoryStats.add(CMemoryStats::MEM_NAME_TREE, -qint64(sizeof(TTree) + t->ids.size() * sizeof(unsigned int)), -1);
     delete t;
 }
 
@@ -116,6 +121,7 @@ int CTree::divingDelete(TTree *p, char *part, unsigned int id)
 
         removeId(id, p);
         if (p->ids.empty()) {
+            MemoryStats.add(CMemoryStats::MEM_NAME_TREE, -qint64(sizeof(TTree)), -1);
             delete p;
             return 1;
         }
@@ -142,6 +148,7 @@ int CTree::divingDelete(TTree *p, char *part, unsigned int id)
             return -1; /* no still in use ! */
 
     /* else ! we have to delete it ... */
+    MemoryStats.add(CMemoryStats::MEM_NAME_TREE, -qint64(sizeof(TTree)), -1);
     delete p;
     return 1; /* deleted ! so ... */
 }
@@ -161,6 +168,7 @@ void CTree::deleteItem(const char *name, unsigned int id)
             if (divingDelete(root, hash, id) == 1) {
                 /* meaning - occasionally freed our ROOT element */
                 root = new TTree;
+                MemoryStats.add(CMemoryStats::MEM_NAME_TREE, sizeof(TTree), 1);
                 resetTTree(root);
                 return;
             } else
@@ -175,12 +183,14 @@ void CTree::resetTTree(TTree *t)
 
     for (i = 0; i < A_SIZE; i++)
         t->leads[i] = nullptr;
+    MemoryStats.add(CMemoryStats::MEM_NAME_TREE, -qint64(t->ids.size() * sizeof(unsigned int)));
     t->ids.clear();
 }
 
 CTree::CTree()
 {
     root = new TTree;
+    MemoryStats.add(CMemoryStats::MEM_NAME_TREE, sizeof(TTree), 1);
     resetTTree(root);
 }
 
@@ -201,6 +211,7 @@ void CTree::addName(const char *name, unsigned int id)
         } else {
             /* there is no line like this in tree yet - we have to create new lead */
             n = new TTree;
+            MemoryStats.add(CMemoryStats::MEM_NAME_TREE, sizeof(TTree), 1);
             resetTTree(n);
 
             p->leads[(int)hash[i]] = n;
@@ -209,8 +220,10 @@ void CTree::addName(const char *name, unsigned int id)
     }
 
     /* ok, we found totaly similar or created new entry, add id to it */
-    if (p->ids.contains(id) == false)
+    if (p->ids.contains(id) == false) {
         p->ids.push_back(id);
+        MemoryStats.add(CMemoryStats::MEM_NAME_TREE, sizeof(unsigned int));
+    }
 }
 
 TTree *CTree::findByName(const char *name)
@@ -43,9 +43,8 @@
 #include "Engine/CStacksManager.h"
 #include "Engine/CEngine.h"
 
-#include "GroupManager/CGroup.h"
+#include "GroupManager/CGroupCharState.h"
 
-#include "Gui/mainwindow.h"
 
 static QRegularExpression makeWildcardRegex(const QByteArray &pattern, Qt::CaseSensitivity sensitivity)
 {
@@ -57,7 +56,7 @@ static QRegularExpression makeWildcardRegex(const QByteArray &pattern, Qt::CaseS
     return QRegularExpression(QRegularExpression::anchoredPattern(regex), options);
 }
 
-Cdispatcher::Cdispatcher()
+Cdispatcher::Cdispatcher(CDispatcherSink *sink) : sink(sink)
 {
     xmlState = STATE_NORMAL;
     mbrief_state = STATE_NORMAL;
@@ -584,7 +583,8 @@ int Cdispatcher::analyzeMudStream(ProxySocket &c)
                 // TODO: this prompt setting might be dangerous and non-thread safe!
                 engine->setPrompt(event.prompt);
                 lastPrompt = event.prompt;
-                proxy->sendPromptLineEvent(event.prompt);
+                if (sink)
+                    sink->sendPromptLineEvent(event.prompt);
                 event.terrain = parseTerrain(event.prompt);
                 SEND_EVENT_TO_ENGINE;
                 xmlState = STATE_NORMAL;
@@ -615,9 +615,8 @@ int Cdispatcher::analyzeMudStream(ProxySocket &c)
         if (mbrief_state == STATE_DESC && conf->getBriefMode())
             continue;
 
-        printf("xmlState: %i, buff type %i, line: ...%s...\r\n", xmlState, buffer[i].type,
-               (const char *)buffer[i].line);
-        fflush(stdout);
+        print_debug(DEBUG_DISPATCHER, "xmlState: %i, buff type %i, line: ...%s...", xmlState, buffer[i].type,
+                    (const char *)buffer[i].line);
 
         if (xmlState == STATE_NORMAL && buffer[i].type == IS_NORMAL) {
             QByteArray a_line = cutColours(buffer[i].line);
@@ -627,8 +626,7 @@ int Cdispatcher::analyzeMudStream(ProxySocket &c)
                 continue;
             }
 
-            printf("a_line: %s\r\n", (const char *)a_line);
-            fflush(stdout);
+            print_debug(DEBUG_DISPATCHER, "a_line: %s", (const char *)a_line);
 
             checkStateChange(a_line);
 
@@ -665,7 +663,8 @@ int Cdispatcher::analyzeMudStream(ProxySocket &c)
             // inform groupManager
             QString lineText = QString::fromLatin1(a_line);
             if (scoreExp.match(lineText).hasMatch() || scoreTrollExp.match(lineText).hasMatch()) {
-                proxy->sendScoreLineEvent(a_line);
+                if (sink)
+                    sink->sendScoreLineEvent(a_line);
             }
 
             // all necessary spells up/down/refresh lines checks
@@ -742,7 +741,8 @@ int Cdispatcher::analyzeUserStream(ProxySocket &c)
                 int len = buffer[i].line.size() - GTellCommand.length();  // 10 is length of "tell Group "
                 QByteArray data = buffer[i].line.right(len);
                 print_debug(DEBUG_GROUP, "Sending a G-tell from local user: %s", (const char *)data);
-                proxy->sendGroupTellEvent(data);
+                if (sink)
+                    sink->sendGroupTellEvent(data);
                 send_to_user("Ok.\r\n\r\n");
                 send_to_user(lastPrompt);
                 //                send_prompt();
@@ -774,10 +774,14 @@ char Cdispatcher::parseTerrain(QByteArray prompt)
 
 void Cdispatcher::checkStateChange(QByteArray line)
 {
+    /* the states only go to the group manager */
+    if (sink == nullptr)
+        return;
+
     // DEAD STATE
     // timer in CGroup turns this even off
     if (line == "You are dead! Sorry...") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::DEAD);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::DEAD);
         return;
     }
 
@@ -786,58 +790,58 @@ void Cdispatcher::checkStateChange(QByteArray line)
         makeWildcardRegex("* sends you sprawling with a powerful bash.", Qt::CaseSensitive);
     if (bashed.match(QString::fromLatin1(line)).hasMatch()) {
         printf("bash matches!\r\n");
-        proxy->sendCharStateUpdatedEvent(CGroupChar::BASHED);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::BASHED);
         return;
     }
 
     if (line == "Your head stops stinging.") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::STANDING);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::STANDING);
     }
 
     // SLEEPING
     if (line == "You go to sleep." || line == "You feel very sleepy... zzzzzz" || line == "In your dreams, or what?") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::SLEEPING);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::SLEEPING);
         return;
     }
 
     if (line == "You wake, and sit up.") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::RESTING);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::RESTING);
         return;
     }
 
     // hmmm
     //    if (line == "You feel less tired.") {
-    //        proxy->sendCharStateUpdatedEvent(CGroupChar::RESTING);
+    //        sink->sendCharStateUpdatedEvent(CGroupCharState::RESTING);
     //        return;
     //    }
 
     // RESTING
     if (line == "You sit down." || line == "You sit down and rest your tired bones.") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::RESTING);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::RESTING);
         return;
     }
 
     if (line == "You stop resting, and stand up.") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::STANDING);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::STANDING);
         return;
     }
 
     if (line == "You stand up.") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::STANDING);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::STANDING);
         return;
     }
 
     // INCAP
     if (line == "You're stunned and will probably die soon if no-one helps you." ||
         line == "You are incapacitated and will slowly die, if not aided.") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::INCAP);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::INCAP);
         return;
     }
     // the only way to leave incap is either to die or to improve from HP:Dying to something else!
 
     // DEAD
     if (line == "You are dead! Sorry...") {
-        proxy->sendCharStateUpdatedEvent(CGroupChar::STANDING);
+        sink->sendCharStateUpdatedEvent(CGroupCharState::STANDING);
         return;
     }
 }
@@ -851,7 +855,8 @@ void Cdispatcher::updateSpellsState(QByteArray line)
             conf->spells[p].timer.start();  // start counting
             conf->spells[p].up = true;
             conf->spells[p].silently_up = false;
-            proxy->sendSpellsUpdatedEvent();
+            if (sink)
+                sink->sendSpellsUpdatedEvent();
             break;
         }
 
@@ -861,7 +866,8 @@ void Cdispatcher::updateSpellsState(QByteArray line)
             conf->spells[p].silently_up = false;
             print_debug(DEBUG_SPELLS, "SPELL: %s is DOWN. Uptime: %s.", (const char *)conf->spells[p].name,
                         qPrintable(conf->spellUpFor(p)));
-            proxy->sendSpellsUpdatedEvent();
+            if (sink)
+                sink->sendSpellsUpdatedEvent();
             break;
         }
     }
@@ -881,7 +887,8 @@ QByteArray Cdispatcher::checkAffectedByLine(QByteArray line)
                 } else {
                     s = QString("- %1 (unknown time)\r\n").arg((const char *)conf->spells[p].name);
                     conf->spells[p].silently_up = true;
-                    proxy->sendSpellsUpdatedEvent();
+                    if (sink)
+                        sink->sendSpellsUpdatedEvent();
                 }
 
                 return qPrintable(s);
@@ -37,6 +37,8 @@ struct Tincoming_line
 
 class Cdispatcher
 {
+    friend class BenchHotPaths; /* tests/benchmarks feeds dispatchBuffer() directly */
+
     struct Tincoming_line buffer[4096];
     int amount;
     QByteArray commandBuffer;
@@ -49,6 +51,8 @@ class Cdispatcher
 
     QByteArray lastPrompt;
 
+    CDispatcherSink *sink; /* may be null, see CDispatcherSink */
+
     enum dispatcherStates
     {
         STATE_NORMAL = 0,
@@ -146,7 +150,7 @@ class Cdispatcher
     int analyzeMudStream(ProxySocket &c);
     int analyzeUserStream(ProxySocket &c);
 
-    Cdispatcher();
+    explicit Cdispatcher(CDispatcherSink *sink = nullptr);
 };
 
 // extern class Cdispatcher *dispatcher;
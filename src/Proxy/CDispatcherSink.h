@@ -0,0 +1,42 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CDISPATCHERSINK_H
+#define CDISPATCHERSINK_H
+
+#include <QByteArray>
+
+// What Cdispatcher spots in the stream besides the engine events. Proxy
+// passes it on to the group manager and the spells dialog. A dispatcher
+// without a sink (offline ingest, benchmarks) drops it
+
+class CDispatcherSink
+{
+  public:
+    virtual ~CDispatcherSink() {}
+
+    virtual void sendGroupTellEvent(QByteArray data) = 0;
+    virtual void sendScoreLineEvent(QByteArray data) = 0;
+    virtual void sendPromptLineEvent(QByteArray data) = 0;
+    virtual void sendSpellsUpdatedEvent() = 0;
+    virtual void sendCharStateUpdatedEvent(int state) = 0;
+};
+
+#endif
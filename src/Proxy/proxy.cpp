@@ -63,19 +63,26 @@
 
 #include "Map/CRoomManager.h"
 
-#include "Gui/mainwindow.h"
-
 #include "Engine/CEngine.h"
 #include "Engine/CStacksManager.h"
 
-class Proxy *proxy;
+thread_local class Proxy *proxy = nullptr;
 
 #ifdef DEBUG
 #define DEBUG_FILE_NAME "completelog.txt"
 FILE *debug_file;
 #endif
 
-Proxy::Proxy() : mud(std::make_unique<ProxySocket>(this, true)), user(std::make_unique<ProxySocket>(this, false)) {}
+Proxy::Proxy()
+    : mud(std::make_unique<ProxySocket>(this, true)), user(std::make_unique<ProxySocket>(this, false)), session(nullptr)
+{
+}
+
+/* every session listens on its own port */
+int Proxy::getLocalPort()
+{
+    return session ? session->getLocalPort() : conf->getLocalPort();
+}
 
 Proxy::~Proxy()
 {
@@ -120,7 +127,7 @@ int Proxy::init()
 
     proxy_name.sin_family = AF_INET;
     proxy_name.sin_addr.s_addr = INADDR_ANY;
-    proxy_name.sin_port = htons(conf->getLocalPort());
+    proxy_name.sin_port = htons(getLocalPort());
 
     sockaddr_in service;
     // iResult = bind(ListenSocket, (SOCKADDR *) &service, sizeof (service));
@@ -133,8 +140,8 @@ int Proxy::init()
     }
 
     print_debug(DEBUG_PROXY, "Proxy: ready and listening...\r\n");
-    emit log("MUD Proxy", QString("OK! Waiting for connection on port %1").arg(conf->getLocalPort()));
-    emit log("MUD Proxy", QString("Hint: Connect to localhost:%1 in your MUD client").arg(conf->getLocalPort()));
+    emit log("MUD Proxy", QString("OK! Waiting for connection on port %1").arg(getLocalPort()));
+    emit log("MUD Proxy", QString("Hint: Connect to localhost:%1 in your MUD client").arg(getLocalPort()));
     listen(proxy_hangsock, 3);
 
     return 0;
@@ -230,11 +237,14 @@ int Proxy::loop(void)
 
 void Proxy::run()
 {
-    int inited = proxy->init();
+    if (session)
+        session->bind();
+
+    int inited = init();
 
     mud->clear();
     user->clear();
-    dispatcher = std::make_unique<Cdispatcher>();
+    dispatcher = std::make_unique<Cdispatcher>(this);
 
     // well, otherwise we cannot start listening
     if (inited != -1)
@@ -257,10 +267,10 @@ void Proxy::sendMudEmulationGreeting()
 
     user->send_line("Welcome to PandoraMapper MUD Emulation!\r\n\r\n");
 
-    if (stacker.amount() == 0)
+    if (stacker->amount() == 0)
         r = Map.getRoom(1);
     else
-        r = stacker.first();
+        r = stacker->first();
 
     if (r != nullptr)
         r->sendRoom();
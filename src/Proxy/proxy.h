@@ -26,6 +26,8 @@
 #include <QThread>
 #include <memory>
 
+#include "Proxy/CDispatcherSink.h"
+
 #if defined Q_OS_LINUX || defined Q_OS_MACX || defined Q_OS_FREEBSD
 #define SOCKET int
 #elif defined Q_OS_WIN32
@@ -58,6 +60,7 @@
 #define TN_EOF 236
 #define LAST_TN_CMD 236
 
+class CSession;
 class Cdispatcher;
 class Proxy;
 
@@ -121,7 +124,7 @@ class ProxySocket
 };
 
 /* PROXY THREAD DEFINES */
-class Proxy : public QThread
+class Proxy : public QThread, public CDispatcherSink
 {
     Q_OBJECT
 
@@ -130,6 +133,7 @@ class Proxy : public QThread
     SOCKET proxy_hangsock;
 
     std::unique_ptr<Cdispatcher> dispatcher;
+    CSession *session; /* bound by the proxy thread, see CSession */
 
     int loop();
     bool mudEmulation;
@@ -148,16 +152,18 @@ class Proxy : public QThread
     void send_line_to_mud(const char *line);
     bool isMudEmulation() { return mudEmulation; }
     void setMudEmulation(bool b);
+    void setSession(CSession *s) { session = s; }
+    int getLocalPort();
     void shutdown();
 
     void startEngineCall() { emit startEngine(); }
     void startRendererCall() { emit startRenderer(); }
 
-    void sendGroupTellEvent(QByteArray data);
-    void sendScoreLineEvent(QByteArray data);
-    void sendPromptLineEvent(QByteArray data);
-    void sendSpellsUpdatedEvent() { emit sendSpellsUpdate(); }
-    void sendCharStateUpdatedEvent(int state) { emit sendCharStateUpdate(state); }
+    void sendGroupTellEvent(QByteArray data) override;
+    void sendScoreLineEvent(QByteArray data) override;
+    void sendPromptLineEvent(QByteArray data) override;
+    void sendSpellsUpdatedEvent() override { emit sendSpellsUpdate(); }
+    void sendCharStateUpdatedEvent(int state) override { emit sendCharStateUpdate(state); }
 
     void sendLog(const QString &message) { emit log("Network", message); }
     void sendLog(const QString &module, const QString &message) { emit log(module, message); }
@@ -177,6 +183,7 @@ class Proxy : public QThread
 
 /* PROX THREAD ENDS */
 
-extern class Proxy *proxy;
+/* proxy of the session of the calling thread, see CSession */
+extern thread_local class Proxy *proxy;
 
 #endif
@@ -18,28 +18,54 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <algorithm>
+#include <cstdarg>
 
 #include "defines.h"
 #include "utils.h"
 #include "userfunc.h"
 #include "xml2.h"
 #include "CConfigurator.h"
+#include "CMemoryStats.h"
 
 #include "Proxy/CDispatcher.h"
 #include "Proxy/proxy.h"
 
 #include "Map/CRoomManager.h"
+#include "Map/CMapChecker.h"
+#include "Map/CMapTransaction.h"
+#include "Map/CMapGraph.h"
+#include "Map/CMapLayout.h"
+#include "Map/CMapPath.h"
+#include "Map/CRoomIndex.h"
 #include "Map/CTree.h"
 
 #include "Engine/CStacksManager.h"
 #include "Engine/CEngine.h"
 
-#include "Gui/mainwindow.h"
+thread_local class Userland *userland_parser = nullptr;
 
-class Userland *userland_parser;
+/* set by a command that failed, mscript clears and checks it per line */
+static thread_local bool user_command_failed = false;
+
+/* send_to_user for the replies that tell a command failed */
+static void send_failure(const char *messg, ...)
+{
+    char txt[MAX_STR_LEN * 2];
+    va_list args;
+
+    va_start(args, messg);
+    vsnprintf(txt, sizeof(txt), messg, args);
+    va_end(args);
+
+    user_command_failed = true;
+    send_to_user("%s", txt);
+}
 
 /* ================= ENCHANCED USER FUNCTIONS VERSIONS =============== */
 #define USERCMD_FLAG_SYNC (1 << 0)    /* sync is required */
@@ -65,7 +91,7 @@ class Userland *userland_parser;
 
 #define GET_INT_ARGUMENT(arg, value)                                                                                   \
     if (!is_integer(arg)) {                                                                                            \
-        send_to_user("--[ argument %s is not an integer as its supposed to be.\r\n", arg);                             \
+        send_failure("--[ argument %s is not an integer as its supposed to be.\r\n", arg);                             \
         send_prompt();                                                                                                 \
         return USER_PARSE_SKIP;                                                                                        \
     }                                                                                                                  \
@@ -73,7 +99,7 @@ class Userland *userland_parser;
 
 #define MISSING_ARGUMENTS                                                                                              \
     {                                                                                                                  \
-        send_to_user("--[Pandora: Missing arguments.\n");                                                              \
+        send_failure("--[Pandora: Missing arguments.\n");                                                              \
         send_prompt();                                                                                                 \
         return USER_PARSE_SKIP;                                                                                        \
     }
@@ -81,14 +107,14 @@ class Userland *userland_parser;
 #define PARSE_DIR_ARGUMENT(dir, arg)                                                                                   \
     dir = parse_dir(arg);                                                                                              \
     if (dir == -1) {                                                                                                   \
-        send_to_user("--[ %s is not a dirrection.\r\n", arg);                                                          \
+        send_failure("--[ %s is not a dirrection.\r\n", arg);                                                          \
         send_prompt();                                                                                                 \
         return USER_PARSE_SKIP;                                                                                        \
     }
 
 #define CHECK_SYNC                                                                                                     \
-    if (stacker.amount() != 1) {                                                                                       \
-        send_to_user("--[Pandora: Current position is undefined(out of sync).\n");                                     \
+    if (stacker->amount() != 1) {                                                                                       \
+        send_failure("--[Pandora: Current position is undefined(out of sync).\n");                                     \
         send_prompt();                                                                                                 \
         return USER_PARSE_SKIP;                                                                                        \
     }
@@ -123,7 +149,9 @@ const struct user_command_type user_commands[] = {
      "    Usage: mcheckexits [boolean]\r\n"
      "    Examples: mcheckexits / mcheckexits on / mcheckexits true / mcheckexits 1 /mcheckexits yes\r\n\r\n"
      "    This command turns on the exits analyzing. Exits analyzer requires a very full\r\n"
-     "map.\r\n"},
+     "map. Candidate rooms whose exits differ from the exits line are dropped before their\r\n"
+     "names and descriptions are compared; secret doors may be missing. exitsTolerance in the\r\n"
+     "[Engine] section of the config sets how many exits may differ (default 0).\r\n"},
     {"mautomerge", usercmd_config, USER_CONF_AUTOMERGE, 0, "Turn descriptions analyzer in mapping mode on/off.",
      "    Usage: mautomerge [boolean]\r\n"
      "    Examples: mautomerge / mautomerge on / mautomerge true / mautomerge 1 / mautomerge yes\r\n\r\n"
@@ -164,14 +192,68 @@ const struct user_command_type user_commands[] = {
      "For example - you forgot to add some movement failure pattern to the config file. When this \r\n"
      "movement failure case will show up you will have to reset the stacks and resync manualy.\r\n"},
     {"mstat", usercmd_mstat, 0, 0, "Display settings and mappers state stacks.",
-     "    Usage: mstat\r\n"
-     "    Examples: mstat\r\n\r\n"
-     "    This command displays settings, stacks and possible current position room id's\r\n"},
+     "    Usage: mstat [memory]\r\n"
+     "    Examples: mstat / mstat memory\r\n\r\n"
+     "    This command displays settings, stacks and possible current position room id's.\r\n"
+     "With memory it shows how much memory rooms, texts, name tree, renderer and queues hold.\r\n"},
     {"minfo", usercmd_minfo, 0, 0, "Display current rooms data (or by given id).",
      "    Usage: minfo [id]\r\n"
      "    Examples: minfo / minfo 120\r\n\r\n"
      "    This command displays everything know about current room. Roomname, id, flags,\r\n"
      "room description, exits, connections and last update date.\r\n"},
+    {"mcheck", usercmd_mcheck, 0, USERCMD_FLAG_REDRAW, "Check the map integrity (and fix it).",
+     "    Usage: mcheck [fix]\r\n"
+     "    Examples: mcheck / mcheck fix\r\n\r\n"
+     "    Checks all rooms for exits into deleted rooms, exits with wrong flags, doors without exits,\r\n"
+     "links that miss their way back, broken ids, regions and local spaces. Violations are listed\r\n"
+     "grouped by kind. With fix all safe repairs are applied (broken ids are only reported).\r\n"},
+    {"mgraph", usercmd_mgraph, 0, USERCMD_FLAG_REDRAW, "Analyze the exits graph and select the results.",
+     "    Usage: mgraph [islands|oneway|cuts|unreachable [id]]\r\n"
+     "    Examples: mgraph / mgraph islands / mgraph unreachable 1\r\n\r\n"
+     "    Without arguments prints the amount of connected parts of the map, of areas you can walk\r\n"
+     "in both ways and of cut rooms. The arguments select rooms outside the largest connected part\r\n"
+     "(islands), rooms you cannot walk back from to the main area (oneway), rooms whose removal\r\n"
+     "splits the map (cuts) and rooms not reachable from the given or current room (unreachable).\r\n"},
+    {"mquery", usercmd_mquery, 0, USERCMD_FLAG_REDRAW, "Select rooms by flags, terrain and region.",
+     "    Usage: mquery <query>\r\n"
+     "    Examples: mquery rent and region:bree / mquery terrain:water & (shop | load:boat)\r\n\r\n"
+     "    Terms are mob or load flag names (rent, shop, boat, ...) or kind:value with the kinds\r\n"
+     "mob, load, terrain, region, light, align, portable, ridable and sundeath. Join them with\r\n"
+     "and/&, or/|, not/! and parentheses, all matches every room. Found rooms get selected.\r\n"},
+    {"mscript", usercmd_mscript, 0, USERCMD_FLAG_REDRAW, "Run m-commands from a file as one batch.",
+     "    Usage: mscript [check] <file>\r\n"
+     "    Examples: mscript links.txt / mscript check links.txt\r\n\r\n"
+     "    Runs one m-command per line, empty lines and lines starting with # are skipped. The whole\r\n"
+     "file is read first and nothing runs if a line is broken. The commands run as one map\r\n"
+     "transaction, so the map is indexed and redrawn once at the end. Replies of the commands are\r\n"
+     "not shown, lines whose reply reports a failure are listed instead. check only reads the file.\r\n"},
+    {"mlayout", usercmd_mlayout, 0, USERCMD_FLAG_REDRAW, "Move overlapping rooms apart.",
+     "    Usage: mlayout [check|undo|region <name>]\r\n"
+     "    Examples: mlayout / mlayout region bree / mlayout check\r\n\r\n"
+     "    Moves the selected rooms (or the rooms of your region if nothing is selected) so that no\r\n"
+     "two rooms share a spot. Other rooms stay where they are, exits keep their direction where\r\n"
+     "possible. region works on the named region, check only selects the overlapping rooms and\r\n"
+     "undo puts the rooms of the last mlayout back.\r\n"},
+    {"mpath", usercmd_mpath, 0, USERCMD_FLAG_REDRAW, "Find the way to some room and print a speedwalk.",
+     "    Usage: mpath [secret] [death] [select] <id|note|name>\r\n"
+     "    Examples: mpath 1200 / mpath secret rent / mpath select The Prancing Pony\r\n\r\n"
+     "    Finds the cheapest way from the current room by terrain move costs and prints it as a\r\n"
+     "speedwalk, with open commands for the doors on the way. The target is a room id or a text\r\n"
+     "found in notes (or else in names), the nearest match wins. Secret doors and deathtraps are\r\n"
+     "avoided unless secret or death is given, select also selects the rooms of the way.\r\n"},
+    {"mnearest", usercmd_mnearest, 0, USERCMD_FLAG_REDRAW, "List and select the nearest matching rooms.",
+     "    Usage: mnearest [amount] [secret] [death] <flags query|text>\r\n"
+     "    Examples: mnearest rent / mnearest 3 shop and region:bree / mnearest herb\r\n\r\n"
+     "    Finds the rooms closest to the current one (by the amount of moves) among the rooms\r\n"
+     "matching a flags query as in mquery, or else containing the text in their note or name.\r\n"
+     "Lists the nearest 5 (or amount) of them and selects them, mpath <id> prints the way.\r\n"
+     "Secret doors and deathtraps are avoided unless secret or death is given.\r\n"},
+    {"mreident", usercmd_mreident, 0, USERCMD_FLAG_REDRAW, "Propose and apply updates of changed room descriptions.",
+     "    Usage: mreident [on|off|list|apply|clear]\r\n\r\n"
+     "    With on, a room you walk into that has the expected name and exits, but a description\r\n"
+     "that only matches within the wider reidentQuote (40% by default), gets an update proposed.\r\n"
+     "The comparison runs when the mapper has nothing else to do. list shows the proposals,\r\n"
+     "apply updates all of them at once and clear drops them.\r\n"},
     {"north", usercmd_move, NORTH, USERCMD_FLAG_INSTANT | USERCMD_FLAG_REDRAW, nullptr, nullptr},
     {"east", usercmd_move, EAST, USERCMD_FLAG_INSTANT | USERCMD_FLAG_REDRAW, nullptr, nullptr},
     {"south", usercmd_move, SOUTH, USERCMD_FLAG_INSTANT | USERCMD_FLAG_REDRAW, nullptr, nullptr},
@@ -322,6 +404,19 @@ const struct user_command_type user_commands[] = {
 
     {nullptr, nullptr, 0, 0, nullptr, nullptr}};
 
+/* index of user_commands by name, built on the first lookup */
+static int find_user_command(const char *name)
+{
+    static const QHash<QByteArray, int> index = []() {
+        QHash<QByteArray, int> result;
+        for (int i = 0; user_commands[i].name != nullptr; i++)
+            result.insert(user_commands[i].name, i);
+        return result;
+    }();
+
+    return index.value(QByteArray(name), -1);
+}
+
 void Userland::add_command(int id, const char *arg)
 {
     struct queued_command_type t;
@@ -383,31 +478,31 @@ int Userland::parse_user_input_line(const char *line)
     p = one_argument(p, arg, 0);
     //  printf("One argument : line ..%s..,  arg ...%s...\r\n", p, arg);
 
-    for (i = 0; user_commands[i].name != nullptr; i++)
-        if (strcmp(user_commands[i].name, arg) == 0) {
-            /* call the appropriate command handler */
+    i = find_user_command(arg);
+    if (i != -1) {
+        /* call the appropriate command handler */
 
-            if (IS_SET(user_commands[i].flags, USERCMD_FLAG_SYNC))
-                CHECK_SYNC;
+        if (IS_SET(user_commands[i].flags, USERCMD_FLAG_SYNC))
+            CHECK_SYNC;
 
-            result = USER_PARSE_SKIP;
-            if (IS_SET(user_commands[i].flags, USERCMD_FLAG_INSTANT)) {
-                result = ((*user_commands[i].command_pointer)(i, user_commands[i].subcmd, p, (char *)line));
-                if (IS_SET(user_commands[i].flags, USERCMD_FLAG_REDRAW))
-                    toggle_renderer_reaction();
-            } else {
-                if (Map.isBlocked()) {
-                    send_to_user("--[ Map is blocked! Delaying the execution of your command...\r\n\r\n");
-                    send_prompt();
-                }
-                userland_parser->add_command(i, p);
+        result = USER_PARSE_SKIP;
+        if (IS_SET(user_commands[i].flags, USERCMD_FLAG_INSTANT)) {
+            result = ((*user_commands[i].command_pointer)(i, user_commands[i].subcmd, p, (char *)line));
+            if (IS_SET(user_commands[i].flags, USERCMD_FLAG_REDRAW))
+                toggle_renderer_reaction();
+        } else {
+            if (Map.isBlocked()) {
+                send_to_user("--[ Map is blocked! Delaying the execution of your command...\r\n\r\n");
+                send_prompt();
             }
+            userland_parser->add_command(i, p);
+        }
 
-            //      if (renderer_window)
-            //        renderer_window->update_status_bar();
+        //      if (renderer_window)
+        //        renderer_window->update_status_bar();
 
-            return result;
-        }
+        return result;
+    }
 
     if (proxy->isMudEmulation()) {
         send_to_user("Arglebargle...No such command\r\n");
@@ -481,7 +576,7 @@ USERCMD(usercmd_maddroom)
     CRoom *r;
 
     if (proxy->isMudEmulation()) {
-        send_to_user("Disabled in MUD emulation.\r\n");
+        send_failure("Disabled in MUD emulation.\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -492,18 +587,18 @@ USERCMD(usercmd_maddroom)
     userfunc_print_debug;
 
     if (engine->getRoomName().isEmpty()) {
-        send_to_user("--[ Missing room name.\r\n");
+        send_failure("--[ Missing room name.\r\n");
 
         send_prompt();
         return USER_PARSE_SKIP;
     }
 
     if (engine->getDesc().isEmpty()) {
-        send_to_user("--[ Missing description!\r\n");
+        send_failure("--[ Missing description!\r\n");
     }
 
     if (engine->getExits().isEmpty()) {
-        send_to_user("--[ Missing exits.\r\n");
+        send_failure("--[ Missing exits.\r\n");
 
         send_prompt();
         return USER_PARSE_SKIP;
@@ -531,8 +626,8 @@ USERCMD(usercmd_maddroom)
 
     Map.addRoom(r);
 
-    stacker.put(r);
-    stacker.swap();
+    stacker->put(r);
+    stacker->swap();
 
     send_prompt();
     return USER_PARSE_SKIP;
@@ -540,7 +635,7 @@ USERCMD(usercmd_maddroom)
 
 #define GET_INT_ARGUMENT(arg, value)                                                                                   \
     if (!is_integer(arg)) {                                                                                            \
-        send_to_user("--[ argument %s is not an integer as its supposed to be.\r\n", arg);                             \
+        send_failure("--[ argument %s is not an integer as its supposed to be.\r\n", arg);                             \
         send_prompt();                                                                                                 \
         return USER_PARSE_SKIP;                                                                                        \
     }                                                                                                                  \
@@ -588,7 +683,7 @@ USERCMD(usercmd_maction)
         if (is_abbrev(arg, "all")) {
             dir = -1;
         } else {
-            send_to_user("--[ %s is not a direction.\r\n", arg);
+            send_failure("--[ %s is not a direction.\r\n", arg);
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -600,7 +695,7 @@ USERCMD(usercmd_maction)
 
     original[0] = 0; /* nullify the incoming line and get ready to put generated commands */
 
-    if (stacker.amount() == 0) {
+    if (stacker->amount() == 0) {
         exit = 1;
     } else {
         exit = 0;
@@ -641,10 +736,10 @@ USERCMD(usercmd_maction)
     }
 
     /* get the door names */
-    for (i = 0; i < stacker.amount(); i++) {
+    for (i = 0; i < stacker->amount(); i++) {
         if (Map.isBlocked())
             break;
-        r = stacker.get(i);
+        r = stacker->get(i);
 
         if (r != nullptr) {
             if (dir == -1) {
@@ -702,27 +797,31 @@ USERCMD(usercmd_mdelete)
 
     } else {
         CHECK_SYNC;
-        r = stacker.first();
+        r = stacker->first();
         ids.append(r->id);
     }
 
+    if (ids.contains(1)) {
+        send_failure("--[ Sorry, you can not delete the base (id == 1) room!\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    /* the rooms are freed and the map redrawn once, at the commit */
+    CMapTransaction transaction(&Map);
     for (int i = 0; i < ids.size(); ++i) {
         r = Map.getRoom(ids.at(i));
         if (r == nullptr)
             continue;
-        if (r->id == 1) {
-            send_to_user("--[ Sorry, you can not delete the base (id == 1) room!\r\n");
-            send_prompt();
-            return USER_PARSE_SKIP;
-        }
 
         if (remove)
             Map.deleteRoom(r, 0);
         else
             Map.deleteRoom(r, 1);
     }
+    transaction.commit();
 
-    stacker.swap();
+    stacker->swap();
 
     toggle_renderer_reaction();
 
@@ -738,7 +837,7 @@ USERCMD(usercmd_mnote)
 
     userfunc_print_debug;
 
-    r = stacker.first();
+    r = stacker->first();
 
     p = skip_spaces(line);
     r->setNote(p);
@@ -755,7 +854,7 @@ USERCMD(usercmd_mnotecolor)
 
     userfunc_print_debug;
 
-    r = stacker.first();
+    r = stacker->first();
 
     p = skip_spaces(line);
 
@@ -764,7 +863,7 @@ USERCMD(usercmd_mnotecolor)
         r->setNoteColor(p);
         send_to_user("--[ Set note color.\r\n");
     } else {
-        send_to_user("--[ Invalid color: %s!\r\n", line);
+        send_failure("--[ Invalid color: %s!\r\n", line);
     }
 
     send_prompt();
@@ -788,9 +887,9 @@ USERCMD(usercmd_mrefresh)
     userfunc_print_debug;
     skip_spaces(line);
 
-    stacker.first()->setName(engine->getRoomName());
-    stacker.first()->setDesc(engine->getDesc());
-    stacker.first()->setTerrain(engine->getTerrain());
+    stacker->first()->setName(engine->getRoomName());
+    stacker->first()->setDesc(engine->getDesc());
+    stacker->first()->setTerrain(engine->getTerrain());
 
     send_to_user("--[ Refreshed.\r\n");
     send_prompt();
@@ -812,7 +911,7 @@ USERCMD(usercmd_mgoto)
     // if not go on with selection
     if (!*p) {
         if (Map.selections.isEmpty() == false) {
-            stacker.put(Map.selections.getFirst());
+            stacker->put(Map.selections.getFirst());
         } else
             MISSING_ARGUMENTS
 
@@ -821,34 +920,33 @@ USERCMD(usercmd_mgoto)
         if (is_integer(arg)) {
             id = atoi(arg);
             if (Map.getRoom(id) == nullptr) {
-                send_to_user("--[ There is no room with id %s.\r\n", arg);
+                send_failure("--[ There is no room with id %s.\r\n", arg);
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
 
-            stacker.put(Map.getRoom(id));
+            stacker->put(Map.getRoom(id));
 
         } else {
             CHECK_SYNC;
-            r = stacker.first();
+            r = stacker->first();
 
             PARSE_DIR_ARGUMENT(dir, arg);
 
             if (r->isConnected(dir) == false) {
-                send_to_user("--[ Bad direction - there is no connection.\r\n", arg);
+                send_failure("--[ Bad direction - there is no connection.\r\n", arg);
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
 
-            stacker.put(r->exits[dir]->id);
+            stacker->put(r->exits[dir]->id);
         }
     }
 
-    renderer_window->renderer->setUserX(0, true);
-    renderer_window->renderer->setUserY(0, true);
+    recenter_renderer();
 
     engine->setMgoto(true); /* ignore prompt while we are in mgoto mode */
-    stacker.swap();
+    stacker->swap();
     send_prompt();
     return USER_PARSE_SKIP;
 }
@@ -884,7 +982,7 @@ USERCMD(usercmd_mdetach)
         }
     }
 
-    r = stacker.first();
+    r = stacker->first();
     if (r->isExitPresent(dir) == true) {
         s = r->exits[dir];
         if (del) {
@@ -893,7 +991,7 @@ USERCMD(usercmd_mdetach)
             r->setExitUndefined(dir);
         }
     } else {
-        send_to_user("--[ %s is not marked nor linked.\r\n", exits[dir]);
+        send_failure("--[ %s is not marked nor linked.\r\n", exits[dir]);
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -924,7 +1022,7 @@ USERCMD(usercmd_mlink)
 
     userfunc_print_debug;
 
-    r = stacker.first();
+    r = stacker->first();
 
     /* get essential arguments - id and direction */
     p = skip_spaces(line);
@@ -945,7 +1043,7 @@ USERCMD(usercmd_mlink)
     second = Map.getRoom(id);
 
     if (second == nullptr) {
-        send_to_user("--[ There is no room with id %i.\r\n", id);
+        send_failure("--[ There is no room with id %i.\r\n", id);
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -969,7 +1067,7 @@ USERCMD(usercmd_mlink)
 
     /* first room */
     if (r->isConnected(dir) && !force) {
-        send_to_user("--[ There is an existing connection to the %s.\r\n", exits[dir]);
+        send_failure("--[ There is an existing connection to the %s.\r\n", exits[dir]);
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -984,7 +1082,7 @@ USERCMD(usercmd_mlink)
             backdir = reversenum(dir);
 
         if (second->isConnected(backdir) && !force) {
-            send_to_user("--[ There is an existing connection to the %s in second room.\r\n", exits[backdir]);
+            send_failure("--[ There is an existing connection to the %s in second room.\r\n", exits[backdir]);
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -1020,7 +1118,7 @@ USERCMD(usercmd_mmark)
 
     p = one_argument(p, arg, 0); /* flag */
 
-    r = stacker.first();
+    r = stacker->first();
 
     i = 0;
     while (room_flags[i].name != "") {
@@ -1033,7 +1131,7 @@ USERCMD(usercmd_mmark)
         }
         i++;
     }
-    send_to_user("--[ no such flag.\r\n");
+    send_failure("--[ no such flag.\r\n");
     send_prompt();
     return USER_PARSE_SKIP;
 }
@@ -1069,13 +1167,13 @@ USERCMD(usercmd_mdoor)
 
     p = one_argument(p, arg2, 0); /* direction */
 
-    r = stacker.first();
+    r = stacker->first();
 
     PARSE_DIR_ARGUMENT(i, arg2);
 
     if (strcmp(arg, "remove") == 0) {
         if (r->isDoorSet(i) == false) {
-            send_to_user("--[ There is no door to the %s.\r\n", exits[i]);
+            send_failure("--[ There is no door to the %s.\r\n", exits[i]);
         } else {
             r->removeDoor(i);
             send_to_user("--[Pandora: Removed the door to the %s\n", exits[i]);
@@ -1098,7 +1196,7 @@ USERCMD(usercmd_mcoord)
 
     userfunc_print_debug;
 
-    r = stacker.first();
+    r = stacker->first();
 
     p = skip_spaces(line);
     if (!*p) {
@@ -1157,7 +1255,7 @@ USERCMD(usercmd_mdec)
         GET_INT_ARGUMENT(arg, value);
     }
 
-    r = stacker.first();
+    r = stacker->first();
 
     switch (subcmd) {
     case USER_DEC_X:
@@ -1346,20 +1444,24 @@ USERCMD(usercmd_msave)
     if (!*p) {
         /* no arguments */
         // xml_writebase( conf->get_base_file() );
-        Map.saveMap(conf->getBaseFile());
-        send_to_user("--[Pandora: Saved...\r\n");
-        conf->setDatabaseModified(false);
+        if (Map.saveMap(conf->getBaseFile())) {
+            send_to_user("--[Pandora: Saved...\r\n");
+            conf->setDatabaseModified(false);
+        } else {
+            user_command_failed = true;
+        }
 
         send_prompt();
         return USER_PARSE_SKIP;
     } else {
         p = one_argument(p, arg, 1); /* do not lower or upper case - filename */
 
-        Map.saveMap(arg);
-
-        send_to_user("--[Pandora: Saved to %s...\r\n", p);
-
-        conf->setDatabaseModified(false);
+        if (Map.saveMap(arg)) {
+            send_to_user("--[Pandora: Saved to %s...\r\n", p);
+            conf->setDatabaseModified(false);
+        } else {
+            user_command_failed = true;
+        }
 
         send_prompt();
         return USER_PARSE_SKIP;
@@ -1377,7 +1479,7 @@ USERCMD(usercmd_mload)
     Map.reinit(); /* this one reinits Ctree structure also */
 
     send_to_user(" * Resetting possibility stacks...\r\n");
-    stacker.reset(); /* resetting stacks */
+    stacker->reset(); /* resetting stacks */
 
     send_to_user(" * Clearing events stacks...\r\n");
     engine->clear();
@@ -1414,7 +1516,7 @@ USERCMD(usercmd_mreset)
 
     engine->clear();
 
-    stacker.reset();
+    stacker->reset();
 
     send_to_user("--[Pandora: Resetted!\n");
 
@@ -1435,7 +1537,7 @@ USERCMD(usercmd_mmerge)
     userfunc_print_debug;
 
     if (engine->addedroom == nullptr) {
-        send_to_user("--[There is new added room to merge.\r\n");
+        send_failure("--[There is new added room to merge.\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -1454,7 +1556,7 @@ USERCMD(usercmd_mmerge)
         // yet again, sensitive!
         t = Map.findDuplicateRoom(engine->addedroom);
         if (t == nullptr) {
-            send_to_user("--[ No matching room found.\r\n");
+            send_failure("--[ No matching room found.\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -1464,14 +1566,14 @@ USERCMD(usercmd_mmerge)
         GET_INT_ARGUMENT(arg, id);
 
         if (id <= 0 || id > MAX_ROOMS) {
-            send_to_user("--[ %s is not a room id.\r\n", arg);
+            send_failure("--[ %s is not a room id.\r\n", arg);
             send_prompt();
             return USER_PARSE_SKIP;
         }
 
         t = Map.getRoom(id);
         if (t == nullptr) {
-            send_to_user("--[ There is no room with this id %i.\r\n", id);
+            send_failure("--[ There is no room with this id %i.\r\n", id);
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -1485,7 +1587,7 @@ USERCMD(usercmd_mmerge)
 
         if (!force)
             if (engine->addedroom->isEqualNameAndDesc(t) == false) {
-                send_to_user("--[ Roomname or description do not match.\r\n");
+                send_failure("--[ Roomname or description do not match.\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -1494,11 +1596,11 @@ USERCMD(usercmd_mmerge)
     if (Map.tryMergeRooms(t, engine->addedroom, j)) {
         send_to_user("--[ merged.\r\n");
     } else {
-        send_to_user("--[ failed.\r\n");
-        stacker.put(engine->addedroom);
+        send_failure("--[ failed.\r\n");
+        stacker->put(engine->addedroom);
     }
 
-    stacker.swap();
+    stacker->swap();
 
     /* now make sure we have a room in stack */
 
@@ -1508,10 +1610,27 @@ USERCMD(usercmd_mmerge)
 
 USERCMD(usercmd_mstat)
 {
+    char *p;
+    char arg[MAX_STR_LEN];
+
     userfunc_print_debug;
-    skip_spaces(line);
+    p = skip_spaces(line);
+    if (*p) {
+        one_argument(p, arg, 0);
+        if (is_abbrev(arg, "memory")) {
+            send_to_user("%s", MemoryStats.report().constData());
+        } else {
+            send_failure("--[ Usage: mstat [memory]\r\n");
+        }
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
 
     engine->printStacks();
+    if (Map.pager.isEnabled())
+        send_to_user(" Region paging: %d regions resident, %d paged out (%d loads, %d evictions, %d unreadable).\r\n",
+                     Map.pager.residentCount(), Map.pager.pagedCount(), Map.pager.pageInCount(),
+                     Map.pager.pageOutCount(), Map.pager.readFailureCount());
 
     send_prompt();
     return USER_PARSE_SKIP;
@@ -1553,8 +1672,8 @@ USERCMD(usercmd_minfo)
         return USER_PARSE_SKIP;
     }
 
-    for (i = 0; i < stacker.amount(); i++) {
-        t = stacker.get(i);
+    for (i = 0; i < stacker->amount(); i++) {
+        t = stacker->get(i);
         t->sendRoom();
     }
 
@@ -1562,6 +1681,628 @@ USERCMD(usercmd_minfo)
     return USER_PARSE_SKIP;
 }
 
+USERCMD(usercmd_mcheck)
+{
+    char *p;
+    char arg[MAX_STR_LEN];
+    bool fixMode = false;
+    QElapsedTimer timer;
+    int counts[CMapChecker::KIND_COUNT] = {0};
+    int kind;
+
+    userfunc_print_debug;
+
+    p = skip_spaces(line);
+    if (*p) {
+        p = one_argument(p, arg, 0);
+        if (!is_abbrev(arg, "fix")) {
+            send_failure("--[ Usage: mcheck [fix]\r\n");
+            send_prompt();
+            return USER_PARSE_SKIP;
+        }
+        fixMode = true;
+    }
+
+    timer.start();
+    Map.setBlocked(true);
+    QVector<CMapViolation> violations = CMapChecker::check(&Map);
+    qint64 elapsed = timer.elapsed();
+
+    for (const CMapViolation &v : violations)
+        counts[v.kind]++;
+
+    send_to_user("--[ Checked %u rooms in %lld ms, %d violations.\r\n", Map.size(), elapsed,
+                 static_cast<int>(violations.size()));
+    for (kind = 0; kind < CMapChecker::KIND_COUNT; kind++) {
+        if (counts[kind] == 0)
+            continue;
+        send_to_user(" %s: %d\r\n", CMapChecker::kindName(kind), counts[kind]);
+
+        int shown = 0;
+        for (const CMapViolation &v : violations) {
+            if (v.kind != kind)
+                continue;
+            if (++shown > 20) {
+                send_to_user("    ...\r\n");
+                break;
+            }
+            if (v.room == nullptr)
+                send_to_user("    region %s -> local space %u\r\n", (const char *)v.region->getName(), v.other);
+            else if (v.dir == -1)
+                send_to_user("    room %u\r\n", v.room->id);
+            else if (v.other != 0)
+                send_to_user("    room %u %s -> %u\r\n", v.room->id, exits[v.dir], v.other);
+            else
+                send_to_user("    room %u %s\r\n", v.room->id, exits[v.dir]);
+        }
+    }
+
+    if (fixMode && !violations.isEmpty()) {
+        int fixed = CMapChecker::fix(&Map, violations);
+        send_to_user("--[ Fixed %d violations.\r\n", fixed);
+        for (kind = 0; kind < CMapChecker::KIND_COUNT; kind++)
+            if (counts[kind] > 0 && !CMapChecker::isFixable(kind))
+                send_to_user("--[ Skipped %d %s, there is no safe fix for them.\r\n", counts[kind],
+                             CMapChecker::kindName(kind));
+    } else if (!violations.isEmpty()) {
+        send_to_user("--[ Use mcheck fix to repair them.\r\n");
+    }
+    Map.setBlocked(false);
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
+USERCMD(usercmd_mgraph)
+{
+    char *p;
+    char arg[MAX_STR_LEN];
+    QElapsedTimer timer;
+    QVector<unsigned int> result;
+
+    userfunc_print_debug;
+
+    Map.setBlocked(true);
+    timer.start();
+    CMapGraph graph = CMapGraph::fromRoomManager(&Map);
+    qint64 built = timer.elapsed();
+    Map.setBlocked(false);
+
+    p = skip_spaces(line);
+    if (!*p) {
+        timer.restart();
+        QVector<QVector<unsigned int>> components = graph.components();
+        QVector<QVector<unsigned int>> strong = graph.strongComponents();
+        QVector<unsigned int> cuts = graph.articulationPoints();
+
+        send_to_user("--[ %d rooms, %d links (read in %lld ms, analyzed in %lld ms).\r\n", graph.size(),
+                     graph.linkCount(), built, timer.elapsed());
+        send_to_user(" Connected parts : %d, the largest has %d rooms.\r\n", static_cast<int>(components.size()),
+                     components.isEmpty() ? 0 : static_cast<int>(components.first().size()));
+        send_to_user(" Two-way areas   : %d, the largest has %d rooms.\r\n", static_cast<int>(strong.size()),
+                     strong.isEmpty() ? 0 : static_cast<int>(strong.first().size()));
+        send_to_user(" Cut rooms       : %d\r\n", static_cast<int>(cuts.size()));
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    p = one_argument(p, arg, 0);
+    timer.restart();
+    if (is_abbrev(arg, "islands")) {
+        QVector<QVector<unsigned int>> components = graph.components();
+        for (int i = 1; i < components.size(); i++)
+            result += components[i];
+    } else if (is_abbrev(arg, "oneway")) {
+        QVector<QVector<unsigned int>> strong = graph.strongComponents();
+        for (int i = 1; i < strong.size(); i++)
+            result += strong[i];
+    } else if (is_abbrev(arg, "cuts")) {
+        result = graph.articulationPoints();
+    } else if (is_abbrev(arg, "unreachable")) {
+        unsigned int root = 1;
+
+        p = one_argument(p, arg, 0);
+        if (*arg && is_integer(arg))
+            root = atoi(arg);
+        else if (stacker->amount() == 1)
+            root = stacker->first()->id;
+
+        if (!graph.contains(root)) {
+            send_failure("--[ There is no room with id %u.\r\n", root);
+            send_prompt();
+            return USER_PARSE_SKIP;
+        }
+        result = graph.unreachableFrom(root);
+    } else {
+        send_failure("--[ Usage: mgraph [islands|oneway|cuts|unreachable [id]]\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    std::sort(result.begin(), result.end());
+    Map.selections.selectList(result);
+    send_to_user("--[ Selected %d of %d rooms (%lld ms).\r\n", static_cast<int>(result.size()), graph.size(),
+                 timer.elapsed());
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
+USERCMD(usercmd_mquery)
+{
+    char *p;
+    QElapsedTimer timer;
+    CRoomBitmap found;
+    QString error;
+
+    userfunc_print_debug;
+
+    p = skip_spaces(line);
+    if (!*p) {
+        send_failure("--[ Usage: mquery <query>\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    timer.start();
+    if (!FlagIndex.query(QByteArray(p).trimmed(), found, &error)) {
+        send_failure("--[ %s\r\n", qPrintable(error));
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+    qint64 elapsed = timer.nsecsElapsed() / 1000;
+
+    QVector<unsigned int> ids = found.toList();
+    send_to_user("--[ %d of %d rooms match (%lld us).\r\n", static_cast<int>(ids.size()), FlagIndex.size(),
+                 elapsed);
+    for (int i = 0; i < ids.size() && i < 20; i++)
+        send_to_user("    %u: %s\r\n", ids[i], Map.getName(ids[i]).constData());
+    if (ids.size() > 20)
+        send_to_user("    ...\r\n");
+    Map.selections.selectList(ids);
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
+USERCMD(usercmd_mscript)
+{
+    struct ScriptLine
+    {
+        int number;
+        int command;
+        QByteArray text;
+        QByteArray arg;
+    };
+
+    char *p;
+    char *rest;
+    char arg[MAX_STR_LEN];
+    bool checkOnly = false;
+    QVector<ScriptLine> script;
+    QVector<QByteArray> problems;
+    QElapsedTimer timer;
+
+    userfunc_print_debug;
+
+    p = skip_spaces(line);
+    rest = one_argument(p, arg, 0);
+    if (strcmp(arg, "check") == 0 && *skip_spaces(rest)) {
+        checkOnly = true;
+        p = skip_spaces(rest);
+    }
+    if (!*p) {
+        send_to_user("--[ Usage: mscript [check] <file>\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    QByteArray filename = QByteArray(p).trimmed();
+    QFile file(QString::fromLocal8Bit(filename));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        send_to_user("--[ Cannot open %s.\r\n", filename.constData());
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    /* read it all first - a broken script changes nothing */
+    int number = 0;
+    while (!file.atEnd()) {
+        QByteArray text = file.readLine().trimmed();
+        number++;
+        if (text.isEmpty() || text.startsWith('#'))
+            continue;
+        if (text.size() >= MAX_STR_LEN) {
+            problems.append(QByteArray("line ") + QByteArray::number(number) + ": too long");
+            continue;
+        }
+
+        rest = one_argument(text.data(), arg, 0);
+        int command = find_user_command(arg);
+        if (command == -1) {
+            problems.append(QByteArray("line ") + QByteArray::number(number) + ": unknown command " + arg);
+        } else if (IS_SET(user_commands[command].flags, USERCMD_FLAG_INSTANT) ||
+                   user_commands[command].command_pointer == usercmd_mscript ||
+                   user_commands[command].command_pointer == usercmd_mload) {
+            problems.append(QByteArray("line ") + QByteArray::number(number) + ": " + arg +
+                            " can not run in a script");
+        } else {
+            ScriptLine scriptLine;
+            scriptLine.number = number;
+            scriptLine.command = command;
+            scriptLine.text = text;
+            scriptLine.arg = QByteArray(rest);
+            script.append(scriptLine);
+        }
+    }
+
+    if (!problems.isEmpty()) {
+        send_to_user("--[ %s: %d broken lines, nothing was run.\r\n", filename.constData(),
+                     static_cast<int>(problems.size()));
+        for (int i = 0; i < problems.size() && i < 20; i++)
+            send_to_user("    %s\r\n", problems[i].constData());
+        if (problems.size() > 20)
+            send_to_user("    ...\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+    if (checkOnly) {
+        send_to_user("--[ %s: %d commands, no broken lines.\r\n", filename.constData(),
+                     static_cast<int>(script.size()));
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    timer.start();
+    int failed = 0;
+    {
+        QByteArray reply;
+        CMapTransaction transaction(&Map);
+
+        user_output_capture = &reply;
+        for (const ScriptLine &scriptLine : script) {
+            const struct user_command_type &command = user_commands[scriptLine.command];
+
+            reply.clear();
+            user_command_failed = false;
+            if (IS_SET(command.flags, USERCMD_FLAG_SYNC) && stacker->amount() != 1) {
+                send_failure("--[Pandora: Current position is undefined(out of sync).\n");
+            } else {
+                /* the handlers may write into their argument */
+                QByteArray argument = scriptLine.arg;
+                (*command.command_pointer)(scriptLine.command, command.subcmd, argument.data(), argument.data());
+            }
+
+            if (user_command_failed) {
+                failed++;
+                problems.append(QByteArray("line ") + QByteArray::number(scriptLine.number) + ": " +
+                                scriptLine.text + " - " + reply.split('\n').first().trimmed());
+            }
+        }
+        user_output_capture = nullptr;
+        user_command_failed = false;
+
+        transaction.commit();
+    }
+
+    send_to_user("--[ %s: %d commands in %lld ms, %d failed.\r\n", filename.constData(),
+                 static_cast<int>(script.size()), timer.elapsed(), failed);
+    for (int i = 0; i < problems.size() && i < 20; i++)
+        send_to_user("    %s\r\n", problems[i].constData());
+    if (problems.size() > 20)
+        send_to_user("    ...\r\n");
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
+/* moves of the last mlayout, for mlayout undo */
+static QVector<CMapLayout::Move> lastLayout;
+
+USERCMD(usercmd_mlayout)
+{
+    char *p;
+    char arg[MAX_STR_LEN];
+    QElapsedTimer timer;
+    QVector<unsigned int> movable;
+    CRegion *region = nullptr;
+
+    userfunc_print_debug;
+
+    p = skip_spaces(line);
+    p = one_argument(p, arg, 0);
+
+    if (*arg && is_abbrev(arg, "undo")) {
+        if (lastLayout.isEmpty()) {
+            send_to_user("--[ Nothing to undo.\r\n");
+        } else {
+            CMapLayout::revert(&Map, lastLayout);
+            send_to_user("--[ Moved %d rooms back.\r\n", static_cast<int>(lastLayout.size()));
+            lastLayout.clear();
+        }
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    if (*arg && is_abbrev(arg, "check")) {
+        Map.setBlocked(true);
+        CMapLayout layout = CMapLayout::fromRoomManager(&Map, movable);
+        Map.setBlocked(false);
+
+        QVector<unsigned int> ids = layout.overlapping();
+        send_to_user("--[ %d of %d rooms overlap, %d exits point the wrong way.\r\n", static_cast<int>(ids.size()),
+                     layout.size(), layout.badLinks());
+        Map.selections.selectList(ids);
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    if (*arg && is_abbrev(arg, "region")) {
+        QByteArray name = QByteArray(skip_spaces(p)).trimmed();
+        region = Map.getRegionByName(name);
+        if (region == nullptr) {
+            send_failure("--[ There is no region %s.\r\n", name.constData());
+            send_prompt();
+            return USER_PARSE_SKIP;
+        }
+    } else if (*arg) {
+        send_failure("--[ Usage: mlayout [check|undo|region <name>]\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    } else if (!Map.selections.isEmpty()) {
+        for (int id : Map.selections.getList())
+            movable.append(id);
+    } else if (stacker->amount() == 1) {
+        region = stacker->first()->getRegion();
+    } else {
+        send_failure("--[ Select the rooms to move or sync first.\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    Map.setBlocked(true);
+    if (region != nullptr)
+        for (CRoom *room = region->firstMember(); room != nullptr; room = room->nextInRegion())
+            movable.append(room->id);
+
+    timer.start();
+    CMapLayout layout = CMapLayout::fromRoomManager(&Map, movable);
+    int overlapsBefore = static_cast<int>(layout.overlapping().size());
+    int badBefore = layout.badLinks();
+    QVector<CMapLayout::Move> moves = layout.solve();
+    Map.setBlocked(false);
+
+    if (moves.isEmpty()) {
+        send_to_user("--[ Nothing to move among %d rooms.\r\n", static_cast<int>(movable.size()));
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    CMapLayout::apply(&Map, moves);
+    lastLayout = moves;
+    send_to_user("--[ Moved %d of %d rooms (%lld ms). Overlapping rooms %d -> %d, wrong exits %d -> %d.\r\n",
+                 static_cast<int>(moves.size()), static_cast<int>(movable.size()), timer.elapsed(), overlapsBefore,
+                 static_cast<int>(layout.overlapping().size()), badBefore, layout.badLinks());
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
+/* copy of the exit graph for mpath and mnearest, refreshed when the map changes */
+static CMapPath pathCache;
+static const int PATH_CANDIDATES = 8;  /* matches of a text mpath compares by cost */
+static const int NEAREST_DEFAULT = 5; /* rooms listed by mnearest */
+
+USERCMD(usercmd_mpath)
+{
+    char *p;
+    char arg[MAX_STR_LEN];
+    int options = CMapPath::AVOID_ALL;
+    bool select = false;
+    QElapsedTimer timer;
+    QList<int> targets;
+
+    userfunc_print_debug;
+
+    CHECK_SYNC;
+
+    p = skip_spaces(line);
+    for (;;) {
+        char *rest = one_argument(p, arg, 0);
+        if (strcmp(arg, "secret") == 0)
+            options |= CMapPath::USE_SECRET;
+        else if (strcmp(arg, "death") == 0)
+            options |= CMapPath::USE_DEATHTRAPS;
+        else if (strcmp(arg, "select") == 0)
+            select = true;
+        else
+            break;
+        p = skip_spaces(rest);
+    }
+
+    QByteArray target = QByteArray(p).trimmed();
+    if (target.isEmpty())
+        MISSING_ARGUMENTS
+
+    if (is_integer(target.data())) {
+        targets << target.toInt();
+    } else {
+        targets = Map.searchNotes(QString::fromUtf8(target), Qt::CaseInsensitive);
+        if (targets.isEmpty())
+            targets = Map.searchNames(QString::fromUtf8(target), Qt::CaseInsensitive);
+    }
+    if (targets.isEmpty()) {
+        send_failure("--[ There is no room matching %s.\r\n", target.constData());
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    timer.start();
+    pathCache.refresh(&Map);
+    qint64 built = timer.elapsed();
+
+    unsigned int from = stacker->first()->id;
+    QVector<CMapPath::Hit> hits;
+    if (targets.size() == 1) {
+        hits.append(CMapPath::Hit{(unsigned int)targets.first(), 0});
+    } else {
+        /* the cheapest way is looked for among the closest matches only */
+        QVector<unsigned int> ids;
+        for (int id : targets)
+            ids.append(id);
+        pathCache.nearest(from, ids, PATH_CANDIDATES, options, hits);
+    }
+
+    QVector<CMapPath::Step> best;
+    int bestCost = 0;
+    unsigned int bestTarget = 0;
+    for (const CMapPath::Hit &hit : hits) {
+        int cost;
+        QVector<CMapPath::Step> route = pathCache.find(from, hit.id, options, &cost);
+        if (!route.isEmpty() && (best.isEmpty() || cost < bestCost)) {
+            best = route;
+            bestCost = cost;
+            bestTarget = hit.id;
+        }
+    }
+
+    if (best.isEmpty()) {
+        if (targets.size() == 1 && (unsigned int)targets.first() == from)
+            send_to_user("--[ You are already there.\r\n");
+        else if (options != (CMapPath::USE_SECRET | CMapPath::USE_DEATHTRAPS))
+            send_failure("--[ No way found, try secret or death.\r\n");
+        else
+            send_failure("--[ No way found.\r\n");
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    send_to_user("--[ Way to room %u: %d moves, cost %d (%lld ms, graph %lld ms).\r\n", bestTarget,
+                 static_cast<int>(best.size()), bestCost, timer.elapsed() - built, built);
+    send_to_user("--[ %s\r\n", CMapPath::speedwalk(best).constData());
+
+    if (select) {
+        QVector<unsigned int> ids;
+        ids << from;
+        for (const CMapPath::Step &step : best)
+            ids << step.id;
+        Map.selections.selectList(ids);
+    }
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
+USERCMD(usercmd_mnearest)
+{
+    char *p;
+    char arg[MAX_STR_LEN];
+    int options = CMapPath::AVOID_ALL;
+    int k = NEAREST_DEFAULT;
+    QElapsedTimer timer;
+    QVector<unsigned int> targets;
+    QVector<CMapPath::Hit> hits;
+
+    userfunc_print_debug;
+
+    CHECK_SYNC;
+
+    p = skip_spaces(line);
+    for (;;) {
+        char *rest = one_argument(p, arg, 0);
+        if (is_integer(arg) && atoi(arg) > 0)
+            k = atoi(arg);
+        else if (strcmp(arg, "secret") == 0)
+            options |= CMapPath::USE_SECRET;
+        else if (strcmp(arg, "death") == 0)
+            options |= CMapPath::USE_DEATHTRAPS;
+        else
+            break;
+        p = skip_spaces(rest);
+    }
+
+    QByteArray text = QByteArray(p).trimmed();
+    if (text.isEmpty())
+        MISSING_ARGUMENTS
+
+    /* a flags query if it parses, otherwise a text in notes or names */
+    CRoomBitmap found;
+    if (FlagIndex.query(text, found)) {
+        targets = found.toList();
+    } else {
+        QList<int> ids = Map.searchNotes(QString::fromUtf8(text), Qt::CaseInsensitive);
+        if (ids.isEmpty())
+            ids = Map.searchNames(QString::fromUtf8(text), Qt::CaseInsensitive);
+        for (int id : ids)
+            targets.append(id);
+    }
+    if (targets.isEmpty()) {
+        send_failure("--[ There is no room matching %s.\r\n", text.constData());
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    timer.start();
+    pathCache.refresh(&Map);
+    pathCache.nearest(stacker->first()->id, targets, k, options, hits);
+
+    if (hits.isEmpty()) {
+        send_failure("--[ None of %d matching rooms can be reached.\r\n", static_cast<int>(targets.size()));
+        send_prompt();
+        return USER_PARSE_SKIP;
+    }
+
+    QVector<unsigned int> ids;
+    for (const CMapPath::Hit &hit : hits) {
+        send_to_user("  %3d moves  %6u  %s\r\n", hit.moves, hit.id, Map.getName(hit.id).constData());
+        ids.append(hit.id);
+    }
+    send_to_user("--[ %d nearest of %d matching rooms (%lld ms).\r\n", static_cast<int>(hits.size()),
+                 static_cast<int>(targets.size()), timer.elapsed());
+    Map.selections.selectList(ids);
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
+USERCMD(usercmd_mreident)
+{
+    char *p;
+    char arg[MAX_STR_LEN];
+
+    userfunc_print_debug;
+
+    p = skip_spaces(line);
+    p = one_argument(p, arg, 0);
+    const QVector<CReidentProposal> &proposals = engine->getReidentProposals();
+
+    if (!*arg) {
+        send_to_user("--[ Re-identification is %s, %d description updates proposed.\r\n",
+                     engine->isReidentify() ? "on" : "off", static_cast<int>(proposals.size()));
+    } else if (is_abbrev(arg, "on") || is_abbrev(arg, "off")) {
+        engine->setReidentify(is_abbrev(arg, "on"));
+        send_to_user("--[ Re-identification is now %s.\r\n", engine->isReidentify() ? "on" : "off");
+    } else if (is_abbrev(arg, "list")) {
+        if (proposals.isEmpty())
+            send_to_user("--[ No description updates proposed.\r\n");
+        for (const CReidentProposal &proposal : proposals)
+            send_to_user(" %u %s (%d errors)\r\n", proposal.id, Map.getName(proposal.id).constData(),
+                         proposal.errors);
+    } else if (is_abbrev(arg, "apply")) {
+        int proposed = static_cast<int>(proposals.size());
+        int applied = engine->applyReidentProposals();
+        send_to_user("--[ Updated %d of %d descriptions.\r\n", applied, proposed);
+    } else if (is_abbrev(arg, "clear")) {
+        engine->clearReidentProposals();
+        send_to_user("--[ Proposals dropped.\r\n");
+    } else {
+        send_failure("--[ Usage: mreident [on|off|list|apply|clear]\r\n");
+    }
+
+    send_prompt();
+    return USER_PARSE_SKIP;
+}
+
 USERCMD(usercmd_move)
 {
     CRoom *r;
@@ -1598,14 +2339,14 @@ USERCMD(usercmd_move)
     }
 
     if (proxy->isMudEmulation()) {
-        if (stacker.amount() == 0) {
-            send_to_user("You are in an undefined position.\r\n");
+        if (stacker->amount() == 0) {
+            send_failure("You are in an undefined position.\r\n");
             send_to_user("Use mgoto <room_id> to go to some place...\r\n");
 
             send_prompt();
             return USER_PARSE_SKIP;
         }
-        r = stacker.first();
+        r = stacker->first();
 
         switch (subcmd) {
         case USER_MOVE_LOOK:
@@ -1620,12 +2361,12 @@ USERCMD(usercmd_move)
         if (dir == -1)
             return USER_PARSE_NONE;
         if (r->isConnected(dir) == false) {
-            send_to_user("Alas, you cannot go this way.\r\n\r\n");
+            send_failure("Alas, you cannot go this way.\r\n\r\n");
         } else {
-            stacker.put(r->exits[dir]->id);
-            stacker.swap();
+            stacker->put(r->exits[dir]->id);
+            stacker->swap();
 
-            r = stacker.first();
+            r = stacker->first();
             engine->updateRegions();
 
             toggle_renderer_reaction();
@@ -1673,7 +2414,7 @@ USERCMD(usercmd_mregion)
 
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("Error. Missing new regions name. \r\n");
+            send_failure("Error. Missing new regions name. \r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -1682,7 +2423,7 @@ USERCMD(usercmd_mregion)
             //            engine->set_users_region( Map.getRegionByName( arg ) );
             send_to_user("Ok. Done.\r\n");
         } else {
-            send_to_user("Error. Failed to add new region named %s.\r\n", arg);
+            send_failure("Error. Failed to add new region named %s.\r\n", arg);
         }
         send_prompt();
         return USER_PARSE_SKIP;
@@ -1691,20 +2432,20 @@ USERCMD(usercmd_mregion)
     if (is_abbrev(arg, "localspace")) {
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("Missing arguments. Usage: mregion localspace <region> <id>\r\n");
+            send_failure("Missing arguments. Usage: mregion localspace <region> <id>\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
         p = one_argument(p, arg, 0);
         CRegion *reg = Map.getRegionByName(arg);
         if (!reg) {
-            send_to_user("Failed. No such region!\r\n");
+            send_failure("Failed. No such region!\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("Missing arguments. Usage: mregion localspace <region> <id>\r\n");
+            send_failure("Missing arguments. Usage: mregion localspace <region> <id>\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -1713,7 +2454,7 @@ USERCMD(usercmd_mregion)
         if (strcmp(arg, "none") != 0)
             GET_INT_ARGUMENT(arg, id);
         if (!Map.setRegionLocalSpace(reg, id)) {
-            send_to_user("Failed. Unknown local space id.\r\n");
+            send_failure("Failed. Unknown local space id.\r\n");
         } else {
             send_to_user("Ok. Region %s local space set to %d.\r\n", (const char *)reg->getName(), id);
         }
@@ -1737,7 +2478,7 @@ USERCMD(usercmd_mregion)
 
             if (!*p) {
                 // PRINT USAGE
-                send_to_user("Missing arguments. Usage: mregion door add <alias> <door> <direction>\r\n");
+                send_failure("Missing arguments. Usage: mregion door add <alias> <door> <direction>\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -1745,7 +2486,7 @@ USERCMD(usercmd_mregion)
             p = skip_spaces(p);
             if (!*p) {
                 // PRINT USAGE
-                send_to_user("Missing arguments. Usage: mregion door add <alias> <door> <direction>\r\n");
+                send_failure("Missing arguments. Usage: mregion door add <alias> <door> <direction>\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -1753,7 +2494,7 @@ USERCMD(usercmd_mregion)
             engine->get_users_region()->addDoor(arg, p);
 
             // try to rebuild at least current square with rooms
-            CRoom *r = stacker.first();
+            CRoom *r = stacker->first();
             if (r != nullptr) {
                 r->rebuildDisplayList();
             }
@@ -1788,7 +2529,7 @@ USERCMD(usercmd_mregion)
 
             QByteArray door = engine->get_users_region()->getDoor(alias);
             if (door == "") {
-                send_to_user("--[ No door with such an alias (%s) in this region!\r\n", (const char *)alias);
+                send_failure("--[ No door with such an alias (%s) in this region!\r\n", (const char *)alias);
             } else {
                 if (local == false)
                     sprintf(original + strlen(original), "%s %s", arg, (const char *)door);
@@ -1806,7 +2547,7 @@ USERCMD(usercmd_mregion)
 
             if (!*p) {
                 // PRINT USAGE
-                send_to_user("Missing arguments. Usage: mregion door remove <alias>\r\n");
+                send_failure("Missing arguments. Usage: mregion door remove <alias>\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -1814,7 +2555,7 @@ USERCMD(usercmd_mregion)
             if (engine->get_users_region()->removeDoor(arg) == true)
                 send_to_user("Ok. Removed.\r\n");
             else
-                send_to_user("Sorry, failed.\r\n");
+                send_failure("Sorry, failed.\r\n");
 
             send_prompt();
             return USER_PARSE_SKIP;
@@ -1831,7 +2572,7 @@ USERCMD(usercmd_mregion)
         /* set current USERS region */
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("Error. Missing regions name. \r\n");
+            send_failure("Error. Missing regions name. \r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -1842,7 +2583,7 @@ USERCMD(usercmd_mregion)
         if (reg != nullptr) {
             engine->set_users_region(reg);
         } else {
-            send_to_user("Failed. No such region!\r\n");
+            send_failure("Failed. No such region!\r\n");
         }
 
         send_prompt();
@@ -1861,28 +2602,20 @@ USERCMD(usercmd_mregion)
     if (is_abbrev(arg, "show")) {
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("Missing arguments. Usage: mregion show <name>\r\n");
+            send_failure("Missing arguments. Usage: mregion show <name>\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
         p = one_argument(p, arg, 0);
         CRegion *reg = Map.getRegionByName(arg);
         if (!reg) {
-            send_to_user("Failed. No such region!\r\n");
+            send_failure("Failed. No such region!\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
 
-        int roomCount = 0;
-        QVector<CRoom *> rooms = Map.getRooms();
-        for (int i = 0; i < rooms.size(); i++) {
-            CRoom *room = rooms[i];
-            if (room && room->getRegion() == reg)
-                roomCount++;
-        }
-
         send_to_user("Region %s\r\n", (const char *)reg->getName());
-        send_to_user("  rooms: %d\r\n", roomCount);
+        send_to_user("  rooms: %d\r\n", reg->memberAmount());
         send_to_user("  localspace: %d\r\n", reg->getLocalSpaceId());
 
         if (reg->getLocalSpaceId() > 0) {
@@ -1932,15 +2665,15 @@ USERCMD(usercmd_mregion)
         /* set region in current ROOM (reset) */
         CRoom *r;
 
-        if (stacker.amount() != 1) {
-            send_to_user("Error. Must be in sync to use this subcommand!\r\n");
+        if (stacker->amount() != 1) {
+            send_failure("Error. Must be in sync to use this subcommand!\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
 
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("Error. Missing regions name. \r\n");
+            send_failure("Error. Missing regions name. \r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -1950,13 +2683,13 @@ USERCMD(usercmd_mregion)
         reg = Map.getRegionByName(arg);
         if (reg != nullptr) {
             send_to_user("Ok. Setting current room's region to %s.\r\n", (const char *)reg->getName());
-            r = stacker.first();
+            r = stacker->first();
             r->setRegion(reg);
             engine->set_last_region(reg);
             engine->set_users_region(reg);
 
         } else {
-            send_to_user("Failed. No such region!\r\n");
+            send_failure("Failed. No such region!\r\n");
         }
 
         send_prompt();
@@ -2046,7 +2779,7 @@ USERCMD(usercmd_mlocalspace)
     char arg[MAX_STR_LEN];
     char *p = skip_spaces(line);
     if (!*p) {
-        send_to_user("Missing arguments. Usage: mlocalspace <name>|list\r\n");
+        send_failure("Missing arguments. Usage: mlocalspace <name>|list\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -2110,7 +2843,7 @@ USERCMD(usercmd_mportal)
     char arg[MAX_STR_LEN];
     char *p = skip_spaces(line);
     if (!*p) {
-        send_to_user("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
+        send_failure("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -2121,7 +2854,7 @@ USERCMD(usercmd_mportal)
 
     p = skip_spaces(p);
     if (!*p) {
-        send_to_user("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
+        send_failure("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
@@ -2129,65 +2862,65 @@ USERCMD(usercmd_mportal)
     bool ok = false;
     float x = QString(arg).toFloat(&ok);
     if (!ok) {
-        send_to_user("Bad x value.\r\n");
+        send_failure("Bad x value.\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = skip_spaces(p);
     if (!*p) {
-        send_to_user("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
+        send_failure("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = one_argument(p, arg, 0);
     float y = QString(arg).toFloat(&ok);
     if (!ok) {
-        send_to_user("Bad y value.\r\n");
+        send_failure("Bad y value.\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = skip_spaces(p);
     if (!*p) {
-        send_to_user("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
+        send_failure("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = one_argument(p, arg, 0);
     float z = QString(arg).toFloat(&ok);
     if (!ok) {
-        send_to_user("Bad z value.\r\n");
+        send_failure("Bad z value.\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = skip_spaces(p);
     if (!*p) {
-        send_to_user("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
+        send_failure("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = one_argument(p, arg, 0);
     float w = QString(arg).toFloat(&ok);
     if (!ok) {
-        send_to_user("Bad w value.\r\n");
+        send_failure("Bad w value.\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = skip_spaces(p);
     if (!*p) {
-        send_to_user("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
+        send_failure("Missing arguments. Usage: mportal <localspaceId> <x> <y> <z> <w> <h>\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
     p = one_argument(p, arg, 0);
     float h = QString(arg).toFloat(&ok);
     if (!ok) {
-        send_to_user("Bad h value.\r\n");
+        send_failure("Bad h value.\r\n");
         send_prompt();
         return USER_PARSE_SKIP;
     }
 
     if (!Map.setLocalSpacePortal(id, x, y, z, w, h)) {
-        send_to_user("Failed. Unknown local space id.\r\n");
+        send_failure("Failed. Unknown local space id.\r\n");
     } else {
         send_to_user("Ok. Portal set for local space %d.\r\n", id);
     }
@@ -2217,7 +2950,7 @@ USERCMD(usercmd_mtimer)
         p = one_argument(p, arg, 0);
         if (!*p) {
             /* print help file or current settings */
-            send_to_user("--[ Missing parameters. \r\n\r\n");
+            send_failure("--[ Missing parameters. \r\n\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -2225,7 +2958,7 @@ USERCMD(usercmd_mtimer)
         if (is_abbrev(arg, "start")) {
             p = skip_spaces(p);
             if (!*p) {
-                send_to_user("--[ Error. Missing timer's name. \r\n\r\n");
+                send_failure("--[ Error. Missing timer's name. \r\n\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -2243,13 +2976,13 @@ USERCMD(usercmd_mtimer)
                 }
             }
 
-            send_to_user("--[ Timer with this name not found. \r\n\r\n");
+            send_failure("--[ Timer with this name not found. \r\n\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         } else if (is_abbrev(arg, "stop")) {
             p = skip_spaces(p);
             if (!*p) {
-                send_to_user("--[ Error. Missing timer's name. \r\n\r\n");
+                send_failure("--[ Error. Missing timer's name. \r\n\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -2271,7 +3004,7 @@ USERCMD(usercmd_mtimer)
             send_prompt();
             return USER_PARSE_SKIP;
         } else {
-            send_to_user("--[ Start or Stop command expected as argument! \r\n\r\n");
+            send_failure("--[ Start or Stop command expected as argument! \r\n\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -2291,7 +3024,7 @@ USERCMD(usercmd_mtimer)
         p = skip_spaces(p);
         p = one_argument(p, arg, 0);
         if (!*p) {
-            send_to_user("--[ Error. Missing countdowns name. \r\n\r\n");
+            send_failure("--[ Error. Missing countdowns name. \r\n\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -2301,14 +3034,14 @@ USERCMD(usercmd_mtimer)
         if (name == "remove") {
             p = skip_spaces(p);
             if (!*p) {
-                send_to_user("--[ Error. Missing countdown timer's name to remove. \r\n\r\n");
+                send_failure("--[ Error. Missing countdown timer's name to remove. \r\n\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
 
             p = one_argument(p, arg, 0);
             if (conf->timers.removeCountdown(arg) == false) {
-                send_to_user("--[ Failed to remove countdown timer with that name. \r\n\r\n");
+                send_failure("--[ Failed to remove countdown timer with that name. \r\n\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -2319,7 +3052,7 @@ USERCMD(usercmd_mtimer)
 
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("--[ Error. Missing countdowns timeout. \r\n\r\n");
+            send_failure("--[ Error. Missing countdowns timeout. \r\n\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -2329,7 +3062,7 @@ USERCMD(usercmd_mtimer)
         if (is_integer(arg)) {
             timeout = atoi(arg) * 1000;
         } else {
-            send_to_user("--[ Error. Timeout should be an integer value. \r\n\r\n");
+            send_failure("--[ Error. Timeout should be an integer value. \r\n\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -2349,7 +3082,7 @@ USERCMD(usercmd_mtimer)
 
         p = skip_spaces(p);
         if (!*p) {
-            send_to_user("--[ Error. Missing timer's name. \r\n\r\n");
+            send_failure("--[ Error. Missing timer's name. \r\n\r\n");
             send_prompt();
             return USER_PARSE_SKIP;
         }
@@ -2362,14 +3095,14 @@ USERCMD(usercmd_mtimer)
         if (name == "remove") {
             p = skip_spaces(p);
             if (!*p) {
-                send_to_user("--[ Error. Missing timer's name to remove. \r\n\r\n");
+                send_failure("--[ Error. Missing timer's name to remove. \r\n\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
 
             p = one_argument(p, arg, 0);
             if (conf->timers.removeTimer(arg) == false) {
-                send_to_user("--[ Failed to remove timer with that name. \r\n\r\n");
+                send_failure("--[ Failed to remove timer with that name. \r\n\r\n");
                 send_prompt();
                 return USER_PARSE_SKIP;
             }
@@ -2387,8 +3120,9 @@ USERCMD(usercmd_mtimer)
         return USER_PARSE_SKIP;
     }
 
-    send_to_user("--[ timer, countdown or addon?\r\n\r\n");
+    send_failure("--[ timer, countdown or addon?\r\n\r\n");
 
     send_prompt();
     return USER_PARSE_SKIP;
 }
+
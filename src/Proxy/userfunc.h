@@ -45,6 +45,14 @@ USERCMD(usercmd_mload);
 USERCMD(usercmd_mreset);
 USERCMD(usercmd_mstat);
 USERCMD(usercmd_minfo);
+USERCMD(usercmd_mcheck);
+USERCMD(usercmd_mgraph);
+USERCMD(usercmd_mquery);
+USERCMD(usercmd_mscript);
+USERCMD(usercmd_mlayout);
+USERCMD(usercmd_mpath);
+USERCMD(usercmd_mnearest);
+USERCMD(usercmd_mreident);
 USERCMD(usercmd_move);
 USERCMD(usercmd_mmerge);
 USERCMD(usercmd_mdec);
@@ -96,7 +104,8 @@ class Userland
     int parse_user_input_line(const char *line);
 };
 
-extern class Userland *userland_parser;
+/* command queue of the session of the calling thread, see CSession */
+extern thread_local class Userland *userland_parser;
 
 #define USER_PARSE_NONE 0 /* 0 - not my area - send the line further */
 #define USER_PARSE_SKIP 1 /* skip this line */
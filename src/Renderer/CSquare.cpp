@@ -23,6 +23,7 @@
 #include "Renderer/CSquare.h"
 
 #include "Map/CRoom.h"
+#include "CMemoryStats.h"
 
 #define MAX_SQUARE_SIZE 40
 #define MAX_SQUARE_ROOMS 40
@@ -40,6 +41,7 @@ CSquare::CSquare()
     righty = -MAX_SQUARE_SIZE / 2;
     centerx = 0;
     centery = 0;
+    MemoryStats.add(CMemoryStats::MEM_SQUARES, sizeof(CSquare), 1);
 
     //    doors.clear();
     //    notes.clear();
@@ -62,6 +64,7 @@ CSquare::~CSquare()
 
     clearNotesList();
     clearDoorsList();
+    MemoryStats.add(CMemoryStats::MEM_SQUARES, -qint64(sizeof(CSquare)), -1);
 }
 
 CSquare::CSquare(int lx, int ly, int rx, int ry)
@@ -80,6 +83,7 @@ CSquare::CSquare(int lx, int ly, int rx, int ry)
     centery = righty + (lefty - righty) / 2;
     gllist = -1;
     rebuild_display_list = true;
+    MemoryStats.add(CMemoryStats::MEM_SQUARES, sizeof(CSquare), 1);
 
     //    doors.clear();
     //    notes.clear();
@@ -24,18 +24,25 @@
 #include <QVector>
 #include <QColor>
 
+#include "CMemoryStats.h"
+
 class CRoom;
 
 // temporary storage for a billboard text
 class Billboard
 {
   public:
-    Billboard() {}
+    Billboard() { MemoryStats.add(CMemoryStats::MEM_BILLBOARDS, sizeof(Billboard), 1); }
     Billboard(CRoom *_room, double _ox, double _oy, double _oz, QString _text, QColor _col)
         : room(_room), offsetX(_ox), offsetY(_oy), offsetZ(_oz), x(0.0), y(0.0), z(0.0), color(_col), text(_text)
     {
+        MemoryStats.add(CMemoryStats::MEM_BILLBOARDS, sizeof(Billboard) + text.size() * sizeof(QChar), 1);
+    }
+    ~Billboard()
+    {
+        MemoryStats.add(CMemoryStats::MEM_BILLBOARDS, -qint64(sizeof(Billboard) + text.size() * sizeof(QChar)), -1);
+        text.clear();
     }
-    ~Billboard() { text.clear(); }
 
     CRoom *room;
     double offsetX;
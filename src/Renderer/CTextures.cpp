@@ -0,0 +1,125 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/* Configurator's texture loaders. They need a current GL context and the
+ * renderer's room size, so they are built with the renderer and not with
+ * the widget-free map core */
+
+#include <QImage>
+#include <cstring>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+
+#include "Renderer/renderer.h"
+
+int Configurator::loadNormalTexture(QByteArray filename, GLuint *texture)
+{
+    QImage tex1, buf1;
+    QByteArray resolved = filename;
+    const struct
+    {
+        const char *from;
+        const char *to;
+    } terrainMap[] = {
+        {"images/indoors.png", ":/pixmaps/terrain-indoors.png"},
+        {"images/city.png", ":/pixmaps/terrain-city.png"},
+        {"images/field.png", ":/pixmaps/terrain-field.png"},
+        {"images/forest.png", ":/pixmaps/terrain-forest.png"},
+        {"images/hills.png", ":/pixmaps/terrain-hills.png"},
+        {"images/shwater.png", ":/pixmaps/terrain-shallow.png"},
+        {"images/river.png", ":/pixmaps/terrain-water.png"},
+        {"images/rapids.png", ":/pixmaps/terrain-rapids.png"},
+        {"images/unwater.png", ":/pixmaps/terrain-underwater.png"},
+        {"images/road.png", ":/pixmaps/terrain-road.png"},
+        {"images/brush.png", ":/pixmaps/terrain-brush.png"},
+        {"images/tunnel.png", ":/pixmaps/terrain-tunnel.png"},
+        {"images/cavern.png", ":/pixmaps/terrain-cavern.png"},
+        {"images/mountain.png", ":/pixmaps/terrain-mountains.png"},
+        {"images/death.png", ":/images/death.png"},
+    };
+
+    for (const auto &entry : terrainMap) {
+        if (resolved == entry.from) {
+            resolved = entry.to;
+            break;
+        }
+    }
+    if (!resolved.startsWith(":/")) {
+        if (resolved.startsWith("images/")) {
+            resolved = QByteArray(":/images/") + resolved.mid(strlen("images/"));
+        } else if (resolved.startsWith("resources/pixmaps/")) {
+            resolved = QByteArray(":/pixmaps/") + resolved.mid(strlen("resources/pixmaps/"));
+        } else if (resolved.startsWith(":/resources/pixmaps/")) {
+            resolved = QByteArray(":/pixmaps/") + resolved.mid(strlen(":/resources/pixmaps/"));
+        }
+    }
+
+    print_debug(DEBUG_RENDERER, "loading texture %s", (const char *)resolved);
+    if (resolved == "")
+        return -1;
+    if (!buf1.load(resolved)) {
+        print_debug(DEBUG_CONFIG, "Failed to load the %s!", (const char *)resolved);
+        return -1;
+    }
+    tex1 = buf1.convertToFormat(QImage::Format_RGBA8888).mirrored();
+    glGenTextures(1, texture);
+    glBindTexture(GL_TEXTURE_2D, *texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex1.width(), tex1.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, tex1.bits());
+
+    return 1;
+}
+
+int Configurator::loadSectorTexture(struct roomSectorsData *p)
+{
+    loadNormalTexture(p->filename, &p->texture);
+
+    p->gllist = glGenLists(1);
+    if (p->gllist != 0) {
+        glNewList(p->gllist, GL_COMPILE);
+
+        glEnable(GL_TEXTURE_2D);
+
+        glBindTexture(GL_TEXTURE_2D, p->texture);
+
+        glBegin(GL_QUADS);
+        glTexCoord2f(0.0, 1.0);
+        glVertex3f(-ROOM_SIZE, ROOM_SIZE, 0.0f);
+        glTexCoord2f(0.0, 0.0);
+        glVertex3f(-ROOM_SIZE, -ROOM_SIZE, 0.0f);
+        glTexCoord2f(1.0, 0.0);
+        glVertex3f(ROOM_SIZE, -ROOM_SIZE, 0.0f);
+        glTexCoord2f(1.0, 1.0);
+        glVertex3f(ROOM_SIZE, ROOM_SIZE, 0.0f);
+
+        glEnd();
+        glDisable(GL_TEXTURE_2D);
+
+        glEndList();
+    }
+    return 1;
+}
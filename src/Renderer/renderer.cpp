@@ -36,6 +36,7 @@
 #include <GL/glu.h>
 
 #include "CConfigurator.h"
+#include "CMemoryStats.h"
 #include "utils.h"
 
 #include "Renderer/renderer.h"
@@ -44,6 +45,7 @@
 #include "Renderer/GLPrimitives.h"
 
 #include "Engine/CEngine.h"
+#include "Engine/CSession.h"
 #include "Engine/CStacksManager.h"
 
 #include "Gui/mainwindow.h"
@@ -326,8 +328,8 @@ void RendererWidget::updateEffectiveScale()
     const float innerRadius = 0.0f;
     const float outerRadius = 6.0f;
 
-    if (stacker.amount() > 0) {
-        CRoom *current = stacker.first();
+    if (stacker->amount() > 0) {
+        CRoom *current = stacker->first();
         if (current) {
             CRegion *region = current->getRegion();
             if (region) {
@@ -527,6 +529,21 @@ void RendererWidget::display(void)
     QOpenGLWidget::update();  // Schedule a repaint through Qt's event system
 }
 
+void RendererWidget::touchViewRegions()
+{
+    QList<CRegion *> regions;
+
+    pagerTouchQueued = false;
+    /* the map may have been reloaded since the frame */
+    QList<CRegion *> current = Map.getAllRegions();
+    for (CRegion *region : pagerRegions)
+        if (current.contains(region))
+            regions.append(region);
+    pagerRegions.clear();
+
+    Map.pager.touch(regions);
+}
+
 void RendererWidget::paintGL()
 {
     print_debug(DEBUG_RENDERER, "in paintGL()");
@@ -543,12 +560,12 @@ void RendererWidget::glDrawMarkers()
     QByteArray lastMovement;
     float dx, dy, dz;
 
-    if (stacker.amount() == 0)
+    if (stacker->amount() == 0)
         return;
 
     GLfloat markerColor[4] = {marker_colour[0], marker_colour[1], marker_colour[2], marker_colour[3]};
-    for (k = 0; k < stacker.amount(); k++) {
-        p = stacker.get(k);
+    for (k = 0; k < stacker->amount(); k++) {
+        p = stacker->get(k);
 
         if (p == nullptr) {
             print_debug(DEBUG_RENDERER, "RENDERER ERROR: Stuck upon corrupted room while drawing red pointers.\r\n");
@@ -585,9 +602,9 @@ void RendererWidget::glDrawMarkers()
         }
     }
 
-    if (last_drawn_marker != stacker.first()->id) {
+    if (last_drawn_marker != stacker->first()->id) {
         last_drawn_trail = last_drawn_marker;
-        last_drawn_marker = stacker.first()->id;
+        last_drawn_marker = stacker->first()->id;
         renderer_window->getGroupManager()->setCharPosition(last_drawn_marker);
         // emit updateCharPosition(last_drawn_marker);
     }
@@ -730,6 +747,53 @@ void RendererWidget::glDrawGroupMarkers()
     }
 }
 
+/* positions tracked by the other sessions, see CSession */
+void RendererWidget::glDrawSessionMarkers()
+{
+    static const GLfloat sessionColors[][4] = {
+        {0.1f, 0.8f, 0.1f, 0.9f}, {0.1f, 0.6f, 1.0f, 0.9f}, {1.0f, 0.6f, 0.1f, 0.9f},
+        {0.9f, 0.2f, 0.9f, 0.9f}, {0.1f, 0.9f, 0.9f, 0.9f}, {1.0f, 1.0f, 0.2f, 0.9f},
+    };
+    const int colorCount = sizeof(sessionColors) / sizeof(sessionColors[0]);
+    CSession *own = CSession::current();
+
+    for (CSession *session : CSession::all()) {
+        if (session == own || session->getStacks()->amount() == 0)
+            continue;
+
+        CRoom *p = session->getStacks()->first();
+        if (p == nullptr || p->id == last_drawn_marker)
+            continue;
+
+        const GLfloat *color = sessionColors[session->getIndex() % colorCount];
+
+        RenderTransform t = getRenderTransform(p);
+        int dx = t.pos.x() - curx;
+        int dy = t.pos.y() - cury;
+        int dz = t.pos.z() - curz;
+
+        appendMarkerGeometry(dx, dy, dz, 2, color, t.scale);
+
+        float rotX = 0;
+        float rotY = 0;
+        QByteArray lastMovement = session->getEngine()->getLastMovement();
+        if (!lastMovement.isEmpty()) {
+            if (lastMovement[0] == 'n') {
+                rotX = -90.0;
+            } else if (lastMovement[0] == 'e') {
+                rotY = 90.0;
+            } else if (lastMovement[0] == 's') {
+                rotX = 90.0;
+            } else if (lastMovement[0] == 'w') {
+                rotY = -90.0;
+            } else if (lastMovement[0] == 'd') {
+                rotX = 180.0;
+            }
+        }
+        appendConeGeometry(dx, dy, dz + 0.2f * t.scale, rotX, rotY, color, t.scale);
+    }
+}
+
 void RendererWidget::resetRenderBatch()
 {
     renderVertices.clear();
@@ -1568,6 +1632,7 @@ void RendererWidget::appendSquareGeometry(CSquare *square)
                 continue;
         }
         appendRoomGeometry(room);
+        viewRegions.insert(room->getRegion());
 
         if (!Map.selections.isEmpty() && Map.selections.isSelected(room->id) == true) {
             GLfloat highlight[4] = {0.20f, 0.20f, 0.80f, colour[3] - 0.1f};
@@ -1675,13 +1740,13 @@ void RendererWidget::setupNewBaseCoordinates()
     print_debug(DEBUG_RENDERER, "calculating new Base coordinates");
 
     // in case we lost sync, stay at the last position
-    if (stacker.amount() == 0)
+    if (stacker->amount() == 0)
         return;
 
     // initial unbeatably worst value for euclidean test
     bestDistance = 32000.0f * 32000.0f * 1000.0f;
-    for (i = 0; i < stacker.amount(); i++) {
-        p = stacker.get(i);
+    for (i = 0; i < stacker->amount(); i++) {
+        p = stacker->get(i);
         RenderTransform t = getRenderTransform(p);
         newX = curx - t.pos.x();
         newY = cury - t.pos.y();
@@ -1791,6 +1856,7 @@ void RendererWidget::draw(void)
 
     plane = Map.getPlanes();
     resetRenderBatch();
+    viewRegions.clear();
     while (plane) {
         if (plane->z < lowerZ || plane->z > upperZ) {
             if (!squareHasLocalspaceRooms(plane->squares)) {
@@ -1827,8 +1893,19 @@ void RendererWidget::draw(void)
 
     glDrawMarkers();
     glDrawGroupMarkers();
+    glDrawSessionMarkers();
     glDrawPrespamLine();
 
+    /* paging regions in reads files, so it runs after the frame, not in it */
+    viewRegions.remove(nullptr);
+    if (Map.pager.isEnabled()) {
+        pagerRegions = viewRegions.values();
+        if (!pagerTouchQueued) {
+            pagerTouchQueued = true;
+            QTimer::singleShot(0, this, SLOT(touchViewRegions()));
+        }
+    }
+
     if (!renderVertices.isEmpty()) {
         QMatrix4x4 viewMatrix;
         viewMatrix.setToIdentity();
@@ -1842,6 +1919,12 @@ void RendererWidget::draw(void)
         renderBatch(renderVertices, renderCommands, mvp);
     }
 
+    /* the arrays keep their capacity between frames, that is what they hold on to */
+    MemoryStats.set(CMemoryStats::MEM_RENDER,
+                    renderVertices.capacity() * sizeof(RenderVertex) + renderCommands.capacity() * sizeof(RenderCommand) +
+                        textBillboards.capacity() * sizeof(TextBillboard),
+                    renderVertices.size() + renderCommands.size() + textBillboards.size());
+
     //    print_debug(DEBUG_RENDERER, "draw() done");
 }
 
@@ -35,6 +35,7 @@
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLWidget>
+#include <QSet>
 #include <QVector>
 #include <QVector3D>
 
@@ -115,6 +116,9 @@ class RendererWidget : public QOpenGLWidget, protected QOpenGLFunctions
     QVector<RenderVertex> renderVertices;
     QVector<RenderCommand> renderCommands;
     QVector<TextBillboard> textBillboards;
+    QSet<CRegion *> viewRegions;   /* regions drawn in this frame, for the pager */
+    QList<CRegion *> pagerRegions; /* viewRegions of the last frame, not yet given to the pager */
+    bool pagerTouchQueued = false;
 
     struct RenderTransform
     {
@@ -123,6 +127,7 @@ class RendererWidget : public QOpenGLWidget, protected QOpenGLFunctions
     };
 
     void glDrawGroupMarkers();
+    void glDrawSessionMarkers();
     void glDrawPrespamLine();
     void glDrawMarkers();
     void glDrawCSquare(CSquare *p, int renderingMode);
@@ -263,6 +268,7 @@ class RendererWidget : public QOpenGLWidget, protected QOpenGLFunctions
   public slots:
     void display(void);
     void paintGL() override;
+    void touchViewRegions();
 
   signals:
     void updateCharPosition(unsigned int);
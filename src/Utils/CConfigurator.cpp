@@ -20,8 +20,7 @@
 
 /* configuration reader/saver and handler */
 #include <QFile>
-#include <QImage>
-#include <QImage>
+#include <QRect>
 #include <QRegularExpression>
 #include <QMutex>
 #include <QSettings>
@@ -32,10 +31,9 @@
 
 #include "Map/CRoom.h"
 #include "Map/CRoomManager.h"
-#include "Gui/mainwindow.h"
 
 #include "Engine/CEngine.h"
-#include "GroupManager/CGroup.h"
+#include "GroupManager/CGroupCommunicator.h"
 // #include "renderer.h"
 
 class Configurator *conf;
@@ -44,12 +42,24 @@ Configurator::Configurator()
 {
     /* here we set the default configuration */
     setLogFileEnabled(true);
+    memoryLogInterval = 0;
     setRegionsAutoReplace(false);
     setRegionsAutoSet(false);
 
     /* data */
     databaseModified = false;
 
+    /* everything stays resident unless mume.ini turns paging on */
+    pagingEnabled = false;
+    pagingResidentRegions = 16;
+
+    /* the exits check is off until turned on, then it is strict */
+    exitsCheck = false;
+    exitsTolerance = 0;
+
+    /* a patched description keeps most of the old words */
+    reidentQuote = 40;
+
     groupManagerState = CGroupCommunicator::Off;
 
     resetCurrentConfig();
@@ -67,6 +77,7 @@ void Configurator::resetCurrentConfig()
 
     first.pattern = 0;
     first.desc = "NONE";
+    first.moveCost = defaultMoveCost(first.desc);
     first.texture = 1;
     first.gllist = 1;
     sectors.push_back(first);
@@ -81,9 +92,10 @@ int Configurator::saveConfigAs(QByteArray path, QByteArray filename)
 
     conf.beginGroup("General");
     conf.setValue("mapFile", getBaseFile());
-    conf.setValue("windowRect", renderer_window->geometry());
+    conf.setValue("windowRect", main_window_rect());
     conf.setValue("alwaysOnTop", getAlwaysOnTop());
     conf.setValue("startupMode", getStartupMode());
+    conf.setValue("memoryLogInterval", getMemoryLogInterval());
     conf.endGroup();
 
     conf.beginGroup("Networking");
@@ -119,12 +131,14 @@ int Configurator::saveConfigAs(QByteArray path, QByteArray filename)
         conf.setValue("handle", sectors[i].desc);
         conf.setValue("file", sectors[i].filename);
         conf.setValue("pattern", sectors[i].pattern);
+        conf.setValue("moveCost", sectors[i].moveCost);
     }
     conf.endArray();
     conf.endGroup();
 
     conf.beginGroup("Engine");
     conf.setValue("checkExits", getExitsCheck());
+    conf.setValue("exitsTolerance", getExitsTolerance());
     conf.setValue("checkTerrain", getTerrainCheck());
     conf.setValue("briefmode", getBriefMode());
     conf.setValue("autoMerge", getAutomerge());
@@ -133,10 +147,20 @@ int Configurator::saveConfigAs(QByteArray path, QByteArray filename)
     conf.setValue("autoRefresh", getAutorefresh());
     conf.setValue("roomNameQuote", getNameQuote());
     conf.setValue("descQuote", getDescQuote());
+    conf.setValue("reidentQuote", getReidentQuote());
     conf.setValue("mactionUsesPrespam", getMactionUsesPrespam());
     conf.setValue("prespamTTL", getPrespamTTL());
     conf.endGroup();
 
+    conf.beginGroup("Paging");
+    conf.setValue("enabled", getPagingEnabled());
+    conf.setValue("residentRegions", getPagingResidentRegions());
+    QStringList pinned;
+    for (const QByteArray &name : pagingPinnedRegions)
+        pinned << QString::fromUtf8(name);
+    conf.setValue("pinnedRegions", pinned);
+    conf.endGroup();
+
     conf.beginGroup("Patterns");
     conf.setValue("exitsPattern", getExitsPattern());
     conf.setValue("spellsEffectPattern", spells_pattern);
@@ -156,7 +180,7 @@ int Configurator::saveConfigAs(QByteArray path, QByteArray filename)
     conf.setValue("notifyBash", getGroupManagerNotifyBash());
     conf.setValue("showGroupManager", getGroupManagerShowManager());
 
-    conf.setValue("windowRect", renderer_window->getGroupManagerRect());
+    conf.setValue("windowRect", group_manager_rect());
 
     conf.endGroup();
 
@@ -215,6 +239,7 @@ int Configurator::loadConfig(QByteArray path, QByteArray filename)
     setAlwaysOnTop(conf.value("alwaysOnTop", true).toBool());
     setStartupMode(conf.value("startupMode", 1).toInt());
     setLogFileEnabled(conf.value("isLogFileEnabled", true).toBool());
+    setMemoryLogInterval(conf.value("memoryLogInterval", 0).toInt());
     conf.endGroup();
 
     conf.beginGroup("Networking");
@@ -247,13 +272,15 @@ int Configurator::loadConfig(QByteArray path, QByteArray filename)
         // ignore "NONE" handle, it's always added by constructors
         if (handle == "NONE")
             continue;
-        addTexture(handle, conf.value("file").toByteArray(), (char)conf.value("pattern").toInt());
+        addTexture(handle, conf.value("file").toByteArray(), (char)conf.value("pattern").toInt(),
+                   conf.value("moveCost", defaultMoveCost(handle)).toInt());
     }
     conf.endArray();
     conf.endGroup();
 
     conf.beginGroup("Engine");
     setExitsCheck(conf.value("checkExits", false).toBool());
+    setExitsTolerance(conf.value("exitsTolerance", 0).toInt());
     setTerrainCheck(conf.value("checkTerrain", true).toBool());
     setBriefMode(conf.value("briefmode", true).toBool());
     setAutomerge(conf.value("autoMerge", true).toBool());
@@ -262,6 +289,7 @@ int Configurator::loadConfig(QByteArray path, QByteArray filename)
     setAutorefresh(conf.value("autoRefresh", true).toBool());
     setNameQuote(conf.value("roomNameQuote", 10).toInt());
     setDescQuote(conf.value("descQuote", 10).toInt());
+    setReidentQuote(conf.value("reidentQuote", 40).toInt());
     setRegionsAutoReplace(conf.value("regionsAutoReplace", false).toBool());
     setRegionsAutoSet(conf.value("regionsAutoSet", false).toBool());
     setMactionUsesPrespam(conf.value("mactionUsesPrespam", true).toBool());
@@ -269,6 +297,15 @@ int Configurator::loadConfig(QByteArray path, QByteArray filename)
 
     conf.endGroup();
 
+    conf.beginGroup("Paging");
+    setPagingEnabled(conf.value("enabled", false).toBool());
+    setPagingResidentRegions(conf.value("residentRegions", 16).toInt());
+    QList<QByteArray> pinned;
+    for (const QString &name : conf.value("pinnedRegions").toStringList())
+        pinned << name.toUtf8();
+    setPagingPinnedRegions(pinned);
+    conf.endGroup();
+
     conf.beginGroup("Patterns");
     setExitsPattern(conf.value("exitsPattern", "Exits: ").toByteArray());
     spells_pattern = conf.value("spellsEffectPattern", "Affected by:").toByteArray();
@@ -434,17 +471,35 @@ GLuint Configurator::getTextureByDesc(QByteArray desc)
     return sectors[i].texture;
 }
 
-void Configurator::addTexture(QByteArray desc, QByteArray filename, char pattern)
+void Configurator::addTexture(QByteArray desc, QByteArray filename, char pattern, int moveCost)
 {
     struct roomSectorsData s;
 
     s.desc = desc;
     s.filename = filename;
     s.pattern = pattern;
+    s.moveCost = qMax(1, moveCost);
 
     sectors.push_back(s);
 }
 
+/* rough MUME movement costs, used when the config does not give one */
+int Configurator::defaultMoveCost(QByteArray desc)
+{
+    static const struct
+    {
+        const char *desc;
+        int cost;
+    } costs[] = {{"INDOORS", 1},   {"CITY", 1},   {"ROAD", 1},    {"TUNNEL", 1},     {"FIELD", 2},
+                 {"CAVERN", 2},    {"FOREST", 3}, {"HILLS", 3},   {"BRUSH", 4},      {"SHALLOWWATER", 4},
+                 {"MOUNTAINS", 6}, {"WATER", 10}, {"RAPIDS", 20}, {"UNDERWATER", 30}};
+
+    for (const auto &entry : costs)
+        if (desc == entry.desc)
+            return entry.cost;
+    return 2;
+}
+
 int Configurator::getSectorByPattern(char pattern)
 {
     unsigned int i;
@@ -564,6 +619,12 @@ void Configurator::setExitsCheck(bool b)
     /* mapping on and off */
 }
 
+void Configurator::setExitsTolerance(int i)
+{
+    exitsTolerance = qBound(0, i, 6);
+    setConfigModified(true);
+}
+
 void Configurator::setTerrainCheck(bool b)
 {
     terrainCheck = b;
@@ -618,6 +679,12 @@ void Configurator::setDescQuote(int i)
     setConfigModified(true);
 }
 
+void Configurator::setReidentQuote(int i)
+{
+    reidentQuote = i;
+    setConfigModified(true);
+}
+
 void Configurator::setStartupMode(int i)
 {
     startupMode = i;
@@ -640,95 +707,3 @@ QByteArray Configurator::getNoteColor()
 {
     return noteColor;
 }
-
-int Configurator::loadNormalTexture(QByteArray filename, GLuint *texture)
-{
-    QImage tex1, buf1;
-    QByteArray resolved = filename;
-    const struct
-    {
-        const char *from;
-        const char *to;
-    } terrainMap[] = {
-        {"images/indoors.png", ":/pixmaps/terrain-indoors.png"},
-        {"images/city.png", ":/pixmaps/terrain-city.png"},
-        {"images/field.png", ":/pixmaps/terrain-field.png"},
-        {"images/forest.png", ":/pixmaps/terrain-forest.png"},
-        {"images/hills.png", ":/pixmaps/terrain-hills.png"},
-        {"images/shwater.png", ":/pixmaps/terrain-shallow.png"},
-        {"images/river.png", ":/pixmaps/terrain-water.png"},
-        {"images/rapids.png", ":/pixmaps/terrain-rapids.png"},
-        {"images/unwater.png", ":/pixmaps/terrain-underwater.png"},
-        {"images/road.png", ":/pixmaps/terrain-road.png"},
-        {"images/brush.png", ":/pixmaps/terrain-brush.png"},
-        {"images/tunnel.png", ":/pixmaps/terrain-tunnel.png"},
-        {"images/cavern.png", ":/pixmaps/terrain-cavern.png"},
-        {"images/mountain.png", ":/pixmaps/terrain-mountains.png"},
-        {"images/death.png", ":/images/death.png"},
-    };
-
-    for (const auto &entry : terrainMap) {
-        if (resolved == entry.from) {
-            resolved = entry.to;
-            break;
-        }
-    }
-    if (!resolved.startsWith(":/")) {
-        if (resolved.startsWith("images/")) {
-            resolved = QByteArray(":/images/") + resolved.mid(strlen("images/"));
-        } else if (resolved.startsWith("resources/pixmaps/")) {
-            resolved = QByteArray(":/pixmaps/") + resolved.mid(strlen("resources/pixmaps/"));
-        } else if (resolved.startsWith(":/resources/pixmaps/")) {
-            resolved = QByteArray(":/pixmaps/") + resolved.mid(strlen(":/resources/pixmaps/"));
-        }
-    }
-
-    print_debug(DEBUG_RENDERER, "loading texture %s", (const char *)resolved);
-    if (resolved == "")
-        return -1;
-    if (!buf1.load(resolved)) {
-        print_debug(DEBUG_CONFIG, "Failed to load the %s!", (const char *)resolved);
-        return -1;
-    }
-    tex1 = buf1.convertToFormat(QImage::Format_RGBA8888).mirrored();
-    glGenTextures(1, texture);
-    glBindTexture(GL_TEXTURE_2D, *texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex1.width(), tex1.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, tex1.bits());
-
-    return 1;
-}
-
-int Configurator::loadSectorTexture(struct roomSectorsData *p)
-{
-    loadNormalTexture(p->filename, &p->texture);
-
-    p->gllist = glGenLists(1);
-    if (p->gllist != 0) {
-        glNewList(p->gllist, GL_COMPILE);
-
-        glEnable(GL_TEXTURE_2D);
-
-        glBindTexture(GL_TEXTURE_2D, p->texture);
-
-        glBegin(GL_QUADS);
-        glTexCoord2f(0.0, 1.0);
-        glVertex3f(-ROOM_SIZE, ROOM_SIZE, 0.0f);
-        glTexCoord2f(0.0, 0.0);
-        glVertex3f(-ROOM_SIZE, -ROOM_SIZE, 0.0f);
-        glTexCoord2f(1.0, 0.0);
-        glVertex3f(ROOM_SIZE, -ROOM_SIZE, 0.0f);
-        glTexCoord2f(1.0, 1.0);
-        glVertex3f(ROOM_SIZE, ROOM_SIZE, 0.0f);
-
-        glEnd();
-        glDisable(GL_TEXTURE_2D);
-
-        glEndList();
-    }
-    return 1;
-}
@@ -38,6 +38,7 @@ struct roomSectorsData
     QByteArray desc;     /* name of this flag */
     QByteArray filename; /* appropriate texture's filename */
     char pattern;        /* appropriate pattern */
+    int moveCost;        /* cost of entering such a room, for mpath */
     GLuint texture;      /* and texture handler for renderer */
     GLuint gllist;       /* OpenGL display list */
 };
@@ -64,6 +65,7 @@ class Configurator : public QObject
     QByteArray configFile;
     QByteArray configPath;
     bool isLogFileEnabled;
+    int memoryLogInterval; /* seconds between memory summaries in the log, 0 - off */
 
     /* patterns/regexps */
     QByteArray exitsPattern;
@@ -83,6 +85,7 @@ class Configurator : public QObject
     bool duallinker;  /* auto-link to the room you came from */
 
     bool exitsCheck;   /* apply exits check to stacks */
+    int exitsTolerance; /* exits a candidate may differ in and still pass the check */
     bool terrainCheck; /* apply terrain check to stacks */
     bool briefMode;
     bool alwaysOnTop; /* keep Pandora window on top of others */
@@ -103,6 +106,7 @@ class Configurator : public QObject
 
     int descQuote; /* quote for description - in percents */
     int nameQuote; /* quote for roomname - in percents */
+    int reidentQuote; /* wider description quote for proposed updates, see mreident */
 
     //    void parse_line(char *line);
 
@@ -139,7 +143,34 @@ class Configurator : public QObject
     bool drawPrespam;
     bool mactionUsesPrespam;
     int prespamTTL; /* in ms */
+
+    /* region paging */
+    bool pagingEnabled;
+    int pagingResidentRegions;
+    QList<QByteArray> pagingPinnedRegions;
+
   public:
+    /* region paging config */
+    bool getPagingEnabled() { return pagingEnabled; }
+    int getPagingResidentRegions() { return pagingResidentRegions; }
+    QList<QByteArray> getPagingPinnedRegions() { return pagingPinnedRegions; }
+
+    void setPagingEnabled(bool b)
+    {
+        pagingEnabled = b;
+        setConfigModified(true);
+    }
+    void setPagingResidentRegions(int amount)
+    {
+        pagingResidentRegions = amount < 1 ? 1 : amount;
+        setConfigModified(true);
+    }
+    void setPagingPinnedRegions(const QList<QByteArray> &names)
+    {
+        pagingPinnedRegions = names;
+        setConfigModified(true);
+    }
+
     /* prespam config */
     bool getDrawPrespam() { return drawPrespam; }
     bool getMactionUsesPrespam() { return mactionUsesPrespam; }
@@ -191,6 +222,13 @@ class Configurator : public QObject
     bool getLogFileEnabled() { return isLogFileEnabled; }
     void setLogFileEnabled(bool b);
 
+    int getMemoryLogInterval() { return memoryLogInterval; }
+    void setMemoryLogInterval(int seconds)
+    {
+        memoryLogInterval = seconds < 0 ? 0 : seconds;
+        setConfigModified(true);
+    }
+
     void setGroupManagerState(int val)
     {
         groupManagerState = val;
@@ -257,7 +295,8 @@ class Configurator : public QObject
     int loadNormalTexture(QByteArray filename, GLuint *texture);
     char getPatternByRoom(CRoom *r);
     GLuint getTextureByDesc(QByteArray desc);
-    void addTexture(QByteArray desc, QByteArray filename, char pattern);
+    void addTexture(QByteArray desc, QByteArray filename, char pattern, int moveCost);
+    static int defaultMoveCost(QByteArray desc);
 
     GLuint exit_normal_texture;
     GLuint exit_door_texture;
@@ -315,6 +354,7 @@ class Configurator : public QObject
     void setAutomerge(bool b);
     void setAngrylinker(bool b);
     void setExitsCheck(bool b);
+    void setExitsTolerance(int i);
     void setTerrainCheck(bool b);
     void setDetailsVisibility(int i);
     void setTextureVisibility(int i);
@@ -323,6 +363,7 @@ class Configurator : public QObject
     void setAlwaysOnTop(bool b);
     void setDescQuote(int i);
     void setNameQuote(int i);
+    void setReidentQuote(int i);
 
     void setRegionsAutoSet(bool b);
     void setRegionsAutoReplace(bool b);
@@ -352,6 +393,7 @@ class Configurator : public QObject
     bool getAutomerge() { return automerge; }
     bool getAngrylinker() { return angrylinker; }
     bool getExitsCheck() { return exitsCheck; }
+    int getExitsTolerance() { return exitsTolerance; }
     bool getTerrainCheck() { return terrainCheck; }
     bool getBriefMode() { return briefMode; }
     bool getAlwaysOnTop() { return alwaysOnTop; }
@@ -415,6 +457,7 @@ class Configurator : public QObject
 
     int getDescQuote() { return descQuote; }
     int getNameQuote() { return nameQuote; }
+    int getReidentQuote() { return reidentQuote; }
 
   signals:
     void configurationChanged();
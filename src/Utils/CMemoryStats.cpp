@@ -0,0 +1,88 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QTimer>
+
+#include "CMemoryStats.h"
+#include "utils.h"
+
+class CMemoryStats MemoryStats;
+
+qint64 CMemoryStats::total() const
+{
+    qint64 result = 0;
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++)
+        result += bytes(i);
+    return result;
+}
+
+const char *CMemoryStats::name(int subsystem)
+{
+    static const char *names[MEM_SUBSYSTEMS] = {"rooms",  "room texts", "name tree", "squares", "billboards",
+                                                "render", "events",     "stacks",    "log"};
+    return (subsystem >= 0 && subsystem < MEM_SUBSYSTEMS) ? names[subsystem] : "";
+}
+
+static QByteArray humanSize(qint64 bytes)
+{
+    if (bytes >= 10 * 1024 * 1024)
+        return QByteArray::number(bytes / (1024 * 1024)) + " MB";
+    if (bytes >= 10 * 1024)
+        return QByteArray::number(bytes / 1024) + " KB";
+    return QByteArray::number(bytes) + " B";
+}
+
+QByteArray CMemoryStats::report() const
+{
+    QByteArray result;
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++)
+        result += QString(" %1 %2 %3 objects\r\n")
+                      .arg(name(i), -12)
+                      .arg(QString::fromLatin1(humanSize(bytes(i))), 10)
+                      .arg(objects(i), 9)
+                      .toLatin1();
+    result += QString(" %1 %2\r\n").arg("total", -12).arg(QString::fromLatin1(humanSize(total())), 10).toLatin1();
+    return result;
+}
+
+QByteArray CMemoryStats::summary() const
+{
+    QByteArray result = "memory: " + humanSize(total());
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++)
+        result += QByteArray(", ") + name(i) + " " + humanSize(bytes(i));
+    return result;
+}
+
+void CMemoryStats::startLogging(int seconds)
+{
+    if (seconds <= 0) {
+        if (logTimer)
+            logTimer->stop();
+        return;
+    }
+
+    if (logTimer == nullptr) {
+        logTimer = new QTimer();
+        QObject::connect(logTimer, &QTimer::timeout,
+                         []() { print_debug(DEBUG_GENERAL, "%s", MemoryStats.summary().constData()); });
+    }
+    logTimer->start(seconds * 1000);
+}
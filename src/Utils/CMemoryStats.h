@@ -0,0 +1,89 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CMEMORYSTATS_H
+#define CMEMORYSTATS_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+
+class QTimer;
+
+// Memory accounting per subsystem. The owners add and subtract as they
+// allocate and free (or set a gauge for buffers they resize), so reading
+// the numbers never walks any data. Bytes are payload estimates: object
+// sizes plus the sizes of their strings and arrays, no allocator overhead.
+
+class CMemoryStats
+{
+  public:
+    enum Subsystems
+    {
+        MEM_ROOMS = 0,   /* CRoom objects */
+        MEM_ROOM_TEXT,   /* names, descriptions, notes, contents and doors */
+        MEM_NAME_TREE,   /* NameMap trie nodes and their id lists */
+        MEM_SQUARES,     /* CSquare quadtree nodes */
+        MEM_BILLBOARDS,  /* note and door billboards of the squares */
+        MEM_RENDER,      /* renderer CPU side vertex and command arrays */
+        MEM_EVENTS,      /* events and commands waiting in the engine pipes */
+        MEM_STACKS,      /* stacks manager arrays */
+        MEM_LOG,         /* log viewer contents */
+        MEM_SUBSYSTEMS
+    };
+
+    inline void add(int subsystem, qint64 bytes, int objects = 0)
+    {
+        counters[subsystem].bytes.fetchAndAddRelaxed(bytes);
+        counters[subsystem].objects.fetchAndAddRelaxed(objects);
+    }
+    inline void set(int subsystem, qint64 bytes, int objects)
+    {
+        counters[subsystem].bytes.storeRelaxed(bytes);
+        counters[subsystem].objects.storeRelaxed(objects);
+    }
+
+    qint64 bytes(int subsystem) const { return counters[subsystem].bytes.loadRelaxed(); }
+    qint64 objects(int subsystem) const { return counters[subsystem].objects.loadRelaxed(); }
+    qint64 total() const;
+
+    static const char *name(int subsystem);
+
+    // table for mstat memory, and the one line version for the log
+    QByteArray report() const;
+    QByteArray summary() const;
+
+    // writes summary() to the log every given seconds, 0 stops it
+    void startLogging(int seconds);
+
+  private:
+    struct Counter
+    {
+        QAtomicInteger<qint64> bytes;
+        QAtomicInteger<qint64> objects;
+    };
+    /* constant initialized, so other globals may count before main() */
+    Counter counters[MEM_SUBSYSTEMS];
+    QTimer *logTimer = nullptr;
+};
+
+extern class CMemoryStats MemoryStats;
+
+#endif
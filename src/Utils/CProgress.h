@@ -0,0 +1,46 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CPROGRESS_H
+#define CPROGRESS_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Progress of a long map operation (loading, saving). The application shows
+// a progress dialog, the widget-free targets get this base, which shows
+// nothing and is never canceled
+
+class CProgress
+{
+  public:
+    virtual ~CProgress() {}
+
+    virtual void setLabelText(const QString &text) { Q_UNUSED(text); }
+    virtual void setMaximum(int maximum) { Q_UNUSED(maximum); }
+    virtual void setValue(int value) { Q_UNUSED(value); }
+    virtual bool wasCanceled() const { return false; }
+};
+
+// GUI hook like the ones in defines.h, the caller owns the result
+CProgress *create_progress(const QString &label, const QString &cancelText, int maximum, Qt::WindowModality modality);
+
+#endif  // CPROGRESS_H
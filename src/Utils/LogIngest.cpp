@@ -0,0 +1,128 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "LogIngest.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+
+#include "Engine/CEngine.h"
+#include "Engine/CStacksManager.h"
+
+#include "Map/CRoomManager.h"
+
+#include "Proxy/CDispatcher.h"
+#include "Proxy/proxy.h"
+
+/* the dispatcher works on one socket buffer at a time, leave it room for what it adds */
+static const int INGEST_CHUNK_SIZE = PROXY_BUFFER_SIZE / 2;
+
+bool LogIngest::ingestFile(const QString &filename, IngestStats &stats, QString *error)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = QString("Cannot read %1: %2").arg(filename, file.errorString());
+        return false;
+    }
+
+    /* an engine of its own, bound to the global the dispatcher feeds. The
+     * dispatcher has no sink, the group states and prompts go nowhere, and
+     * the socket is only its buffer, nothing is ever connected */
+    CEngine *previousEngine = engine;
+    bool autorefresh = conf->getAutorefresh();
+    CEngine pipelineEngine;
+    engine = &pipelineEngine;
+
+    Cdispatcher dispatcher;
+    ProxySocket socket(nullptr, true);
+    QByteArray output;
+    QByteArray chunk;
+    QElapsedTimer timer;
+
+    socket.setXmlMode(true);
+    conf->setAutorefresh(true); /* descriptions follow the log */
+    user_output_capture = &output;
+    stacker->reset();
+    engine->setMapping(true);
+
+    auto feed = [&]() {
+        socket.clearBuffer();
+        socket.append(chunk);
+        dispatcher.analyzeMudStream(socket);
+        chunk.clear();
+        output.clear();
+
+        while (!engine->empty()) {
+            engine->exec();
+            stats.events++;
+            /* mapping goes off with the sync, it is back on as soon as we know where we are */
+            if (!engine->isMapping() && stacker->amount() == 1)
+                engine->setMapping(true);
+        }
+    };
+
+    timer.start();
+    chunk.reserve(INGEST_CHUNK_SIZE);
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine(INGEST_CHUNK_SIZE / 2);
+        stats.bytes += line.size();
+
+        /* logs saved on unix lost the \r the dispatcher splits descriptions by */
+        if (line.endsWith('\n') && !line.endsWith("\r\n"))
+            line.insert(line.size() - 1, '\r');
+        if (chunk.size() + line.size() > INGEST_CHUNK_SIZE)
+            feed();
+        chunk.append(line);
+    }
+    feed();
+    stats.msecs += timer.elapsed();
+    stats.logs++;
+
+    user_output_capture = nullptr;
+    conf->setAutorefresh(autorefresh);
+    stacker->reset();
+    engine = previousEngine;
+    return true;
+}
+
+bool LogIngest::ingestLogs(const MapDocument &base, const QStringList &logs, MapDocument &out, IngestStats &stats,
+                           MapMerge &merge, QString *error)
+{
+    QVector<MapDocument> staged(logs.size());
+
+    /* Map and the name index are single, so the staging maps take turns on it */
+    for (int i = 0; i < logs.size(); i++) {
+        MapDocumentIO::toRoomManager(base, &Map);
+        if (!ingestFile(logs[i], stats, error))
+            return false;
+        if (!MapDocumentIO::fromRoomManager(&Map, staged[i], error))
+            return false;
+        print_debug(DEBUG_SYSTEM, "Staged %s: %i rooms.", qPrintable(logs[i]), static_cast<int>(staged[i].rooms.size()));
+    }
+
+    merge = MapTools::mergeStaged(base, staged, out);
+    return true;
+}
@@ -0,0 +1,60 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef LOGINGEST_H
+#define LOGINGEST_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "MapDocument.h"
+#include "MapTools.h"
+
+struct IngestStats
+{
+    qint64 bytes = 0;
+    qint64 msecs = 0;
+    int events = 0; /* events the engine went through */
+    int logs = 0;
+};
+
+// Offline mapping from MUME session logs recorded with XML mode on. The log
+// goes through the same Cdispatcher and CEngine as a live session, with the
+// engine kept in mapping mode whenever it is in sync. No Proxy, connection
+// or GUI is involved, the dispatcher runs without a sink. Works on the live
+// map (Map), so it has to run where the map may be modified - a headless
+// tool or the engine thread - and the logs are staged one after the other,
+// not in parallel.
+
+class LogIngest
+{
+  public:
+    // Maps one log into Map. The user messages of the engine are dropped
+    static bool ingestFile(const QString &filename, IngestStats &stats, QString *error = nullptr);
+
+    // Every log is mapped into its own staging copy of base, one after the
+    // other, the staging maps are then merged into out (see MapTools::mergeStaged)
+    static bool ingestLogs(const MapDocument &base, const QStringList &logs, MapDocument &out, IngestStats &stats,
+                           MapMerge &merge, QString *error = nullptr);
+};
+
+#endif  // LOGINGEST_H
@@ -21,21 +21,21 @@
 
 #include "MMapperImport.h"
 
-#include <QBuffer>
 #include <QDataStream>
 #include <QFile>
-#include <QProgressDialog>
-#include <QApplication>
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QtConcurrent>
 
 #include "defines.h"
 #include "CConfigurator.h"
+#include "parallel.h"
 #include "utils.h"
 
 #include "Map/CRoom.h"
 #include "Map/CRoomManager.h"
 #include "Engine/CStacksManager.h"
-#include "Renderer/renderer.h"
-#include "Gui/mainwindow.h"
 
 QString MMapperImport::s_lastError;
 
@@ -45,10 +45,15 @@ QString MMapperImport::lastError()
 }
 
 uint32_t MMapperImport::checkFile(const QString &filename)
+{
+    return readVersion(filename, &s_lastError);
+}
+
+uint32_t MMapperImport::readVersion(const QString &filename, QString *error)
 {
     QFile file(filename);
     if (!file.open(QIODevice::ReadOnly)) {
-        s_lastError = QString("Cannot open file: %1").arg(filename);
+        *error = QString("Cannot open file: %1").arg(filename);
         return 0;
     }
 
@@ -57,7 +62,7 @@ uint32_t MMapperImport::checkFile(const QString &filename)
     int32_t magic;
     stream >> magic;
     if (magic != MMAPPER_MAGIC) {
-        s_lastError = "Not an MMapper file (invalid magic number)";
+        *error = "Not an MMapper file (invalid magic number)";
         return 0;
     }
 
@@ -134,67 +139,93 @@ char MMapperImport::convertTerrain(uint8_t mmapperTerrain)
     return (sectorIndex > 0) ? static_cast<char>(sectorIndex) : 0;
 }
 
-bool MMapperImport::importFile(const QString &filename, CRoomManager *roomManager, QWidget *parentWidget)
+namespace
 {
+/* one room as stored in the file, before any conversion */
+struct RawRoom
+{
+    QString area, name, desc, contents, note;
+    uint8_t terrainType;
+    uint8_t lightType, alignType, portableType, ridableType, sundeathType;
+    uint32_t mobFlags, loadFlags;
+    int32_t x, y, z;
+    uint16_t exitFlags[7];
+    uint16_t doorFlags[7];
+    QString doorNames[7];
+    bool hasOutbound[7];
+};
+
+const uint32_t NO_LINK = 0xFFFFFFFF;
+
+/* decoded rooms are handed over to the converters in batches of this size */
+const int IMPORT_BATCH = 2048;
+}  // namespace
+
+bool MMapperImport::importFile(const QString &filename, CRoomManager *roomManager)
+{
+    MapDocument doc;
+
     s_lastError.clear();
+    if (!readFile(filename, doc, &s_lastError))
+        return false;
+
+    commit(doc, roomManager);
+    return true;
+}
+
+bool MMapperImport::readFile(const QString &filename, MapDocument &doc, QString *error, const QAtomicInt *cancel,
+                             const ProgressFn &progress)
+{
+    auto canceled = [cancel]() { return cancel != nullptr && cancel->loadAcquire() != 0; };
 
     // Check file
-    uint32_t version = checkFile(filename);
+    uint32_t version = readVersion(filename, error);
     if (version == 0) {
         return false;
     }
 
     // Check version support
     if (version < SCHEMA_QCOMPRESS) {
-        s_lastError = QString("MMapper file version %1 is too old. Only version %2+ (qCompress) is supported.\n"
-                              "Please open this file in MMapper and re-save it to update the format.")
-                          .arg(version)
-                          .arg(SCHEMA_QCOMPRESS);
+        *error = QString("MMapper file version %1 is too old. Only version %2+ (qCompress) is supported.\n"
+                         "Please open this file in MMapper and re-save it to update the format.")
+                     .arg(version)
+                     .arg(SCHEMA_QCOMPRESS);
         return false;
     }
 
     if (version > SCHEMA_CURRENT) {
-        s_lastError = QString("MMapper file version %1 is newer than supported (%2).\n"
-                              "Please update PandoraMapper or use an older MMapper map file.")
-                          .arg(version)
-                          .arg(SCHEMA_CURRENT);
+        *error = QString("MMapper file version %1 is newer than supported (%2).\n"
+                         "Please update PandoraMapper or use an older MMapper map file.")
+                     .arg(version)
+                     .arg(SCHEMA_CURRENT);
         return false;
     }
 
-    // Open file
+    // Open file, skip magic and version (already read) and take the compressed rest.
+    // The payload is a single qCompress() blob, so it can only be inflated in one go
     QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
-        s_lastError = QString("Cannot open file: %1").arg(filename);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(2 * sizeof(uint32_t))) {
+        *error = QString("Cannot open file: %1").arg(filename);
         return false;
     }
-
-    QDataStream stream(&file);
-
-    // Skip magic and version (already read)
-    int32_t magic;
-    uint32_t ver;
-    stream >> magic >> ver;
-
-    // Set Qt4.8 compatibility mode (MMapper uses this)
-    stream.setVersion(QDataStream::Qt_4_8);
-
-    // Read remaining compressed data
-    QByteArray compressedData = stream.device()->readAll();
+    QByteArray compressedData = file.readAll();
     file.close();
 
-    // Decompress
     QByteArray uncompressedData = qUncompress(compressedData);
     if (uncompressedData.isEmpty()) {
-        s_lastError = "Failed to decompress MMapper file data";
+        *error = "Failed to decompress MMapper file data";
         return false;
     }
-
     print_debug(DEBUG_XML, "MMapper file decompressed: %d -> %d bytes", compressedData.size(), uncompressedData.size());
+    compressedData.clear();
 
-    // Parse decompressed data
-    QBuffer buffer(&uncompressedData);
-    buffer.open(QIODevice::ReadOnly);
-    QDataStream dataStream(&buffer);
+    if (canceled()) {
+        *error = "Import canceled by user";
+        return false;
+    }
+
+    // Set Qt4.8 compatibility mode (MMapper uses this)
+    QDataStream dataStream(uncompressedData);
     dataStream.setVersion(QDataStream::Qt_4_8);
 
     // Read header
@@ -208,63 +239,118 @@ bool MMapperImport::importFile(const QString &filename, CRoomManager *roomManage
 
     // Check room count limit
     if (roomsCount >= MAX_ROOMS) {
-        s_lastError = QString("MMapper file has %1 rooms, but PandoraMapper only supports %2 rooms.\n"
-                              "The map is too large to import.")
-                          .arg(roomsCount)
-                          .arg(MAX_ROOMS);
+        *error = QString("MMapper file has %1 rooms, but PandoraMapper only supports %2 rooms.\n"
+                         "The map is too large to import.")
+                     .arg(roomsCount)
+                     .arg(MAX_ROOMS);
         return false;
     }
 
-    // Setup progress dialog
-    QProgressDialog progress("Importing MMapper database...", "Abort", 0, roomsCount, parentWidget);
-    progress.setWindowModality(Qt::ApplicationModal);
-    progress.show();
+    doc = MapDocument();
+    doc.rooms.resize(roomsCount);
+    RoomRecord *records = doc.rooms.data();
 
-    // Mapping from MMapper room IDs to new sequential IDs (1-based)
+    // Mapping from MMapper room IDs to new sequential IDs (1-based) and the
+    // first outbound MMapper id per room and direction, resolved at the end
     QHash<uint32_t, uint32_t> idMapping;
+    QVector<uint32_t> targets(roomsCount * 6, NO_LINK);
+    QSet<QString> areas;
+
+    idMapping.reserve(roomsCount);
+
+    // Converts a decoded batch into records while the next one is decoded.
+    // Every batch owns its own slice of doc.rooms
+    auto convertBatch = [records, version](QVector<RawRoom> batch, int first) {
+        for (int k = 0; k < batch.size(); k++) {
+            const RawRoom &raw = batch[k];
+            RoomRecord &r = records[first + k];
+
+            // Assign new sequential ID (1-based, 0 is reserved)
+            r.id = first + k + 1;
+            r.name = raw.name.toLocal8Bit();
+            r.desc = raw.desc.toLocal8Bit();
+            r.contents = raw.contents.toLocal8Bit();
+            r.region = raw.area.toLocal8Bit();
+
+            // Check for deathtrap in loadFlags (bit 24 = DEATHTRAP in newer schema)
+            // We'll also mark this in the note for visibility
+            QString finalNote = raw.note;
+            if ((raw.loadFlags & (1 << 24)) != 0) {
+                if (!finalNote.isEmpty())
+                    finalNote += " ";
+                finalNote += "[DEATHTRAP]";
+            }
+            r.note = finalNote.toLocal8Bit();
+
+            // Handle death terrain in older schemas
+            uint8_t terrainType = raw.terrainType;
+            if (version < SCHEMA_DEATH_FLAG && terrainType == 15) {
+                terrainType = TERRAIN_INDOORS;  // Death was terrain 15, now it's a load flag
+            }
+            int sector = convertTerrain(terrainType);
+            if (sector >= 0 && sector < static_cast<int>(conf->sectors.size()))
+                r.terrain = conf->sectors[sector].desc;
+            else
+                r.terrain = "UNDEFINED";
+
+            r.lightType = raw.lightType;
+            r.alignType = raw.alignType;
+            r.portableType = raw.portableType;
+            r.ridableType = raw.ridableType;
+            r.sundeathType = raw.sundeathType;
+            r.mobFlags = raw.mobFlags;
+            r.loadFlags = raw.loadFlags;
+
+            // Stretch the map to make it look pandora-familiar
+            r.x = raw.x * 2;
+            r.y = raw.y * 2;
+            r.z = raw.z * 2;
+
+            // Convert coordinates (older schemas used ESU, newer use ENU)
+            if (version < SCHEMA_NEW_COORDS) {
+                r.y = -r.y;
+            }
 
-    // Temporary storage for room data (IDs -> exits mapping)
-    struct RoomExitData
-    {
-        CRoom *room;
-        uint32_t mmapperExitIds[6];  // Original MMapper IDs for exits
-        bool exitPresent[6];
+            for (int dir = 0; dir < 7; ++dir) {
+                int pandoraDir = convertDirection(dir);
+                if (pandoraDir < 0 || pandoraDir >= 6)
+                    continue;
+
+                r.mmExitFlags[pandoraDir] = raw.exitFlags[dir];
+                r.mmDoorFlags[pandoraDir] = raw.doorFlags[dir];
+
+                bool hasExitFlag = (raw.exitFlags[dir] & (MM_EXIT_EXIT | MM_EXIT_STUB)) != 0;
+                bool hasDoorInfo = (raw.doorFlags[dir] != 0) || !raw.doorNames[dir].isEmpty();
+
+                // Exit exists but has no known target in MMapper data
+                if (!raw.hasOutbound[dir] && (hasExitFlag || hasDoorInfo))
+                    r.exits[pandoraDir] = RoomRecord::EXIT_TARGET_UNDEFINED;
+
+                // Set door if present (even on undefined exits)
+                r.doors[pandoraDir] = raw.doorNames[dir].toLocal8Bit();
+            }
+        }
     };
-    QVector<RoomExitData> roomData;
-    roomData.reserve(roomsCount);
+
+    QVector<QFuture<void>> conversions;
+    QVector<RawRoom> batch;
+    int batchStart = 0;
+    bool failed = false;
+
+    batch.reserve(IMPORT_BATCH);
 
     // Read rooms
     for (uint32_t i = 0; i < roomsCount; ++i) {
-        if (progress.wasCanceled()) {
-            s_lastError = "Import canceled by user";
-            return false;
-        }
-        progress.setValue(i);
-        QApplication::processEvents();
-
-        CRoom *room = new CRoom();
-        RoomExitData exitData;
-        exitData.room = room;
-        for (int j = 0; j < 6; j++) {
-            exitData.mmapperExitIds[j] = 0;
-            exitData.exitPresent[j] = false;
-        }
+        RawRoom raw;
+        uint32_t mmapperRoomId;
 
         // Read room data based on schema version
-        QString area, name, desc, contents, note;
-
         if (version >= SCHEMA_AREA) {
-            dataStream >> area;
+            dataStream >> raw.area;
         }
-        dataStream >> name >> desc >> contents;
-
-        uint32_t mmapperRoomId;
+        dataStream >> raw.name >> raw.desc >> raw.contents;
         dataStream >> mmapperRoomId;
-
-        // Assign new sequential ID (1-based, 0 is reserved)
-        uint32_t newId = i + 1;
-        room->id = newId;
-        idMapping[mmapperRoomId] = newId;
+        idMapping.insert(mmapperRoomId, i + 1);
 
         if (version >= SCHEMA_SERVER_ID) {
             uint32_t serverId;
@@ -272,39 +358,10 @@ bool MMapperImport::importFile(const QString &filename, CRoomManager *roomManage
             // serverId is MMapper-specific, we ignore it
         }
 
-        dataStream >> note;
-
-        // Read terrain
-        uint8_t terrainType;
-        dataStream >> terrainType;
-
-        // Handle death terrain in older schemas
-        if (version < SCHEMA_DEATH_FLAG && terrainType == 15) {
-            terrainType = TERRAIN_INDOORS;  // Death was terrain 15, now it's a load flag
-        }
-
-        // Read MMapper room properties and store them
-        uint8_t lightType, alignType, portableType, ridableType, sundeathType;
-        dataStream >> lightType >> alignType >> portableType >> ridableType >> sundeathType;
-
-        uint32_t mobFlags, loadFlags;
-        dataStream >> mobFlags >> loadFlags;
-
-        // Store MMapper properties in the room
-        room->setLightType(lightType);
-        room->setAlignType(alignType);
-        room->setPortableType(portableType);
-        room->setRidableType(ridableType);
-        room->setSundeathType(sundeathType);
-        room->setMobFlags(mobFlags);
-        room->setLoadFlags(loadFlags);
-
-        // Store contents
-        room->setContents(contents.toLocal8Bit());
-
-        // Check for deathtrap in loadFlags (bit 24 = DEATHTRAP in newer schema)
-        // We'll also mark this in the note for visibility
-        bool isDeathtrap = (loadFlags & (1 << 24)) != 0;
+        dataStream >> raw.note;
+        dataStream >> raw.terrainType;
+        dataStream >> raw.lightType >> raw.alignType >> raw.portableType >> raw.ridableType >> raw.sundeathType;
+        dataStream >> raw.mobFlags >> raw.loadFlags;
 
         // Read upToDate field (removed in schema v39)
         if (version < SCHEMA_NO_UPTODATE) {
@@ -313,170 +370,101 @@ bool MMapperImport::importFile(const QString &filename, CRoomManager *roomManage
             // Ignored - MMapper-specific field
         }
 
-        // Read coordinates
-        int32_t x, y, z;
-        dataStream >> x >> y >> z;
-
-        // Stretch the map to make it look pandora-familiar
-        x = x * 2;
-        y = y * 2;
-        z = z * 2;
-
-        // Convert coordinates (older schemas used ESU, newer use ENU)
-        if (version < SCHEMA_NEW_COORDS) {
-            y = -y;  // ESU to ENU conversion
-        }
-
-        // Set room properties
-        room->setName(name.toLocal8Bit());
-        room->setDesc(desc.toLocal8Bit());
-
-        QString finalNote = note;
-        if (isDeathtrap) {
-            if (!finalNote.isEmpty())
-                finalNote += " ";
-            finalNote += "[DEATHTRAP]";
-        }
-        room->setNote(finalNote.toLocal8Bit());
-
-        room->setSector(convertTerrain(terrainType));
-        room->setX(x);
-        room->setY(y);
-        room->simpleSetZ(z);
-
-        // Set region - use area if available, otherwise "default"
-        // If the region doesn't exist, create it
-        QByteArray regionName = area.isEmpty() ? QByteArray("default") : area.toLocal8Bit();
-        if (roomManager->getRegionByName(regionName) == nullptr && !regionName.isEmpty() && regionName != "default") {
-            roomManager->addRegion(regionName);
-        }
-        room->setRegion(regionName);
+        dataStream >> raw.x >> raw.y >> raw.z;
 
         // Read exits (7 directions in MMapper: NSEWUD + UNKNOWN)
         for (int dir = 0; dir < 7; ++dir) {
-            uint16_t exitFlags;
-            uint16_t doorFlags;
-            QString doorName;
-
-            dataStream >> exitFlags >> doorFlags >> doorName;
+            dataStream >> raw.exitFlags[dir] >> raw.doorFlags[dir] >> raw.doorNames[dir];
 
             // Read inbound links (older versions)
             if (version < SCHEMA_NO_INBOUND) {
                 uint32_t inbound;
                 dataStream >> inbound;
-                while (inbound != 0xFFFFFFFF) {
+                while (inbound != NO_LINK && dataStream.status() == QDataStream::Ok) {
                     dataStream >> inbound;
                 }
             }
 
-            // Read outbound links
+            // Keep the first outbound connection (MMapper supports multiple, Pandora doesn't)
             uint32_t outbound;
             dataStream >> outbound;
+            raw.hasOutbound[dir] = (outbound != NO_LINK);
 
             int pandoraDir = convertDirection(dir);
-            if (pandoraDir >= 0 && pandoraDir < 6) {
-                // Store MMapper exit and door flags
-                room->setMMExitFlags(pandoraDir, exitFlags);
-                room->setMMDoorFlags(pandoraDir, doorFlags);
-
-                bool hasExitFlag = (exitFlags & (MM_EXIT_EXIT | MM_EXIT_STUB)) != 0;
-                bool hasDoorInfo = (doorFlags != 0) || !doorName.isEmpty();
-
-                // Store first outbound connection (MMapper ID - will be remapped later)
-                if (outbound != 0xFFFFFFFF) {
-                    exitData.mmapperExitIds[pandoraDir] = outbound;
-                    exitData.exitPresent[pandoraDir] = true;
-                } else if (hasExitFlag || hasDoorInfo) {
-                    // Exit exists but has no known target in MMapper data
-                    // Mark as undefined immediately; don't set exitPresent since there's
-                    // nothing to resolve (avoids accidental resolution to room with ID 0)
-                    room->setExitUndefined(pandoraDir);
-                }
+            if (pandoraDir >= 0 && pandoraDir < 6 && outbound != NO_LINK)
+                targets[i * 6 + pandoraDir] = outbound;
 
-                // Set door if present (even on undefined exits)
-                if (!doorName.isEmpty()) {
-                    room->setDoor(pandoraDir, doorName.toLocal8Bit());
-                }
-
-                // Skip remaining outbound connections (MMapper supports multiple, Pandora doesn't)
-                while (outbound != 0xFFFFFFFF) {
-                    dataStream >> outbound;
-                }
-            } else {
-                // Skip outbound for UNKNOWN direction
-                while (outbound != 0xFFFFFFFF) {
-                    dataStream >> outbound;
-                }
+            while (outbound != NO_LINK && dataStream.status() == QDataStream::Ok) {
+                dataStream >> outbound;
             }
         }
 
         // Check for stream errors
         if (dataStream.status() != QDataStream::Ok) {
-            s_lastError = QString("Stream error while reading room %1: status=%2")
-                              .arg(i)
-                              .arg(dataStream.status());
-            // Clean up
-            delete room;
-            for (int j = 0; j < roomData.size(); ++j) {
-                delete roomData[j].room;
-            }
-            return false;
+            *error = QString("Stream error while reading room %1: status=%2").arg(i).arg(dataStream.status());
+            failed = true;
+            break;
         }
 
-        roomData.append(exitData);
-    }
-
-    buffer.close();
-
-    // Add rooms to manager and resolve exit connections
-    progress.setLabelText("Adding rooms to database...");
-    progress.setMaximum(roomData.size() * 2);
-
-    for (int i = 0; i < roomData.size(); ++i) {
-        progress.setValue(roomsCount + i);
-        if (progress.wasCanceled()) {
-            s_lastError = "Import canceled by user";
-            // Clean up rooms not yet added
-            for (int j = i; j < roomData.size(); ++j) {
-                delete roomData[j].room;
+        if (!raw.area.isEmpty() && raw.area != "default")
+            areas.insert(raw.area);
+        batch.append(raw);
+
+        if (batch.size() == IMPORT_BATCH || i + 1 == roomsCount) {
+            conversions.append(QtConcurrent::run(convertBatch, batch, batchStart));
+            batch.clear();
+            batchStart = i + 1;
+
+            if (progress)
+                progress(i + 1, roomsCount);
+            if (canceled()) {
+                *error = "Import canceled by user";
+                failed = true;
+                break;
             }
-            return false;
         }
+    }
 
-        roomManager->addRoom(roomData[i].room);
+    for (QFuture<void> &f : conversions)
+        f.waitForFinished();
+    if (failed) {
+        doc = MapDocument();
+        return false;
     }
 
-    // Resolve exit connections using ID mapping
-    progress.setLabelText("Resolving exit connections...");
-    for (int i = 0; i < roomData.size(); ++i) {
-        progress.setValue(roomsCount + roomData.size() + i);
-        QApplication::processEvents();
-
-        CRoom *room = roomData[i].room;
-        for (int dir = 0; dir < 6; ++dir) {
-            if (roomData[i].exitPresent[dir]) {
-                uint32_t mmapperTargetId = roomData[i].mmapperExitIds[dir];
-                // Look up the remapped ID
-                if (idMapping.contains(mmapperTargetId)) {
-                    uint32_t newTargetId = idMapping[mmapperTargetId];
-                    CRoom *target = roomManager->getRoom(newTargetId);
-                    if (target != nullptr) {
-                        room->setExit(dir, target);
-                    } else {
-                        // Target room not found (shouldn't happen), mark as undefined
-                        room->setExitUndefined(dir);
-                    }
-                } else {
-                    // Target room ID not in our mapping (external reference), mark as undefined
-                    room->setExitUndefined(dir);
-                }
+    // Regions - one per MMapper area
+    for (const QString &area : areas) {
+        RegionRecord region;
+        region.name = area.toLocal8Bit();
+        doc.regions.append(region);
+    }
+
+    // Resolve exit connections using ID mapping. External references
+    // (targets not in the file) become undefined exits
+    runChunked<bool>(roomsCount, [records, &targets, &idMapping](int from, int to) {
+        for (int i = from; i < to; i++) {
+            for (int dir = 0; dir < 6; dir++) {
+                uint32_t target = targets[i * 6 + dir];
+                if (target == NO_LINK)
+                    continue;
+                auto it = idMapping.constFind(target);
+                records[i].exits[dir] =
+                    (it != idMapping.constEnd()) ? static_cast<int>(it.value()) : RoomRecord::EXIT_TARGET_UNDEFINED;
             }
         }
-    }
+        return true;
+    });
 
-    progress.setValue(progress.maximum());
+    print_debug(DEBUG_XML, "MMapper import decoded: %d rooms, %d regions", static_cast<int>(doc.rooms.size()),
+                static_cast<int>(doc.regions.size()));
+    return true;
+}
+
+void MMapperImport::commit(const MapDocument &doc, CRoomManager *roomManager)
+{
+    MapDocumentIO::toRoomManager(doc, roomManager);
 
-    print_debug(DEBUG_XML, "MMapper import complete: %d rooms imported", roomData.size());
+    print_debug(DEBUG_XML, "MMapper import complete: %d rooms imported", roomManager->size());
 
     // Focus view on room 1 or first available room
     CRoom *focusRoom = roomManager->getRoom(1);
@@ -484,15 +472,22 @@ bool MMapperImport::importFile(const QString &filename, CRoomManager *roomManage
         focusRoom = roomManager->getRooms()[0];
     }
     if (focusRoom != nullptr) {
-        stacker.reset();
-        stacker.put(focusRoom);
-        stacker.swap();
+        stacker->reset();
+        stacker->put(focusRoom);
+        stacker->swap();
         // Reset camera offset
-        if (renderer_window && renderer_window->renderer) {
-            renderer_window->renderer->setUserX(0, true);
-            renderer_window->renderer->setUserY(0, true);
-        }
+        recenter_renderer();
     }
+}
 
-    return true;
+MMapperImportThread::MMapperImportThread(const QString &filename, QObject *parent)
+    : QThread(parent), filename(filename), ok(false), canceled(0)
+{
+}
+
+void MMapperImportThread::run()
+{
+    ok = MMapperImport::readFile(filename, doc, &error, &canceled, [this](int done, int total) {
+        emit progress(done, total);
+    });
 }
@@ -22,23 +22,39 @@
 #ifndef MMAPPERIMPORT_H
 #define MMAPPERIMPORT_H
 
+#include <QAtomicInt>
 #include <QString>
+#include <QThread>
+#include <functional>
+
+#include "MapDocument.h"
 
 class CRoomManager;
-class QProgressDialog;
-class QWidget;
 
 // MMapper .mm2 file importer
 // Supports schema versions 34+ (qCompress compression)
 // Older zlib-compressed files (v25-33) are not supported to avoid external dependency
+//
+// Reading is split from committing: readFile() only builds a MapDocument and
+// may run on any thread, commit() replaces the live map and must run where the
+// map may be modified. MMapperImportThread wraps readFile() for the GUI.
 
 class MMapperImport
 {
   public:
-    // Import an MMapper .mm2 file into the room manager
+    typedef std::function<void(int done, int total)> ProgressFn;
+
+    // Import an MMapper .mm2 file into the room manager, synchronously
     // Returns true on success, false on failure
-    // parentWidget is used for progress dialog
-    static bool importFile(const QString &filename, CRoomManager *roomManager, QWidget *parentWidget = nullptr);
+    static bool importFile(const QString &filename, CRoomManager *roomManager);
+
+    // Decode the file into doc. Thread safe, reads the sector table of conf only.
+    // Stops early when *cancel becomes non-zero
+    static bool readFile(const QString &filename, MapDocument &doc, QString *error,
+                         const QAtomicInt *cancel = nullptr, const ProgressFn &progress = ProgressFn());
+
+    // Replace the map with the imported document in one go and focus the first room
+    static void commit(const MapDocument &doc, CRoomManager *roomManager);
 
     // Check if a file is a valid MMapper file
     // Returns the schema version or 0 if invalid
@@ -98,6 +114,39 @@ class MMapperImport
 
     // Convert MMapper terrain to PandoraMapper sector
     static char convertTerrain(uint8_t mmapperTerrain);
+
+    static uint32_t readVersion(const QString &filename, QString *error);
+};
+
+// Runs MMapperImport::readFile() in the background. Connect to finished()
+// and hand document() to MMapperImport::commit() on the GUI thread.
+class MMapperImportThread : public QThread
+{
+    Q_OBJECT
+
+  public:
+    explicit MMapperImportThread(const QString &filename, QObject *parent = nullptr);
+
+    bool succeeded() const { return ok; }
+    QString errorString() const { return error; }
+    bool wasCanceled() const { return canceled.loadAcquire() != 0; }
+    const MapDocument &document() const { return doc; }
+
+  public slots:
+    void cancel() { canceled.storeRelease(1); }
+
+  signals:
+    void progress(int done, int total);
+
+  protected:
+    void run() override;
+
+  private:
+    QString filename;
+    MapDocument doc;
+    QString error;
+    bool ok;
+    QAtomicInt canceled;
 };
 
 #endif // MMAPPERIMPORT_H
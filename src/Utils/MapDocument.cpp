@@ -0,0 +1,610 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "MapDocument.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+#include "xml2.h"
+
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+#include "Engine/CStacksManager.h"
+#include "Engine/CEngine.h"
+
+/* ---- helpers ---- */
+
+static void setError(QString *error, const QString &msg)
+{
+    if (error)
+        *error = msg;
+}
+
+static QDataStream &operator<<(QDataStream &s, const LocalSpaceRecord &r)
+{
+    s << r.id << r.name << r.portalX << r.portalY << r.portalZ << r.portalW << r.portalH << r.hasPortal;
+    return s;
+}
+
+static QDataStream &operator>>(QDataStream &s, LocalSpaceRecord &r)
+{
+    s >> r.id >> r.name >> r.portalX >> r.portalY >> r.portalZ >> r.portalW >> r.portalH >> r.hasPortal;
+    return s;
+}
+
+static QDataStream &operator<<(QDataStream &s, const RegionRecord &r)
+{
+    s << r.name << r.localSpaceId << r.doors;
+    return s;
+}
+
+static QDataStream &operator>>(QDataStream &s, RegionRecord &r)
+{
+    s >> r.name >> r.localSpaceId >> r.doors;
+    return s;
+}
+
+static QDataStream &operator<<(QDataStream &s, const RoomRecord &r)
+{
+    s << r.id << r.x << r.y << r.z << r.name << r.desc << r.note << r.noteColor << r.contents << r.terrain
+      << r.region;
+    for (int dir = 0; dir <= 5; dir++)
+        s << r.exits[dir] << r.doors[dir] << r.mmExitFlags[dir] << r.mmDoorFlags[dir];
+    s << r.lightType << r.alignType << r.portableType << r.ridableType << r.sundeathType << r.mobFlags
+      << r.loadFlags;
+    return s;
+}
+
+static QDataStream &operator>>(QDataStream &s, RoomRecord &r)
+{
+    s >> r.id >> r.x >> r.y >> r.z >> r.name >> r.desc >> r.note >> r.noteColor >> r.contents >> r.terrain >>
+        r.region;
+    for (int dir = 0; dir <= 5; dir++)
+        s >> r.exits[dir] >> r.doors[dir] >> r.mmExitFlags[dir] >> r.mmDoorFlags[dir];
+    s >> r.lightType >> r.alignType >> r.portableType >> r.ridableType >> r.sundeathType >> r.mobFlags >>
+        r.loadFlags;
+    return s;
+}
+
+MapDocumentIO::Format MapDocumentIO::formatByName(const QString &filename)
+{
+    QString suffix = QFileInfo(filename).suffix().toLower();
+
+    if (suffix == "xml")
+        return FORMAT_XML;
+    if (suffix == "pmb")
+        return FORMAT_BINARY;
+    if (suffix == "mm2")
+        return FORMAT_MMAPPER;
+    return FORMAT_UNKNOWN;
+}
+
+/* ---- XML ---- */
+
+bool MapDocumentIO::readXml(const QString &filename, MapDocument &doc, QString *error)
+{
+    QFile file(filename);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        setError(error, QString("Cannot open file: %1").arg(filename));
+        return false;
+    }
+    QByteArray data = filterInvalidXmlChars(file.readAll());
+    file.close();
+
+    doc = MapDocument();
+
+    QXmlStreamReader reader(data);
+    RoomRecord room;
+    RegionRecord region;
+    bool inRoom = false;
+    bool inRegion = false;
+
+    while (!reader.atEnd()) {
+        reader.readNext();
+
+        if (reader.isStartElement()) {
+            const auto tag = reader.name();
+            QXmlStreamAttributes attr = reader.attributes();
+
+            if (tag == QLatin1String("room")) {
+                room = RoomRecord();
+                room.id = attr.value("id").toUInt();
+                room.x = attr.value("x").toInt();
+                room.y = attr.value("y").toInt();
+                room.z = attr.value("z").toInt();
+                room.terrain = attr.value("terrain").toString().toUtf8();
+                room.region = attr.value("region").toString().toUtf8();
+                room.lightType = attr.value("light").toUInt();
+                room.alignType = attr.value("align").toUInt();
+                room.portableType = attr.value("portable").toUInt();
+                room.ridableType = attr.value("ridable").toUInt();
+                room.sundeathType = attr.value("sundeath").toUInt();
+                room.mobFlags = attr.value("mobflags").toUInt();
+                room.loadFlags = attr.value("loadflags").toUInt();
+                inRoom = true;
+            } else if (tag == QLatin1String("exit") && inRoom) {
+                QString dirStr = attr.value("dir").toString();
+                int dir = dirStr.isEmpty() ? -1 : numbydir(dirStr.at(0).toLatin1());
+                if (dir < 0 || dir > 5)
+                    continue;
+
+                const auto to = attr.value("to");
+                if (to == QLatin1String("DEATH"))
+                    room.exits[dir] = RoomRecord::EXIT_TARGET_DEATH;
+                else if (to == QLatin1String("UNDEFINED"))
+                    room.exits[dir] = RoomRecord::EXIT_TARGET_UNDEFINED;
+                else {
+                    bool ok = false;
+                    unsigned int target = to.toUInt(&ok);
+                    room.exits[dir] = ok ? static_cast<int>(target) : RoomRecord::EXIT_TARGET_UNDEFINED;
+                }
+                room.doors[dir] = attr.value("door").toString().toUtf8();
+                room.mmExitFlags[dir] = attr.value("exitflags").toUInt();
+                room.mmDoorFlags[dir] = attr.value("doorflags").toUInt();
+            } else if (tag == QLatin1String("roomname") && inRoom) {
+                room.name = reader.readElementText().toUtf8();
+            } else if (tag == QLatin1String("desc") && inRoom) {
+                room.desc = reader.readElementText().toUtf8();
+            } else if (tag == QLatin1String("note") && inRoom) {
+                room.noteColor = attr.value("color").toString().toUtf8();
+                room.note = reader.readElementText().toUtf8();
+            } else if (tag == QLatin1String("contents") && inRoom) {
+                room.contents = reader.readElementText().toUtf8();
+            } else if (tag == QLatin1String("region")) {
+                region = RegionRecord();
+                region.name = attr.value("name").toString().toUtf8();
+                region.localSpaceId = attr.value("localspace").toInt();
+                inRegion = true;
+            } else if (tag == QLatin1String("alias") && inRegion) {
+                region.doors.insert(attr.value("name").toString().toUtf8(), attr.value("door").toString().toUtf8());
+            } else if (tag == QLatin1String("localspace")) {
+                LocalSpaceRecord space;
+                space.id = attr.value("id").toInt();
+                space.name = attr.value("name").toString().toUtf8();
+                space.portalX = attr.value("x").toFloat();
+                space.portalY = attr.value("y").toFloat();
+                space.portalZ = attr.value("z").toFloat();
+                space.portalW = attr.value("w").toFloat();
+                space.portalH = attr.value("h").toFloat();
+                space.hasPortal = true;
+                doc.localSpaces.append(space);
+            }
+        } else if (reader.isEndElement()) {
+            if (reader.name() == QLatin1String("room") && inRoom) {
+                doc.rooms.append(room);
+                inRoom = false;
+            } else if (reader.name() == QLatin1String("region") && inRegion) {
+                doc.regions.append(region);
+                inRegion = false;
+            }
+        }
+    }
+
+    if (reader.hasError()) {
+        setError(error, QString("XML parse error: %1 (line %2, col %3)")
+                            .arg(reader.errorString())
+                            .arg(reader.lineNumber())
+                            .arg(reader.columnNumber()));
+        return false;
+    }
+    return true;
+}
+
+// Same layout as CRoomManager::saveMap(), without touching the live map
+bool MapDocumentIO::writeXml(const QString &filename, const MapDocument &doc, QString *error)
+{
+    QSaveFile file(filename);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        setError(error, QString("Cannot open file for writing: %1").arg(filename));
+        return false;
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(2);
+    xml.writeStartDocument("1.0");
+
+    xml.writeStartElement("map");
+    xml.writeAttribute("version", QString::number(MAP_FILE_VERSION));
+    xml.writeAttribute("rooms", QString::number(doc.rooms.size()));
+
+    xml.writeStartElement("localspaces");
+    for (const LocalSpaceRecord &space : doc.localSpaces) {
+        xml.writeStartElement("localspace");
+        xml.writeAttribute("id", QString::number(space.id));
+        xml.writeAttribute("name", QString::fromUtf8(space.name));
+        xml.writeAttribute("x", QString::number(space.portalX));
+        xml.writeAttribute("y", QString::number(space.portalY));
+        xml.writeAttribute("z", QString::number(space.portalZ));
+        xml.writeAttribute("w", QString::number(space.portalW));
+        xml.writeAttribute("h", QString::number(space.portalH));
+        xml.writeEndElement();  // localspace
+    }
+    xml.writeEndElement();  // localspaces
+
+    xml.writeStartElement("regions");
+    for (const RegionRecord &region : doc.regions) {
+        if (region.name == "default")
+            continue;
+        xml.writeStartElement("region");
+        xml.writeAttribute("name", QString::fromUtf8(region.name));
+        if (region.localSpaceId > 0)
+            xml.writeAttribute("localspace", QString::number(region.localSpaceId));
+        QMapIterator<QByteArray, QByteArray> iter(region.doors);
+        while (iter.hasNext()) {
+            iter.next();
+            xml.writeStartElement("alias");
+            xml.writeAttribute("name", QString::fromUtf8(iter.key()));
+            xml.writeAttribute("door", QString::fromUtf8(iter.value()));
+            xml.writeEndElement();  // alias
+        }
+        xml.writeEndElement();  // region
+    }
+    xml.writeEndElement();  // regions
+
+    for (const RoomRecord &r : doc.rooms) {
+        xml.writeStartElement("room");
+        xml.writeAttribute("id", QString::number(r.id));
+        xml.writeAttribute("x", QString::number(r.x));
+        xml.writeAttribute("y", QString::number(r.y));
+        xml.writeAttribute("z", QString::number(r.z));
+        xml.writeAttribute("terrain", r.terrain.isEmpty() ? QString("UNDEFINED") : QString::fromUtf8(r.terrain));
+        xml.writeAttribute("region", QString::fromUtf8(r.region.isEmpty() ? QByteArray("default") : r.region));
+
+        if (r.lightType != 0)
+            xml.writeAttribute("light", QString::number(r.lightType));
+        if (r.alignType != 0)
+            xml.writeAttribute("align", QString::number(r.alignType));
+        if (r.portableType != 0)
+            xml.writeAttribute("portable", QString::number(r.portableType));
+        if (r.ridableType != 0)
+            xml.writeAttribute("ridable", QString::number(r.ridableType));
+        if (r.sundeathType != 0)
+            xml.writeAttribute("sundeath", QString::number(r.sundeathType));
+        if (r.mobFlags != 0)
+            xml.writeAttribute("mobflags", QString::number(r.mobFlags));
+        if (r.loadFlags != 0)
+            xml.writeAttribute("loadflags", QString::number(r.loadFlags));
+
+        xml.writeTextElement("roomname", QString::fromUtf8(filterInvalidXmlChars(r.name)));
+        xml.writeTextElement("desc", QString::fromUtf8(filterInvalidXmlChars(r.desc)));
+
+        xml.writeStartElement("note");
+        if (!r.noteColor.isEmpty())
+            xml.writeAttribute("color", QString::fromUtf8(r.noteColor));
+        xml.writeCharacters(QString::fromUtf8(filterInvalidXmlChars(r.note)));
+        xml.writeEndElement();  // note
+
+        if (!r.contents.isEmpty())
+            xml.writeTextElement("contents", QString::fromUtf8(filterInvalidXmlChars(r.contents)));
+
+        xml.writeStartElement("exits");
+        for (int dir = 0; dir <= 5; dir++) {
+            if (r.exits[dir] == RoomRecord::EXIT_TARGET_NONE)
+                continue;
+
+            xml.writeStartElement("exit");
+            xml.writeAttribute("dir", QString(QChar(exitnames[dir][0])));
+            if (r.exits[dir] == RoomRecord::EXIT_TARGET_DEATH)
+                xml.writeAttribute("to", "DEATH");
+            else if (r.exits[dir] == RoomRecord::EXIT_TARGET_UNDEFINED)
+                xml.writeAttribute("to", "UNDEFINED");
+            else
+                xml.writeAttribute("to", QString::number(r.exits[dir]));
+            xml.writeAttribute("door", QString::fromUtf8(r.doors[dir]));
+            if (r.mmExitFlags[dir] != 0)
+                xml.writeAttribute("exitflags", QString::number(r.mmExitFlags[dir]));
+            if (r.mmDoorFlags[dir] != 0)
+                xml.writeAttribute("doorflags", QString::number(r.mmDoorFlags[dir]));
+            xml.writeEndElement();  // exit
+        }
+        xml.writeEndElement();  // exits
+
+        xml.writeEndElement();  // room
+    }
+
+    xml.writeEndElement();  // map
+    xml.writeEndDocument();
+
+    if (!file.commit()) {
+        setError(error, QString("Failed to write %1").arg(filename));
+        return false;
+    }
+    return true;
+}
+
+/* ---- binary ---- */
+
+bool MapDocumentIO::readBinary(const QString &filename, MapDocument &doc, QString *error)
+{
+    QFile file(filename);
+    quint32 magic;
+    quint32 version;
+    QByteArray payload;
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, QString("Cannot open file: %1").arg(filename));
+        return false;
+    }
+
+    QDataStream header(&file);
+    header.setVersion(QDataStream::Qt_5_12);
+    header >> magic >> version;
+    if (magic != BINARY_MAGIC) {
+        setError(error, "Not a Pandora binary map (invalid magic number)");
+        return false;
+    }
+    if (version > BINARY_VERSION) {
+        setError(error, QString("Unsupported binary map version %1").arg(version));
+        return false;
+    }
+    header >> payload;
+
+    QByteArray raw = qUncompress(payload);
+    if (raw.isEmpty()) {
+        setError(error, "Corrupted binary map (decompression failed)");
+        return false;
+    }
+
+    doc = MapDocument();
+    QDataStream stream(raw);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream >> doc.localSpaces >> doc.regions >> doc.rooms;
+
+    if (stream.status() != QDataStream::Ok) {
+        setError(error, "Corrupted binary map (truncated data)");
+        return false;
+    }
+    return true;
+}
+
+bool MapDocumentIO::writeBinary(const QString &filename, const MapDocument &doc, QString *error)
+{
+    QByteArray raw;
+    QSaveFile file(filename);
+
+    {
+        QDataStream stream(&raw, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream << doc.localSpaces << doc.regions << doc.rooms;
+    }
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        setError(error, QString("Cannot open file for writing: %1").arg(filename));
+        return false;
+    }
+
+    QDataStream header(&file);
+    header.setVersion(QDataStream::Qt_5_12);
+    header << BINARY_MAGIC << BINARY_VERSION << qCompress(raw);
+
+    if (!file.commit()) {
+        setError(error, QString("Failed to write %1").arg(filename));
+        return false;
+    }
+    return true;
+}
+
+bool MapDocumentIO::writeFile(const QString &filename, const MapDocument &doc, QString *error)
+{
+    switch (formatByName(filename)) {
+    case FORMAT_XML:
+        return writeXml(filename, doc, error);
+    case FORMAT_BINARY:
+        return writeBinary(filename, doc, error);
+    default:
+        setError(error, QString("Cannot write %1: output must be .xml or .pmb").arg(filename));
+        return false;
+    }
+}
+
+/* ---- live map conversion ---- */
+
+bool MapDocumentIO::fromRoomManager(CRoomManager *roomManager, MapDocument &doc, QString *error)
+{
+    doc = MapDocument();
+
+    QVector<LocalSpace *> spaces = roomManager->getLocalSpaces();
+    for (LocalSpace *space : spaces) {
+        LocalSpaceRecord r;
+        r.id = space->id;
+        r.name = space->name;
+        r.portalX = space->portalX;
+        r.portalY = space->portalY;
+        r.portalZ = space->portalZ;
+        r.portalW = space->portalW;
+        r.portalH = space->portalH;
+        r.hasPortal = space->hasPortal;
+        doc.localSpaces.append(r);
+    }
+
+    QList<CRegion *> regions = roomManager->getAllRegions();
+    for (CRegion *region : regions) {
+        if (region->getName() == "default")
+            continue;
+        RegionRecord r;
+        r.name = region->getName();
+        r.localSpaceId = region->getLocalSpaceId();
+        r.doors = region->getAllDoors();
+        doc.regions.append(r);
+    }
+
+    QVector<CRoom *> rooms = roomManager->getRooms();
+    doc.rooms.resize(rooms.size());
+    for (int i = 0; i < rooms.size(); i++) {
+        CRoom *room = rooms[i];
+        RoomRecord &r = doc.rooms[i];
+
+        r.id = room->id;
+        r.x = room->getX();
+        r.y = room->getY();
+        r.z = room->getZ();
+        r.name = room->getName();
+        r.desc = room->getDesc();
+        r.note = room->getNote();
+        r.noteColor = room->getNoteColor();
+        r.contents = room->getContents();
+        r.region = room->getRegionName();
+        if (room->isPaged()) {
+            if (error)
+                *error = QString("Room %1 lost its texts with an unreadable region page").arg(room->id);
+            return false;
+        }
+
+        int terrain = room->getTerrain();
+        if (terrain >= 0 && terrain < static_cast<int>(conf->sectors.size()))
+            r.terrain = conf->sectors[terrain].desc;
+        else
+            r.terrain = "UNDEFINED";
+
+        for (int dir = 0; dir <= 5; dir++) {
+            if (room->isExitDeath(dir))
+                r.exits[dir] = RoomRecord::EXIT_TARGET_DEATH;
+            else if (room->isExitUndefined(dir))
+                r.exits[dir] = RoomRecord::EXIT_TARGET_UNDEFINED;
+            else if (room->exits[dir] != nullptr)
+                r.exits[dir] = room->exits[dir]->id;
+            r.doors[dir] = room->getDoor(dir);
+            r.mmExitFlags[dir] = room->getMMExitFlags(dir);
+            r.mmDoorFlags[dir] = room->getMMDoorFlags(dir);
+        }
+
+        r.lightType = room->getLightType();
+        r.alignType = room->getAlignType();
+        r.portableType = room->getPortableType();
+        r.ridableType = room->getRidableType();
+        r.sundeathType = room->getSundeathType();
+        r.mobFlags = room->getMobFlags();
+        r.loadFlags = room->getLoadFlags();
+    }
+    return true;
+}
+
+void MapDocumentIO::toRoomManager(const MapDocument &doc, CRoomManager *roomManager)
+{
+    int i;
+    bool wasBlocked = roomManager->isBlocked();
+
+    // same preparations as for loading a map from disk
+    stacker->reset();
+    roomManager->selections.resetSelection();
+    if (engine)
+        engine->resetAddedRoomVar();
+    roomManager->setBlocked(true);
+    roomManager->reinit();
+
+    for (const LocalSpaceRecord &r : doc.localSpaces) {
+        int id = (r.id > 0) ? roomManager->addLocalSpaceWithId(r.name, r.id) : roomManager->addLocalSpace(r.name);
+        if (r.hasPortal)
+            roomManager->setLocalSpacePortal(id, r.portalX, r.portalY, r.portalZ, r.portalW, r.portalH);
+    }
+
+    for (const RegionRecord &r : doc.regions) {
+        CRegion *region = new CRegion();
+        region->setName(r.name);
+        region->setLocalSpaceId(r.localSpaceId);
+        QMapIterator<QByteArray, QByteArray> iter(r.doors);
+        while (iter.hasNext()) {
+            iter.next();
+            region->addDoor(iter.key(), iter.value());
+        }
+        roomManager->addRegion(region);
+    }
+
+    CRegion *defaultRegion = roomManager->getRegionByName("default");
+    QVector<bool> skipped(doc.rooms.size(), false); /* their exits must not land on the room added first */
+    for (i = 0; i < doc.rooms.size(); i++) {
+        const RoomRecord &r = doc.rooms[i];
+        if (r.id >= MAX_ROOMS || roomManager->getRoom(r.id) != nullptr) {
+            print_debug(DEBUG_XML, "MapDocument: skipping invalid or duplicate room id %u", r.id);
+            skipped[i] = true;
+            continue;
+        }
+
+        CRoom *room = new CRoom();
+        room->id = r.id;
+        room->setX(r.x);
+        room->setY(r.y);
+        room->simpleSetZ(r.z);
+        room->setSector(conf->getSectorByDesc(r.terrain));
+
+        CRegion *region = r.region.isEmpty() ? nullptr : roomManager->getRegionByName(r.region);
+        room->setRegion(region != nullptr ? region : defaultRegion);
+
+        room->setName(r.name);
+        room->setDesc(r.desc);
+        room->setNote(r.note);
+        room->setNoteColor(r.noteColor);
+        room->setContents(r.contents);
+
+        for (int dir = 0; dir <= 5; dir++) {
+            room->setDoor(dir, r.doors[dir]);
+            if (r.exits[dir] == RoomRecord::EXIT_TARGET_DEATH)
+                room->setExitDeath(dir);
+            else if (r.exits[dir] == RoomRecord::EXIT_TARGET_UNDEFINED)
+                room->setExitUndefined(dir);
+            room->setMMExitFlags(dir, r.mmExitFlags[dir]);
+            room->setMMDoorFlags(dir, r.mmDoorFlags[dir]);
+        }
+
+        room->setLightType(r.lightType);
+        room->setAlignType(r.alignType);
+        room->setPortableType(r.portableType);
+        room->setRidableType(r.ridableType);
+        room->setSundeathType(r.sundeathType);
+        room->setMobFlags(r.mobFlags);
+        room->setLoadFlags(r.loadFlags);
+
+        roomManager->addRoom(room);
+    }
+
+    /* second pass: resolve normal exits */
+    for (i = 0; i < doc.rooms.size(); i++) {
+        if (skipped[i])
+            continue;
+        const RoomRecord &r = doc.rooms[i];
+        CRoom *room = roomManager->getRoom(r.id);
+        if (room == nullptr)
+            continue;
+
+        for (int dir = 0; dir <= 5; dir++) {
+            if (r.exits[dir] < 0)
+                continue;
+            CRoom *target = roomManager->getRoom(r.exits[dir]);
+            if (target != nullptr)
+                room->setExit(dir, target);
+            else
+                room->setExitUndefined(dir);
+        }
+    }
+
+    roomManager->setBlocked(wasBlocked);
+}
@@ -0,0 +1,126 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MAPDOCUMENT_H
+#define MAPDOCUMENT_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+class CRoomManager;
+
+// Plain-data copy of a map. Unlike CRoom/CRoomManager it touches no globals
+// (NameMap, planes, renderer), so documents can be read, compared and
+// checked on worker threads and several of them can live side by side.
+
+struct RoomRecord
+{
+    enum ExitTargets
+    {
+        EXIT_TARGET_NONE = -1,
+        EXIT_TARGET_UNDEFINED = -2,
+        EXIT_TARGET_DEATH = -3
+    };
+
+    unsigned int id = 0;
+    int x = 0, y = 0, z = 0;
+    QByteArray name;
+    QByteArray desc;
+    QByteArray note;
+    QByteArray noteColor;
+    QByteArray contents;
+    QByteArray terrain;  // sector description, as in the XML files
+    QByteArray region;
+
+    int exits[6] = {EXIT_TARGET_NONE, EXIT_TARGET_NONE, EXIT_TARGET_NONE,
+                    EXIT_TARGET_NONE, EXIT_TARGET_NONE, EXIT_TARGET_NONE};
+    QByteArray doors[6];
+    quint16 mmExitFlags[6] = {0, 0, 0, 0, 0, 0};
+    quint16 mmDoorFlags[6] = {0, 0, 0, 0, 0, 0};
+
+    quint8 lightType = 0;
+    quint8 alignType = 0;
+    quint8 portableType = 0;
+    quint8 ridableType = 0;
+    quint8 sundeathType = 0;
+    quint32 mobFlags = 0;
+    quint32 loadFlags = 0;
+};
+
+struct RegionRecord
+{
+    QByteArray name;
+    int localSpaceId = 0;
+    QMap<QByteArray, QByteArray> doors;  // alias -> door
+};
+
+struct LocalSpaceRecord
+{
+    int id = 0;
+    QByteArray name;
+    float portalX = 0, portalY = 0, portalZ = 0, portalW = 0, portalH = 0;
+    bool hasPortal = false;
+};
+
+struct MapDocument
+{
+    QVector<LocalSpaceRecord> localSpaces;
+    QVector<RegionRecord> regions;
+    QVector<RoomRecord> rooms;
+};
+
+class MapDocumentIO
+{
+  public:
+    enum Format
+    {
+        FORMAT_UNKNOWN = 0,
+        FORMAT_XML,
+        FORMAT_BINARY,
+        FORMAT_MMAPPER
+    };
+
+    // Guess the format by extension (.xml, .pmb, .mm2)
+    static Format formatByName(const QString &filename);
+
+    // Thread safe readers/writers, they only work on the document.
+    // On failure the reason is stored in *error (if given)
+    static bool readXml(const QString &filename, MapDocument &doc, QString *error = nullptr);
+    static bool readBinary(const QString &filename, MapDocument &doc, QString *error = nullptr);
+    static bool writeBinary(const QString &filename, const MapDocument &doc, QString *error = nullptr);
+    static bool writeXml(const QString &filename, const MapDocument &doc, QString *error = nullptr);
+    // Writes XML or binary, chosen by the extension of filename
+    static bool writeFile(const QString &filename, const MapDocument &doc, QString *error = nullptr);
+
+    // Conversion from/to the live map. Must run where the map may be
+    // modified (GUI or engine thread, or a headless tool). fromRoomManager
+    // fails on rooms whose texts were lost with an unreadable region page
+    static bool fromRoomManager(CRoomManager *roomManager, MapDocument &doc, QString *error = nullptr);
+    static void toRoomManager(const MapDocument &doc, CRoomManager *roomManager);
+
+  private:
+    static constexpr quint32 BINARY_MAGIC = 0x504D4231u;  // "PMB1"
+    static constexpr quint32 BINARY_VERSION = 1;
+};
+
+#endif  // MAPDOCUMENT_H
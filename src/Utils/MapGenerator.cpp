@@ -0,0 +1,320 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "MapGenerator.h"
+
+#include <QFile>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QVector>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+#include "Engine/CStacksManager.h"
+#include "Engine/CEngine.h"
+
+QString MapGenerator::s_lastError;
+
+namespace
+{
+const char *adjectives[] = {"Dark",    "Narrow",  "Old",      "Great", "Quiet", "Winding", "Muddy",  "Grassy",
+                            "Stone",   "Dusty",   "Hidden",   "Wide",  "Small", "Steep",   "Shallow", "Ruined",
+                            "Forgotten", "Misty", "Overgrown", "Cold", nullptr};
+
+const char *nouns[] = {"Corridor", "Path",    "Road",   "Clearing", "Hall",  "Tunnel", "Bridge", "Ford",
+                       "Square",   "Alley",   "Cave",   "Forest",   "Field", "Ridge",  "Stair",  "Chamber",
+                       "Gate",     "Crossing", "Marsh", "Hillside", nullptr};
+
+const char *sentences[] = {"The walls are rough and damp.",
+                           "A thin layer of dust covers the floor.",
+                           "You hear the faint sound of dripping water.",
+                           "Tall trees rise on both sides of the trail.",
+                           "The ground is soft and muddy here.",
+                           "An old wooden sign points further along the way.",
+                           "Cold wind blows through the cracks in the rocks.",
+                           "The path bends sharply and disappears from view.",
+                           "Thick bushes block the view to the north.",
+                           "A few broken crates lie scattered around.",
+                           "Torches set in iron brackets light the way.",
+                           "The air smells of smoke and old leaves.",
+                           nullptr};
+
+const char *secretDoors[] = {"trapdoor", "panel", "boulder", "bushes", "hatch", "grate", "rubble", nullptr};
+
+const char *noteColors[] = {"#F28003", "#FF0000", "#00FF00", "#0000FF", "#FFFF00", nullptr};
+
+int countOf(const char **list)
+{
+    int i = 0;
+    while (list[i] != nullptr)
+        i++;
+    return i;
+}
+
+inline quint64 coordKey(int x, int y, int z)
+{
+    return (static_cast<quint64>(static_cast<quint32>(x) & 0x1FFFFF) << 42) |
+           (static_cast<quint64>(static_cast<quint32>(y) & 0x1FFFFF) << 21) |
+           (static_cast<quint64>(static_cast<quint32>(z) & 0x1FFFFF));
+}
+
+struct GenRegion
+{
+    CRegion *region;
+    QVector<QByteArray> names;
+    int terrain;
+};
+
+QByteArray makeDesc(unsigned int seed, int nameIndex, int variant)
+{
+    QRandomGenerator rng(seed ^ (nameIndex * 7919u + variant * 104729u + 1u));
+    int amount = countOf(sentences);
+    int lines = 3 + rng.bounded(3);
+    QByteArray desc;
+
+    for (int i = 0; i < lines; i++) {
+        desc.append(sentences[rng.bounded(amount)]);
+        desc.append('|');
+    }
+    return desc;
+}
+
+}  // namespace
+
+QString MapGenerator::lastError()
+{
+    return s_lastError;
+}
+
+int MapGenerator::generate(CRoomManager *roomManager, const MapGeneratorOptions &options)
+{
+    QRandomGenerator rng(options.seed);
+    QHash<quint64, CRoom *> occupied;
+    QVector<GenRegion> genRegions;
+    QVector<CRoom *> created;
+    int amount;
+    int regionsAmount;
+    int sectors;
+    int i;
+
+    s_lastError.clear();
+
+    amount = options.rooms;
+    if (amount >= MAX_ROOMS) {
+        print_debug(DEBUG_ROOMS, "MapGenerator: %d rooms requested, capping at MAX_ROOMS-1 (%d)", amount,
+                    MAX_ROOMS - 1);
+        amount = MAX_ROOMS - 1;
+    }
+    if (amount <= 0) {
+        s_lastError = "Nothing to generate";
+        return 0;
+    }
+    regionsAmount = qBound(1, options.regions, amount);
+    sectors = qMax(1, static_cast<int>(conf->sectors.size()));
+
+    // same preparations as for loading a map from disk
+    stacker->reset();
+    roomManager->selections.resetSelection();
+    if (engine)
+        engine->resetAddedRoomVar();
+    roomManager->setBlocked(true);
+    roomManager->reinit();
+    occupied.reserve(amount);
+    created.reserve(amount);
+
+    /* regions, their name pools and local spaces */
+    int adjAmount = countOf(adjectives);
+    int nounAmount = countOf(nouns);
+    for (i = 0; i < regionsAmount; i++) {
+        GenRegion gen;
+        QByteArray regionName = "region" + QByteArray::number(i + 1);
+
+        roomManager->addRegion(regionName);
+        gen.region = roomManager->getRegionByName(regionName);
+        gen.terrain = rng.bounded(sectors);
+        for (int n = 0; n < qMax(1, options.namesPerRegion); n++) {
+            QByteArray name = QByteArray("The ") + adjectives[rng.bounded(adjAmount)] + " " +
+                              nouns[rng.bounded(nounAmount)];
+            gen.names.append(name);
+        }
+
+        if (i >= regionsAmount - options.localSpaces && i > 0) {
+            int spaceId = roomManager->addLocalSpace("space" + QByteArray::number(i + 1));
+            roomManager->setRegionLocalSpace(gen.region, spaceId);
+        }
+        genRegions.append(gen);
+    }
+
+    /* grow the map region by region */
+    int perRegion = amount / regionsAmount;
+    int regionIndex = 0;
+    int regionStart = 0;
+    int attempts = 0;
+    int secretAmount = countOf(secretDoors);
+
+    while (created.size() < amount && attempts < amount * 50) {
+        attempts++;
+
+        if (regionIndex < regionsAmount - 1 && created.size() - regionStart >= perRegion) {
+            regionIndex++;
+            regionStart = created.size();
+        }
+        GenRegion &gen = genRegions[regionIndex];
+
+        CRoom *parent = nullptr;
+        int dir = 0;
+        int x = 0, y = 0, z = 0;
+
+        if (!created.isEmpty()) {
+            // new regions bud off the previous one, inside a region prefer
+            // the latest rooms to get corridors rather than blobs
+            int from = (created.size() == regionStart) ? 0 : regionStart;
+            if (rng.bounded(2) == 0)
+                parent = created.last();
+            else
+                parent = created[from + rng.bounded(created.size() - from)];
+
+            if (rng.generateDouble() < options.verticalRatio)
+                dir = UP + rng.bounded(2);
+            else
+                dir = rng.bounded(4);
+
+            if (parent->isExitPresent(dir))
+                continue;
+
+            x = parent->getX();
+            y = parent->getY();
+            z = parent->getZ();
+            if (dir == NORTH)
+                y += 2;
+            if (dir == SOUTH)
+                y -= 2;
+            if (dir == EAST)
+                x += 2;
+            if (dir == WEST)
+                x -= 2;
+            if (dir == UP)
+                z += 1;
+            if (dir == DOWN)
+                z -= 1;
+
+            CRoom *neighbour = occupied.value(coordKey(x, y, z), nullptr);
+            if (neighbour != nullptr) {
+                // close a loop instead, if the other side is free as well
+                if (rng.generateDouble() < options.loopRatio && !neighbour->isExitPresent(reversenum(dir))) {
+                    parent->setExit(dir, neighbour);
+                    neighbour->setExit(reversenum(dir), parent);
+                }
+                continue;
+            }
+        }
+
+        CRoom *room = new CRoom;
+        int nameIndex = rng.bounded(gen.names.size());
+
+        room->id = created.size() + 1;
+        room->setName(gen.names[nameIndex]);
+        room->setDesc(makeDesc(options.seed + regionIndex * 131u, nameIndex,
+                               rng.bounded(qMax(1, options.descsPerName))));
+        room->setRegion(gen.region);
+        room->setSector(rng.bounded(10) < 7 ? gen.terrain : rng.bounded(sectors));
+        room->setX(x);
+        room->setY(y);
+        room->simpleSetZ(z);
+
+        roomManager->addRoom(room);
+        occupied.insert(coordKey(x, y, z), room);
+        created.append(room);
+
+        if (parent != nullptr) {
+            parent->setExit(dir, room);
+            if (rng.generateDouble() >= options.onewayRatio)
+                room->setExit(reversenum(dir), parent);
+
+            double door = rng.generateDouble();
+            if (door < options.secretDoorRatio) {
+                QByteArray doorName = secretDoors[rng.bounded(secretAmount)];
+                parent->setDoor(dir, doorName);
+                room->setDoor(reversenum(dir), doorName);
+            } else if (door < options.secretDoorRatio + options.doorRatio) {
+                parent->setDoor(dir, "exit");
+                room->setDoor(reversenum(dir), "exit");
+            }
+        }
+    }
+
+    if (created.size() < amount)
+        print_debug(DEBUG_ROOMS, "MapGenerator: gave up growing after %d attempts, %d rooms placed", attempts,
+                    static_cast<int>(created.size()));
+
+    /* decorations: unexplored exits, deathtraps, notes and MMapper flags */
+    int colorAmount = countOf(noteColors);
+    for (i = 0; i < created.size(); i++) {
+        CRoom *room = created[i];
+        int dir = rng.bounded(6);
+
+        if (!room->isExitPresent(dir)) {
+            double r = rng.generateDouble();
+            if (r < options.deathRatio) {
+                room->setExitDeath(dir);
+                room->setLoadFlags(room->getLoadFlags() | MM_LOAD_DEATHTRAP);
+            } else if (r < options.deathRatio + options.undefinedRatio) {
+                room->setExitUndefined(dir);
+            }
+        }
+
+        if (rng.generateDouble() < options.noteRatio) {
+            room->setNote("generated note " + QByteArray::number(room->id));
+            room->setNoteColor(noteColors[rng.bounded(colorAmount)]);
+        }
+
+        if (rng.generateDouble() < options.flagsRatio) {
+            room->setMobFlags(1u << rng.bounded(19));
+            room->setLoadFlags(room->getLoadFlags() | (1u << rng.bounded(24)));
+            room->setLightType(1 + rng.bounded(2));
+        }
+    }
+
+    roomManager->setBlocked(false);
+
+    print_debug(DEBUG_ROOMS, "MapGenerator: generated %d rooms in %d regions (seed %u)",
+                static_cast<int>(created.size()),
+                regionsAmount, options.seed);
+
+    return static_cast<int>(created.size());
+}
+
+bool MapGenerator::generateFile(const QString &filename, const MapGeneratorOptions &options)
+{
+    if (generate(&Map, options) == 0)
+        return false;
+
+    Map.saveMap(filename);
+    if (!QFile::exists(filename)) {
+        s_lastError = QString("Failed to save the generated map to %1").arg(filename);
+        return false;
+    }
+    return true;
+}
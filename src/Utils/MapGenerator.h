@@ -0,0 +1,71 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MAPGENERATOR_H
+#define MAPGENERATOR_H
+
+#include <QString>
+
+class CRoomManager;
+
+// Parameters of a synthetic map. Ratios are per room (or per exit for the
+// exit related ones), all randomness comes from the seed.
+struct MapGeneratorOptions
+{
+    int rooms = 10000;
+    int regions = 40;
+    int localSpaces = 3;       // the last regions get their own local space
+    int namesPerRegion = 25;   // small pools give realistic name repetition
+    int descsPerName = 3;      // same-named rooms often share a description
+    double loopRatio = 0.15;   // links into already existing neighbours
+    double onewayRatio = 0.02;
+    double doorRatio = 0.05;
+    double secretDoorRatio = 0.01;
+    double deathRatio = 0.002;
+    double undefinedRatio = 0.01;
+    double noteRatio = 0.02;
+    double flagsRatio = 0.03;  // mob/load flags
+    double verticalRatio = 0.04;
+    unsigned int seed = 1;
+};
+
+// Synthetic large-map generator for scale testing. Builds a connected,
+// region-clustered map by growing rooms out of a random walk over the
+// coordinate grid.
+
+class MapGenerator
+{
+  public:
+    // Fill the room manager (which is reinitialised first) with a generated map
+    // Returns the amount of rooms created
+    static int generate(CRoomManager *roomManager, const MapGeneratorOptions &options);
+
+    // Generate into the global map and save it in the native XML format
+    static bool generateFile(const QString &filename, const MapGeneratorOptions &options);
+
+    // Get error message from last operation
+    static QString lastError();
+
+  private:
+    static QString s_lastError;
+};
+
+#endif  // MAPGENERATOR_H
@@ -0,0 +1,590 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "MapTools.h"
+
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QtConcurrent>
+
+#include "defines.h"
+#include "parallel.h"
+#include "utils.h"
+
+#include "Map/CRoom.h"
+
+namespace
+{
+typedef QHash<unsigned int, int> RoomIndex; /* room id -> position in doc.rooms */
+
+/* a room's spot, keyed on the full coordinates so far-apart rooms never collide */
+struct Spot
+{
+    int space;
+    int x;
+    int y;
+    int z;
+
+    bool operator==(const Spot &o) const { return space == o.space && x == o.x && y == o.y && z == o.z; }
+};
+
+inline size_t qHash(const Spot &s, size_t seed = 0)
+{
+    return qHashMulti(seed, s.space, s.x, s.y, s.z);
+}
+
+QVector<MapIssue> checkDangling(const MapDocument &doc, const RoomIndex &index)
+{
+    QVector<MapIssue> issues;
+    for (const RoomRecord &r : doc.rooms)
+        for (int dir = 0; dir <= 5; dir++)
+            if (r.exits[dir] >= 0 && !index.contains(r.exits[dir]))
+                issues.append({MapIssue::DANGLING_EXIT, r.id, dir, static_cast<unsigned int>(r.exits[dir])});
+    return issues;
+}
+
+QVector<MapIssue> checkOverlaps(const MapDocument &doc)
+{
+    QHash<QByteArray, int> spaceByRegion;
+    QHash<Spot, unsigned int> spots;
+    QVector<MapIssue> issues;
+
+    for (const RegionRecord &region : doc.regions)
+        spaceByRegion.insert(region.name, region.localSpaceId);
+
+    spots.reserve(doc.rooms.size());
+    for (const RoomRecord &r : doc.rooms) {
+        Spot key{spaceByRegion.value(r.region, 0), r.x, r.y, r.z};
+        auto it = spots.constFind(key);
+        if (it != spots.constEnd())
+            issues.append({MapIssue::OVERLAPPING_COORDS, r.id, -1, it.value()});
+        else
+            spots.insert(key, r.id);
+    }
+    return issues;
+}
+
+QVector<MapIssue> checkLinks(const MapDocument &doc, const RoomIndex &index)
+{
+    QVector<QVector<MapIssue>> parts = runChunked<QVector<MapIssue>>(doc.rooms.size(), [&doc, &index](int from, int to) {
+        QVector<MapIssue> issues;
+        for (int i = from; i < to; i++) {
+            const RoomRecord &r = doc.rooms[i];
+            for (int dir = 0; dir <= 5; dir++) {
+                int target = r.exits[dir];
+                if (target < 0 || !index.contains(target))
+                    continue;
+                const RoomRecord &t = doc.rooms[index.value(target)];
+                int back = t.exits[reversenum(dir)];
+                if (back == static_cast<int>(r.id))
+                    continue;
+                if (back >= 0)
+                    issues.append({MapIssue::ASYMMETRIC_LINK, r.id, dir, static_cast<unsigned int>(target)});
+                else
+                    issues.append({MapIssue::ONEWAY_LINK, r.id, dir, static_cast<unsigned int>(target)});
+            }
+        }
+        return issues;
+    });
+
+    QVector<MapIssue> issues;
+    for (const QVector<MapIssue> &part : parts)
+        issues += part;
+    return issues;
+}
+
+QByteArray compareRooms(const RoomRecord &a, const RoomRecord &b)
+{
+    QByteArray fields;
+
+    auto add = [&fields](const char *field) {
+        if (!fields.isEmpty())
+            fields += ", ";
+        fields += field;
+    };
+
+    if (a.name != b.name)
+        add("name");
+    if (a.desc != b.desc)
+        add("desc");
+    if (a.note != b.note || a.noteColor != b.noteColor)
+        add("note");
+    if (a.terrain != b.terrain)
+        add("terrain");
+    if (a.region != b.region)
+        add("region");
+    if (a.x != b.x || a.y != b.y || a.z != b.z)
+        add("coords");
+    if (a.contents != b.contents)
+        add("contents");
+    if (a.mobFlags != b.mobFlags || a.loadFlags != b.loadFlags || a.lightType != b.lightType ||
+        a.alignType != b.alignType || a.portableType != b.portableType || a.ridableType != b.ridableType ||
+        a.sundeathType != b.sundeathType)
+        add("flags");
+    for (int dir = 0; dir <= 5; dir++) {
+        if (a.exits[dir] != b.exits[dir] || a.mmExitFlags[dir] != b.mmExitFlags[dir])
+            add(exits[dir]);
+        if (a.doors[dir] != b.doors[dir] || a.mmDoorFlags[dir] != b.mmDoorFlags[dir])
+            add(QByteArray(exits[dir]).append(" door").constData());
+    }
+    return fields;
+}
+
+enum FieldMerge
+{
+    FIELD_SAME = 0,
+    FIELD_TAKEN,
+    FIELD_CONFLICT
+};
+
+/* three-way merge of one field: as in the base map, as merged so far and as staged */
+template <typename T>
+FieldMerge mergeField(const T &base, T &merged, const T &staged)
+{
+    if (staged == base || staged == merged)
+        return FIELD_SAME;
+    if (merged != base)
+        return FIELD_CONFLICT;
+    merged = staged;
+    return FIELD_TAKEN;
+}
+
+/* the fields the engine maps; true if any was taken, conflicting ones are listed in conflicts */
+bool mergeRoom(const RoomRecord &base, RoomRecord &merged, const RoomRecord &staged, QByteArray &conflicts)
+{
+    bool taken = false;
+
+    auto note = [&taken, &conflicts](FieldMerge result, const QByteArray &field) {
+        if (result == FIELD_TAKEN) {
+            taken = true;
+        } else if (result == FIELD_CONFLICT) {
+            if (!conflicts.isEmpty())
+                conflicts += ", ";
+            conflicts += field;
+        }
+    };
+
+    note(mergeField(base.name, merged.name, staged.name), "name");
+    note(mergeField(base.desc, merged.desc, staged.desc), "desc");
+    note(mergeField(base.terrain, merged.terrain, staged.terrain), "terrain");
+    for (int dir = 0; dir <= 5; dir++) {
+        QPair<int, quint16> exit = qMakePair(merged.exits[dir], merged.mmExitFlags[dir]);
+        note(mergeField(qMakePair(base.exits[dir], base.mmExitFlags[dir]), exit,
+                        qMakePair(staged.exits[dir], staged.mmExitFlags[dir])),
+             exits[dir]);
+        merged.exits[dir] = exit.first;
+        merged.mmExitFlags[dir] = exit.second;
+
+        QPair<QByteArray, quint16> door = qMakePair(merged.doors[dir], merged.mmDoorFlags[dir]);
+        note(mergeField(qMakePair(base.doors[dir], base.mmDoorFlags[dir]), door,
+                        qMakePair(staged.doors[dir], staged.mmDoorFlags[dir])),
+             QByteArray(exits[dir]).append(" door"));
+        merged.doors[dir] = door.first;
+        merged.mmDoorFlags[dir] = door.second;
+    }
+    return taken;
+}
+
+}  // namespace
+
+const char *MapTools::issueKindName(int kind)
+{
+    static const char *names[] = {"dangling exits", "duplicate ids", "overlapping coordinates",
+                                  "asymmetric links", "oneway links"};
+    if (kind < 0 || kind >= MapIssue::KIND_COUNT)
+        return "unknown";
+    return names[kind];
+}
+
+QByteArray MapTools::issueToText(const MapIssue &issue)
+{
+    switch (issue.kind) {
+    case MapIssue::DANGLING_EXIT:
+        return QByteArray("room ") + QByteArray::number(issue.id) + " " + exits[issue.dir] + " -> missing room " +
+               QByteArray::number(issue.other);
+    case MapIssue::DUPLICATE_ID:
+        return QByteArray("room id ") + QByteArray::number(issue.id) + " is used more than once";
+    case MapIssue::OVERLAPPING_COORDS:
+        return QByteArray("room ") + QByteArray::number(issue.id) + " shares its coordinates with room " +
+               QByteArray::number(issue.other);
+    case MapIssue::ASYMMETRIC_LINK:
+        return QByteArray("room ") + QByteArray::number(issue.id) + " " + exits[issue.dir] + " -> " +
+               QByteArray::number(issue.other) + ", but the way back leads elsewhere";
+    case MapIssue::ONEWAY_LINK:
+        return QByteArray("room ") + QByteArray::number(issue.id) + " " + exits[issue.dir] + " -> " +
+               QByteArray::number(issue.other) + " has no way back";
+    default:
+        return "unknown issue";
+    }
+}
+
+QVector<MapIssue> MapTools::validate(const MapDocument &doc)
+{
+    RoomIndex index;
+    QVector<MapIssue> issues;
+
+    index.reserve(doc.rooms.size());
+    for (int i = 0; i < doc.rooms.size(); i++) {
+        unsigned int id = doc.rooms[i].id;
+        if (index.contains(id))
+            issues.append({MapIssue::DUPLICATE_ID, id, -1, id});
+        else
+            index.insert(id, i);
+    }
+
+    // the checks only read the document, so they run side by side
+    QFuture<QVector<MapIssue>> dangling = QtConcurrent::run([&doc, &index]() { return checkDangling(doc, index); });
+    QFuture<QVector<MapIssue>> overlaps = QtConcurrent::run([&doc]() { return checkOverlaps(doc); });
+    QVector<MapIssue> links = checkLinks(doc, index);
+
+    issues += dangling.result();
+    issues += overlaps.result();
+    issues += links;
+
+    return issues;
+}
+
+MapStats MapTools::stats(const MapDocument &doc)
+{
+    MapStats s;
+    QHash<QByteArray, int> names;
+    bool first = true;
+
+    s.rooms = doc.rooms.size();
+    s.regions = doc.regions.size();
+    s.localSpaces = doc.localSpaces.size();
+
+    for (const RoomRecord &r : doc.rooms) {
+        for (int dir = 0; dir <= 5; dir++) {
+            if (r.exits[dir] >= 0)
+                s.normalExits++;
+            else if (r.exits[dir] == RoomRecord::EXIT_TARGET_UNDEFINED)
+                s.undefinedExits++;
+            else if (r.exits[dir] == RoomRecord::EXIT_TARGET_DEATH)
+                s.deathExits++;
+
+            if (!r.doors[dir].isEmpty()) {
+                s.doors++;
+                if (r.doors[dir] != "exit")
+                    s.secretDoors++;
+            }
+        }
+        if (!r.note.isEmpty())
+            s.notes++;
+
+        int &repeat = names[r.name];
+        repeat++;
+        if (repeat > s.maxNameRepeat) {
+            s.maxNameRepeat = repeat;
+            s.mostRepeatedName = r.name;
+        }
+
+        s.roomsByRegion[r.region.isEmpty() ? QByteArray("default") : r.region]++;
+        s.roomsByTerrain[r.terrain]++;
+
+        if (first) {
+            s.minX = s.maxX = r.x;
+            s.minY = s.maxY = r.y;
+            s.minZ = s.maxZ = r.z;
+            first = false;
+        }
+        s.minX = qMin(s.minX, r.x);
+        s.maxX = qMax(s.maxX, r.x);
+        s.minY = qMin(s.minY, r.y);
+        s.maxY = qMax(s.maxY, r.y);
+        s.minZ = qMin(s.minZ, r.z);
+        s.maxZ = qMax(s.maxZ, r.z);
+    }
+    s.distinctNames = names.size();
+
+    return s;
+}
+
+QByteArray MapTools::statsToText(const MapStats &s)
+{
+    QByteArray out;
+
+    out += "Rooms            : " + QByteArray::number(s.rooms) + "\n";
+    out += "Regions          : " + QByteArray::number(s.regions) + "\n";
+    out += "Local spaces     : " + QByteArray::number(s.localSpaces) + "\n";
+    out += "Exits            : " + QByteArray::number(s.normalExits) + " normal, " +
+           QByteArray::number(s.undefinedExits) + " undefined, " + QByteArray::number(s.deathExits) + " death\n";
+    out += "Doors            : " + QByteArray::number(s.doors) + " (" + QByteArray::number(s.secretDoors) +
+           " secret)\n";
+    out += "Notes            : " + QByteArray::number(s.notes) + "\n";
+    out += "Distinct names   : " + QByteArray::number(s.distinctNames) + " (most repeated: " + s.mostRepeatedName +
+           " x" + QByteArray::number(s.maxNameRepeat) + ")\n";
+    out += "Bounding box     : x " + QByteArray::number(s.minX) + ".." + QByteArray::number(s.maxX) + ", y " +
+           QByteArray::number(s.minY) + ".." + QByteArray::number(s.maxY) + ", z " + QByteArray::number(s.minZ) +
+           ".." + QByteArray::number(s.maxZ) + "\n";
+
+    out += "Rooms by terrain :\n";
+    for (auto it = s.roomsByTerrain.constBegin(); it != s.roomsByTerrain.constEnd(); ++it)
+        out += "  " + it.key() + ": " + QByteArray::number(it.value()) + "\n";
+    out += "Rooms by region  :\n";
+    for (auto it = s.roomsByRegion.constBegin(); it != s.roomsByRegion.constEnd(); ++it)
+        out += "  " + it.key() + ": " + QByteArray::number(it.value()) + "\n";
+
+    return out;
+}
+
+MapDiff MapTools::diff(const MapDocument &first, const MapDocument &second)
+{
+    RoomIndex firstIndex;
+    RoomIndex secondIndex;
+    MapDiff result;
+
+    // both indexes are independent
+    QFuture<void> indexing = QtConcurrent::run([&first, &firstIndex]() {
+        firstIndex.reserve(first.rooms.size());
+        for (int i = 0; i < first.rooms.size(); i++)
+            firstIndex.insert(first.rooms[i].id, i);
+    });
+    secondIndex.reserve(second.rooms.size());
+    for (int i = 0; i < second.rooms.size(); i++)
+        secondIndex.insert(second.rooms[i].id, i);
+    indexing.waitForFinished();
+
+    typedef QVector<QPair<unsigned int, QByteArray>> Changes;
+    QVector<Changes> parts = runChunked<Changes>(first.rooms.size(), [&first, &second, &secondIndex](int from, int to) {
+        Changes changes;
+        for (int i = from; i < to; i++) {
+            const RoomRecord &a = first.rooms[i];
+            auto it = secondIndex.constFind(a.id);
+            if (it == secondIndex.constEnd())
+                continue;
+            QByteArray fields = compareRooms(a, second.rooms[it.value()]);
+            if (!fields.isEmpty())
+                changes.append(qMakePair(a.id, fields));
+        }
+        return changes;
+    });
+    for (const Changes &part : parts)
+        result.changed += part;
+
+    for (const RoomRecord &r : first.rooms)
+        if (!secondIndex.contains(r.id))
+            result.removed.append(r.id);
+    for (const RoomRecord &r : second.rooms)
+        if (!firstIndex.contains(r.id))
+            result.added.append(r.id);
+
+    return result;
+}
+
+static inline bool isSecretDoor(const QByteArray &door)
+{
+    return !door.isEmpty() && door != "exit";
+}
+
+bool MapTools::publicSubset(const MapDocument &doc, unsigned int startId, MapDocument &out)
+{
+    RoomIndex index;
+    QVector<char> reached(doc.rooms.size(), 0);
+    QVector<int> queue;
+    QSet<QByteArray> usedRegions;
+
+    index.reserve(doc.rooms.size());
+    for (int i = 0; i < doc.rooms.size(); i++)
+        index.insert(doc.rooms[i].id, i);
+
+    auto start = index.constFind(startId);
+    if (start == index.constEnd())
+        return false;
+
+    /* "wave" over all rooms reachable over non-secret exits */
+    queue.reserve(doc.rooms.size());
+    queue.append(start.value());
+    reached[start.value()] = 1;
+    for (int head = 0; head < queue.size(); head++) {
+        const RoomRecord &r = doc.rooms[queue[head]];
+        for (int dir = 0; dir <= 5; dir++) {
+            if (r.exits[dir] < 0 || isSecretDoor(r.doors[dir]))
+                continue;
+            auto it = index.constFind(r.exits[dir]);
+            if (it != index.constEnd() && !reached[it.value()]) {
+                reached[it.value()] = 1;
+                queue.append(it.value());
+            }
+        }
+    }
+
+    out = MapDocument();
+    out.localSpaces = doc.localSpaces;
+    out.rooms.reserve(queue.size());
+
+    for (int i = 0; i < doc.rooms.size(); i++) {
+        if (!reached[i])
+            continue;
+
+        RoomRecord r = doc.rooms[i];
+        r.note.clear();
+        r.noteColor.clear();
+
+        for (int dir = 0; dir <= 5; dir++) {
+            bool secret = isSecretDoor(r.doors[dir]);
+            bool hidden = false;
+
+            if (r.exits[dir] >= 0) {
+                auto it = index.constFind(r.exits[dir]);
+                hidden = (it == index.constEnd() || !reached[it.value()]);
+            } else if (r.exits[dir] == RoomRecord::EXIT_TARGET_UNDEFINED) {
+                // an undefined exit behind a secret door only tells where the door is
+                hidden = secret;
+            }
+
+            if (hidden) {
+                r.exits[dir] = RoomRecord::EXIT_TARGET_NONE;
+                r.doors[dir].clear();
+                r.mmExitFlags[dir] = 0;
+                r.mmDoorFlags[dir] = 0;
+            } else if (secret) {
+                r.doors[dir].clear();
+                r.mmDoorFlags[dir] = 0;
+                r.mmExitFlags[dir] &= ~MM_EXIT_DOOR;
+            }
+        }
+
+        usedRegions.insert(r.region);
+        out.rooms.append(r);
+    }
+
+    // door aliases name the secret doors, only the region names are kept
+    for (const RegionRecord &region : doc.regions) {
+        if (!usedRegions.contains(region.name))
+            continue;
+        RegionRecord r = region;
+        r.doors.clear();
+        out.regions.append(r);
+    }
+
+    return true;
+}
+
+MapMerge MapTools::mergeStaged(const MapDocument &base, const QVector<MapDocument> &staged, MapDocument &out)
+{
+    RoomIndex baseIndex;  /* positions are the same in base.rooms and out.rooms */
+    RoomIndex addedIndex; /* merged id of a new room -> position in out.rooms */
+    QHash<unsigned int, RoomRecord> addedBase; /* new rooms as first added, the base of later merges */
+    QHash<QByteArray, unsigned int> addedBySight;
+    QHash<Spot, unsigned int> addedSpots;
+    QHash<QByteArray, int> spaceByRegion;
+    QSet<unsigned int> updated;
+    unsigned int nextId = 1;
+    MapMerge result;
+
+    out = base;
+    baseIndex.reserve(base.rooms.size());
+    for (int i = 0; i < base.rooms.size(); i++) {
+        baseIndex.insert(base.rooms[i].id, i);
+        nextId = qMax(nextId, base.rooms[i].id + 1);
+    }
+    for (const RegionRecord &region : base.regions)
+        spaceByRegion.insert(region.name, region.localSpaceId);
+
+    for (int s = 0; s < staged.size(); s++) {
+        const MapDocument &doc = staged[s];
+        QHash<unsigned int, unsigned int> idMap; /* new room: staged id -> merged id, 0 if dropped */
+        QSet<unsigned int> present;
+        QByteArray prefix = "log " + QByteArray::number(s + 1) + ": ";
+
+        for (const RegionRecord &region : doc.regions) {
+            if (spaceByRegion.contains(region.name))
+                continue;
+            spaceByRegion.insert(region.name, region.localSpaceId);
+            out.regions.append(region);
+        }
+
+        /* ids for the new rooms first, exits of any room may lead into them */
+        for (const RoomRecord &r : doc.rooms) {
+            present.insert(r.id);
+            if (baseIndex.contains(r.id))
+                continue;
+
+            QByteArray sight = r.name + '\n' + r.desc + '\n' + r.region + '\n' + QByteArray::number(r.x) + ',' +
+                               QByteArray::number(r.y) + ',' + QByteArray::number(r.z);
+            auto same = addedBySight.constFind(sight);
+            if (same != addedBySight.constEnd()) {
+                idMap.insert(r.id, same.value());
+                continue;
+            }
+
+            Spot spot{spaceByRegion.value(r.region, 0), r.x, r.y, r.z};
+            auto taken = addedSpots.constFind(spot);
+            if (taken != addedSpots.constEnd()) {
+                result.conflicts.append(prefix + "new room \"" + r.name + "\" is on the spot of new room " +
+                                        QByteArray::number(taken.value()) + ", dropped");
+                idMap.insert(r.id, 0);
+                continue;
+            }
+
+            idMap.insert(r.id, nextId);
+            addedBySight.insert(sight, nextId);
+            addedSpots.insert(spot, nextId);
+            nextId++;
+        }
+
+        for (const RoomRecord &stagedRoom : doc.rooms) {
+            RoomRecord r = stagedRoom;
+            QByteArray conflicts;
+
+            for (int dir = 0; dir <= 5; dir++) {
+                int target = r.exits[dir];
+                if (target < 0 || baseIndex.contains(target))
+                    continue;
+                unsigned int id = idMap.value(target, 0);
+                r.exits[dir] = id ? static_cast<int>(id) : static_cast<int>(RoomRecord::EXIT_TARGET_UNDEFINED);
+            }
+
+            auto inBase = baseIndex.constFind(r.id);
+            if (inBase != baseIndex.constEnd()) {
+                if (mergeRoom(base.rooms[inBase.value()], out.rooms[inBase.value()], r, conflicts))
+                    updated.insert(r.id);
+            } else {
+                r.id = idMap.value(r.id, 0);
+                if (r.id == 0)
+                    continue;
+
+                auto known = addedIndex.constFind(r.id);
+                if (known == addedIndex.constEnd()) {
+                    addedIndex.insert(r.id, out.rooms.size());
+                    addedBase.insert(r.id, r);
+                    out.rooms.append(r);
+                    result.added++;
+                    continue;
+                }
+                mergeRoom(addedBase.value(r.id), out.rooms[known.value()], r, conflicts);
+            }
+
+            if (!conflicts.isEmpty())
+                result.conflicts.append(prefix + "room " + QByteArray::number(r.id) + ": " + conflicts +
+                                        " changed differently, the earlier change is kept");
+        }
+
+        for (const RoomRecord &r : base.rooms)
+            if (!present.contains(r.id))
+                result.conflicts.append(prefix + "room " + QByteArray::number(r.id) + " was removed, it is kept");
+    }
+
+    result.updated = updated.size();
+    return result;
+}
@@ -0,0 +1,107 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MAPTOOLS_H
+#define MAPTOOLS_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QVector>
+
+#include "MapDocument.h"
+
+struct MapIssue
+{
+    enum Kind
+    {
+        DANGLING_EXIT = 0, /* exit into a room id that does not exist */
+        DUPLICATE_ID,      /* the same room id appears more than once */
+        OVERLAPPING_COORDS, /* two rooms on one spot of the same local space */
+        ASYMMETRIC_LINK,   /* the way back leads to a different room */
+        ONEWAY_LINK,       /* no way back at all - often legit, reported for review */
+        KIND_COUNT
+    };
+
+    Kind kind;
+    unsigned int id;
+    int dir;            /* -1 if not exit related */
+    unsigned int other; /* the other room involved, if any */
+};
+
+struct MapStats
+{
+    int rooms = 0;
+    int regions = 0;
+    int localSpaces = 0;
+    int normalExits = 0;
+    int undefinedExits = 0;
+    int deathExits = 0;
+    int doors = 0;
+    int secretDoors = 0;
+    int notes = 0;
+    int distinctNames = 0;
+    int maxNameRepeat = 0;
+    QByteArray mostRepeatedName;
+    int minX = 0, maxX = 0, minY = 0, maxY = 0, minZ = 0, maxZ = 0;
+    QMap<QByteArray, int> roomsByRegion;
+    QMap<QByteArray, int> roomsByTerrain;
+};
+
+struct MapDiff
+{
+    QVector<unsigned int> added;   /* only in the second map */
+    QVector<unsigned int> removed; /* only in the first map */
+    QVector<QPair<unsigned int, QByteArray>> changed; /* id and the list of changed fields */
+};
+
+struct MapMerge
+{
+    int added = 0;   /* rooms new to the base map */
+    int updated = 0; /* base rooms changed by at least one staged map */
+    QVector<QByteArray> conflicts;
+};
+
+// Validation, statistics and structural diff over map documents. The work
+// is split over QThreadPool::globalInstance() where the parts are independent.
+
+class MapTools
+{
+  public:
+    static QVector<MapIssue> validate(const MapDocument &doc);
+    static MapStats stats(const MapDocument &doc);
+    static MapDiff diff(const MapDocument &first, const MapDocument &second);
+
+    // The part of the map reachable from startId without passing secret doors,
+    // with secret doors, door aliases and notes stripped. Pure, doc is not changed
+    static bool publicSubset(const MapDocument &doc, unsigned int startId, MapDocument &out);
+
+    // Merges maps that each started as a copy of base. New rooms get fresh ids,
+    // a room several maps added alike (name, desc, coords) is added once. A
+    // field of a base room changed differently by two maps keeps the first
+    // change and is reported as a conflict, as are removed rooms (kept)
+    static MapMerge mergeStaged(const MapDocument &base, const QVector<MapDocument> &staged, MapDocument &out);
+
+    static const char *issueKindName(int kind);
+    static QByteArray issueToText(const MapIssue &issue);
+    static QByteArray statsToText(const MapStats &stats);
+};
+
+#endif  // MAPTOOLS_H
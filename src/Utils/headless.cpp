@@ -0,0 +1,78 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/* GUI hooks of defines.h and CProgress.h for the widget-free targets such
+ * as tools/maptool, see pandora_map.pri. Without a window there is nothing
+ * to redraw, recenter or warn in, the user messages carry it all */
+
+#include <QRect>
+#include <QString>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "CProgress.h"
+
+void toggle_renderer_reaction()
+{
+}
+
+void notify_analyzer()
+{
+}
+
+void refresh_status_bar()
+{
+}
+
+void notify_room_deleted(unsigned int id)
+{
+    Q_UNUSED(id);
+}
+
+void recenter_renderer()
+{
+}
+
+/* saving the config keeps the window placement it was loaded with */
+QRect main_window_rect()
+{
+    return conf->getWindowRect();
+}
+
+QRect group_manager_rect()
+{
+    return conf->getGroupManagerRect();
+}
+
+void show_warning(const QString &title, const QString &text)
+{
+    Q_UNUSED(title);
+    Q_UNUSED(text);
+}
+
+CProgress *create_progress(const QString &label, const QString &cancelText, int maximum, Qt::WindowModality modality)
+{
+    Q_UNUSED(label);
+    Q_UNUSED(cancelText);
+    Q_UNUSED(maximum);
+    Q_UNUSED(modality);
+    return new CProgress;
+}
@@ -0,0 +1,50 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <QFuture>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+/* runs fn(from, to) over [0, amount) in one chunk per core on the global */
+/* thread pool, results come back in chunk order. Inputs are only split   */
+/* into chunks of at least grain items, smaller ones stay whole           */
+template <typename Result, typename Fn>
+QVector<Result> runChunked(int amount, Fn fn, int grain = 1024)
+{
+    int chunks = qMax(1, qMin(QThread::idealThreadCount(), amount / grain + 1));
+    int step = (amount + chunks - 1) / chunks;
+    QVector<QFuture<Result>> futures;
+    QVector<Result> results;
+
+    for (int from = 0; from < amount; from += step) {
+        int to = qMin(amount, from + step);
+        futures.append(QtConcurrent::run([fn, from, to]() { return fn(from, to); }));
+    }
+    for (QFuture<Result> &f : futures)
+        results.append(f.result());
+    return results;
+}
+
+#endif  // PARALLEL_H
@@ -66,6 +66,8 @@ const boolean_struct input_booleans[] = {{"on", true},    {"off", false},   {"1"
 
 QElapsedTimer debug_timer;
 
+QByteArray *user_output_capture = nullptr;
+
 int write_to_channel(int mode, const char *format, va_list args);
 
 int write_debug(unsigned int flag, const char *format, va_list args);
@@ -305,6 +307,8 @@ void send_to_user(const char *messg, ...)
 
 void send_prompt()
 {
+    if (proxy == nullptr || engine == nullptr || user_output_capture != nullptr)
+        return;
     proxy->send_line_to_user((const char *)engine->getPrompt());
 }
 
@@ -327,6 +331,17 @@ int write_to_channel(int mode, const char *format, va_list args)
     int size;
 
     size = vsnprintf(txt, sizeof(txt), format, args);
+    if (mode == 0 && user_output_capture != nullptr) {
+        user_output_capture->append(txt);
+        return size;
+    }
+    if (proxy == nullptr) {
+        /* headless run without a proxy - user messages go to the console */
+        if (mode == 0)
+            fputs(txt, stdout);
+        return size;
+    }
+
     if (mode == 0)
         proxy->send_line_to_user(txt);
     else if (mode == 1)
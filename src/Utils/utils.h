@@ -144,6 +144,8 @@ char dirbynum(int dir);
 int numbydir(char dir);
 void send_prompt();
 void send_to_user(const char *messg, ...);
+/* while set, user messages are collected here and prompts dropped (mscript) */
+extern QByteArray *user_output_capture;
 void send_to_mud(const char *messg, ...);
 int get_input_boolean(char *input);
 int parse_dir(char *dir);
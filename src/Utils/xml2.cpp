@@ -19,33 +19,28 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
-#include <QApplication>
 #include <QBuffer>
+#include <QCoreApplication>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QMessageBox>
-#include <QProgressDialog>
 #include <QSaveFile>
 #include <QString>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <memory>
 
 #include "defines.h"
 #include "xml2.h"
 #include "CConfigurator.h"
+#include "CProgress.h"
 #include "utils.h"
 
 #include "Map/CRoomManager.h"
 #include "Proxy/CDispatcher.h"
 #include "Proxy/proxy.h"
-#include "Gui/mainwindow.h"
 #include "Engine/CStacksManager.h"
 #include "Engine/CEngine.h"
-#include "Renderer/renderer.h"
-
-// Current file format version
-static const int MAP_FILE_VERSION = 2;
 
 // Flags for text content parsing
 #define XML_ROOMNAME (1 << 0)
@@ -54,7 +49,7 @@ static const int MAP_FILE_VERSION = 2;
 #define XML_CONTENTS (1 << 3)
 
 // Filter invalid XML characters (control chars except tab, newline, carriage return)
-static QByteArray filterInvalidXmlChars(const QByteArray &input, int *strippedCount = nullptr)
+QByteArray filterInvalidXmlChars(const QByteArray &input, int *strippedCount)
 {
     QByteArray output;
     output.reserve(input.size());
@@ -110,7 +105,7 @@ void CRoomManager::loadMap(QString filename)
     send_to_user("--[ Loading map: %s\r\n", qPrintable(filename));
 
     // Clear references to rooms BEFORE reinit deletes them
-    stacker.reset();
+    stacker->reset();
     selections.resetSelection();
     if (engine)
         engine->resetAddedRoomVar();
@@ -120,14 +115,13 @@ void CRoomManager::loadMap(QString filename)
     reinit();
 
     unsigned int currentMaximum = 22000;
-    QProgressDialog progress("Loading the database...", "Abort Loading", 0, currentMaximum, renderer_window);
-    progress.setWindowModality(Qt::ApplicationModal);
-    progress.show();
+    std::unique_ptr<CProgress> progress(
+        create_progress("Loading the database...", "Abort Loading", currentMaximum, Qt::ApplicationModal));
 
     QBuffer buffer(&filteredXml);
     buffer.open(QIODevice::ReadOnly);
     QXmlStreamReader reader(&buffer);
-    StructureParser handler(&progress, currentMaximum, this);
+    StructureParser handler(progress.get(), currentMaximum, this);
 
     print_debug(DEBUG_XML, "Parsing XML...");
     bool parseOk = handler.parse(reader);
@@ -139,28 +133,26 @@ void CRoomManager::loadMap(QString filename)
                           .arg(handler.errorColumn());
         print_debug(DEBUG_XML, "%s", qPrintable(msg));
         send_to_user("--[ %s\r\n", qPrintable(msg));
-        if (renderer_window) {
-            QMessageBox::warning(renderer_window, "XML Load Error", msg);
-        }
+        show_warning("XML Load Error", msg);
     }
 
-    if (progress.wasCanceled()) {
+    if (progress->wasCanceled()) {
         print_debug(DEBUG_XML, "Loading was canceled");
         send_to_user("--[ Map load canceled\r\n");
         reinit();
     } else {
         print_debug(DEBUG_XML, "Parsed %d rooms, resolving exits...", size());
-        progress.setLabelText("Resolving exit connections...");
-        progress.setMaximum(size());
-        progress.setValue(0);
+        progress->setLabelText("Resolving exit connections...");
+        progress->setMaximum(size());
+        progress->setValue(0);
 
         // Second pass: resolve exit pointers
         unsigned int resolvedExits = 0;
         unsigned int failedExits = 0;
 
         for (unsigned int i = 0; i < size(); i++) {
-            progress.setValue(i);
-            if (progress.wasCanceled()) {
+            progress->setValue(i);
+            if (progress->wasCanceled()) {
                 reinit();
                 break;
             }
@@ -186,7 +178,7 @@ void CRoomManager::loadMap(QString filename)
             }
         }
 
-        progress.setValue(size());
+        progress->setValue(size());
         print_debug(DEBUG_XML, "Exit resolution: %d resolved, %d failed", resolvedExits, failedExits);
         send_to_user("--[ Map loaded: %d rooms (%d exits resolved, %d failed)\r\n", size(), resolvedExits, failedExits);
 
@@ -196,13 +188,10 @@ void CRoomManager::loadMap(QString filename)
             focusRoom = rooms[0];
         }
         if (focusRoom != nullptr) {
-            stacker.reset();
-            stacker.put(focusRoom);
-            stacker.swap();
-            if (renderer_window && renderer_window->renderer) {
-                renderer_window->renderer->setUserX(0, true);
-                renderer_window->renderer->setUserY(0, true);
-            }
+            stacker->reset();
+            stacker->put(focusRoom);
+            stacker->swap();
+            recenter_renderer();
         }
     }
 
@@ -213,7 +202,7 @@ void CRoomManager::loadMap(QString filename)
 // XML Parser Implementation
 // ============================================================================
 
-StructureParser::StructureParser(QProgressDialog *progress, unsigned int &currentMaximum, CRoomManager *parent)
+StructureParser::StructureParser(CProgress *progress, unsigned int &currentMaximum, CRoomManager *parent)
     : parent(parent), progress(progress), currentMaximum(currentMaximum)
 {
     flag = 0;
@@ -346,6 +335,7 @@ bool StructureParser::startElement(const QString &qName, const QXmlStreamAttribu
             if (ok) {
                 // Store target ID temporarily in the pointer field (resolved later)
                 currentRoom->exits[dir] = reinterpret_cast<CRoom *>(static_cast<uintptr_t>(targetId));
+                currentRoom->updateExitSignature();
             } else {
                 print_debug(DEBUG_XML, "Invalid exit target '%s' in room %d", qPrintable(toStr), currentRoomId);
                 currentRoom->setExitUndefined(dir);
@@ -506,7 +496,7 @@ bool StructureParser::isAborted() const
 // SAVING
 // ============================================================================
 
-void CRoomManager::saveMap(QString filename)
+bool CRoomManager::saveMap(QString filename)
 {
     print_debug(DEBUG_XML, "Saving map to: %s", qPrintable(filename));
 
@@ -517,15 +507,14 @@ void CRoomManager::saveMap(QString filename)
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         print_debug(DEBUG_XML, "ERROR: Cannot open file for writing: %s", qPrintable(filename));
         send_to_user("--[ Map save failed: cannot open file\r\n");
-        return;
+        return false;
     }
 
     Map.setBlocked(true);
     send_to_user("--[ Saving map: %s\r\n", qPrintable(filename));
 
-    QProgressDialog progress("Saving the database...", "Abort Saving", 0, size(), renderer_window);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.show();
+    std::unique_ptr<CProgress> progress(
+        create_progress("Saving the database...", "Abort Saving", size(), Qt::WindowModal));
 
     QXmlStreamWriter xml(&file);
     xml.setAutoFormatting(true);
@@ -587,17 +576,26 @@ void CRoomManager::saveMap(QString filename)
 
     // Rooms
     bool aborted = false;
+    CRoom *lostText = nullptr;
     for (unsigned int i = 0; i < size(); i++) {
-        progress.setValue(i);
-        QApplication::processEvents();
+        progress->setValue(i);
+        QCoreApplication::processEvents();
 
-        if (progress.wasCanceled()) {
+        if (progress->wasCanceled()) {
             aborted = true;
             break;
         }
 
         CRoom *room = rooms[i];
 
+        // A region page that could not be read left the room without its
+        // texts - never write that over the map file that still has them
+        QByteArray desc = room->getDesc();
+        if (room->isPaged()) {
+            lostText = room;
+            break;
+        }
+
         xml.writeStartElement("room");
         xml.writeAttribute("id", QString::number(room->id));
         xml.writeAttribute("x", QString::number(room->getX()));
@@ -634,7 +632,7 @@ void CRoomManager::saveMap(QString filename)
         xml.writeTextElement("roomname", QString::fromUtf8(filterInvalidXmlChars(room->getName())));
 
         // Description
-        xml.writeTextElement("desc", QString::fromUtf8(filterInvalidXmlChars(room->getDesc())));
+        xml.writeTextElement("desc", QString::fromUtf8(filterInvalidXmlChars(desc)));
 
         // Note with color
         xml.writeStartElement("note");
@@ -688,7 +686,7 @@ void CRoomManager::saveMap(QString filename)
         xml.writeEndElement();  // room
     }
 
-    progress.setValue(size());
+    progress->setValue(size());
 
     xml.writeEndElement();  // map
     xml.writeEndDocument();
@@ -699,11 +697,18 @@ void CRoomManager::saveMap(QString filename)
         file.cancelWriting();
         print_debug(DEBUG_XML, "Save aborted by user");
         send_to_user("--[ Map save aborted\r\n");
+        return false;
+    } else if (lostText != nullptr) {
+        file.cancelWriting();
+        print_debug(DEBUG_XML, "ERROR: room %u has no texts, its region page could not be read", lostText->id);
+        send_to_user("--[ Map save refused: room %u lost its texts with an unreadable region page\r\n", lostText->id);
+        return false;
     } else if (!file.commit()) {
         print_debug(DEBUG_XML, "ERROR: Failed to commit save file: %s", qPrintable(file.errorString()));
         send_to_user("--[ Map save failed: %s\r\n", qPrintable(file.errorString()));
-    } else {
-        print_debug(DEBUG_XML, "Saved %d rooms to %s", size(), qPrintable(filename));
-        send_to_user("--[ Map saved: %d rooms\r\n", size());
+        return false;
     }
+    print_debug(DEBUG_XML, "Saved %d rooms to %s", size(), qPrintable(filename));
+    send_to_user("--[ Map saved: %d rooms\r\n", size());
+    return true;
 }
@@ -25,11 +25,17 @@
 #include <QString>
 #include <QXmlStreamReader>
 
-class QProgressDialog;
+class CProgress;
 class CRoomManager;
 class CRoom;
 class CRegion;
 
+// Current file format version
+static const int MAP_FILE_VERSION = 2;
+
+// Strip control characters that are not allowed in XML 1.0 (keeps tab, LF, CR)
+QByteArray filterInvalidXmlChars(const QByteArray &input, int *strippedCount = nullptr);
+
 /**
  * XML Parser for PandoraMapper map files.
  *
@@ -41,7 +47,7 @@ class CRegion;
 class StructureParser
 {
 public:
-    StructureParser(QProgressDialog *progress, unsigned int &currentMaximum, CRoomManager *parent);
+    StructureParser(CProgress *progress, unsigned int &currentMaximum, CRoomManager *parent);
 
     bool parse(QXmlStreamReader &reader);
     bool isAborted() const;
@@ -59,7 +65,7 @@ private:
 
     // Parent and progress
     CRoomManager *parent;
-    QProgressDialog *progress;
+    CProgress *progress;
     unsigned int &currentMaximum;
 
     // Parser state
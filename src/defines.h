@@ -23,6 +23,7 @@
 #define SVN_REVISION 220
 
 class QString;
+class QRect;
 
 #define MAX_ROOMS 70000 /* maximal amount of rooms */
 
@@ -43,7 +44,15 @@ class QString;
 /* global flags */
 extern QString *logFileName;
 
+/* GUI hooks: Gui/mainwindow.cpp implements them for the application,
+ * Utils/headless.cpp stubs them out for the widget-free targets */
 void toggle_renderer_reaction();
 void notify_analyzer();
+void refresh_status_bar();
+void notify_room_deleted(unsigned int id);
+void recenter_renderer();
+QRect main_window_rect();
+QRect group_manager_rect();
+void show_warning(const QString &title, const QString &text);
 
 #endif
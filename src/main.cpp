@@ -37,6 +37,7 @@
 #include "defines.h"
 
 #include "CConfigurator.h"
+#include "CMemoryStats.h"
 #include "xml2.h"
 #include "utils.h"
 
@@ -51,6 +52,7 @@
 
 #include "Engine/CStacksManager.h"
 #include "Engine/CEngine.h"
+#include "Engine/CSession.h"
 
 #ifdef Q_OS_MACX
 #include <CoreFoundation/CoreFoundation.h>
@@ -69,6 +71,7 @@ int main(int argc, char *argv[])
     const int default_local_port = 3000;
     const int default_remote_port = 4242;
     bool mud_emulation = false;
+    int session_count = 1;
 
 #ifdef Q_OS_MACX
     CFURLRef pluginRef = CFBundleCopyBundleURL(CFBundleGetMainBundle());
@@ -104,6 +107,8 @@ int main(int argc, char *argv[])
     QCommandLineOption remotePortOption(QStringList() << "rp" << "remoteport",
                                         "Override the remote (game) port number.", "port");
     QCommandLineOption emulateOption(QStringList() << "e" << "emulate", "Emulate MUD environment.");
+    QCommandLineOption sessionsOption(QStringList() << "s" << "sessions",
+                                      "Play sessions on one map, listening on consecutive local ports.", "amount");
 
     parser.addOption(configOption);
     parser.addOption(baseOption);
@@ -111,6 +116,7 @@ int main(int argc, char *argv[])
     parser.addOption(hostOption);
     parser.addOption(remotePortOption);
     parser.addOption(emulateOption);
+    parser.addOption(sessionsOption);
 
     parser.process(app);
 
@@ -122,6 +128,9 @@ int main(int argc, char *argv[])
         printf("Pandora: Starting in MUD emulation mode.\r\n");
         mud_emulation = true;
     }
+    if (parser.isSet(sessionsOption)) {
+        session_count = qMax(1, parser.value(sessionsOption).toInt());
+    }
     if (parser.isSet(baseOption)) {
         override_base_file = parser.value(baseOption);
     }
@@ -178,9 +187,13 @@ int main(int argc, char *argv[])
 
     conf->setConfigModified(false);
 
+    MemoryStats.startLogging(conf->getMemoryLogInterval());
+
     splash->showMessage("Starting Analyzer and Proxy...");
-    engine = new CEngine();
-    proxy = new Proxy();
+    for (int i = 0; i < session_count; i++)
+        CSession::create(conf->getLocalPort() + i);
+    /* the GUI acts on the first session */
+    CSession::all().first()->bind();
 
     // splash->showMessage("Loading the database, please wait...");
     // print_debug(DEBUG_SYSTEM, "Loading the database ... ");
@@ -188,15 +201,17 @@ int main(int argc, char *argv[])
     // print_debug(DEBUG_SYSTEM, "Successfuly loaded %i rooms!", Map.size());
 
     /* special init for the mud emulation */
-    if (mud_emulation) {
-        print_debug(DEBUG_SYSTEM, "Starting in MUD emulation mode...");
+    for (CSession *session : CSession::all()) {
+        if (mud_emulation) {
+            print_debug(DEBUG_SYSTEM, "Starting session %i in MUD emulation mode...", session->getIndex());
 
-        engine->setPrompt("-->");
-        stacker.put(1);
-        stacker.swap();
-    }
+            session->getEngine()->setPrompt("-->");
+            session->getStacks()->put(1);
+            session->getStacks()->swap();
+        }
 
-    proxy->setMudEmulation(mud_emulation);
+        session->getProxy()->setMudEmulation(mud_emulation);
+    }
 
     print_debug(DEBUG_SYSTEM, "Starting renderer ...\n");
 
@@ -236,9 +251,15 @@ int main(int argc, char *argv[])
     splash->finish(renderer_window);
     delete splash;
 
-    proxy->start();
-    QObject::connect(proxy, SIGNAL(startEngine()), engine, SLOT(slotRunEngine()), Qt::QueuedConnection);
-    QObject::connect(proxy, SIGNAL(startRenderer()), renderer_window->renderer, SLOT(display()), Qt::QueuedConnection);
+    for (CSession *session : CSession::all()) {
+        Proxy *sessionProxy = session->getProxy();
+
+        sessionProxy->start();
+        QObject::connect(sessionProxy, SIGNAL(startEngine()), session->getEngine(), SLOT(slotRunEngine()),
+                         Qt::QueuedConnection);
+        QObject::connect(sessionProxy, SIGNAL(startRenderer()), renderer_window->renderer, SLOT(display()),
+                         Qt::QueuedConnection);
+    }
 
     userland_parser->parse_user_input_line("mload");
 
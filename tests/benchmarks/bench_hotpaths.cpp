@@ -0,0 +1,280 @@
+/*
+ *  Pandora MUME mapper - Benchmarks
+ *
+ *  QBENCHMARK coverage of the mapper hot paths
+ */
+
+#include "bench_hotpaths.h"
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "utils.h"
+#include "MapGenerator.h"
+
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+#include "Map/CTree.h"
+
+#include "Engine/CEngine.h"
+#include "Engine/CStacksManager.h"
+
+#include "Proxy/CDispatcher.h"
+#include "Proxy/proxy.h"
+
+#include "Gui/mainwindow.h"
+#include "Renderer/renderer.h"
+
+static const QByteArray bench_desc = "This narrow corridor leads deeper into the hill. The walls are rough|"
+                                     "and damp, and the floor is covered with a thin layer of dust. Somewhere|"
+                                     "ahead you hear the faint sound of dripping water.|";
+
+void BenchHotPaths::generateMap(int amount)
+{
+    MapGeneratorOptions options;
+
+    options.rooms = amount;
+    options.regions = qMax(1, amount / 250);
+    MapGenerator::generate(&Map, options);
+}
+
+/* a few MUME room movements in XML mode, as seen on the wire */
+QByteArray BenchHotPaths::capturedStream()
+{
+    QByteArray chunk;
+    QByteArray stream;
+
+    chunk = "<movement dir=east/><room><name>A Dark Corridor</name>\r\n"
+            "<description>This narrow corridor leads deeper into the hill. The walls are rough\r\n"
+            "and damp, and the floor is covered with a thin layer of dust.\r\n</description>"
+            "A large rat is here, sniffing around.\r\n"
+            "<exits>Exits: east, west, (north).\r\n</exits></room>\r\n"
+            "<prompt>!* i&gt;</prompt>\xff\xf9";
+
+    while (stream.length() + chunk.length() < PROXY_BUFFER_SIZE - 1)
+        stream.append(chunk);
+
+    return stream;
+}
+
+void BenchHotPaths::initTestCase()
+{
+    QVERIFY(tmpDir.isValid());
+
+    conf = new Configurator();
+    conf->setLogFileEnabled(false);
+    conf->setNameQuote(10);
+    conf->setDescQuote(10);
+    conf->setAutorefresh(false);
+    conf->setPrespamTTL(5000);
+
+    engine = new CEngine();
+}
+
+void BenchHotPaths::cleanupTestCase()
+{
+    stacker->reset();
+    Map.reinit();
+}
+
+void BenchHotPaths::benchCompare_data()
+{
+    QTest::addColumn<QByteArray>("pattern");
+    QTest::addColumn<QByteArray>("text");
+
+    QTest::newRow("name-exact") << QByteArray("The Great East Road") << QByteArray("The Great East Road");
+    QTest::newRow("name-typo") << QByteArray("The Great East Road") << QByteArray("The Graet East Raod");
+    QTest::newRow("desc-exact") << bench_desc << bench_desc;
+    QTest::newRow("desc-changed") << bench_desc << QByteArray(bench_desc).replace("dust", "sand");
+}
+
+void BenchHotPaths::benchCompare()
+{
+    QFETCH(QByteArray, pattern);
+    QFETCH(QByteArray, text);
+
+    int result = 0;
+    QBENCHMARK {
+        result = comparator.compare(pattern, text);
+    }
+    QVERIFY(result >= 0);
+}
+
+void BenchHotPaths::benchFindByName()
+{
+    generateMap(20000);
+
+    QVector<QByteArray> names;
+    for (unsigned int i = 1; i <= Map.size(); i += 97)
+        names.append(Map.getName(i));
+
+    TTree *n = nullptr;
+    QBENCHMARK {
+        for (int i = 0; i < names.size(); i++)
+            n = NameMap.findByName(names[i]);
+    }
+    QVERIFY(n != nullptr);
+}
+
+void BenchHotPaths::benchDispatchBuffer()
+{
+    Cdispatcher dispatcher;
+    ProxySocket socket(nullptr, true);
+    QByteArray stream = capturedStream();
+
+    socket.setXmlMode(true);
+
+    QBENCHMARK {
+        socket.clearBuffer();
+        socket.append(stream);
+        dispatcher.dispatchBuffer(socket);
+    }
+    QVERIFY(dispatcher.amount > 0);
+}
+
+void BenchHotPaths::benchSaveMap_data()
+{
+    QTest::addColumn<int>("rooms");
+
+    // 200k rooms from the scale-testing plan do not fit under MAX_ROOMS
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("50k") << 50000;
+}
+
+void BenchHotPaths::benchSaveMap()
+{
+    QFETCH(int, rooms);
+
+    generateMap(rooms);
+    QString file = tmpDir.filePath(QString("save_%1.xml").arg(rooms));
+
+    QBENCHMARK {
+        Map.saveMap(file);
+    }
+    QVERIFY(QFile::exists(file));
+}
+
+void BenchHotPaths::benchLoadMap_data()
+{
+    benchSaveMap_data();
+}
+
+void BenchHotPaths::benchLoadMap()
+{
+    QFETCH(int, rooms);
+
+    QString file = tmpDir.filePath(QString("load_%1.xml").arg(rooms));
+    generateMap(rooms);
+    unsigned int generated = Map.size();
+    Map.saveMap(file);
+
+    QBENCHMARK {
+        Map.loadMap(file);
+    }
+    QCOMPARE(Map.size(), generated);
+}
+
+void BenchHotPaths::benchTryDir_data()
+{
+    QTest::addColumn<int>("candidates");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void BenchHotPaths::benchTryDir()
+{
+    QFETCH(int, candidates);
+    int i;
+
+    /* every candidate has an east exit into an identical looking room */
+    stacker->reset();
+    Map.reinit();
+    for (i = 1; i <= candidates * 2; i++) {
+        CRoom *r = new CRoom;
+        r->id = i;
+        r->setName("A Dark Corridor");
+        r->setDesc(bench_desc);
+        r->setRegion("default");
+        r->setX(i * 2);
+        Map.addRoom(r);
+    }
+    for (i = 1; i <= candidates; i++)
+        Map.getRoom(i)->setExit(EAST, Map.getRoom(i + candidates));
+
+    Event move;
+    move.clear();
+    move.movement = true;
+    move.dir = "east";
+    move.name = "A Dark Corridor";
+    move.desc = bench_desc;
+    move.exits = "east, west.";
+
+    QBENCHMARK {
+        for (i = 1; i <= candidates; i++)
+            stacker->put(i);
+        stacker->swap();
+
+        engine->addEvent(move);
+        engine->exec();
+    }
+    QCOMPARE(static_cast<int>(stacker->amount()), candidates);
+}
+
+void BenchHotPaths::benchStacks_data()
+{
+    QTest::addColumn<int>("candidates");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("8") << 8;
+    QTest::newRow("100") << 100;
+    QTest::newRow("10000") << 10000;
+}
+
+void BenchHotPaths::benchStacks()
+{
+    QFETCH(int, candidates);
+    int i;
+
+    generateMap(qMax(candidates * 2, 100));
+    stacker->reset();
+
+    /* the engine puts a room once per matching neighbour, so about half are repeats */
+    QBENCHMARK {
+        for (i = 0; i < candidates; i++) {
+            stacker->put(i + 1);
+            stacker->put(i / 2 + 1);
+        }
+        stacker->swap();
+        for (i = 0; i < static_cast<int>(stacker->amount()); i++)
+            stacker->get(i);
+    }
+    QCOMPARE(static_cast<int>(stacker->amount()), candidates);
+}
+
+void BenchHotPaths::benchRendererBatch()
+{
+    generateMap(10000);
+    stacker->put(1);
+    stacker->swap();
+
+    renderer_window = new CMainWindow;
+    renderer_window->resize(1024, 768);
+    renderer_window->show();
+
+    RendererWidget *renderer = renderer_window->renderer;
+    if (!renderer->isValid() || renderer->context() == nullptr) {
+        delete renderer_window;
+        renderer_window = nullptr;
+        QSKIP("No OpenGL context available on this platform");
+    }
+
+    renderer->centerOnRoom(1);
+    QBENCHMARK {
+        /* grabbing the framebuffer forces a full paintGL() with batch rebuild */
+        renderer->grabFramebuffer();
+    }
+
+    delete renderer_window;
+    renderer_window = nullptr;
+}
@@ -0,0 +1,55 @@
+/*
+ *  Pandora MUME mapper - Benchmarks
+ *
+ *  QBENCHMARK coverage of the mapper hot paths
+ */
+
+#ifndef BENCH_HOTPATHS_H
+#define BENCH_HOTPATHS_H
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+class BenchHotPaths : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir tmpDir;
+
+    void generateMap(int amount);
+    QByteArray capturedStream();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // Levenshtein based room name/desc comparison
+    void benchCompare_data();
+    void benchCompare();
+
+    // Room name trie lookups
+    void benchFindByName();
+
+    // Telnet/XML stream splitting
+    void benchDispatchBuffer();
+
+    // Map database I/O
+    void benchSaveMap_data();
+    void benchSaveMap();
+    void benchLoadMap_data();
+    void benchLoadMap();
+
+    // Analyzer movement step over large candidate stacks
+    void benchTryDir_data();
+    void benchTryDir();
+
+    // Candidate stack bookkeeping of one event, without the room tests
+    void benchStacks_data();
+    void benchStacks();
+
+    // Renderer vertex batch building (offscreen)
+    void benchRendererBatch();
+};
+
+#endif // BENCH_HOTPATHS_H
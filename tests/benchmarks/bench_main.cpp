@@ -0,0 +1,26 @@
+/*
+ *  Pandora MUME mapper - Benchmarks
+ *
+ *  Benchmark runner main file
+ */
+
+#include <QApplication>
+#include <QTest>
+
+#include "bench_hotpaths.h"
+
+/* normally defined in src/main.cpp, which is not linked in here */
+QString *logFileName;
+
+int main(int argc, char *argv[])
+{
+    // the map loader and the renderer need a widget application;
+    // default to the offscreen platform so the suite runs on CI hosts
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    BenchHotPaths benchHotPaths;
+    return QTest::qExec(&benchHotPaths, argc, argv);
+}
@@ -0,0 +1,28 @@
+TEMPLATE = app
+
+CONFIG += qt testcase c++17 thread
+QT += testlib xml opengl openglwidgets gui network core widgets
+
+TARGET = pandora_benchmarks
+
+# Benchmarks exercise the real code paths, so the whole mapper is linked
+# in, except for src/main.cpp which is replaced by bench_main.cpp.
+#
+# Machine-readable results for comparing versions:
+#   QT_QPA_PLATFORM=offscreen ./pandora_benchmarks -o results.xml,xml
+#   QT_QPA_PLATFORM=offscreen ./pandora_benchmarks -o results.csv,csv
+# Use -iterations N or -minimumvalue N to stabilise the numbers.
+
+DEFINES += NOMINMAX
+
+include(../../pandora_core.pri)
+
+SOURCES += \
+    bench_main.cpp \
+    bench_hotpaths.cpp
+
+HEADERS += \
+    bench_hotpaths.h
+
+win32:LIBS += -lwsock32 -lopengl32 -lglu32
+unix:LIBS += -lm -lGLU
@@ -4,15 +4,44 @@
  *  Test runner main file
  */
 
+#include <QApplication>
 #include <QTest>
 
+#include "CConfigurator.h"
+
 #include "test_utils.h"
 #include "test_room.h"
+#include "test_epoch.h"
+#include "test_graph.h"
+#include "test_bitmap.h"
+#include "test_layout.h"
+#include "test_sketch.h"
+#include "test_path.h"
+#include "test_ingest.h"
+#include "test_stacks.h"
+#include "test_document.h"
+#include "test_reident.h"
+#include "test_transaction.h"
+
+/* normally defined in src/main.cpp, which is not linked in here */
+QString *logFileName;
 
 int main(int argc, char *argv[])
 {
     int status = 0;
 
+    // the map code pulls in the widgets, keep them off any real display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    // the defaults of mume.ini for what the tests touch
+    conf = new Configurator();
+    conf->setLogFileEnabled(false);
+    conf->setNameQuote(10);
+    conf->setDescQuote(10);
+
     // Run utility function tests
     {
         TestUtils testUtils;
@@ -25,5 +54,71 @@ int main(int argc, char *argv[])
         status |= QTest::qExec(&testRoom, argc, argv);
     }
 
+    // Run epoch reclamation tests, including the concurrent stress test
+    {
+        TestEpoch testEpoch;
+        status |= QTest::qExec(&testEpoch, argc, argv);
+    }
+
+    // Run map graph analysis tests
+    {
+        TestGraph testGraph;
+        status |= QTest::qExec(&testGraph, argc, argv);
+    }
+
+    // Run flag index bitmap tests
+    {
+        TestBitmap testBitmap;
+        status |= QTest::qExec(&testBitmap, argc, argv);
+    }
+
+    // Run overlap resolving layout tests
+    {
+        TestLayout testLayout;
+        status |= QTest::qExec(&testLayout, argc, argv);
+    }
+
+    // Run description prefilter tests
+    {
+        TestSketch testSketch;
+        status |= QTest::qExec(&testSketch, argc, argv);
+    }
+
+    // Run route finder tests
+    {
+        TestPath testPath;
+        status |= QTest::qExec(&testPath, argc, argv);
+    }
+
+    // Run log ingestion and staged map merge tests
+    {
+        TestIngest testIngest;
+        status |= QTest::qExec(&testIngest, argc, argv);
+    }
+
+    // Run candidate stack tests
+    {
+        TestStacks testStacks;
+        status |= QTest::qExec(&testStacks, argc, argv);
+    }
+
+    // Run map document conversion tests
+    {
+        TestMapDocument testDocument;
+        status |= QTest::qExec(&testDocument, argc, argv);
+    }
+
+    // Run description re-identification tests
+    {
+        TestReident testReident;
+        status |= QTest::qExec(&testReident, argc, argv);
+    }
+
+    // Run map transaction tests
+    {
+        TestTransaction testTransaction;
+        status |= QTest::qExec(&testTransaction, argc, argv);
+    }
+
     return status;
 }
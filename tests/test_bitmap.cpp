@@ -0,0 +1,96 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CRoomBitmap (compressed room id sets of the flag index)
+ */
+
+#include "test_bitmap.h"
+
+#include <QRandomGenerator>
+#include <QSet>
+#include <QVector>
+#include <algorithm>
+
+#include "Map/CRoomBitmap.h"
+
+namespace
+{
+QVector<unsigned int> sorted(const QSet<unsigned int> &set)
+{
+    QVector<unsigned int> result(set.begin(), set.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+}  // namespace
+
+void TestBitmap::testAddRemove()
+{
+    CRoomBitmap bitmap;
+    QVERIFY(bitmap.isEmpty());
+
+    bitmap.add(5);
+    bitmap.add(70000); /* second chunk */
+    bitmap.add(5);
+    QCOMPARE(bitmap.cardinality(), 2);
+    QVERIFY(bitmap.contains(5));
+    QVERIFY(bitmap.contains(70000));
+    QVERIFY(!bitmap.contains(6));
+
+    bitmap.remove(5);
+    bitmap.remove(12345); /* not a member */
+    QCOMPARE(bitmap.toList(), QVector<unsigned int>({70000}));
+
+    bitmap.remove(70000);
+    QVERIFY(bitmap.isEmpty());
+}
+
+void TestBitmap::testDenseChunk()
+{
+    // crosses the array limit both ways
+    CRoomBitmap bitmap;
+    for (unsigned int id = 0; id < 10000; id++)
+        bitmap.add(id);
+    QCOMPARE(bitmap.cardinality(), 10000);
+    QVERIFY(bitmap.contains(9999));
+
+    for (unsigned int id = 0; id < 10000; id += 2)
+        bitmap.remove(id);
+    QCOMPARE(bitmap.cardinality(), 5000);
+    QVERIFY(!bitmap.contains(0));
+    QVERIFY(bitmap.contains(1));
+
+    for (unsigned int id = 1; id < 10000; id += 4)
+        bitmap.remove(id);
+    QCOMPARE(bitmap.cardinality(), 2500);
+    QCOMPARE(bitmap.toList().first(), 3u);
+}
+
+void TestBitmap::testSetOperations()
+{
+    // random sets of every density against QSet
+    QRandomGenerator random(1234);
+    const int sizes[] = {50, 3000, 9000, 40000};
+
+    for (int a : sizes) {
+        for (int b : sizes) {
+            CRoomBitmap first, second;
+            QSet<unsigned int> firstSet, secondSet;
+
+            for (int i = 0; i < a; i++) {
+                unsigned int id = random.bounded(70000);
+                first.add(id);
+                firstSet.insert(id);
+            }
+            for (int i = 0; i < b; i++) {
+                unsigned int id = random.bounded(70000);
+                second.add(id);
+                secondSet.insert(id);
+            }
+
+            QCOMPARE((first & second).toList(), sorted(QSet<unsigned int>(firstSet).intersect(secondSet)));
+            QCOMPARE((first | second).toList(), sorted(QSet<unsigned int>(firstSet).unite(secondSet)));
+            QCOMPARE(first.andNot(second).toList(), sorted(QSet<unsigned int>(firstSet).subtract(secondSet)));
+            QCOMPARE((first | second).cardinality(), QSet<unsigned int>(firstSet).unite(secondSet).size());
+        }
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CRoomBitmap (compressed room id sets of the flag index)
+ */
+
+#ifndef TEST_BITMAP_H
+#define TEST_BITMAP_H
+
+#include <QObject>
+#include <QTest>
+
+class TestBitmap : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testAddRemove();
+    void testDenseChunk();
+    void testSetOperations();
+};
+
+#endif // TEST_BITMAP_H
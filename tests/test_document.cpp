@@ -0,0 +1,89 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for MapDocumentIO (map documents and the live map) and MapTools::validate
+ */
+
+#include "test_document.h"
+
+#include "defines.h"
+
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+#include "Utils/MapDocument.h"
+#include "Utils/MapTools.h"
+
+namespace
+{
+RoomRecord room(unsigned int id, const char *name, int x)
+{
+    RoomRecord r;
+    r.id = id;
+    r.name = name;
+    r.desc = "A room.|";
+    r.x = x;
+    return r;
+}
+}  // namespace
+
+void TestMapDocument::testRoundTrip()
+{
+    MapDocument doc, back;
+    RoomRecord first = room(1, "First", 0);
+    RoomRecord second = room(2, "Second", 2);
+    first.exits[EAST] = 2;
+    first.exits[NORTH] = RoomRecord::EXIT_TARGET_UNDEFINED;
+    second.exits[WEST] = 1;
+    second.doors[WEST] = "gate";
+    doc.rooms << first << second;
+
+    MapDocumentIO::toRoomManager(doc, &Map);
+    QCOMPARE(Map.size(), 2u);
+    QCOMPARE(Map.getRoom(1)->exits[EAST], Map.getRoom(2));
+    QVERIFY(Map.getRoom(1)->isExitUndefined(NORTH));
+
+    QVERIFY(MapDocumentIO::fromRoomManager(&Map, back));
+    QCOMPARE(back.rooms.size(), 2);
+    QCOMPARE(back.rooms[0].exits[EAST], 2);
+    QCOMPARE(back.rooms[0].exits[NORTH], static_cast<int>(RoomRecord::EXIT_TARGET_UNDEFINED));
+    QCOMPARE(back.rooms[1].doors[WEST], QByteArray("gate"));
+}
+
+void TestMapDocument::testDuplicateId()
+{
+    // the second record with id 1 is skipped - its exits too
+    MapDocument doc;
+    RoomRecord first = room(1, "First", 0);
+    RoomRecord second = room(2, "Second", 2);
+    RoomRecord impostor = room(1, "Impostor", 4);
+    first.exits[EAST] = 2;
+    impostor.exits[WEST] = 2;
+    impostor.exits[UP] = RoomRecord::EXIT_TARGET_DEATH;
+    doc.rooms << first << second << impostor;
+
+    MapDocumentIO::toRoomManager(doc, &Map);
+    QCOMPARE(Map.size(), 2u);
+
+    CRoom *r = Map.getRoom(1);
+    QCOMPARE(r->getName(), QByteArray("First"));
+    QCOMPARE(r->getX(), 0);
+    QCOMPARE(r->exits[EAST], Map.getRoom(2));
+    QVERIFY(!r->isExitPresent(WEST));
+    QVERIFY(!r->isExitPresent(UP));
+}
+
+void TestMapDocument::testFarRoomsDoNotOverlap()
+{
+    // 65536 apart - the same spot if the coordinates were cut to 16 bits
+    MapDocument doc;
+    doc.rooms << room(1, "First", 0) << room(2, "Second", 65536) << room(3, "Third", 0);
+
+    int overlaps = 0;
+    for (const MapIssue &issue : MapTools::validate(doc))
+        if (issue.kind == MapIssue::OVERLAPPING_COORDS) {
+            QCOMPARE(issue.id, 3u);
+            QCOMPARE(issue.other, 1u);
+            overlaps++;
+        }
+    QCOMPARE(overlaps, 1);
+}
@@ -0,0 +1,23 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for MapDocumentIO (map documents and the live map)
+ */
+
+#ifndef TEST_DOCUMENT_H
+#define TEST_DOCUMENT_H
+
+#include <QObject>
+#include <QTest>
+
+class TestMapDocument : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip();
+    void testDuplicateId();
+    void testFarRoomsDoNotOverlap();
+};
+
+#endif // TEST_DOCUMENT_H
@@ -0,0 +1,147 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapEpoch (epoch based reclamation of map objects)
+ */
+
+#include "test_epoch.h"
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QThread>
+#include <QVector>
+
+#include "Map/CMapEpoch.h"
+
+namespace
+{
+// Stand-in for a room. Retired nodes are only marked as freed and kept in a
+// graveyard until the test ends, so a reader touching a "freed" node is
+// caught by the flag instead of crashing
+struct Node
+{
+    QAtomicInt freed;
+    int payload;
+};
+}  // namespace
+
+void TestEpoch::testRetireWithoutReaders()
+{
+    CMapEpoch epoch;
+    bool freed = false;
+
+    epoch.retire([&freed]() { freed = true; });
+    QCOMPARE(epoch.pending(), 1);
+    QCOMPARE(epoch.collect(), 1);
+    QVERIFY(freed);
+    QCOMPARE(epoch.pending(), 0);
+}
+
+void TestEpoch::testRetireWaitsForReader()
+{
+    CMapEpoch epoch;
+    bool freed = false;
+
+    int slot = epoch.enter();
+    epoch.retire([&freed]() { freed = true; });
+
+    QCOMPARE(epoch.collect(), 0);
+    QVERIFY(!freed);
+    QCOMPARE(epoch.activeReaders(), 1);
+
+    epoch.leave(slot);
+    QCOMPARE(epoch.collect(), 1);
+    QVERIFY(freed);
+}
+
+void TestEpoch::testReaderEnteringLaterDoesNotBlock()
+{
+    CMapEpoch epoch;
+    bool freed = false;
+
+    epoch.retire([&freed]() { freed = true; });
+    {
+        CEpochGuard guard(epoch);
+        // the object was unlinked before this reader came, it can go
+        QCOMPARE(epoch.collect(), 1);
+        QVERIFY(freed);
+    }
+    QCOMPARE(epoch.activeReaders(), 0);
+}
+
+void TestEpoch::testConcurrentReadersAndWriters()
+{
+    const int SLOTS = 64;
+    const int READERS = 6;
+    const int WRITERS = 2;
+    const int ROUNDS = 20000;
+
+    CMapEpoch epoch;
+    QAtomicPointer<Node> shared[SLOTS];
+    QVector<Node *> graveyard[WRITERS];
+    QAtomicInt violations(0);
+    QAtomicInt reads(0);
+    QAtomicInt stop(0);
+
+    for (int i = 0; i < SLOTS; i++) {
+        Node *n = new Node;
+        n->payload = i;
+        shared[i].storeRelease(n);
+    }
+
+    QVector<QThread *> threads;
+
+    for (int r = 0; r < READERS; r++) {
+        threads.append(QThread::create([&, r]() {
+            unsigned int seed = r * 7919 + 1;
+            while (stop.loadAcquire() == 0) {
+                CEpochGuard guard(epoch);
+                for (int k = 0; k < 16; k++) {
+                    seed = seed * 1103515245 + 12345;
+                    Node *n = shared[(seed >> 16) % SLOTS].loadAcquire();
+                    if (n->freed.loadAcquire() != 0)
+                        violations.ref();
+                    reads.ref();
+                }
+            }
+        }));
+    }
+
+    for (int w = 0; w < WRITERS; w++) {
+        threads.append(QThread::create([&, w]() {
+            for (int round = 0; round < ROUNDS; round++) {
+                // writers own every other slot, so they do not race each other
+                int index = (round * 2 + w) % SLOTS;
+                Node *fresh = new Node;
+                fresh->payload = round;
+                Node *old = shared[index].fetchAndStoreOrdered(fresh);
+
+                graveyard[w].append(old);
+                epoch.retire([old]() { old->freed.storeRelease(1); });
+                if (round % 64 == 0)
+                    epoch.collect();
+            }
+        }));
+    }
+
+    for (QThread *t : threads)
+        t->start();
+    for (int i = READERS; i < threads.size(); i++)
+        threads[i]->wait();
+    stop.storeRelease(1);
+    for (int i = 0; i < READERS; i++)
+        threads[i]->wait();
+
+    epoch.collect();
+
+    QCOMPARE(violations.loadAcquire(), 0);
+    QVERIFY(reads.loadAcquire() > 0);
+    QCOMPARE(epoch.activeReaders(), 0);
+    QCOMPARE(epoch.pending(), 0);
+
+    qDeleteAll(threads);
+    for (int w = 0; w < WRITERS; w++)
+        qDeleteAll(graveyard[w]);
+    for (int i = 0; i < SLOTS; i++)
+        delete shared[i].loadAcquire();
+}
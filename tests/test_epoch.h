@@ -0,0 +1,24 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapEpoch (epoch based reclamation of map objects)
+ */
+
+#ifndef TEST_EPOCH_H
+#define TEST_EPOCH_H
+
+#include <QObject>
+#include <QTest>
+
+class TestEpoch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRetireWithoutReaders();
+    void testRetireWaitsForReader();
+    void testReaderEnteringLaterDoesNotBlock();
+    void testConcurrentReadersAndWriters();
+};
+
+#endif // TEST_EPOCH_H
@@ -0,0 +1,112 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapGraph (components, reachability and cut rooms)
+ */
+
+#include "test_graph.h"
+
+#include <QVector>
+
+#include "Map/CMapGraph.h"
+
+namespace
+{
+typedef QVector<QPair<unsigned int, unsigned int>> Links;
+typedef QVector<unsigned int> Ids;
+
+// a two-way exit, as most of them are in the game
+void twoWay(Links &links, unsigned int a, unsigned int b)
+{
+    links.append(qMakePair(a, b));
+    links.append(qMakePair(b, a));
+}
+
+// Two triangles 1-2-3 and 4-5-6 joined by the corridor 3-7-4, plus the
+// island 10-11 and room 12 with a one-way exit into 1
+CMapGraph sampleGraph()
+{
+    Links links;
+    twoWay(links, 1, 2);
+    twoWay(links, 2, 3);
+    twoWay(links, 3, 1);
+    twoWay(links, 3, 7);
+    twoWay(links, 7, 4);
+    twoWay(links, 4, 5);
+    twoWay(links, 5, 6);
+    twoWay(links, 6, 4);
+    twoWay(links, 10, 11);
+    links.append(qMakePair(12u, 1u));
+    links.append(qMakePair(12u, 99u)); /* no such room, dropped */
+
+    return CMapGraph(Ids{1, 2, 3, 4, 5, 6, 7, 10, 11, 12}, links);
+}
+}  // namespace
+
+void TestGraph::testComponents()
+{
+    CMapGraph graph = sampleGraph();
+    QCOMPARE(graph.size(), 10);
+    QCOMPARE(graph.linkCount(), 19);
+
+    QVector<Ids> components = graph.components();
+    QCOMPARE(components.size(), 2);
+    QCOMPARE(components[0], Ids({1, 2, 3, 4, 5, 6, 7, 12}));
+    QCOMPARE(components[1], Ids({10, 11}));
+}
+
+void TestGraph::testStrongComponents()
+{
+    CMapGraph graph = sampleGraph();
+
+    QVector<Ids> strong = graph.strongComponents();
+    QCOMPARE(strong.size(), 3);
+    QCOMPARE(strong[0], Ids({1, 2, 3, 4, 5, 6, 7}));
+    QCOMPARE(strong[1], Ids({10, 11}));
+    QCOMPARE(strong[2], Ids({12}));
+}
+
+void TestGraph::testUnreachable()
+{
+    CMapGraph graph = sampleGraph();
+
+    QCOMPARE(graph.unreachableFrom(1), Ids({10, 11, 12}));
+    QCOMPARE(graph.unreachableFrom(12), Ids({10, 11}));
+    QCOMPARE(graph.unreachableFrom(42).size(), graph.size());
+}
+
+void TestGraph::testArticulationPoints()
+{
+    CMapGraph graph = sampleGraph();
+
+    // 1 holds room 12, 3/7/4 hold the corridor between the triangles
+    QCOMPARE(graph.articulationPoints(), Ids({1, 3, 4, 7}));
+
+    // a plain cycle has no cut rooms
+    Links ring;
+    twoWay(ring, 1, 2);
+    twoWay(ring, 2, 3);
+    twoWay(ring, 3, 4);
+    twoWay(ring, 4, 1);
+    QVERIFY(CMapGraph(Ids{1, 2, 3, 4}, ring).articulationPoints().isEmpty());
+}
+
+void TestGraph::testLongChain()
+{
+    // deep enough to overflow a recursive DFS
+    const unsigned int amount = 60000;
+    Ids ids;
+    Links links;
+    for (unsigned int id = 1; id <= amount; id++) {
+        ids.append(id);
+        if (id > 1)
+            twoWay(links, id - 1, id);
+    }
+    links.append(qMakePair(amount, 1u)); /* one-way back to the start closes a cycle */
+
+    CMapGraph graph(ids, links);
+    QCOMPARE(graph.components().size(), 1);
+    QCOMPARE(graph.strongComponents().size(), 1);
+    QVERIFY(graph.unreachableFrom(amount).isEmpty());
+    QCOMPARE(graph.articulationPoints().size(), 0);
+}
@@ -0,0 +1,25 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapGraph (components, reachability and cut rooms)
+ */
+
+#ifndef TEST_GRAPH_H
+#define TEST_GRAPH_H
+
+#include <QObject>
+#include <QTest>
+
+class TestGraph : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testComponents();
+    void testStrongComponents();
+    void testUnreachable();
+    void testArticulationPoints();
+    void testLongChain();
+};
+
+#endif // TEST_GRAPH_H
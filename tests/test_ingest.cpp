@@ -0,0 +1,194 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for LogIngest and MapTools::mergeStaged (offline mapping from logs)
+ */
+
+#include "test_ingest.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "defines.h"
+#include "CConfigurator.h"
+
+#include "Utils/LogIngest.h"
+#include "Utils/MapDocument.h"
+#include "Utils/MapTools.h"
+
+namespace
+{
+RoomRecord room(unsigned int id, const char *name, const char *desc, int x, int y = 0)
+{
+    RoomRecord r;
+    r.id = id;
+    r.name = name;
+    r.desc = desc;
+    r.region = "default";
+    r.x = x;
+    r.y = y;
+    return r;
+}
+
+// Town Square (1) with an unexplored exit east, Dark Alley (2) with one west
+MapDocument twoRooms()
+{
+    MapDocument doc;
+    RoomRecord square = room(1, "Town Square", "A wide square.|", 0);
+    RoomRecord alley = room(2, "Dark Alley", "A narrow alley.|", 2);
+    square.exits[EAST] = RoomRecord::EXIT_TARGET_UNDEFINED;
+    alley.exits[WEST] = RoomRecord::EXIT_TARGET_UNDEFINED;
+    doc.rooms << square << alley;
+    return doc;
+}
+
+const RoomRecord *findRoom(const MapDocument &doc, unsigned int id)
+{
+    for (const RoomRecord &r : doc.rooms)
+        if (r.id == id)
+            return &r;
+    return nullptr;
+}
+
+bool anyConflictWith(const MapMerge &merge, const char *text)
+{
+    for (const QByteArray &conflict : merge.conflicts)
+        if (conflict.contains(text))
+            return true;
+    return false;
+}
+}  // namespace
+
+void TestIngest::testTwinRoomHeadless()
+{
+    // walking into the unexplored exit adds a copy of Dark Alley, which is
+    // merged with the mapped one - without a renderer, a Proxy or a client.
+    // The prompts go to a dispatcher without a sink
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString log = dir.filePath("twin.log");
+    QFile file(log);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("<room><name>Town Square</name>\r\n"
+               "<description>A wide square.\r\n</description>"
+               "<exits>Exits: east.\r\n</exits></room>\r\n"
+               "<prompt>&gt;</prompt>"
+               "<movement dir=east/><room><name>Dark Alley</name>\r\n"
+               "<description>A narrow alley.\r\n</description>"
+               "<exits>Exits: west.\r\n</exits></room>\r\n"
+               "<prompt>&gt;</prompt>");
+    file.close();
+
+    bool automerge = conf->getAutomerge();
+    bool duallinker = conf->getDuallinker();
+    conf->setAutomerge(true);
+    conf->setDuallinker(false);
+
+    MapDocument out;
+    MapMerge merge;
+    IngestStats stats;
+    QString error;
+    bool ok = LogIngest::ingestLogs(twoRooms(), QStringList() << log, out, stats, merge, &error);
+
+    conf->setAutomerge(automerge);
+    conf->setDuallinker(duallinker);
+
+    QVERIFY2(ok, qPrintable(error));
+    QVERIFY(stats.events > 0);
+    QCOMPARE(stats.logs, 1);
+    QCOMPARE(out.rooms.size(), 2);
+    QCOMPARE(merge.added, 0);
+    QCOMPARE(merge.updated, 1);
+    QVERIFY(merge.conflicts.isEmpty());
+    QCOMPARE(findRoom(out, 1)->exits[EAST], 2);
+}
+
+void TestIngest::testSameRoomTwoLogs()
+{
+    // both logs found the same room east of the square, under different ids
+    MapDocument base = twoRooms();
+    base.rooms.removeLast();
+    MapDocument a = base, b = base;
+    RoomRecord alleyA = room(2, "Dark Alley", "A narrow alley.|", 2);
+    RoomRecord alleyB = room(5, "Dark Alley", "A narrow alley.|", 2);
+    a.rooms[0].exits[EAST] = 2;
+    b.rooms[0].exits[EAST] = 5;
+    a.rooms << alleyA;
+    b.rooms << alleyB;
+
+    MapDocument out;
+    MapMerge merge = MapTools::mergeStaged(base, QVector<MapDocument>() << a << b, out);
+
+    QCOMPARE(merge.added, 1);
+    QCOMPARE(merge.updated, 1);
+    QVERIFY(merge.conflicts.isEmpty());
+    QCOMPARE(out.rooms.size(), 2);
+    QCOMPARE(findRoom(out, 1)->exits[EAST], 2);
+    QVERIFY(findRoom(out, 2) != nullptr);
+}
+
+void TestIngest::testConflictingEdits()
+{
+    MapDocument base = twoRooms();
+    MapDocument a = base, b = base;
+    a.rooms[1].desc = "A narrow, dirty alley.|";
+    b.rooms[1].desc = "A narrow, quiet alley.|";
+
+    MapDocument out;
+    MapMerge merge = MapTools::mergeStaged(base, QVector<MapDocument>() << a << b, out);
+
+    QCOMPARE(merge.added, 0);
+    QCOMPARE(merge.updated, 1);
+    QCOMPARE(merge.conflicts.size(), 1);
+    QVERIFY(merge.conflicts[0].startsWith("log 2: room 2:"));
+    QVERIFY(merge.conflicts[0].contains("desc"));
+    QCOMPARE(findRoom(out, 2)->desc, QByteArray("A narrow, dirty alley.|"));
+
+    // the same change from both logs is no conflict
+    b.rooms[1].desc = a.rooms[1].desc;
+    merge = MapTools::mergeStaged(base, QVector<MapDocument>() << a << b, out);
+    QVERIFY(merge.conflicts.isEmpty());
+}
+
+void TestIngest::testSpotCollision()
+{
+    // two different rooms mapped onto the same free spot
+    MapDocument base = twoRooms();
+    MapDocument a = base, b = base;
+    a.rooms << room(3, "Old Well", "A mossy well.|", 0, 2);
+    b.rooms << room(3, "Gate", "A heavy gate.|", 0, 2);
+
+    MapDocument out;
+    MapMerge merge = MapTools::mergeStaged(base, QVector<MapDocument>() << a << b, out);
+
+    QCOMPARE(merge.added, 1);
+    QCOMPARE(out.rooms.size(), 3);
+    QCOMPARE(findRoom(out, 3)->name, QByteArray("Old Well"));
+    QVERIFY(anyConflictWith(merge, "is on the spot of new room 3, dropped"));
+}
+
+void TestIngest::testExitIntoRemappedRoom()
+{
+    // the staged new room 2 clashes with nothing in the staged map, but the
+    // merged map already uses ids up to 3, so it becomes 4 and so must the exit
+    MapDocument base;
+    RoomRecord square = room(1, "Town Square", "A wide square.|", 0);
+    square.exits[EAST] = RoomRecord::EXIT_TARGET_UNDEFINED;
+    base.rooms << square << room(3, "Temple", "A quiet temple.|", 0, 2);
+
+    MapDocument a = base;
+    RoomRecord alley = room(2, "Dark Alley", "A narrow alley.|", 2);
+    alley.exits[WEST] = 1;
+    a.rooms[0].exits[EAST] = 2;
+    a.rooms << alley;
+
+    MapDocument out;
+    MapMerge merge = MapTools::mergeStaged(base, QVector<MapDocument>() << a, out);
+
+    QCOMPARE(merge.added, 1);
+    QVERIFY(merge.conflicts.isEmpty());
+    QCOMPARE(findRoom(out, 1)->exits[EAST], 4);
+    QVERIFY(findRoom(out, 2) == nullptr);
+    QCOMPARE(findRoom(out, 4)->name, QByteArray("Dark Alley"));
+    QCOMPARE(findRoom(out, 4)->exits[WEST], 1);
+}
@@ -0,0 +1,25 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for LogIngest and MapTools::mergeStaged (offline mapping from logs)
+ */
+
+#ifndef TEST_INGEST_H
+#define TEST_INGEST_H
+
+#include <QObject>
+#include <QTest>
+
+class TestIngest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testTwinRoomHeadless();
+    void testSameRoomTwoLogs();
+    void testConflictingEdits();
+    void testSpotCollision();
+    void testExitIntoRemappedRoom();
+};
+
+#endif // TEST_INGEST_H
@@ -0,0 +1,119 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapLayout (overlap detection and removal)
+ */
+
+#include "test_layout.h"
+
+#include <QVector>
+
+#include "defines.h"
+#include "Map/CMapLayout.h"
+
+namespace
+{
+typedef QVector<unsigned int> Ids;
+
+// A 10x10 block of rooms linked east and north, with every second room
+// dropped onto its neighbour - the typical result of a mapping mistake
+CMapLayout crowdedBlock()
+{
+    CMapLayout layout;
+    for (unsigned int y = 0; y < 10; y++)
+        for (unsigned int x = 0; x < 10; x++) {
+            unsigned int id = 1 + y * 10 + x;
+            int shift = (id % 2) ? 0 : -CMapLayout::SPACING;
+            layout.addRoom(id, x * CMapLayout::SPACING + shift, y * CMapLayout::SPACING, 0, 0, true);
+            if (x > 0)
+                layout.addLink(id - 1, id, EAST);
+            if (y > 0)
+                layout.addLink(id - 10, id, NORTH);
+        }
+    return layout;
+}
+}  // namespace
+
+void TestLayout::testOverlapping()
+{
+    CMapLayout layout;
+    layout.addRoom(1, 0, 0, 0, 0, true);
+    layout.addRoom(2, -1, 1, 0, 0, true);
+    layout.addRoom(3, 2, 0, 0, 0, true); /* right next to 1, fine */
+    layout.addRoom(4, 0, 0, 1, 0, true); /* other layer */
+    layout.addRoom(5, 0, 0, 0, 7, true); /* other local space */
+    layout.addRoom(6, -1, 0, 1, 0, true);
+
+    QCOMPARE(layout.size(), 6);
+    QCOMPARE(layout.overlapping(), Ids({1, 2, 4, 6}));
+}
+
+void TestLayout::testNothingToMove()
+{
+    CMapLayout layout;
+    layout.addRoom(1, 0, 0, 0, 0, true);
+    layout.addRoom(2, 2, 0, 0, 0, true);
+    layout.addLink(1, 2, EAST);
+
+    QVERIFY(layout.solve().isEmpty());
+    QCOMPARE(layout.badLinks(), 0);
+}
+
+void TestLayout::testFixedRoomsStay()
+{
+    CMapLayout layout;
+    layout.addRoom(1, 0, 0, 0, 0, false);
+    layout.addRoom(2, 0, 0, 0, 0, true);
+    layout.addRoom(3, 0, 0, 0, 0, false); /* two fixed ones overlap, nothing to do about it */
+
+    QVector<CMapLayout::Move> moves = layout.solve();
+    QCOMPARE(moves.size(), 1);
+    QCOMPARE(moves[0].id, 2u);
+    QCOMPARE(moves[0].fromX, 0);
+    QCOMPARE(moves[0].fromY, 0);
+    QCOMPARE(layout.overlapping(), Ids({1, 3}));
+}
+
+void TestLayout::testExitDirection()
+{
+    CMapLayout layout;
+    layout.addRoom(1, 0, 0, 0, 0, false);
+    layout.addRoom(2, 0, 0, 0, 0, true);
+    layout.addLink(1, 2, EAST);
+    QCOMPARE(layout.badLinks(), 1);
+
+    QVector<CMapLayout::Move> moves = layout.solve();
+    QCOMPARE(moves.size(), 1);
+    QVERIFY(moves[0].toX >= CMapLayout::SPACING);
+    QVERIFY(layout.overlapping().isEmpty());
+    QCOMPARE(layout.badLinks(), 0);
+}
+
+void TestLayout::testCrowdedSpot()
+{
+    CMapLayout layout;
+    for (unsigned int id = 1; id <= 12; id++)
+        layout.addRoom(id, 0, 0, 0, 0, true);
+
+    QVERIFY(layout.solve().size() >= 11);
+    QVERIFY(layout.overlapping().isEmpty());
+}
+
+void TestLayout::testDeterministic()
+{
+    CMapLayout first = crowdedBlock();
+    CMapLayout second = crowdedBlock();
+    QVERIFY(!first.overlapping().isEmpty());
+
+    QVector<CMapLayout::Move> a = first.solve();
+    QVector<CMapLayout::Move> b = second.solve();
+
+    QVERIFY(!a.isEmpty());
+    QVERIFY(first.overlapping().isEmpty());
+    QCOMPARE(a.size(), b.size());
+    for (int i = 0; i < a.size(); i++) {
+        QCOMPARE(a[i].id, b[i].id);
+        QCOMPARE(a[i].toX, b[i].toX);
+        QCOMPARE(a[i].toY, b[i].toY);
+    }
+}
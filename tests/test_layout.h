@@ -0,0 +1,26 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapLayout (overlap detection and removal)
+ */
+
+#ifndef TEST_LAYOUT_H
+#define TEST_LAYOUT_H
+
+#include <QObject>
+#include <QTest>
+
+class TestLayout : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testOverlapping();
+    void testNothingToMove();
+    void testFixedRoomsStay();
+    void testExitDirection();
+    void testCrowdedSpot();
+    void testDeterministic();
+};
+
+#endif // TEST_LAYOUT_H
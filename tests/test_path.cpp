@@ -0,0 +1,191 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapPath (route finder and speedwalks)
+ */
+
+#include "test_path.h"
+
+#include <QVector>
+
+#include "defines.h"
+#include "Map/CMapPath.h"
+
+namespace
+{
+typedef QVector<unsigned int> Ids;
+
+Ids idsOf(const QVector<CMapPath::Step> &route)
+{
+    Ids ids;
+    for (const CMapPath::Step &step : route)
+        ids.append(step.id);
+    return ids;
+}
+
+// rooms 1..length in a row going east, linked both ways
+void addRow(CMapPath &path, unsigned int first, int length, int y, int cost)
+{
+    for (int i = 0; i < length; i++)
+        path.addRoom(first + i, i * 2, y, 0, cost, false);
+    for (int i = 1; i < length; i++) {
+        path.addLink(first + i - 1, first + i, EAST);
+        path.addLink(first + i, first + i - 1, WEST);
+    }
+}
+}  // namespace
+
+void TestPath::testStraightLine()
+{
+    CMapPath path;
+    addRow(path, 1, 4, 0, 1);
+    path.build();
+
+    int cost;
+    QVector<CMapPath::Step> route = path.find(1, 4, CMapPath::AVOID_ALL, &cost);
+    QCOMPARE(idsOf(route), Ids({2, 3, 4}));
+    QCOMPARE(cost, 3);
+    QCOMPARE(CMapPath::speedwalk(route), QByteArray("3e"));
+
+    QCOMPARE(idsOf(path.find(4, 1)), Ids({3, 2, 1}));
+    QVERIFY(path.find(1, 1).isEmpty());
+    QVERIFY(path.find(1, 99).isEmpty());
+}
+
+void TestPath::testCheapestTerrain()
+{
+    // 1 -> 2 -> 3 straight through water, or around it over a road
+    CMapPath path;
+    path.addRoom(1, 0, 0, 0, 1, false);
+    path.addRoom(2, 2, 0, 0, 10, false);
+    path.addRoom(3, 4, 0, 0, 1, false);
+    path.addRoom(4, 0, 2, 0, 1, false);
+    path.addRoom(5, 2, 2, 0, 1, false);
+    path.addRoom(6, 4, 2, 0, 1, false);
+    path.addLink(1, 2, EAST);
+    path.addLink(2, 3, EAST);
+    path.addLink(1, 4, NORTH);
+    path.addLink(4, 5, EAST);
+    path.addLink(5, 6, EAST);
+    path.addLink(6, 3, SOUTH);
+    path.build();
+
+    int cost;
+    QCOMPARE(idsOf(path.find(1, 3, CMapPath::AVOID_ALL, &cost)), Ids({4, 5, 6, 3}));
+    QCOMPARE(cost, 4);
+}
+
+void TestPath::testSecretDoor()
+{
+    CMapPath path;
+    path.addRoom(1, 0, 0, 0, 1, false);
+    path.addRoom(2, 0, 2, 0, 1, false);
+    path.addLink(1, 2, NORTH, "bookcase", true);
+    path.build();
+
+    QVERIFY(path.find(1, 2).isEmpty());
+
+    QVector<CMapPath::Step> route = path.find(1, 2, CMapPath::USE_SECRET);
+    QCOMPARE(route.size(), 1);
+    QVERIFY(route[0].secret);
+    QCOMPARE(CMapPath::speedwalk(route), QByteArray("open bookcase n, n"));
+}
+
+void TestPath::testDeathtrap()
+{
+    // the short way passes a deathtrap, the long one goes around it
+    CMapPath path;
+    path.addRoom(1, 0, 0, 0, 1, false);
+    path.addRoom(2, 2, 0, 0, 1, true);
+    path.addRoom(3, 4, 0, 0, 1, false);
+    path.addRoom(4, 2, 2, 0, 5, false);
+    path.addLink(1, 2, EAST);
+    path.addLink(2, 3, EAST);
+    path.addLink(1, 4, NORTH);
+    path.addLink(4, 3, SOUTH);
+    path.build();
+
+    QCOMPARE(idsOf(path.find(1, 3)), Ids({4, 3}));
+    QCOMPARE(idsOf(path.find(1, 3, CMapPath::USE_DEATHTRAPS)), Ids({2, 3}));
+    QVERIFY(path.find(1, 2).isEmpty());
+}
+
+void TestPath::testSpeedwalk()
+{
+    QVector<CMapPath::Step> route;
+    route.append(CMapPath::Step{2, NORTH, QByteArray(), false});
+    route.append(CMapPath::Step{3, NORTH, QByteArray(), false});
+    route.append(CMapPath::Step{4, EAST, "gate", false});
+    route.append(CMapPath::Step{5, EAST, QByteArray(), false});
+    route.append(CMapPath::Step{6, EAST, QByteArray(), false});
+    route.append(CMapPath::Step{7, UP, QByteArray(), false});
+
+    QCOMPARE(CMapPath::speedwalk(route), QByteArray("2n, open gate e, e, 2e, u"));
+    QCOMPARE(CMapPath::speedwalk(QVector<CMapPath::Step>()), QByteArray());
+}
+
+void TestPath::testOddCoordinates()
+{
+    // a long link between far coordinates must not hide the cheaper way
+    CMapPath path;
+    addRow(path, 1, 5, 0, 1);
+    path.addRoom(10, 1000, 1000, 0, 1, false);
+    path.addLink(1, 10, DOWN);
+    path.addLink(10, 5, UP);
+    path.build();
+
+    int cost;
+    QCOMPARE(idsOf(path.find(1, 5, CMapPath::AVOID_ALL, &cost)), Ids({10, 5}));
+    QCOMPARE(cost, 2);
+}
+
+void TestPath::testNearest()
+{
+    // two rows joined at their first rooms: 1..5 and 11..15
+    CMapPath path;
+    addRow(path, 1, 5, 0, 1);
+    addRow(path, 11, 5, 2, 1);
+    path.addLink(1, 11, NORTH);
+    path.addLink(11, 1, SOUTH);
+    path.addRoom(20, 10, 10, 0, 1, false); /* not linked at all */
+    path.build();
+
+    QVector<CMapPath::Hit> hits;
+    path.nearest(3, Ids({5, 13, 20, 2, 4}), 3, CMapPath::AVOID_ALL, hits);
+    QCOMPARE(hits.size(), 3);
+    QCOMPARE(hits[0].id, 2u); /* ties are ordered by id */
+    QCOMPARE(hits[0].moves, 1);
+    QCOMPARE(hits[1].id, 4u);
+    QCOMPARE(hits[2].id, 5u);
+    QCOMPARE(hits[2].moves, 2);
+
+    path.nearest(3, Ids({13, 20}), 5, CMapPath::AVOID_ALL, hits);
+    QCOMPARE(hits.size(), 1);
+    QCOMPARE(hits[0].id, 13u);
+    QCOMPARE(hits[0].moves, 5);
+}
+
+void TestPath::testNearestReuse()
+{
+    // the scratch of one query must not leak into the next one
+    CMapPath path;
+    addRow(path, 1, 6, 0, 1);
+    path.addRoom(20, 4, 0, 2, 1, false);
+    path.addLink(3, 20, UP, "hatch", true);
+    path.build();
+
+    QVector<CMapPath::Hit> hits;
+    for (int round = 0; round < 3; round++) {
+        path.nearest(1, Ids({6}), 1, CMapPath::AVOID_ALL, hits);
+        QCOMPARE(hits.size(), 1);
+        QCOMPARE(hits[0].moves, 5);
+
+        path.nearest(6, Ids({20}), 1, CMapPath::AVOID_ALL, hits);
+        QVERIFY(hits.isEmpty());
+        path.nearest(6, Ids({20}), 1, CMapPath::USE_SECRET, hits);
+        QCOMPARE(hits.size(), 1);
+        QCOMPARE(hits[0].moves, 4);
+
+        QCOMPARE(idsOf(path.find(1, 4)), Ids({2, 3, 4}));
+    }
+}
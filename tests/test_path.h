@@ -0,0 +1,28 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapPath (route finder and speedwalks)
+ */
+
+#ifndef TEST_PATH_H
+#define TEST_PATH_H
+
+#include <QObject>
+#include <QTest>
+
+class TestPath : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStraightLine();
+    void testCheapestTerrain();
+    void testSecretDoor();
+    void testDeathtrap();
+    void testSpeedwalk();
+    void testOddCoordinates();
+    void testNearest();
+    void testNearestReuse();
+};
+
+#endif // TEST_PATH_H
@@ -0,0 +1,121 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for the re-identification of rooms with changed descriptions
+ */
+
+#include "test_reident.h"
+
+#include "defines.h"
+#include "CConfigurator.h"
+
+#include "Engine/CEngine.h"
+#include "Map/CMapTransaction.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+#include "Utils/MapDocument.h"
+
+namespace
+{
+const char *OLD_DESC = "A wide square with a fountain in the middle.|";
+/* about a quarter of it changed: past descQuote (10%), within reidentQuote (40%) */
+const char *NEW_DESC = "A wide square with a statue in the centre.|";
+
+// Town Square (1) and Market (2) with the old description, linked east - west
+MapDocument twoSquares()
+{
+    MapDocument doc;
+    RoomRecord square, market;
+    square.id = 1;
+    square.name = "Town Square";
+    square.desc = OLD_DESC;
+    square.exits[EAST] = 2;
+    market.id = 2;
+    market.name = "Market";
+    market.desc = OLD_DESC;
+    market.x = 2;
+    market.exits[WEST] = 1;
+    doc.rooms << square << market;
+    return doc;
+}
+
+// what the engine saw when it walked into the room: only the exit in dir
+CReidentCheck seen(unsigned int id, const char *name, int dir)
+{
+    CReidentCheck check;
+    check.id = id;
+    check.name = name;
+    check.desc = NEW_DESC;
+    check.checkExits = true;
+    for (int i = 0; i <= 5; i++)
+        check.exits[i] = (i == dir) ? 1 : 0;
+    return check;
+}
+}  // namespace
+
+void TestReident::init()
+{
+    MapDocumentIO::toRoomManager(twoSquares(), &Map);
+    QCOMPARE(conf->getReidentQuote(), 40);
+    QCOMPARE(conf->getExitsTolerance(), 0);
+}
+
+void TestReident::testProposal()
+{
+    CEngine reident;
+
+    // the usual comparison does not take it, the wider one does
+    QCOMPARE(Map.getRoom(1)->descCmp(NEW_DESC), -1);
+    reident.checkReident(seen(1, "Town Square", EAST));
+
+    QCOMPARE(reident.getReidentProposals().size(), 1);
+    const CReidentProposal &proposal = reident.getReidentProposals().first();
+    QCOMPARE(proposal.id, 1u);
+    QCOMPARE(proposal.oldDesc, QByteArray(OLD_DESC));
+    QCOMPARE(proposal.desc, QByteArray(NEW_DESC));
+    QVERIFY(proposal.errors > 0);
+
+    // a second look replaces it
+    reident.checkReident(seen(1, "Town Square", EAST));
+    QCOMPARE(reident.getReidentProposals().size(), 1);
+
+    // a wrong name proposes nothing
+    reident.clearReidentProposals();
+    reident.checkReident(seen(1, "Dark Alley", EAST));
+    QVERIFY(reident.getReidentProposals().isEmpty());
+}
+
+void TestReident::testExitsDoNotFit()
+{
+    CEngine reident;
+
+    reident.checkReident(seen(1, "Town Square", NORTH));
+    QVERIFY(reident.getReidentProposals().isEmpty());
+
+    // unless the exits are not known
+    CReidentCheck check = seen(1, "Town Square", NORTH);
+    check.checkExits = false;
+    reident.checkReident(check);
+    QCOMPARE(reident.getReidentProposals().size(), 1);
+}
+
+void TestReident::testApplySkipsStale()
+{
+    CEngine reident;
+
+    reident.checkReident(seen(1, "Town Square", EAST));
+    reident.checkReident(seen(2, "Market", WEST));
+    QCOMPARE(reident.getReidentProposals().size(), 2);
+
+    // the market is edited by hand after the proposal
+    {
+        CMapTransaction transaction(&Map);
+        transaction.edit(Map.getRoom(2))->setDesc("A busy market.|");
+        transaction.commit();
+    }
+
+    QCOMPARE(reident.applyReidentProposals(), 1);
+    QVERIFY(reident.getReidentProposals().isEmpty());
+    QCOMPARE(Map.getRoom(1)->getDesc(), QByteArray(NEW_DESC));
+    QCOMPARE(Map.getRoom(2)->getDesc(), QByteArray("A busy market.|"));
+}
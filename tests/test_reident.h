@@ -0,0 +1,24 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for the re-identification of rooms with changed descriptions
+ */
+
+#ifndef TEST_REIDENT_H
+#define TEST_REIDENT_H
+
+#include <QObject>
+#include <QTest>
+
+class TestReident : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void testProposal();
+    void testExitsDoNotFit();
+    void testApplySkipsStale();
+};
+
+#endif // TEST_REIDENT_H
@@ -6,6 +6,9 @@
 
 #include "test_room.h"
 
+#include "Map/CRegion.h"
+#include "Map/CRoom.h"
+
 // Note: CRoom has many dependencies on global state (Map, conf, etc.)
 // These tests are placeholders until those dependencies are refactored
 // to allow for easier testing via dependency injection.
@@ -15,3 +18,35 @@ void TestRoom::testPlaceholder()
     // Placeholder test - will be expanded when CRoom is decoupled from globals
     QVERIFY(true);
 }
+
+void TestRoom::testRegionMembers()
+{
+    CRegion region;
+    CRoom a, b, c;
+    a.id = 1;
+    b.id = 2;
+    c.id = 3;
+
+    // only rooms listed by the map join the member list
+    region.addMember(&a);
+    region.addMember(&b);
+    region.addMember(&c);
+    QCOMPARE(region.memberAmount(), 3);
+
+    region.removeMember(&b);
+    QCOMPARE(region.memberAmount(), 2);
+    QVector<unsigned int> ids;
+    for (CRoom *room = region.firstMember(); room != nullptr; room = room->nextInRegion())
+        ids.append(room->id);
+    QCOMPARE(ids, QVector<unsigned int>({3, 1}));
+
+    region.removeMember(&c);
+    region.removeMember(&a);
+    QCOMPARE(region.memberAmount(), 0);
+    QVERIFY(region.firstMember() == nullptr);
+
+    // a room without region is not listed anywhere, unlisting is a no-op
+    b.listInRegion();
+    b.unlistFromRegion();
+    QCOMPARE(region.memberAmount(), 0);
+}
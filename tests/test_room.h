@@ -17,6 +17,7 @@ class TestRoom : public QObject
 private slots:
     // Placeholder tests - to be implemented when dependencies are resolved
     void testPlaceholder();
+    void testRegionMembers();
 };
 
 #endif // TEST_ROOM_H
@@ -0,0 +1,144 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CDescSketch (description prefilter)
+ */
+
+#include "test_sketch.h"
+
+#include <QVector>
+
+#include "Map/CDescSketch.h"
+#include "Map/CRoom.h"
+
+namespace
+{
+// Room descriptions as the game sends them, several of them close
+// relatives (the same road, the same forest) like on a real map
+const char *corpus[] = {
+    "The road continues through the fields east and west. To the north a\n"
+    "low stone wall separates the road from a pasture, where a few sheep are\n"
+    "grazing peacefully.\n",
+    "The road continues through the fields east and west. To the south a\n"
+    "low stone wall separates the road from a pasture, where a few cows are\n"
+    "grazing peacefully.\n",
+    "You are in a dense forest. Tall trees surround you on all sides, their\n"
+    "branches blocking out most of the light. A narrow trail leads north.\n",
+    "You are in a dense forest. Tall trees surround you on all sides, their\n"
+    "branches blocking out most of the light. A narrow trail leads east.\n",
+    "This is the common room of the inn. Tables and benches are scattered\n"
+    "about, and a fire burns in the large hearth in the western wall. The\n"
+    "innkeeper stands behind a counter, polishing mugs.\n",
+    "A small wooden bridge crosses the river here. The water below is fast\n"
+    "and cold, rushing down from the mountains to the north.\n",
+    "The tunnel is low and damp. Water drips from the ceiling and gathers in\n"
+    "small pools on the uneven floor. The passage turns to the east.\n",
+    "You stand on the top of a grassy hill. From here you can see far to\n"
+    "the west, where the road winds between the farms towards the town.\n",
+    "",
+};
+
+QVector<QByteArray> corpusTexts()
+{
+    QVector<QByteArray> texts;
+    for (const char *text : corpus)
+        texts.append(text);
+    return texts;
+}
+
+// typos, lost and extra characters - what a changed room or a bad line gives
+QByteArray mutate(const QByteArray &text, unsigned int seed, int edits)
+{
+    QByteArray result = text;
+    for (int i = 0; i < edits; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int pos = result.isEmpty() ? 0 : static_cast<int>((seed >> 8) % result.size());
+        char c = static_cast<char>('a' + (seed >> 20) % 26);
+        switch ((seed >> 16) % 3) {
+        case 0:
+            if (!result.isEmpty())
+                result[pos] = c;
+            break;
+        case 1:
+            result.insert(pos, c);
+            break;
+        default:
+            if (!result.isEmpty())
+                result.remove(pos, 1);
+            break;
+        }
+    }
+    return result;
+}
+}  // namespace
+
+void TestSketch::testIdentical()
+{
+    CDescSketch a(corpus[0]), b(corpus[0]);
+    QCOMPARE(a.minDistance(b), 0);
+    QVERIFY(!CDescSketch::cannotMatch(a, b, 0));
+    QVERIFY(CDescSketch(QByteArray()).isEmpty());
+    QCOMPARE(CDescSketch("abc").minDistance(CDescSketch("")), 3);
+}
+
+void TestSketch::testKey()
+{
+    /* the same letters in another order - equal histograms, other texts */
+    CDescSketch a("stone road"), b("road stone");
+    QCOMPARE(a.minDistance(b), 0);
+    QVERIFY(a.key() != b.key());
+    QCOMPARE(a.key(), CDescSketch("stone road").key());
+
+    CDescSketch c;
+    c.set("stone road");
+    c.clear();
+    QCOMPARE(c.key(), CDescSketch(QByteArray()).key());
+}
+
+void TestSketch::testLowerBound()
+{
+    QVector<QByteArray> texts = corpusTexts();
+
+    for (int i = 0; i < texts.size(); i++)
+        for (int j = 0; j < texts.size(); j++)
+            QVERIFY(CDescSketch(texts[i]).minDistance(CDescSketch(texts[j])) <= comparator.compare(texts[i], texts[j]));
+}
+
+void TestSketch::testNoFalseRejects()
+{
+    QVector<QByteArray> texts = corpusTexts();
+    int checked = 0;
+
+    for (int i = 0; i < texts.size(); i++)
+        for (int edits = 0; edits <= 40; edits += 4)
+            for (unsigned int seed = 1; seed <= 5; seed++) {
+                QByteArray changed = mutate(texts[i], seed * 7919u + i, edits);
+                CDescSketch pattern(changed), text(texts[i]);
+                int distance = comparator.compare(changed, texts[i]);
+
+                QVERIFY(pattern.minDistance(text) <= distance);
+                for (int quote = 0; quote <= 30; quote += 5)
+                    if (comparator.compare_with_quote(changed, texts[i], quote) >= 0)
+                        QVERIFY(!CDescSketch::cannotMatch(pattern, text, quote));
+                checked++;
+            }
+    QVERIFY(checked > 0);
+}
+
+void TestSketch::testRejectsUnrelated()
+{
+    QVector<QByteArray> texts = corpusTexts();
+    int unrelated = 0, rejected = 0;
+
+    for (int i = 0; i < texts.size(); i++)
+        for (int j = 0; j < texts.size(); j++) {
+            if (i == j || comparator.compare_with_quote(texts[i], texts[j], 10) >= 0)
+                continue;
+            unrelated++;
+            if (CDescSketch::cannotMatch(CDescSketch(texts[i]), CDescSketch(texts[j]), 10))
+                rejected++;
+        }
+
+    // the sketch alone drops most of the descriptions that do not match
+    QVERIFY(rejected * 2 > unrelated);
+}
@@ -0,0 +1,25 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CDescSketch (description prefilter)
+ */
+
+#ifndef TEST_SKETCH_H
+#define TEST_SKETCH_H
+
+#include <QObject>
+#include <QTest>
+
+class TestSketch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testIdentical();
+    void testLowerBound();
+    void testNoFalseRejects();
+    void testRejectsUnrelated();
+    void testKey();
+};
+
+#endif // TEST_SKETCH_H
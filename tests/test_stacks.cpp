@@ -0,0 +1,144 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CStacksManager (candidate rooms of the engine)
+ */
+
+#include "test_stacks.h"
+
+#include <QRandomGenerator>
+#include <QSet>
+#include <QVector>
+
+#include "Engine/CStacksManager.h"
+#include "Map/CMapTransaction.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomManager.h"
+#include "Utils/MapDocument.h"
+
+namespace
+{
+typedef QVector<unsigned int> Ids;
+
+// the current stack, after a swap
+Ids current(CStacksManager &stacks)
+{
+    Ids ids;
+    for (unsigned int i = 0; i < stacks.amount(); i++)
+        ids.append(stacks.getId(i));
+    return ids;
+}
+}  // namespace
+
+void TestStacks::testDuplicates()
+{
+    CStacksManager stacks;
+
+    // a few ids, inline
+    stacks.put(3u);
+    stacks.put(1u);
+    stacks.put(3u);
+    QCOMPARE(stacks.next(), 2u);
+    stacks.swap();
+    QCOMPARE(current(stacks), Ids({3, 1}));
+
+    // past the inline size the marks grow, a new turn starts with none
+    for (int turn = 0; turn < 3; turn++) {
+        for (unsigned int id = 1; id <= 40; id++) {
+            stacks.put(id);
+            stacks.put(id / 2 + 1);
+        }
+        stacks.swap();
+        QCOMPARE(stacks.amount(), 40u);
+    }
+}
+
+void TestStacks::testRemoveRoom()
+{
+    CStacksManager stacks;
+
+    for (unsigned int id = 1; id <= 20; id++)
+        stacks.put(id);
+    stacks.swap();
+    for (unsigned int id = 10; id <= 30; id++)
+        stacks.put(id);
+
+    stacks.removeRoom(15);
+    QCOMPARE(stacks.amount(), 19u);
+    QCOMPARE(stacks.next(), 20u);
+
+    // the mark of 15 is gone, so it can come back
+    stacks.put(15u);
+    stacks.put(16u);
+    QCOMPARE(stacks.next(), 21u);
+    stacks.swap();
+    QCOMPARE(stacks.getId(stacks.amount() - 1), 15u);
+}
+
+void TestStacks::testRandomized()
+{
+    CStacksManager stacks;
+    QRandomGenerator random(1);
+
+    // put/removeRoom/swap against a plain list, small and large turns mixed
+    for (int turn = 0; turn < 2000; turn++) {
+        int puts = random.bounded(turn % 3 == 0 ? 500 : 12);
+        Ids expected;
+        QSet<unsigned int> seen;
+
+        for (int i = 0; i < puts; i++) {
+            if (!expected.isEmpty() && random.bounded(50) == 0) {
+                unsigned int gone = expected[random.bounded(static_cast<int>(expected.size()))];
+                stacks.removeRoom(gone);
+                expected.removeAll(gone);
+                seen.remove(gone);
+            }
+            unsigned int id = random.bounded(puts + 5) + 1;
+            stacks.put(id);
+            if (!seen.contains(id)) {
+                seen.insert(id);
+                expected.append(id);
+            }
+        }
+        QCOMPARE(stacks.next(), static_cast<unsigned int>(expected.size()));
+        stacks.swap();
+        QCOMPARE(current(stacks), expected);
+    }
+}
+
+void TestStacks::testTransactionRollback()
+{
+    MapDocument doc;
+    for (unsigned int id = 1; id <= 3; id++) {
+        RoomRecord room;
+        room.id = id;
+        room.name = "Room";
+        room.x = 2 * id;
+        doc.rooms << room;
+    }
+    MapDocumentIO::toRoomManager(doc, &Map);
+
+    // the tests run without sessions, so the deletion works on stacker
+    stacker->reset();
+    stacker->put(2u);
+    stacker->put(3u);
+    stacker->swap();
+    stacker->put(3u);
+    Map.selections.select(3);
+
+    {
+        CMapTransaction transaction(&Map);
+        Map.smallDeleteRoom(Map.getRoom(3));
+        QCOMPARE(stacker->holds(3), 0);
+        QVERIFY(!Map.selections.isSelected(3));
+        transaction.rollback();
+    }
+
+    QVERIFY(Map.getRoom(3) != nullptr);
+    QCOMPARE(stacker->holds(3), CStacksManager::CURRENT_STACK | CStacksManager::NEXT_STACK);
+    QCOMPARE(stacker->holds(2), static_cast<int>(CStacksManager::CURRENT_STACK));
+    QVERIFY(Map.selections.isSelected(3));
+
+    stacker->reset();
+    Map.selections.resetSelection();
+}
@@ -0,0 +1,24 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CStacksManager (candidate rooms of the engine)
+ */
+
+#ifndef TEST_STACKS_H
+#define TEST_STACKS_H
+
+#include <QObject>
+#include <QTest>
+
+class TestStacks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDuplicates();
+    void testRemoveRoom();
+    void testRandomized();
+    void testTransactionRollback();
+};
+
+#endif // TEST_STACKS_H
@@ -0,0 +1,252 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapTransaction (bulk map edits with rollback)
+ */
+
+#include "test_transaction.h"
+
+#include "defines.h"
+
+#include "Map/CMapTransaction.h"
+#include "Map/CRegion.h"
+#include "Map/CRoom.h"
+#include "Map/CRoomIndex.h"
+#include "Map/CRoomManager.h"
+#include "Map/CTree.h"
+#include "Renderer/CSquare.h"
+#include "Utils/MapDocument.h"
+
+namespace
+{
+// Square (1) - Market (2) - Alley (3) from west to east, the alley in its own region
+MapDocument street()
+{
+    MapDocument doc;
+    RegionRecord town, slums;
+    town.name = "town";
+    slums.name = "slums";
+    doc.regions << town << slums;
+
+    const char *names[] = {"Square", "Market", "Alley"};
+    for (unsigned int id = 1; id <= 3; id++) {
+        RoomRecord room;
+        room.id = id;
+        room.name = names[id - 1];
+        room.x = 2 * id;
+        room.region = id == 3 ? "slums" : "town";
+        if (id > 1)
+            room.exits[WEST] = id - 1;
+        if (id < 3)
+            room.exits[EAST] = id + 1;
+        doc.rooms << room;
+    }
+    return doc;
+}
+
+// how often the name tree has id under name
+int named(const char *name, unsigned int id)
+{
+    TTree *t = NameMap.findByName(name);
+    return t ? t->ids.count(id) : 0;
+}
+
+int countInSquare(CSquare *square, CRoom *room)
+{
+    if (square == nullptr)
+        return 0;
+    int amount = square->rooms.count(room);
+    for (int i = 0; i < 4; i++)
+        amount += countInSquare(square->subsquares[i], room);
+    return amount;
+}
+
+// how often the room is in the plane tree
+int placed(CRoom *room)
+{
+    int amount = 0;
+    for (CPlane *p = Map.getPlanes(); p; p = p->next)
+        amount += countInSquare(p->squares, room);
+    return amount;
+}
+
+bool listedIn(CRegion *region, CRoom *room)
+{
+    for (CRoom *r = region->firstMember(); r; r = r->nextInRegion())
+        if (r == room)
+            return true;
+    return false;
+}
+
+bool rentRooms(CRoomBitmap &result)
+{
+    return FlagIndex.query("rent", result);
+}
+}  // namespace
+
+void TestTransaction::init()
+{
+    MapDocumentIO::toRoomManager(street(), &Map);
+    QCOMPARE(Map.size(), 3u);
+}
+
+void TestTransaction::testCommitReindexesOnce()
+{
+    CRoom *market = Map.getRoom(2);
+    CRoomBitmap rent;
+
+    {
+        CMapTransaction transaction(&Map);
+        QVERIFY(Map.isBlocked());
+
+        transaction.edit(market)->setName("Bazaar");
+        market->setName("Grand Bazaar");
+        market->setMobFlags(MM_MOB_RENT);
+        market->setX(20);
+        market->setX(22);
+
+        // out of the indexes until the end
+        QCOMPARE(named("Market", 2), 0);
+        QCOMPARE(named("Grand Bazaar", 2), 0);
+        QCOMPARE(placed(market), 0);
+
+        transaction.commit();
+    }
+
+    QVERIFY(!Map.isBlocked());
+    QCOMPARE(named("Grand Bazaar", 2), 1);
+    QCOMPARE(named("Bazaar", 2), 0);
+    QCOMPARE(placed(market), 1);
+    QVERIFY(rentRooms(rent));
+    QCOMPARE(rent.toList(), QVector<unsigned int>({2}));
+    QCOMPARE(market->getX(), 22);
+}
+
+void TestTransaction::testRollbackRestoresFields()
+{
+    CRoom *market = Map.getRoom(2);
+    CRoomBitmap rent;
+
+    {
+        CMapTransaction transaction(&Map);
+        transaction.edit(market)->setName("Bazaar");
+        market->setMobFlags(MM_MOB_RENT);
+        market->setX(30);
+        // leaving the scope without commit() rolls back
+    }
+
+    QVERIFY(!Map.isBlocked());
+    QCOMPARE(market->getName(), QByteArray("Market"));
+    QCOMPARE(market->getX(), 4);
+    QCOMPARE(named("Market", 2), 1);
+    QCOMPARE(named("Bazaar", 2), 0);
+    QCOMPARE(placed(market), 1);
+    QVERIFY(rentRooms(rent));
+    QVERIFY(rent.isEmpty());
+}
+
+void TestTransaction::testRollbackRestoresDeletedRoom()
+{
+    CRoom *market = Map.getRoom(2);
+    CRoom *alley = Map.getRoom(3);
+
+    {
+        CMapTransaction transaction(&Map);
+        Map.deleteRoom(alley, 0);
+        QVERIFY(Map.getRoom(3) == nullptr);
+        QVERIFY(!market->isExitLeadingTo(EAST, alley));
+        transaction.rollback();
+    }
+
+    // the same object is back, with the exit leading in
+    QCOMPARE(Map.getRoom(3), alley);
+    QCOMPARE(Map.size(), 3u);
+    QVERIFY(market->isExitLeadingTo(EAST, alley));
+    QVERIFY(alley->isExitLeadingTo(WEST, market));
+    QCOMPARE(named("Alley", 3), 1);
+    QCOMPARE(placed(alley), 1);
+    QVERIFY(listedIn(Map.getRegionByName("slums"), alley));
+
+    // and a committed delete frees it for good
+    {
+        CMapTransaction transaction(&Map);
+        Map.deleteRoom(alley, 0);
+        transaction.commit();
+    }
+    QVERIFY(Map.getRoom(3) == nullptr);
+    QCOMPARE(Map.size(), 2u);
+    QVERIFY(market->exits[EAST] == nullptr);
+}
+
+void TestTransaction::testRollbackRelistsRegion()
+{
+    CRoom *alley = Map.getRoom(3);
+    CRegion *town = Map.getRegionByName("town");
+    CRegion *slums = Map.getRegionByName("slums");
+    QVERIFY(town != nullptr && slums != nullptr);
+
+    {
+        CMapTransaction transaction(&Map);
+        transaction.edit(alley)->setRegion(town);
+        QVERIFY(listedIn(town, alley));
+        QVERIFY(!listedIn(slums, alley));
+    }
+
+    QCOMPARE(alley->getRegion(), slums);
+    QVERIFY(listedIn(slums, alley));
+    QVERIFY(!listedIn(town, alley));
+    QCOMPARE(town->memberAmount(), 2);
+    QCOMPARE(slums->memberAmount(), 1);
+    QCOMPARE(FlagIndex.regionMembers(slums), QVector<unsigned int>({3}));
+}
+
+void TestTransaction::testNestedJoinsOuter()
+{
+    CRoom *square = Map.getRoom(1);
+    CRoom *market = Map.getRoom(2);
+
+    CMapTransaction outer(&Map);
+    outer.edit(square)->setName("Plaza");
+    {
+        CMapTransaction inner(&Map);
+        inner.edit(market)->setName("Bazaar");
+        inner.commit();
+        QVERIFY(!inner.isOpen());
+    }
+
+    // the inner commit only left it, the outer one still holds both rooms
+    QVERIFY(Map.isBlocked());
+    QVERIFY(outer.isOpen());
+    QCOMPARE(outer.savedRooms(), 2);
+    QCOMPARE(named("Bazaar", 2), 0);
+
+    outer.rollback();
+    QVERIFY(!Map.isBlocked());
+    QCOMPARE(square->getName(), QByteArray("Square"));
+    QCOMPARE(market->getName(), QByteArray("Market"));
+    QCOMPARE(named("Market", 2), 1);
+}
+
+void TestTransaction::testNestedRollbackEndsOuter()
+{
+    CRoom *square = Map.getRoom(1);
+    CRoom *market = Map.getRoom(2);
+
+    CMapTransaction outer(&Map);
+    outer.edit(square)->setName("Plaza");
+    {
+        CMapTransaction inner(&Map);
+        inner.edit(market)->setName("Bazaar");
+        inner.rollback();
+    }
+
+    // an inner rollback takes the whole transaction back
+    QVERIFY(!outer.isOpen());
+    QVERIFY(!Map.isBlocked());
+    QCOMPARE(square->getName(), QByteArray("Square"));
+    QCOMPARE(market->getName(), QByteArray("Market"));
+
+    // a late commit of the outer one changes nothing
+    outer.commit();
+    QCOMPARE(square->getName(), QByteArray("Square"));
+}
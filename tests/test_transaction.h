@@ -0,0 +1,27 @@
+/*
+ *  Pandora MUME mapper - Unit Tests
+ *
+ *  Tests for CMapTransaction (bulk map edits with rollback)
+ */
+
+#ifndef TEST_TRANSACTION_H
+#define TEST_TRANSACTION_H
+
+#include <QObject>
+#include <QTest>
+
+class TestTransaction : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void testCommitReindexesOnce();
+    void testRollbackRestoresFields();
+    void testRollbackRestoresDeletedRoom();
+    void testRollbackRelistsRegion();
+    void testNestedJoinsOuter();
+    void testNestedRollbackEndsOuter();
+};
+
+#endif // TEST_TRANSACTION_H
@@ -1,34 +1,49 @@
 TEMPLATE = app
 
-CONFIG += qt testcase c++17
-QT += testlib core
+CONFIG += qt testcase c++17 thread
+QT += testlib xml opengl openglwidgets gui network core widgets concurrent
 
 TARGET = pandora_tests
 
-INCLUDEPATH = ../src ../src/Utils
+# The code under test reaches the map, the configuration and the session
+# globals, so the whole mapper is linked in, as for the benchmarks, except
+# for src/main.cpp which is replaced by main.cpp.
+#   QT_QPA_PLATFORM=offscreen ./pandora_tests
+
+DEFINES += NOMINMAX
+
+include(../pandora_core.pri)
 
 SOURCES += \
     main.cpp \
     test_utils.cpp \
-    test_room.cpp
+    test_room.cpp \
+    test_epoch.cpp \
+    test_graph.cpp \
+    test_bitmap.cpp \
+    test_layout.cpp \
+    test_sketch.cpp \
+    test_path.cpp \
+    test_ingest.cpp \
+    test_stacks.cpp \
+    test_document.cpp \
+    test_reident.cpp \
+    test_transaction.cpp
 
 HEADERS += \
     test_utils.h \
-    test_room.h
-
-# Include necessary source files from main project
-SOURCES += \
-    ../src/Utils/utils.cpp \
-    ../src/Map/CRoom.cpp \
-    ../src/Map/CTree.cpp \
-    ../src/Map/CRegion.cpp
-
-HEADERS += \
-    ../src/Utils/utils.h \
-    ../src/Map/CRoom.h \
-    ../src/Map/CTree.h \
-    ../src/Map/CRegion.h \
-    ../src/defines.h
-
-# Stubs for dependencies
-DEFINES += TESTING_MODE
+    test_room.h \
+    test_epoch.h \
+    test_graph.h \
+    test_bitmap.h \
+    test_layout.h \
+    test_sketch.h \
+    test_path.h \
+    test_ingest.h \
+    test_stacks.h \
+    test_document.h \
+    test_reident.h \
+    test_transaction.h
+
+win32:LIBS += -lwsock32 -lopengl32 -lglu32
+unix:LIBS += -lm -lGLU
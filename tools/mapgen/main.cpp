@@ -0,0 +1,84 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/* command line front end of the synthetic map generator */
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "MapGenerator.h"
+#include "utils.h"
+
+#include "Map/CRoomManager.h"
+
+QString *logFileName;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("pandora-mapgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Pandora synthetic map generator");
+    parser.addHelpOption();
+
+    QCommandLineOption roomsOption(QStringList() << "n" << "rooms", "Amount of rooms.", "rooms", "10000");
+    QCommandLineOption regionsOption(QStringList() << "r" << "regions", "Amount of regions.", "regions", "40");
+    QCommandLineOption spacesOption(QStringList() << "l" << "localspaces", "Amount of local spaces.", "amount", "3");
+    QCommandLineOption seedOption(QStringList() << "s" << "seed", "Random seed.", "seed", "1");
+    QCommandLineOption configOption(QStringList() << "c" << "config", "Config file with terrain sectors.",
+                                    "configfile");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Output XML file.", "filename",
+                                    "generated.xml");
+
+    parser.addOption(roomsOption);
+    parser.addOption(regionsOption);
+    parser.addOption(spacesOption);
+    parser.addOption(seedOption);
+    parser.addOption(configOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    conf = new Configurator();
+    conf->setLogFileEnabled(false);
+    if (parser.isSet(configOption))
+        conf->loadConfig("", parser.value(configOption).toUtf8());
+
+    MapGeneratorOptions options;
+    options.rooms = parser.value(roomsOption).toInt();
+    options.regions = parser.value(regionsOption).toInt();
+    options.localSpaces = parser.value(spacesOption).toInt();
+    options.seed = parser.value(seedOption).toUInt();
+
+    if (options.rooms >= MAX_ROOMS)
+        fprintf(stderr, "pandora-mapgen: at most %d rooms fit into the map, output is capped.\n", MAX_ROOMS - 1);
+
+    if (!MapGenerator::generateFile(parser.value(outputOption), options)) {
+        fprintf(stderr, "pandora-mapgen: %s\n", qPrintable(MapGenerator::lastError()));
+        return 1;
+    }
+
+    printf("Generated %u rooms into %s\n", Map.size(), qPrintable(parser.value(outputOption)));
+    return 0;
+}
@@ -0,0 +1,19 @@
+TEMPLATE = app
+
+CONFIG += qt c++17 thread console
+CONFIG -= app_bundle
+QT += core gui xml network concurrent
+
+TARGET = pandora-mapgen
+
+# Synthetic map generator, see src/Utils/MapGenerator.h
+#   ./pandora-mapgen -n 50000 -s 7 -o big.xml
+
+DEFINES += NOMINMAX
+
+include(../../pandora_map.pri)
+
+SOURCES += main.cpp
+
+win32:LIBS += -lwsock32
+unix:LIBS += -lm
@@ -0,0 +1,284 @@
+/*
+ *  Pandora MUME mapper
+ *
+ *  Copyright (C) 2000-2009  Azazello
+ *  Copyright (C) 2025 PandoraMapper Contributors
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/* headless map utility: convert, public, validate, stats, diff and ingest */
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "defines.h"
+#include "CConfigurator.h"
+#include "LogIngest.h"
+#include "MMapperImport.h"
+#include "MapDocument.h"
+#include "MapTools.h"
+#include "utils.h"
+
+#include "Map/CRoomManager.h"
+
+QString *logFileName;
+
+namespace
+{
+
+bool loadDocument(const QString &filename, MapDocument &doc, QString *error)
+{
+    switch (MapDocumentIO::formatByName(filename)) {
+    case MapDocumentIO::FORMAT_XML:
+        return MapDocumentIO::readXml(filename, doc, error);
+    case MapDocumentIO::FORMAT_BINARY:
+        return MapDocumentIO::readBinary(filename, doc, error);
+    case MapDocumentIO::FORMAT_MMAPPER:
+        // the importer works on the live map, so this one stays on the main thread
+        if (!MMapperImport::importFile(filename, &Map)) {
+            *error = MMapperImport::lastError();
+            return false;
+        }
+        return MapDocumentIO::fromRoomManager(&Map, doc, error);
+    default:
+        *error = QString("Unknown map format: %1 (expected .xml, .pmb or .mm2)").arg(filename);
+        return false;
+    }
+}
+
+int doConvert(const QString &in, const QString &out)
+{
+    MapDocument doc;
+    QString error;
+    QElapsedTimer timer;
+
+    timer.start();
+    if (!loadDocument(in, doc, &error)) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(error));
+        return 1;
+    }
+    qint64 loaded = timer.elapsed();
+
+    if (!MapDocumentIO::writeFile(out, doc, &error)) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    printf("Converted %d rooms: %s -> %s (read %lld ms, write %lld ms)\n", static_cast<int>(doc.rooms.size()),
+           qPrintable(in), qPrintable(out), loaded, timer.elapsed() - loaded);
+    return 0;
+}
+
+int doPublic(const QString &in, const QString &out, unsigned int startId)
+{
+    MapDocument doc, publicMap;
+    QString error;
+
+    if (!loadDocument(in, doc, &error)) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(error));
+        return 1;
+    }
+    if (!MapTools::publicSubset(doc, startId, publicMap)) {
+        fprintf(stderr, "pandora-maptool: no room %u to start from\n", startId);
+        return 1;
+    }
+    if (!MapDocumentIO::writeFile(out, publicMap, &error)) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    printf("Exported %d of %d rooms without secrets: %s -> %s\n", static_cast<int>(publicMap.rooms.size()),
+           static_cast<int>(doc.rooms.size()), qPrintable(in), qPrintable(out));
+    return 0;
+}
+
+int doValidate(const QString &filename, int limit)
+{
+    MapDocument doc;
+    QString error;
+
+    if (!loadDocument(filename, doc, &error)) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    QVector<MapIssue> issues = MapTools::validate(doc);
+    QVector<QVector<MapIssue>> byKind(MapIssue::KIND_COUNT);
+    for (const MapIssue &issue : issues)
+        byKind[issue.kind].append(issue);
+
+    int errors = 0;
+    for (int kind = 0; kind < MapIssue::KIND_COUNT; kind++) {
+        const QVector<MapIssue> &list = byKind[kind];
+        printf("%-24s: %d\n", MapTools::issueKindName(kind), static_cast<int>(list.size()));
+        for (int i = 0; i < list.size() && i < limit; i++)
+            printf("    %s\n", MapTools::issueToText(list[i]).constData());
+        if (list.size() > limit)
+            printf("    ... and %d more\n", static_cast<int>(list.size()) - limit);
+
+        // one-way and asymmetric links exist in the game, they are only reported
+        if (kind != MapIssue::ONEWAY_LINK && kind != MapIssue::ASYMMETRIC_LINK)
+            errors += list.size();
+    }
+
+    printf("%d rooms checked, %d errors.\n", static_cast<int>(doc.rooms.size()), errors);
+    return errors > 0 ? 2 : 0;
+}
+
+int doStats(const QString &filename)
+{
+    MapDocument doc;
+    QString error;
+
+    if (!loadDocument(filename, doc, &error)) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    fputs(MapTools::statsToText(MapTools::stats(doc)).constData(), stdout);
+    return 0;
+}
+
+int doDiff(const QString &first, const QString &second, int limit)
+{
+    MapDocument a, b;
+    QString errorA, errorB;
+    bool okA, okB;
+
+    if (MapDocumentIO::formatByName(first) == MapDocumentIO::FORMAT_MMAPPER ||
+        MapDocumentIO::formatByName(second) == MapDocumentIO::FORMAT_MMAPPER) {
+        okA = loadDocument(first, a, &errorA);
+        okB = loadDocument(second, b, &errorB);
+    } else {
+        // file readers only touch their own document, read both at once
+        QFuture<bool> reading = QtConcurrent::run([&first, &a, &errorA]() { return loadDocument(first, a, &errorA); });
+        okB = loadDocument(second, b, &errorB);
+        okA = reading.result();
+    }
+    if (!okA || !okB) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(okA ? errorB : errorA));
+        return 1;
+    }
+
+    MapDiff diff = MapTools::diff(a, b);
+
+    printf("Removed rooms: %d\n", static_cast<int>(diff.removed.size()));
+    for (int i = 0; i < diff.removed.size() && i < limit; i++)
+        printf("    %u\n", diff.removed[i]);
+    printf("Added rooms  : %d\n", static_cast<int>(diff.added.size()));
+    for (int i = 0; i < diff.added.size() && i < limit; i++)
+        printf("    %u\n", diff.added[i]);
+    printf("Changed rooms: %d\n", static_cast<int>(diff.changed.size()));
+    for (int i = 0; i < diff.changed.size() && i < limit; i++)
+        printf("    %u: %s\n", diff.changed[i].first, diff.changed[i].second.constData());
+
+    return (diff.removed.isEmpty() && diff.added.isEmpty() && diff.changed.isEmpty()) ? 0 : 2;
+}
+
+int doIngest(const QString &mapFile, const QString &out, const QStringList &logs, int limit)
+{
+    MapDocument base, merged;
+    IngestStats stats;
+    MapMerge merge;
+    QString error;
+
+    if (!loadDocument(mapFile, base, &error) || !LogIngest::ingestLogs(base, logs, merged, stats, merge, &error) ||
+        !MapDocumentIO::writeFile(out, merged, &error)) {
+        fprintf(stderr, "pandora-maptool: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    double seconds = qMax<qint64>(stats.msecs, 1) / 1000.0;
+    printf("Ingested %d logs, %lld bytes, %d events in %lld ms (%.1f MB/s, %.0f events/s)\n", stats.logs, stats.bytes,
+           stats.events, stats.msecs, stats.bytes / seconds / (1024 * 1024), stats.events / seconds);
+    printf("Rooms added  : %d\n", merge.added);
+    printf("Rooms updated: %d\n", merge.updated);
+    printf("Conflicts    : %d\n", static_cast<int>(merge.conflicts.size()));
+    for (int i = 0; i < merge.conflicts.size() && i < limit; i++)
+        printf("    %s\n", merge.conflicts[i].constData());
+    if (merge.conflicts.size() > limit)
+        printf("    ... and %d more\n", static_cast<int>(merge.conflicts.size()) - limit);
+    printf("Written %d rooms to %s\n", static_cast<int>(merged.rooms.size()), qPrintable(out));
+
+    return merge.conflicts.isEmpty() ? 0 : 2;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("pandora-maptool");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Pandora map utility\n\n"
+                                     "  convert <in> <out>     convert between .xml, .pmb (and from .mm2)\n"
+                                     "  public <in> <out>      export the map without secret exits and notes\n"
+                                     "  validate <file>        check exits, ids and coordinates\n"
+                                     "  stats <file>           print map statistics\n"
+                                     "  diff <first> <second>  compare two maps room by room\n"
+                                     "  ingest <map> <out> <log...>\n"
+                                     "                         map session logs (XML mode) into a copy of the map,\n"
+                                     "                         one log after the other");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "convert, public, validate, stats, diff or ingest");
+    parser.addPositionalArgument("files", "Map files (.xml, .pmb, .mm2), session logs for ingest.", "files...");
+
+    QCommandLineOption configOption(QStringList() << "c" << "config", "Config file with terrain sectors.",
+                                    "configfile");
+    QCommandLineOption threadsOption(QStringList() << "j" << "threads", "Worker threads (default: all cores).",
+                                     "amount");
+    QCommandLineOption limitOption(QStringList() << "limit", "Entries listed per group.", "amount", "20");
+    QCommandLineOption startOption(QStringList() << "start", "Room the public map is explored from.", "id", "1");
+
+    parser.addOption(configOption);
+    parser.addOption(threadsOption);
+    parser.addOption(limitOption);
+    parser.addOption(startOption);
+    parser.process(app);
+
+    conf = new Configurator();
+    conf->setLogFileEnabled(false);
+    if (parser.isSet(configOption))
+        conf->loadConfig("", parser.value(configOption).toUtf8());
+
+    if (parser.isSet(threadsOption))
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, parser.value(threadsOption).toInt()));
+
+    QStringList args = parser.positionalArguments();
+    QString command = args.isEmpty() ? QString() : args.takeFirst();
+    int limit = qMax(0, parser.value(limitOption).toInt());
+
+    if (command == "convert" && args.size() == 2)
+        return doConvert(args[0], args[1]);
+    if (command == "public" && args.size() == 2)
+        return doPublic(args[0], args[1], parser.value(startOption).toUInt());
+    if (command == "validate" && args.size() == 1)
+        return doValidate(args[0], limit);
+    if (command == "stats" && args.size() == 1)
+        return doStats(args[0]);
+    if (command == "diff" && args.size() == 2)
+        return doDiff(args[0], args[1], limit);
+    if (command == "ingest" && args.size() >= 3)
+        return doIngest(args[0], args[1], args.mid(2), limit);
+
+    parser.showHelp(1);
+}
@@ -0,0 +1,26 @@
+TEMPLATE = app
+
+CONFIG += qt c++17 thread console
+CONFIG -= app_bundle
+QT += core gui xml network concurrent
+
+TARGET = pandora-maptool
+
+# Headless map utility, see src/Utils/MapDocument.h and src/Utils/MapTools.h
+#   ./pandora-maptool convert mume.xml mume.pmb
+#   ./pandora-maptool validate mume.pmb
+#   ./pandora-maptool stats mume.xml
+#   ./pandora-maptool diff old.xml new.xml
+#   ./pandora-maptool -c mume.ini ingest mume.xml mume-new.xml logs/*.log
+#   ./pandora-maptool -c mume.ini convert arda.mm2 arda.xml
+#
+# Only the widget-free core is built in, no window, OpenGL or display needed
+
+DEFINES += NOMINMAX
+
+include(../../pandora_map.pri)
+
+SOURCES += main.cpp
+
+win32:LIBS += -lwsock32
+unix:LIBS += -lm